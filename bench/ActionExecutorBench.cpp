@@ -0,0 +1,133 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// UI thread stall: actions run inline vs. on the ActionExecutor.
+// A simulated UI loop ticks every millisecond and triggers actions against a
+// fake provider whose Invoke blocks (a busy target application). The longest
+// gap between two ticks is what the user would experience as a frozen window.
+//
+// Usage: ActionExecutorBench [--actions N] [--action-ms A] [--timeout-ms T]
+
+#include "ActionExecutor.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace UIAListCore;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct Result
+    {
+        double MaxStallMs{ 0 };
+        double ResultLatencyMs{ 0 };  // Trigger until the result is known, worst case
+        int Succeeded{ 0 };
+        int TimedOut{ 0 };
+    };
+
+    // Fake Invoke on a target that takes actionMs to answer
+    bool SlowInvoke(std::chrono::milliseconds actionMs)
+    {
+        std::this_thread::sleep_for(actionMs);
+        return true;
+    }
+
+    Result Run(bool useExecutor, int actions, std::chrono::milliseconds actionMs, std::chrono::milliseconds timeout)
+    {
+        Result result;
+        ActionExecutor executor;
+        std::atomic<int> outstanding{ 0 };
+        std::atomic<int> succeeded{ 0 };
+        std::atomic<int> timedOut{ 0 };
+        std::atomic<long long> worstLatencyUs{ 0 };
+
+        auto record = [&](Clock::time_point triggered, ActionResult actionResult)
+        {
+            long long latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - triggered).count();
+            long long worst = worstLatencyUs.load();
+            while (latency > worst && !worstLatencyUs.compare_exchange_weak(worst, latency)) {}
+
+            if (actionResult == ActionResult::Succeeded) ++succeeded;
+            else if (actionResult == ActionResult::TimedOut) ++timedOut;
+            --outstanding;
+        };
+
+        // One action every 50 ticks, then keep ticking until all results are in
+        const int ticksBetweenActions = 50;
+        int triggered = 0;
+        Clock::time_point lastTick = Clock::now();
+        double maxStallMs = 0;
+
+        for (int tick = 0; triggered < actions || outstanding > 0; ++tick)
+        {
+            if (triggered < actions && tick % ticksBetweenActions == 0)
+            {
+                ++triggered;
+                ++outstanding;
+                Clock::time_point start = Clock::now();
+
+                if (useExecutor)
+                {
+                    executor.Submit([actionMs]() { return SlowInvoke(actionMs); }, timeout,
+                                    [&record, start](ActionResult actionResult) { record(start, actionResult); });
+                }
+                else
+                {
+                    record(start, SlowInvoke(actionMs) ? ActionResult::Succeeded : ActionResult::Failed);
+                }
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            Clock::time_point now = Clock::now();
+            double stallMs = std::chrono::duration<double, std::milli>(now - lastTick).count();
+            if (stallMs > maxStallMs) maxStallMs = stallMs;
+            lastTick = now;
+        }
+
+        result.MaxStallMs = maxStallMs;
+        result.ResultLatencyMs = worstLatencyUs / 1000.0;
+        result.Succeeded = succeeded;
+        result.TimedOut = timedOut;
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int actions = 5;
+    long actionMs = 300;
+    long timeoutMs = 100;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--actions") == 0) actions = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--action-ms") == 0) actionMs = std::strtol(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--timeout-ms") == 0) timeoutMs = std::strtol(argv[i + 1], nullptr, 10);
+    }
+
+    std::printf("# %d actions, target answers after %ld ms, timeout %ld ms\n", actions, actionMs, timeoutMs);
+    std::printf("%-10s %14s %18s %10s %9s\n", "mode", "max stall ms", "result latency ms", "succeeded", "timedout");
+
+    for (bool useExecutor : { false, true })
+    {
+        Result result = Run(useExecutor, actions, std::chrono::milliseconds(actionMs), std::chrono::milliseconds(timeoutMs));
+        std::printf("%-10s %14.1f %18.1f %10d %9d\n",
+                    useExecutor ? "executor" : "inline",
+                    result.MaxStallMs, result.ResultLatencyMs, result.Succeeded, result.TimedOut);
+    }
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// Action latency: probe-chain dispatch vs. dispatch on prefetched capabilities.
+// A fake provider charges a fixed latency for every simulated cross-process call.
+//
+// Usage: ActionLatencyBench [--elements N] [--latency-us L]
+
+#include "ActionStrategy.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace UIAListCore;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct FakeControl
+    {
+        const char* Kind;
+        uint32_t Capabilities;  // What the control really supports (always "known")
+    };
+
+    // Rough type mix of a dialog with a scrolled list
+    const FakeControl kControlMix[] =
+    {
+        { "Button",            CapabilitiesKnown | CapabilityOnScreen | CapabilityInvoke | CapabilityLegacyIAccessible | CapabilityKeyboardFocusable },
+        { "CheckBox",          CapabilitiesKnown | CapabilityOnScreen | CapabilityToggle | CapabilityLegacyIAccessible | CapabilityKeyboardFocusable },
+        { "ListItem(scrolled)", CapabilitiesKnown | CapabilitySelectionItem | CapabilityLegacyIAccessible },
+        { "Hyperlink(scrolled)", CapabilitiesKnown | CapabilityInvoke | CapabilityLegacyIAccessible | CapabilityKeyboardFocusable },
+        { "TreeItem(scrolled)", CapabilitiesKnown | CapabilitySelectionItem | CapabilityKeyboardFocusable },
+        { "Custom(scrolled)",  CapabilitiesKnown },
+    };
+
+    void SpinFor(std::chrono::microseconds duration)
+    {
+        const auto end = Clock::now() + duration;
+        while (Clock::now() < end) {}
+    }
+
+    // Fake element: every probe is one "cross-process" call, performing the action another one
+    class FakeTarget : public ActionTarget
+    {
+    public:
+        FakeTarget(uint32_t capabilities, std::chrono::microseconds latency)
+            : m_capabilities(capabilities), m_latency(latency) {}
+
+        bool Run(ActionStrategy strategy, ActionKind) override
+        {
+            switch (strategy)
+            {
+            case ActionStrategy::Mouse: return Call(CapabilityOnScreen);  // Bounding rectangle
+            case ActionStrategy::Invoke: return Probe(CapabilityInvoke);
+            case ActionStrategy::LegacyDefaultAction: return Probe(CapabilityLegacyIAccessible);
+            case ActionStrategy::SelectionItem: return Probe(CapabilitySelectionItem);
+            case ActionStrategy::Toggle: return Probe(CapabilityToggle);
+            case ActionStrategy::SetFocus: return Call(CapabilityKeyboardFocusable);
+            case ActionStrategy::KeyboardTab: return false;  // Input only, no UIA call
+            }
+            return false;
+        }
+
+        uint64_t Calls() const { return m_calls; }
+
+    private:
+        bool Call(uint32_t capability)
+        {
+            ++m_calls;
+            SpinFor(m_latency);
+            return (m_capabilities & capability) != 0;
+        }
+
+        // GetCurrentPatternAs, then the pattern method when available
+        bool Probe(uint32_t capability)
+        {
+            return Call(capability) && Call(capability);
+        }
+
+        uint32_t m_capabilities;
+        std::chrono::microseconds m_latency;
+        uint64_t m_calls{ 0 };
+    };
+
+    struct Result
+    {
+        uint64_t Calls{ 0 };
+        uint64_t Succeeded{ 0 };
+        double Microseconds{ 0 };
+    };
+
+    Result Run(ActionKind kind, bool prefetched, size_t elements, std::chrono::microseconds latency)
+    {
+        Result result;
+        const auto start = Clock::now();
+
+        for (size_t i = 0; i < elements; ++i)
+        {
+            const FakeControl& control = kControlMix[i % (sizeof(kControlMix) / sizeof(kControlMix[0]))];
+            FakeTarget target(control.Capabilities, latency);
+
+            const uint32_t capabilities = prefetched ? control.Capabilities : CapabilitiesNone;
+            if (ExecutePlan(PlanAction(kind, capabilities), kind, target)) ++result.Succeeded;
+            result.Calls += target.Calls();
+        }
+
+        result.Microseconds = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t elements = 6000;
+    long latencyUs = 50;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--elements") == 0) elements = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--latency-us") == 0) latencyUs = std::strtol(argv[i + 1], nullptr, 10);
+    }
+
+    const std::chrono::microseconds latency(latencyUs);
+    std::printf("# %zu actions per row, %ld us per simulated cross-process call\n", elements, latencyUs);
+    std::printf("%-13s %-11s %12s %14s %10s\n", "action", "dispatch", "calls/action", "us/action", "succeeded");
+
+    for (ActionKind kind : { ActionKind::Click, ActionKind::DoubleClick, ActionKind::Focus })
+    {
+        for (bool prefetched : { false, true })
+        {
+            Result result = Run(kind, prefetched, elements, latency);
+            std::printf("%-13s %-11s %12.2f %14.1f %10llu\n",
+                        ToString(kind), prefetched ? "prefetched" : "probe",
+                        static_cast<double>(result.Calls) / elements,
+                        result.Microseconds / elements,
+                        static_cast<unsigned long long>(result.Succeeded));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,234 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// Screen reader announcements under synthetic key repeat and typing, on a
+// simulated clock. Direct is what the Qt frontend did before the
+// AnnouncementScheduler: every selection move and status change raised its
+// two accessibility events at once. The scheduler rows drive it the way
+// the frontend's timer does. Events are accessibility events (two per
+// announcement); max/s is the most in any one-second window; final ms is
+// how long after the last keystroke the final state was announced.
+// The benchmark fails when a kind is announced twice within MinInterval
+// or the final state of a kind is never announced.
+//
+// Usage: AnnouncementBench [--min-interval MS] [--settle MS] [--max-delay MS] [--seed N]
+
+#include "AnnouncementScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace UIAListCore;
+using Clock = AnnouncementScheduler::Clock;
+using std::chrono::milliseconds;
+
+namespace
+{
+    constexpr size_t EventsPerAnnouncement = 2;
+
+    struct Input
+    {
+        milliseconds At;
+        Announcement Kind;
+    };
+
+    struct Output
+    {
+        milliseconds At;
+        Announcement Kind;
+    };
+
+    struct Scenario
+    {
+        const char* Name;
+        std::vector<Input> Inputs;
+    };
+
+    // An arrow key held down: one move, the keyboard delay, then repeats
+    void HoldKey(std::vector<Input>& inputs, milliseconds start, milliseconds held, double hz)
+    {
+        inputs.push_back({ start, Announcement::Selection });
+        const auto period = std::chrono::duration<double, std::milli>(1000.0 / hz);
+        for (auto at = std::chrono::duration<double, std::milli>(500); at < held; at += period)
+        {
+            inputs.push_back({ start + std::chrono::duration_cast<milliseconds>(at), Announcement::Selection });
+        }
+    }
+
+    std::vector<Scenario> MakeScenarios(uint32_t seed)
+    {
+        std::vector<Scenario> scenarios;
+        std::mt19937 random(seed);
+
+        Scenario taps{ "arrow taps 3/s", {} };
+        for (int i = 0; i < 10; ++i) taps.Inputs.push_back({ milliseconds(i * 330), Announcement::Selection });
+        scenarios.push_back(std::move(taps));
+
+        Scenario hold30{ "hold 3 s at 30 Hz", {} };
+        HoldKey(hold30.Inputs, milliseconds(0), milliseconds(3000), 30.0);
+        scenarios.push_back(std::move(hold30));
+
+        Scenario hold60{ "hold 3 s at 60 Hz", {} };
+        HoldKey(hold60.Inputs, milliseconds(0), milliseconds(3000), 60.0);
+        scenarios.push_back(std::move(hold60));
+
+        // Filter typing: every keystroke moves the selection to the best match
+        Scenario typing{ "typing 12 chars/s", {} };
+        std::uniform_int_distribution<int> gap(40, 130);
+        milliseconds at(0);
+        for (int word = 0; word < 4; ++word)
+        {
+            for (int c = 0; c < 6; ++c)
+            {
+                typing.Inputs.push_back({ at, Announcement::Selection });
+                at += milliseconds(gap(random));
+            }
+            at += milliseconds(400);
+        }
+        scenarios.push_back(std::move(typing));
+
+        // List shown: status and first row, then arrowing through it
+        Scenario shown{ "shown, then hold", {} };
+        shown.Inputs.push_back({ milliseconds(0), Announcement::Status });
+        shown.Inputs.push_back({ milliseconds(0), Announcement::Selection });
+        shown.Inputs.push_back({ milliseconds(20), Announcement::Status });
+        HoldKey(shown.Inputs, milliseconds(60), milliseconds(2000), 30.0);
+        scenarios.push_back(std::move(shown));
+
+        return scenarios;
+    }
+
+    // Mirrors the frontend: each input submitted, a timer fired at NextDue
+    std::vector<Output> Schedule(const std::vector<Input>& inputs, const AnnouncementScheduler::Timing& timing,
+                                 AnnouncementScheduler::Stats& stats)
+    {
+        AnnouncementScheduler scheduler(timing);
+        const Clock::time_point origin{};
+        std::vector<Output> outputs;
+
+        size_t next = 0;
+        for (;;)
+        {
+            const Clock::time_point due = scheduler.NextDue();
+            const bool haveInput = next < inputs.size();
+            if (!haveInput && due == Clock::time_point::max()) break;
+
+            if (haveInput && origin + inputs[next].At < due)
+            {
+                const Input& input = inputs[next++];
+                if (scheduler.Submit(input.Kind, origin + input.At)) outputs.push_back({ input.At, input.Kind });
+                continue;
+            }
+            for (Announcement kind : scheduler.TakeDue(due))
+            {
+                outputs.push_back({ std::chrono::duration_cast<milliseconds>(due - origin), kind });
+            }
+        }
+        stats = scheduler.GetStats();
+        return outputs;
+    }
+
+    size_t MaxPerSecond(const std::vector<Output>& outputs)
+    {
+        size_t most = 0;
+        size_t first = 0;
+        for (size_t last = 0; last < outputs.size(); ++last)
+        {
+            while (outputs[last].At - outputs[first].At >= milliseconds(1000)) ++first;
+            most = std::max(most, last - first + 1);
+        }
+        return most * EventsPerAnnouncement;
+    }
+
+    // Announcements of a kind closer than MinInterval, or a kind whose last
+    // input came after its last announcement
+    bool Check(const std::vector<Input>& inputs, const std::vector<Output>& outputs,
+               const AnnouncementScheduler::Timing& timing, double& finalMs)
+    {
+        bool ok = true;
+        finalMs = 0.0;
+        for (size_t k = 0; k < static_cast<size_t>(Announcement::Count); ++k)
+        {
+            const Announcement kind = static_cast<Announcement>(k);
+            milliseconds lastInput(-1);
+            for (const Input& input : inputs)
+            {
+                if (input.Kind == kind) lastInput = std::max(lastInput, input.At);
+            }
+            if (lastInput.count() < 0) continue;
+
+            milliseconds lastOutput(-1);
+            milliseconds previous(-1);
+            for (const Output& output : outputs)
+            {
+                if (output.Kind != kind) continue;
+                if (previous.count() >= 0 && output.At - previous < timing.MinInterval)
+                {
+                    std::fprintf(stderr, "%s announced %lld ms after the previous one\n", ToString(kind),
+                                 static_cast<long long>((output.At - previous).count()));
+                    ok = false;
+                }
+                previous = output.At;
+                lastOutput = output.At;
+            }
+            if (lastOutput < lastInput)
+            {
+                std::fprintf(stderr, "Final %s never announced\n", ToString(kind));
+                ok = false;
+                continue;
+            }
+            finalMs = std::max(finalMs, static_cast<double>((lastOutput - lastInput).count()));
+        }
+        return ok;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    AnnouncementScheduler::Timing timing;
+    uint32_t seed = 1;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--min-interval") == 0) timing.MinInterval = milliseconds(std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--settle") == 0) timing.Settle = milliseconds(std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--max-delay") == 0) timing.MaxDelay = milliseconds(std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--seed") == 0) seed = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+    }
+
+    std::printf("# min interval %lld ms, settle %lld ms, max delay %lld ms, %zu events per announcement\n",
+                static_cast<long long>(timing.MinInterval.count()), static_cast<long long>(timing.Settle.count()),
+                static_cast<long long>(timing.MaxDelay.count()), EventsPerAnnouncement);
+    std::printf("%-20s %-10s %8s %8s %8s %9s %9s\n",
+                "scenario", "variant", "inputs", "events", "max/s", "coalesced", "final ms");
+
+    bool ok = true;
+    for (const Scenario& scenario : MakeScenarios(seed))
+    {
+        std::vector<Output> direct;
+        for (const Input& input : scenario.Inputs) direct.push_back({ input.At, input.Kind });
+        std::printf("%-20s %-10s %8zu %8zu %8zu %9d %9.0f\n", scenario.Name, "direct",
+                    scenario.Inputs.size(), direct.size() * EventsPerAnnouncement, MaxPerSecond(direct), 0, 0.0);
+
+        AnnouncementScheduler::Stats stats;
+        const std::vector<Output> scheduled = Schedule(scenario.Inputs, timing, stats);
+        double finalMs = 0.0;
+        ok = Check(scenario.Inputs, scheduled, timing, finalMs) && ok;
+        std::printf("%-20s %-10s %8zu %8zu %8zu %9llu %9.0f\n", scenario.Name, "scheduler",
+                    scenario.Inputs.size(), scheduled.size() * EventsPerAnnouncement, MaxPerSecond(scheduled),
+                    static_cast<unsigned long long>(stats.Coalesced), finalMs);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// Enumeration walk: ControlWalker variants against a synthetic control tree.
+// Reports cross-process calls per node and walk throughput. With the default
+// zero latency nodes/s is the walker's own overhead; --latency-us adds a
+// simulated round trip per call.
+//
+// Usage: EnumerationBench [--sizes 1000,10000,...] [--latency-us L] [--jitter-us J]
+//                         [--fanout F] [--depth D] [--record FILE]
+//        EnumerationBench --replay FILE [--timing original|fast]
+//   --record   saves the BuildCache walk of the first size as a tree recording
+//   --replay   walks a recorded tree (see TreeRecording.h) instead of synthetic ones
+
+#include "ControlWalker.h"
+#include "SyntheticTreeProvider.h"
+#include "TreeRecording.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace UIAListCore;
+using namespace UIAListBench;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    // What the enumerator asks for
+    const uint32_t kProperties = PropertyControlType | PropertyName | PropertyAutomationId | PropertyCapabilities;
+
+    struct Result
+    {
+        size_t Visited{ 0 };
+        uint64_t Calls{ 0 };
+        double Seconds{ 0 };
+    };
+
+    Result Run(TreeProvider& provider, WalkMode mode)
+    {
+        Result result;
+        const uint64_t calls = provider.Calls();
+
+        // Build the display text like the enumerator does, so string work is included
+        std::wstring displayText;
+        size_t checksum = 0;
+
+        const auto start = Clock::now();
+        ControlWalker walker(provider, mode, kProperties);
+        walker.Walk([&](TreeElement&, const ElementProperties& properties, size_t)
+        {
+            displayText = std::to_wstring(properties.ControlType);
+            displayText += L": ";
+            displayText += properties.HasName ? properties.Name : std::wstring(L"(no name)");
+            checksum += displayText.size() + properties.Capabilities;
+            ++result.Visited;
+        });
+        result.Seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.Calls = provider.Calls() - calls;
+
+        if (checksum == 0) std::printf("# empty walk\n");
+        return result;
+    }
+
+    std::vector<size_t> ParseSizes(const char* text)
+    {
+        std::vector<size_t> sizes;
+        while (*text)
+        {
+            char* end = nullptr;
+            size_t size = std::strtoul(text, &end, 10);
+            if (end == text) break;
+            if (size > 0) sizes.push_back(size);
+            text = (*end == ',') ? end + 1 : end;
+        }
+        return sizes;
+    }
+
+    void PrintResult(const Result& result, const char* walk)
+    {
+        std::printf("%-9zu %-13s %11.2f %14.0f %12.1f\n",
+                    result.Visited, walk,
+                    result.Visited ? static_cast<double>(result.Calls) / result.Visited : 0.0,
+                    result.Seconds > 0 ? result.Visited / result.Seconds : 0.0,
+                    result.Seconds * 1000.0);
+    }
+
+    int Replay(const char* path, ReplayTreeProvider::Timing timing)
+    {
+        TreeRecording recording;
+        if (!TreeRecording::Load(path, recording))
+        {
+            std::fprintf(stderr, "Cannot read tree recording %s\n", path);
+            return 1;
+        }
+
+        std::printf("# %s: %zu nodes recorded from %s (%s), %s timing\n", path, recording.Nodes.size(),
+                    recording.ProcessImage.c_str(), recording.Mode.c_str(),
+                    timing == ReplayTreeProvider::Timing::Original ? "original" : "no");
+        std::printf("%-9s %-13s %11s %14s %12s\n", "nodes", "walk", "calls/node", "nodes/s", "ms");
+
+        // The recording fixes what was cached, so there is one walk to replay
+        ReplayTreeProvider provider(recording, timing);
+        PrintResult(Run(provider, WalkMode::BuildCache), "Replay");
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<size_t> sizes = { 1000, 10000, 100000, 1000000 };
+    long latencyUs = 0;
+    long jitterUs = 0;
+    SyntheticTreeShape shape;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    ReplayTreeProvider::Timing timing = ReplayTreeProvider::Timing::AsFastAsPossible;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--record") == 0) recordPath = argv[i + 1];
+        else if (std::strcmp(argv[i], "--replay") == 0) replayPath = argv[i + 1];
+        else if (std::strcmp(argv[i], "--timing") == 0)
+        {
+            timing = std::strcmp(argv[i + 1], "original") == 0 ? ReplayTreeProvider::Timing::Original
+                                                               : ReplayTreeProvider::Timing::AsFastAsPossible;
+        }
+        else if (std::strcmp(argv[i], "--sizes") == 0) sizes = ParseSizes(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--latency-us") == 0) latencyUs = std::strtol(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--jitter-us") == 0) jitterUs = std::strtol(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--fanout") == 0) shape.FanOut = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--depth") == 0) shape.MaxDepth = std::strtoul(argv[i + 1], nullptr, 10);
+    }
+
+    if (replayPath) return Replay(replayPath, timing);
+
+    SyntheticLatency latency;
+    latency.PerCall = std::chrono::microseconds(latencyUs);
+    latency.Jitter = std::chrono::microseconds(jitterUs);
+
+    std::printf("# fan-out %zu, max depth %zu, %ld us (+/- %ld us) per simulated cross-process call\n",
+                shape.FanOut, shape.MaxDepth, latencyUs, jitterUs);
+    std::printf("%-9s %-13s %11s %14s %12s\n", "nodes", "walk", "calls/node", "nodes/s", "ms");
+
+    for (size_t size : sizes)
+    {
+        shape.Nodes = size;
+        SyntheticTreeProvider provider(shape, latency);
+
+        for (WalkMode mode : { WalkMode::Current, WalkMode::BuildCache, WalkMode::SubtreeCache })
+        {
+            PrintResult(Run(provider, mode), ToString(mode));
+        }
+
+        if (recordPath)
+        {
+            RecordingTreeProvider recorder(provider);
+            recorder.SetProcessImage("synthetic");
+            Run(recorder, WalkMode::BuildCache);
+            if (!recorder.Recording().Save(recordPath))
+            {
+                std::fprintf(stderr, "Cannot write tree recording %s\n", recordPath);
+                return 1;
+            }
+            recordPath = nullptr;
+        }
+    }
+
+    return 0;
+}
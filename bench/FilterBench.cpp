@@ -0,0 +1,376 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// List filtering: per-keystroke cost of the filter pass and of the
+// hide-empty/hide-menus passes on generated application corpora.
+// The reference passes are a std::wstring port of what the Qt frontend did
+// before FilterEngine (widget updates excluded); the engine rows run the
+// shared FilterEngine on the same keystrokes and must list the same
+// controls, or the benchmark fails.
+//
+// Usage: FilterBench [--repeat R] [--scale S] [--seed N] [--json] [--replay FILE]
+//   --replay filters the controls of a tree recording instead of the generated corpora
+//   items: listed items for populate, items still visible after the session for filter
+//   --json prints one JSON object per line for regression tracking
+
+#include "FilterCorpus.h"
+#include "FilterEngine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwctype>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace UIAListBench;
+using Clock = std::chrono::steady_clock;
+
+// Allocation counting for the allocations-per-keystroke column
+static std::atomic<uint64_t> g_allocations{ 0 };
+
+void* operator new(std::size_t size)
+{
+    ++g_allocations;
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+namespace
+{
+    // UIA control type ids used by the passes
+    const int32_t kMenu = 50009;
+    const int32_t kMenuBar = 50010;
+    const int32_t kMenuItem = 50011;
+    const int32_t kText = 50020;
+    const int32_t kWindow = 50032;
+
+    // populateListWidget: indices of the controls that get a list item
+    std::vector<size_t> Populate(const std::vector<CorpusControl>& controls, bool hideEmptyTitles, bool hideMenus)
+    {
+        std::vector<size_t> listed;
+        for (size_t i = 0; i < controls.size(); ++i)
+        {
+            const CorpusControl& control = controls[i];
+            if (control.ControlType == kText || control.ControlType == kWindow) continue;
+
+            if (hideEmptyTitles)
+            {
+                const std::wstring& name = control.OriginalName;
+                size_t first = name.find_first_not_of(L" \t\r\n");
+                if (first == std::wstring::npos || name == L"(no name)") continue;
+            }
+
+            if (hideMenus &&
+                (control.ControlType == kMenu || control.ControlType == kMenuBar || control.ControlType == kMenuItem))
+            {
+                continue;
+            }
+
+            listed.push_back(i);
+        }
+        return listed;
+    }
+
+    bool ContainsCaseInsensitive(const std::wstring& text, const std::wstring& word)
+    {
+        if (word.size() > text.size()) return false;
+        for (size_t start = 0; start + word.size() <= text.size(); ++start)
+        {
+            size_t i = 0;
+            while (i < word.size() && std::towlower(text[start + i]) == std::towlower(word[i])) ++i;
+            if (i == word.size()) return true;
+        }
+        return false;
+    }
+
+    // onFilterChanged: split into words, an item stays visible when it contains all of them
+    size_t Filter(const std::vector<CorpusControl>& controls, const std::vector<size_t>& listed,
+                  const std::wstring& text, std::vector<char>& hidden)
+    {
+        std::vector<std::wstring> words;
+        size_t position = 0;
+        while (position < text.size())
+        {
+            while (position < text.size() && std::iswspace(text[position])) ++position;
+            size_t end = position;
+            while (end < text.size() && !std::iswspace(text[end])) ++end;
+            if (end > position) words.emplace_back(text, position, end - position);
+            position = end;
+        }
+
+        size_t visible = 0;
+        for (size_t i = 0; i < listed.size(); ++i)
+        {
+            const std::wstring& itemText = controls[listed[i]].DisplayText;
+            bool match = true;
+            for (const std::wstring& word : words)
+            {
+                if (!ContainsCaseInsensitive(itemText, word))
+                {
+                    match = false;
+                    break;
+                }
+            }
+            hidden[i] = !match;
+            if (match) ++visible;
+        }
+        return visible;
+    }
+
+    std::u16string ToUtf16(const std::wstring& text)
+    {
+        std::u16string utf16;
+        utf16.reserve(text.size());
+        for (wchar_t c : text)
+        {
+            const uint32_t code = static_cast<uint32_t>(c);
+            if (code > 0xFFFF)
+            {
+                utf16.push_back(static_cast<char16_t>(0xD800 + ((code - 0x10000) >> 10)));
+                utf16.push_back(static_cast<char16_t>(0xDC00 + ((code - 0x10000) & 0x3FF)));
+            }
+            else
+            {
+                utf16.push_back(static_cast<char16_t>(code));
+            }
+        }
+        return utf16;
+    }
+
+    // The corpus as the frontends hand it to the engine
+    struct Utf16Control
+    {
+        std::u16string DisplayText;
+        std::u16string OriginalName;
+    };
+
+    struct Stats
+    {
+        double P50{ 0 };
+        double P99{ 0 };
+        double Max{ 0 };
+        double AllocationsPerRun{ 0 };
+        size_t Samples{ 0 };
+    };
+
+    Stats Summarize(std::vector<double>& microseconds, uint64_t allocations)
+    {
+        Stats stats;
+        stats.Samples = microseconds.size();
+        if (microseconds.empty()) return stats;
+
+        std::sort(microseconds.begin(), microseconds.end());
+        auto at = [&](double quantile)
+        {
+            size_t index = static_cast<size_t>(quantile * (microseconds.size() - 1) + 0.5);
+            return microseconds[index];
+        };
+        stats.P50 = at(0.50);
+        stats.P99 = at(0.99);
+        stats.Max = microseconds.back();
+        stats.AllocationsPerRun = static_cast<double>(allocations) / microseconds.size();
+        return stats;
+    }
+
+    template <typename Fn>
+    double Timed(Fn&& fn)
+    {
+        const auto start = Clock::now();
+        fn();
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+
+    void Print(bool json, const char* bench, const FilterCorpus& corpus, size_t items, const char* variant,
+               const Stats& stats)
+    {
+        if (json)
+        {
+            std::printf("{\"bench\":\"%s\",\"corpus\":\"%s\",\"controls\":%zu,\"items\":%zu,\"variant\":\"%s\","
+                        "\"samples\":%zu,\"p50_us\":%.2f,\"p99_us\":%.2f,\"max_us\":%.2f,\"allocs_per_run\":%.2f}\n",
+                        bench, corpus.Name, corpus.Controls.size(), items, variant,
+                        stats.Samples, stats.P50, stats.P99, stats.Max, stats.AllocationsPerRun);
+        }
+        else
+        {
+            std::printf("%-9s %-14s %8zu %-22s %9.1f %9.1f %9.1f %8.1f\n",
+                        bench, corpus.Name, items, variant, stats.P50, stats.P99, stats.Max, stats.AllocationsPerRun);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int repeat = 5;
+    double scale = 1.0;
+    uint32_t seed = 1;
+    bool json = false;
+    const char* replayPath = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--json") == 0) json = true;
+        else if (i + 1 < argc && std::strcmp(argv[i], "--repeat") == 0) repeat = std::atoi(argv[++i]);
+        else if (i + 1 < argc && std::strcmp(argv[i], "--scale") == 0) scale = std::atof(argv[++i]);
+        else if (i + 1 < argc && std::strcmp(argv[i], "--seed") == 0) seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (i + 1 < argc && std::strcmp(argv[i], "--replay") == 0) replayPath = argv[++i];
+    }
+
+    // Case-insensitive matching of non-ASCII names needs a Unicode locale
+    if (!std::setlocale(LC_CTYPE, "C.UTF-8")) std::setlocale(LC_CTYPE, "");
+
+    size_t mismatches = 0;
+    std::vector<FilterCorpus> corpora;
+    if (replayPath)
+    {
+        UIAListCore::TreeRecording recording;
+        if (!UIAListCore::TreeRecording::Load(replayPath, recording))
+        {
+            std::fprintf(stderr, "Cannot read tree recording %s\n", replayPath);
+            return 1;
+        }
+        corpora.push_back(CorpusFromRecording(recording));
+    }
+    else
+    {
+        corpora = GenerateFilterCorpora(seed, scale);
+    }
+
+    if (!json)
+    {
+        std::printf("# %d runs per sample set, latencies in us\n", repeat);
+        std::printf("%-9s %-14s %8s %-22s %9s %9s %9s %8s\n",
+                    "bench", "corpus", "items", "variant", "p50", "p99", "max", "allocs");
+    }
+
+    for (const FilterCorpus& corpus : corpora)
+    {
+        // Populate passes, once per checkbox combination
+        for (int flags = 0; flags < 4; ++flags)
+        {
+            const bool hideEmpty = (flags & 1) != 0;
+            const bool hideMenus = (flags & 2) != 0;
+            static const char* variants[] = { "all", "hide-empty", "hide-menus", "hide-empty+menus" };
+
+            std::vector<double> samples;
+            size_t listed = 0;
+            uint64_t allocations = g_allocations;
+            for (int run = 0; run < repeat; ++run)
+            {
+                samples.push_back(Timed([&]() { listed = Populate(corpus.Controls, hideEmpty, hideMenus).size(); }));
+            }
+            allocations = g_allocations - allocations;
+            Print(json, "populate", corpus, listed, variants[flags], Summarize(samples, allocations));
+        }
+
+        // Scripted sessions on the default list (hide-empty on, as after the welcome dialog)
+        const std::vector<size_t> listed = Populate(corpus.Controls, true, false);
+        std::vector<char> hidden(listed.size(), 0);
+
+        std::vector<Utf16Control> utf16;
+        utf16.reserve(corpus.Controls.size());
+        size_t textUnits = 0;
+        for (const CorpusControl& control : corpus.Controls)
+        {
+            utf16.push_back({ ToUtf16(control.DisplayText), ToUtf16(control.OriginalName) });
+            textUnits += utf16.back().DisplayText.size() + utf16.back().OriginalName.size();
+        }
+
+        // The engine lists the same controls as the reference pass
+        UIAListCore::ListOptions options;
+        options.HideEmptyTitles = true;
+        std::vector<size_t> engineListed;
+        for (size_t i = 0; i < corpus.Controls.size(); ++i)
+        {
+            if (UIAListCore::IsListed(corpus.Controls[i].ControlType, utf16[i].OriginalName, options)) engineListed.push_back(i);
+        }
+        if (engineListed != listed)
+        {
+            std::fprintf(stderr, "%s: FilterEngine lists %zu controls, the reference %zu\n",
+                         corpus.Name, engineListed.size(), listed.size());
+            mismatches++;
+        }
+
+        // Building the engine's rows, once per list
+        UIAListCore::FilterEngine engine;
+        {
+            std::vector<double> samples;
+            uint64_t allocations = g_allocations;
+            for (int run = 0; run < repeat; ++run)
+            {
+                samples.push_back(Timed([&]() {
+                    engine.Clear();
+                    engine.Reserve(listed.size(), textUnits);
+                    for (size_t index : listed) engine.Add(utf16[index].DisplayText, utf16[index].OriginalName);
+                }));
+            }
+            allocations = g_allocations - allocations;
+            Print(json, "populate", corpus, engine.Size(), "engine-build", Summarize(samples, allocations));
+        }
+
+        for (const QuerySession& session : corpus.Sessions)
+        {
+            std::vector<double> samples;
+            std::vector<double> engineSamples;
+            uint64_t allocations = 0;
+            uint64_t engineAllocations = 0;
+            size_t visible = 0;
+            size_t engineVisible = 0;
+
+            for (int run = 0; run < repeat; ++run)
+            {
+                std::wstring query;
+                engine.SetQuery(u"");
+                for (wchar_t key : session.Keystrokes)
+                {
+                    if (key == L'\b')
+                    {
+                        if (!query.empty()) query.pop_back();
+                    }
+                    else
+                    {
+                        query.push_back(key);
+                    }
+
+                    uint64_t before = g_allocations;
+                    samples.push_back(Timed([&]() { visible = Filter(corpus.Controls, listed, query, hidden); }));
+                    allocations += g_allocations - before;
+
+                    const std::u16string query16 = ToUtf16(query);
+                    before = g_allocations;
+                    engineSamples.push_back(Timed([&]() { engineVisible = engine.SetQuery(query16); }));
+                    engineAllocations += g_allocations - before;
+
+                    if (engineVisible != visible)
+                    {
+                        std::fprintf(stderr, "%s %s: FilterEngine keeps %zu rows, the reference %zu\n",
+                                     corpus.Name, session.Label, engineVisible, visible);
+                        mismatches++;
+                    }
+                }
+            }
+
+            std::string variant = std::string("keystroke:") + session.Label;
+            Print(json, "filter", corpus, visible, variant.c_str(), Summarize(samples, allocations));
+            variant = std::string("engine:") + session.Label;
+            Print(json, "filter", corpus, engineVisible, variant.c_str(), Summarize(engineSamples, engineAllocations));
+        }
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,271 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "FilterCorpus.h"
+#include "SyntheticTreeProvider.h"
+
+#include <random>
+
+namespace UIAListBench
+{
+    namespace
+    {
+        const wchar_t* TypeName(int32_t controlType)
+        {
+            switch (controlType)
+            {
+            case TypeButton: return L"Button";
+            case TypeCheckBox: return L"CheckBox";
+            case TypeComboBox: return L"ComboBox";
+            case TypeEdit: return L"Edit";
+            case TypeHyperlink: return L"Hyperlink";
+            case TypeImage: return L"Image";
+            case TypeListItem: return L"ListItem";
+            case TypeList: return L"List";
+            case TypeMenu: return L"Menu";
+            case TypeMenuBar: return L"MenuBar";
+            case TypeMenuItem: return L"MenuItem";
+            case TypeTab: return L"Tab";
+            case TypeTabItem: return L"TabItem";
+            case TypeText: return L"Text";
+            case TypeToolBar: return L"ToolBar";
+            case TypeTreeItem: return L"TreeItem";
+            case TypeGroup: return L"Group";
+            case TypeDataGrid: return L"DataGrid";
+            case TypeDataItem: return L"DataItem";
+            case TypeDocument: return L"Document";
+            case TypeSplitButton: return L"SplitButton";
+            case TypeWindow: return L"Window";
+            case TypePane: return L"Pane";
+            }
+            return L"Custom";
+        }
+
+        void Add(FilterCorpus& corpus, int32_t controlType, const std::wstring& name)
+        {
+            CorpusControl control;
+            control.ControlType = controlType;
+            control.OriginalName = name.empty() ? L"(no name)" : name;
+            control.DisplayText = std::wstring(TypeName(controlType)) + L": " + control.OriginalName;
+            corpus.Controls.push_back(std::move(control));
+        }
+
+        template <typename T, size_t N>
+        const T& Pick(std::mt19937& random, const T (&items)[N])
+        {
+            return items[std::uniform_int_distribution<size_t>(0, N - 1)(random)];
+        }
+
+        size_t Scaled(size_t count, double scale)
+        {
+            size_t scaled = static_cast<size_t>(count * scale);
+            return scaled > 0 ? scaled : 1;
+        }
+
+        FilterCorpus OfficeRibbon(std::mt19937& random, double scale)
+        {
+            static const wchar_t* commands[] =
+            {
+                L"Paste", L"Cut", L"Copy", L"Format Painter", L"Bold", L"Italic", L"Underline",
+                L"Strikethrough", L"Subscript", L"Superscript", L"Text Highlight Color", L"Font Color",
+                L"Bullets", L"Numbering", L"Multilevel List", L"Decrease Indent", L"Increase Indent",
+                L"Sort", L"Show/Hide", L"Align Left", L"Center", L"Align Right", L"Justify",
+                L"Line and Paragraph Spacing", L"Shading", L"Borders", L"Styles", L"Find", L"Replace",
+                L"Select", L"Dictate", L"Editor", L"Reuse Files", L"Insert Table", L"Pictures",
+                L"Shapes", L"Icons", L"3D Models", L"SmartArt", L"Chart", L"Screenshot", L"Link",
+                L"Bookmark", L"Cross-reference", L"Comment", L"Header", L"Footer", L"Page Number",
+                L"Text Box", L"Quick Parts", L"WordArt", L"Drop Cap", L"Equation", L"Symbol",
+                L"Track Changes", L"Accept", L"Reject", L"Previous", L"Next", L"Compare", L"Protect",
+            };
+            static const wchar_t* tabs[] =
+            {
+                L"File", L"Home", L"Insert", L"Draw", L"Design", L"Layout", L"References",
+                L"Mailings", L"Review", L"View", L"Help",
+            };
+            static const int32_t commandTypes[] = { TypeButton, TypeButton, TypeSplitButton, TypeMenuItem, TypeCheckBox, TypeComboBox };
+
+            FilterCorpus corpus{ "office-ribbon", {}, {} };
+            Add(corpus, TypeWindow, L"Document1 - Word");
+            Add(corpus, TypeMenuBar, L"");
+            for (const wchar_t* tab : tabs) Add(corpus, TypeTabItem, tab);
+
+            const size_t count = Scaled(3000, scale);
+            while (corpus.Controls.size() < count)
+            {
+                // Groups of commands inside unnamed toolbars and panes, repeated per tab and gallery
+                Add(corpus, (random() % 2) ? TypeToolBar : TypePane, L"");
+                Add(corpus, TypeGroup, Pick(random, tabs));
+                for (int i = 0; i < 12; ++i)
+                {
+                    Add(corpus, Pick(random, commandTypes), Pick(random, commands));
+                }
+                Add(corpus, TypeMenu, L"");
+                Add(corpus, TypeText, Pick(random, commands));
+            }
+
+            corpus.Sessions =
+            {
+                { "word", L"format painter" },
+                { "two-words", L"but bol" },
+                { "typo", L"unde\b\b\bnderline" },
+                { "type-filter", L"menuitem" },
+            };
+            return corpus;
+        }
+
+        FilterCorpus ElectronDom(std::mt19937& random, double scale)
+        {
+            static const wchar_t* words[] =
+            {
+                L"the", L"channel", L"message", L"reply", L"thread", L"reaction", L"added", L"by",
+                L"notification", L"settings", L"workspace", L"direct", L"mention", L"unread",
+                L"yesterday", L"today", L"at", L"pm", L"am", L"shared", L"file", L"image", L"link",
+                L"preview", L"open", L"in", L"browser", L"more", L"actions", L"for", L"this",
+            };
+            static const int32_t types[] = { TypeGroup, TypeGroup, TypeGroup, TypeText, TypeText, TypeHyperlink, TypeButton, TypeListItem, TypeImage, TypeDocument };
+
+            FilterCorpus corpus{ "electron-dom", {}, {} };
+            Add(corpus, TypeWindow, L"Team Chat");
+
+            const size_t count = Scaled(20000, scale);
+            std::bernoulli_distribution unnamed(0.4);
+            std::uniform_int_distribution<int> sentenceLength(2, 18);
+            while (corpus.Controls.size() < count)
+            {
+                int32_t type = Pick(random, types);
+                std::wstring name;
+                if (!(type == TypeGroup && unnamed(random)))
+                {
+                    int length = sentenceLength(random);
+                    for (int i = 0; i < length; ++i)
+                    {
+                        if (i) name += L' ';
+                        name += Pick(random, words);
+                    }
+                }
+                Add(corpus, type, name);
+            }
+
+            corpus.Sessions =
+            {
+                { "phrase", L"reply in thread" },
+                { "short", L"op" },
+                { "no-match", L"zzq" },
+                { "retype", L"shared fil\b\b\bfile link" },
+            };
+            return corpus;
+        }
+
+        FilterCorpus DataGrid(std::mt19937& random, double scale)
+        {
+            FilterCorpus corpus{ "data-grid", {}, {} };
+            Add(corpus, TypeWindow, L"Orders.xlsx - Excel");
+            Add(corpus, TypeDataGrid, L"");
+
+            const size_t count = Scaled(50000, scale);
+            std::uniform_int_distribution<int> amount(0, 99999);
+            for (int row = 1; corpus.Controls.size() < count; ++row)
+            {
+                // Unnamed row containers with a few named cells
+                Add(corpus, TypeDataItem, L"");
+                for (int column = 0; column < 6; ++column)
+                {
+                    if (column % 3 == 2)
+                    {
+                        Add(corpus, TypeDataItem, L"");
+                    }
+                    else
+                    {
+                        Add(corpus, TypeDataItem, L"Row " + std::to_wstring(row) + L", " +
+                            std::wstring(1, static_cast<wchar_t>(L'A' + column)) + L" " + std::to_wstring(amount(random)));
+                    }
+                }
+            }
+
+            corpus.Sessions =
+            {
+                { "cell", L"row 4711" },
+                { "number", L"9999" },
+                { "column", L"b " },
+            };
+            return corpus;
+        }
+
+        FilterCorpus Localized(std::mt19937& random, double scale)
+        {
+            static const wchar_t* names[] =
+            {
+                L"Übersicht", L"Einfügen", L"Schließen", L"Größe ändern", L"Öffnen", L"Datei speichern",
+                L"Paramètres", L"Fenêtre précédente", L"Éditer", L"Aperçu avant impression", L"Sécurité",
+                L"Открыть", L"Сохранить как", L"ДАННЫЕ", L"Настройки", L"Поиск",
+                L"Αρχείο", L"Επεξεργασία", L"ΠΡΟΒΟΛΗ",
+                L"ファイル", L"編集", L"表示", L"ヘルプ", L"保存",
+            };
+            static const int32_t types[] = { TypeButton, TypeMenuItem, TypeTabItem, TypeText, TypeListItem, TypeCheckBox };
+
+            FilterCorpus corpus{ "localized", {}, {} };
+            Add(corpus, TypeWindow, L"Ünïcödé");
+
+            const size_t count = Scaled(5000, scale);
+            std::bernoulli_distribution unnamed(0.1);
+            while (corpus.Controls.size() < count)
+            {
+                Add(corpus, Pick(random, types), unnamed(random) ? std::wstring() : std::wstring(Pick(random, names)));
+            }
+
+            corpus.Sessions =
+            {
+                { "umlaut", L"übersicht" },
+                { "cyrillic-case", L"данные" },
+                { "greek-case", L"προβολη" },
+                { "cjk", L"保存" },
+            };
+            return corpus;
+        }
+    }
+
+    std::vector<FilterCorpus> GenerateFilterCorpora(uint32_t seed, double scale)
+    {
+        std::mt19937 random(seed);
+        std::vector<FilterCorpus> corpora;
+        corpora.push_back(OfficeRibbon(random, scale));
+        corpora.push_back(ElectronDom(random, scale));
+        corpora.push_back(DataGrid(random, scale));
+        corpora.push_back(Localized(random, scale));
+        return corpora;
+    }
+
+    FilterCorpus CorpusFromRecording(const UIAListCore::TreeRecording& recording)
+    {
+        FilterCorpus corpus{ "recorded", {}, {} };
+        for (const UIAListCore::TreeRecording::Node& node : recording.Nodes)
+        {
+            if (node.Available) Add(corpus, node.Properties.ControlType, node.Properties.Name);
+        }
+
+        static const char* labels[] = { "quarter", "half", "three-quarters" };
+        for (size_t i = 0; i < 3; ++i)
+        {
+            // The next listed, named control from each quartile on
+            for (size_t index = corpus.Controls.size() * (i + 1) / 4; index < corpus.Controls.size(); ++index)
+            {
+                const CorpusControl& control = corpus.Controls[index];
+                if (control.ControlType == TypeText || control.ControlType == TypeWindow ||
+                    control.OriginalName == L"(no name)")
+                {
+                    continue;
+                }
+                corpus.Sessions.push_back({ labels[i], control.OriginalName.substr(0, control.OriginalName.find(L' ')) });
+                break;
+            }
+        }
+        return corpus;
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "TreeRecording.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace UIAListBench
+{
+    // One enumerated control as the list sees it
+    struct CorpusControl
+    {
+        std::wstring DisplayText;   // "Type: Name"
+        std::wstring OriginalName;  // "(no name)" when the control has none
+        int32_t ControlType;
+    };
+
+    // A scripted filter session: the query is typed one character at a time.
+    // A '\b' in the script is a backspace.
+    struct QuerySession
+    {
+        const char* Label;
+        std::wstring Keystrokes;
+    };
+
+    struct FilterCorpus
+    {
+        const char* Name;
+        std::vector<CorpusControl> Controls;
+        std::vector<QuerySession> Sessions;
+    };
+
+    // Generated corpora shaped after real applications, deterministic per seed:
+    //   office-ribbon   ~3k short, heavily repeated command names, menus and tabs
+    //   electron-dom    ~20k deep web content, long names, many unnamed groups
+    //   data-grid       ~50k cells and rows, mostly "(no name)" and numbers
+    //   localized       ~5k names in German, French, Russian, Greek and Japanese
+    std::vector<FilterCorpus> GenerateFilterCorpora(uint32_t seed = 1, double scale = 1.0);
+
+    // The controls of a recorded window. Sessions type the first word of a
+    // few recorded names, so every session matches something.
+    FilterCorpus CorpusFromRecording(const UIAListCore::TreeRecording& recording);
+}
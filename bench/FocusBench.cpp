@@ -0,0 +1,177 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// Focus-outward enumeration: how soon the controls around the focus are
+// listed. For a few focused elements of a synthetic tree, WalkOutward's
+// first ring (the focused element's container) against the moment a
+// depth-first Walk has been through the same container, when the rings
+// complete so far first hold --near controls, and both walks in full.
+// The outward walk's rings, put in tree order, must be the visits of the
+// depth-first walk.
+//
+// Usage: FocusBench [--sizes 10000,100000] [--latency-us L] [--focus N] [--near C]
+//                   [--fanout F] [--depth D]
+//   Exits 1 when the rings in tree order differ from the depth-first walk
+
+#include "ControlWalker.h"
+#include "SyntheticTreeProvider.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace UIAListCore;
+using namespace UIAListBench;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    const uint32_t kProperties = PropertyControlType | PropertyName | PropertyAutomationId | PropertyBoundingRectangle;
+
+    struct Visit
+    {
+        int32_t ControlType;
+        std::wstring Name;
+        std::wstring AutomationId;
+        int32_t Left;
+        int32_t Top;
+
+        bool operator==(const Visit& other) const
+        {
+            return ControlType == other.ControlType && Name == other.Name && AutomationId == other.AutomationId &&
+                   Left == other.Left && Top == other.Top;
+        }
+    };
+
+    Visit MakeVisit(const ElementProperties& properties)
+    {
+        return { properties.ControlType, properties.Name, properties.AutomationId, properties.BoundingRectangle.Left,
+                 properties.BoundingRectangle.Top };
+    }
+
+    double Milliseconds(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    std::vector<size_t> ParseSizes(const char* text)
+    {
+        std::vector<size_t> sizes;
+        while (*text)
+        {
+            char* end = nullptr;
+            size_t size = std::strtoul(text, &end, 10);
+            if (end == text) break;
+            if (size > 0) sizes.push_back(size);
+            text = (*end == ',') ? end + 1 : end;
+        }
+        return sizes;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<size_t> sizes = { 10000, 100000 };
+    long latencyUs = 5;
+    size_t focusCount = 3;
+    size_t near = 100;
+    SyntheticTreeShape shape;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--sizes") == 0) sizes = ParseSizes(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--latency-us") == 0) latencyUs = std::strtol(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--focus") == 0) focusCount = std::max<size_t>(1, std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--near") == 0) near = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--fanout") == 0) shape.FanOut = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--depth") == 0) shape.MaxDepth = std::strtoul(argv[i + 1], nullptr, 10);
+    }
+
+    SyntheticLatency latency;
+    latency.PerCall = std::chrono::microseconds(latencyUs);
+
+    std::printf("# fan-out %zu, max depth %zu, %ld us per simulated call, BuildCache\n", shape.FanOut, shape.MaxDepth,
+                latencyUs);
+    std::printf("%-9s %6s %6s %8s %10s %12s %10s %6s %12s %12s %10s %10s\n", "nodes", "focus", "depth", "ring 0",
+                "ring 0 ms", "walk it ms", "near ms", "rings", "outward ms", "walk ms", "outward", "walk calls");
+
+    bool violated = false;
+    for (size_t size : sizes)
+    {
+        shape.Nodes = size;
+        SyntheticTreeProvider provider(shape, latency);
+        std::mt19937 random(static_cast<uint32_t>(size));
+
+        for (size_t pick = 0; pick < focusCount; ++pick)
+        {
+            const size_t focus = random() % provider.NodeCount();
+            provider.SetFocused(focus);
+
+            // Outward, noting when each ring was complete
+            std::vector<Visit> outward;
+            std::vector<ControlWalker::Ring> rings;
+            double firstRing = 0.0;
+            double nearRings = 0.0;
+            provider.ResetCalls();
+            ControlWalker outwardWalker(provider, WalkMode::BuildCache, kProperties);
+            auto start = Clock::now();
+            outwardWalker.WalkOutward([&](TreeElement&, const ElementProperties& properties, size_t)
+            {
+                outward.push_back(MakeVisit(properties));
+            }, [&](const ControlWalker::Ring& ring)
+            {
+                if (rings.empty()) firstRing = Milliseconds(start, Clock::now());
+                if (nearRings == 0.0 && ring.First + ring.Count >= near) nearRings = Milliseconds(start, Clock::now());
+                rings.push_back(ring);
+            });
+            const double outwardTotal = Milliseconds(start, Clock::now());
+            const uint64_t outwardCalls = provider.Calls();
+
+            // Where the first ring lies in tree order
+            std::vector<size_t> order;
+            ControlWalker::TreeOrder(rings, order);
+            const size_t ringStart = static_cast<size_t>(std::find(order.begin(), order.end(), size_t{ 0 }) - order.begin());
+            const size_t ringEnd = ringStart + (rings.empty() ? 0 : rings[0].Count);
+
+            std::vector<Visit> depthFirst;
+            double throughRing = 0.0;
+            provider.ResetCalls();
+            ControlWalker walker(provider, WalkMode::BuildCache, kProperties);
+            start = Clock::now();
+            walker.Walk([&](TreeElement&, const ElementProperties& properties, size_t)
+            {
+                depthFirst.push_back(MakeVisit(properties));
+                if (depthFirst.size() == ringEnd) throughRing = Milliseconds(start, Clock::now());
+            });
+            const double walkTotal = Milliseconds(start, Clock::now());
+            const uint64_t walkCalls = provider.Calls();
+
+            bool same = order.size() == depthFirst.size();
+            for (size_t i = 0; same && i < order.size(); ++i) same = outward[order[i]] == depthFirst[i];
+            if (!same)
+            {
+                std::fprintf(stderr, "Focus %zu of %zu: the rings in tree order are not the depth-first walk\n", focus, size);
+                violated = true;
+            }
+
+            std::printf("%-9zu %6zu %6zu %8zu %10.2f %12.2f %10.2f %6zu %12.2f %12.2f %10llu %10llu\n", depthFirst.size(),
+                        focus, provider.Depth(focus), rings.empty() ? size_t{ 0 } : rings[0].Count, firstRing, throughRing,
+                        nearRings, rings.size(), outwardTotal, walkTotal, static_cast<unsigned long long>(outwardCalls),
+                        static_cast<unsigned long long>(walkCalls));
+        }
+    }
+
+    return violated ? 1 : 0;
+}
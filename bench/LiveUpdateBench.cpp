@@ -0,0 +1,272 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// Live list updates: structure and name change events of a synthetic tree
+// fed through TreeUpdateQueue on a simulated clock, the way the frontend's
+// watcher thread takes them. Rows walked is what the batches re-walk (the
+// outermost changed subtrees, single rows for name changes, everything for
+// a storm) in that many walks; per event is re-walking the subtree of
+// every event as it arrives, one walk each; full is re-enumerating the
+// window once per batch. Final ms is
+// how long after the last event its batch was taken. The benchmark fails
+// when batches come closer than the rate limit or the last event is never
+// taken.
+//
+// Usage: LiveUpdateBench [--nodes N] [--seed N]
+
+#include "ControlWalker.h"
+#include "SyntheticTreeProvider.h"
+#include "TreeUpdateQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace UIAListCore;
+using namespace UIAListBench;
+using Clock = TreeUpdateQueue::Clock;
+using std::chrono::milliseconds;
+
+namespace
+{
+    struct Event
+    {
+        milliseconds At;
+        size_t Row;
+        uint32_t Changes;
+    };
+
+    struct Scenario
+    {
+        const char* Name;
+        std::vector<Event> Events;
+    };
+
+    struct Result
+    {
+        size_t Batches{ 0 };
+        size_t MaxPerSecond{ 0 };
+        uint64_t RowsWalked{ 0 };
+        uint64_t Walks{ 0 };
+        double FinalMs{ 0.0 };
+        bool Ok{ true };
+    };
+
+    // The row with the largest subtree at depth, for a pane that fills in lazily
+    size_t LargestAt(const std::vector<uint32_t>& depths, uint32_t depth)
+    {
+        size_t best = 0;
+        size_t bestSize = 0;
+        for (size_t row = 0; row < depths.size(); ++row)
+        {
+            if (depths[row] != depth) continue;
+            const size_t size = SubtreeEnd(depths, row) - row;
+            if (size > bestSize)
+            {
+                best = row;
+                bestSize = size;
+            }
+        }
+        return best;
+    }
+
+    std::vector<Scenario> MakeScenarios(const std::vector<uint32_t>& depths, uint32_t seed)
+    {
+        std::vector<Scenario> scenarios;
+        std::mt19937 random(seed);
+
+        // Children arrive one by one, each raising ChildAdded on itself, the
+        // pane now and then ChildrenInvalidated
+        Scenario lazy{ "lazy dialog pane", {} };
+        const size_t pane = LargestAt(depths, 2);
+        const size_t paneEnd = SubtreeEnd(depths, pane);
+        for (size_t i = 0; i < 150; ++i)
+        {
+            const size_t row = (i % 10 == 0) ? pane : pane + random() % (paneEnd - pane);
+            lazy.Events.push_back({ milliseconds(i * 10), row, TreeChangeStructure });
+        }
+        scenarios.push_back(std::move(lazy));
+
+        Scenario clock{ "clock label 10/s", {} };
+        const size_t label = depths.size() / 2;
+        for (int i = 0; i < 50; ++i) clock.Events.push_back({ milliseconds(i * 100), label, TreeChangeName });
+        scenarios.push_back(std::move(clock));
+
+        // A virtualized list realizing items while it scrolls
+        Scenario scroll{ "list scrolling 60/s", {} };
+        const size_t list = LargestAt(depths, 3);
+        const size_t listEnd = SubtreeEnd(depths, list);
+        for (int i = 0; i < 180; ++i)
+        {
+            const size_t row = (i % 3 == 0) ? list : list + random() % (listEnd - list);
+            scroll.Events.push_back({ milliseconds(i * 1000 / 60), row, i % 3 == 0 ? TreeChangeStructure : TreeChangeName });
+        }
+        scenarios.push_back(std::move(scroll));
+
+        Scenario storm{ "storm 4000/s", {} };
+        for (int i = 0; i < 8000; ++i)
+        {
+            storm.Events.push_back({ milliseconds(i / 4), random() % depths.size(),
+                                     (random() % 2) ? TreeChangeStructure : TreeChangeName });
+        }
+        scenarios.push_back(std::move(storm));
+
+        return scenarios;
+    }
+
+    // Rows one batch re-walks, and in how many walks
+    uint64_t RowsOf(const TreeUpdateQueue::Batch& batch, const std::vector<uint32_t>& depths, uint64_t& walks)
+    {
+        if (batch.WholeTree)
+        {
+            ++walks;
+            return depths.size();
+        }
+
+        std::vector<size_t> structure;
+        std::vector<size_t> names;
+        for (const TreeUpdateQueue::Change& change : batch.Changes)
+        {
+            const size_t row = static_cast<size_t>(change.Id[0]);
+            if (change.Changes & TreeChangeStructure) structure.push_back(row);
+            else names.push_back(row);
+        }
+
+        uint64_t rows = 0;
+        structure = OutermostSubtrees(depths, std::move(structure));
+        for (size_t row : structure) rows += SubtreeEnd(depths, row) - row;
+        walks += structure.size();
+        for (size_t row : names)
+        {
+            // Re-read alone unless a re-walked subtree has it anyway
+            auto after = std::upper_bound(structure.begin(), structure.end(), row);
+            if (after == structure.begin() || row >= SubtreeEnd(depths, *(after - 1)))
+            {
+                ++rows;
+                ++walks;
+            }
+        }
+        return rows;
+    }
+
+    Result Run(const Scenario& scenario, const std::vector<uint32_t>& depths, const TreeUpdateQueue::Timing& timing)
+    {
+        TreeUpdateQueue queue(timing);
+        const Clock::time_point origin{};
+        Result result;
+        std::vector<milliseconds> taken;
+        std::vector<bool> storms;
+
+        size_t next = 0;
+        TreeUpdateQueue::Batch batch;
+        for (;;)
+        {
+            const Clock::time_point due = queue.NextDue();
+            const bool haveEvent = next < scenario.Events.size();
+            if (!haveEvent && due == Clock::time_point::max()) break;
+
+            if (haveEvent && origin + scenario.Events[next].At < due)
+            {
+                const Event& event = scenario.Events[next++];
+                queue.Post(RuntimeId{ static_cast<int32_t>(event.Row) }, event.Changes, nullptr, origin + event.At);
+                continue;
+            }
+            if (!queue.Take(due, batch)) continue;
+            result.RowsWalked += RowsOf(batch, depths, result.Walks);
+            taken.push_back(std::chrono::duration_cast<milliseconds>(due - origin));
+            storms.push_back(batch.WholeTree);
+        }
+
+        result.Batches = taken.size();
+        size_t first = 0;
+        for (size_t last = 0; last < taken.size(); ++last)
+        {
+            while (taken[last] - taken[first] >= milliseconds(1000)) ++first;
+            result.MaxPerSecond = std::max(result.MaxPerSecond, last - first + 1);
+
+            const milliseconds limit = (last > 0 && storms[last - 1]) ? timing.StormInterval : timing.MinInterval;
+            if (last > 0 && taken[last] - taken[last - 1] < limit)
+            {
+                std::fprintf(stderr, "%s: batch %lld ms after the previous one\n", scenario.Name,
+                             static_cast<long long>((taken[last] - taken[last - 1]).count()));
+                result.Ok = false;
+            }
+        }
+
+        const milliseconds lastEvent = scenario.Events.back().At;
+        if (taken.empty() || taken.back() < lastEvent)
+        {
+            std::fprintf(stderr, "%s: the last event was never taken\n", scenario.Name);
+            result.Ok = false;
+        }
+        else
+        {
+            result.FinalMs = static_cast<double>((taken.back() - lastEvent).count());
+        }
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t nodes = 10000;
+    uint32_t seed = 1;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--nodes") == 0) nodes = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--seed") == 0) seed = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+    }
+
+    SyntheticTreeShape shape;
+    shape.Nodes = nodes;
+    SyntheticTreeProvider provider(shape);
+
+    std::vector<uint32_t> depths;
+    ControlWalker walker(provider, WalkMode::BuildCache, PropertyControlType | PropertyName);
+    walker.Walk([&depths](TreeElement&, const ElementProperties&, size_t depth) {
+        depths.push_back(static_cast<uint32_t>(depth));
+    });
+    if (depths.empty())
+    {
+        std::fprintf(stderr, "Cannot walk the synthetic tree\n");
+        return 1;
+    }
+
+    const TreeUpdateQueue::Timing timing;
+    std::printf("# %zu controls; settle %lld ms, max delay %lld ms, min interval %lld ms, storm beyond %zu elements\n",
+                depths.size(), static_cast<long long>(timing.Settle.count()), static_cast<long long>(timing.MaxDelay.count()),
+                static_cast<long long>(timing.MinInterval.count()), timing.StormElements);
+    std::printf("%-22s %7s %8s %6s %7s %12s %12s %12s %9s\n",
+                "scenario", "events", "batches", "max/s", "walks", "rows walked", "per event", "full", "final ms");
+
+    bool ok = true;
+    for (const Scenario& scenario : MakeScenarios(depths, seed))
+    {
+        uint64_t perEvent = 0;
+        for (const Event& event : scenario.Events)
+        {
+            perEvent += (event.Changes & TreeChangeStructure) ? SubtreeEnd(depths, event.Row) - event.Row : 1;
+        }
+
+        const Result result = Run(scenario, depths, timing);
+        ok = ok && result.Ok;
+        std::printf("%-22s %7zu %8zu %6zu %7llu %12llu %12llu %12llu %9.0f\n", scenario.Name, scenario.Events.size(),
+                    result.Batches, result.MaxPerSecond, static_cast<unsigned long long>(result.Walks),
+                    static_cast<unsigned long long>(result.RowsWalked),
+                    static_cast<unsigned long long>(perEvent),
+                    static_cast<unsigned long long>(result.Batches * depths.size()), result.FinalMs);
+    }
+    return ok ? 0 : 1;
+}
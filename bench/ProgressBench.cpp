@@ -0,0 +1,243 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// Enumeration progress: what EnumerationProgress costs the walk and how
+// good its remaining count is. The BuildCache walk runs with and without
+// progress, best of --reps each, while a second thread reads the progress
+// at the window's cadence. With the default zero latency the walk is the
+// walker's own overhead only, the worst case for the counters. As whole
+// walks vary by more than the counters cost, the overhead is also taken
+// from the walk's progress calls replayed alone, against the plain walk;
+// the replay's own bookkeeping is counted in, so it is an upper bound.
+// The estimate is sampled at fixed fractions of the walk and shown as the
+// predicted total against the real one. With --focus the walks go outward
+// from the element at that share of the tree instead of down from the root.
+//
+// Usage: ProgressBench [--sizes 10000,100000,1000000] [--reps R] [--poll-ms P]
+//                      [--latency-us L] [--fanout F] [--depth D] [--focus SHARE]
+//                      [--max-overhead PCT]
+//   Exits 1 when the replayed progress calls cost more than --max-overhead
+//   percent of the plain walk: by default 5 in optimized builds, 10 in debug
+//   builds, where every counter update is a call of its own
+
+#include "ControlWalker.h"
+#include "EnumerationProgress.h"
+#include "SyntheticTreeProvider.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace UIAListCore;
+using namespace UIAListBench;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    // What the enumerator asks for
+    const uint32_t kProperties = PropertyControlType | PropertyName | PropertyAutomationId | PropertyCapabilities;
+
+    // Points of the walk the estimate is sampled at
+    const double kFractions[] = { 0.10, 0.25, 0.50, 0.75, 0.90 };
+    const size_t kFractionCount = sizeof(kFractions) / sizeof(kFractions[0]);
+
+    struct Result
+    {
+        size_t Visited{ 0 };
+        double Seconds{ 0.0 };
+        std::vector<uint32_t> Depths;  // Of the visited elements, in walk order
+        uint64_t Reads{ 0 };
+        double Predicted[kFractionCount] = {};  // Visited + EstimatedRemaining at each fraction
+    };
+
+    // total is the size of the walk when known, to sample the estimate
+    Result Run(TreeProvider& provider, EnumerationProgress* progress, std::chrono::milliseconds poll, size_t total,
+               bool outward)
+    {
+        Result result;
+        std::wstring displayText;
+        size_t checksum = 0;
+        size_t nextFraction = 0;
+
+        // The window's progress timer
+        std::atomic<bool> done{ false };
+        uint64_t remainingSum = 0;
+        std::thread reader;
+        if (progress)
+        {
+            progress->Start();
+            reader = std::thread([&]()
+            {
+                while (!done)
+                {
+                    std::this_thread::sleep_for(poll);
+                    remainingSum += progress->Read().EstimatedRemaining;
+                    ++result.Reads;
+                }
+            });
+        }
+
+        const auto start = Clock::now();
+        ControlWalker walker(provider, WalkMode::BuildCache, kProperties);
+        walker.SetProgress(progress);
+        auto visitor = [&](TreeElement&, const ElementProperties& properties, size_t depth)
+        {
+            displayText = std::to_wstring(properties.ControlType);
+            displayText += L": ";
+            displayText += properties.HasName ? properties.Name : std::wstring(L"(no name)");
+            checksum += displayText.size();
+            ++result.Visited;
+            if (!progress) result.Depths.push_back(static_cast<uint32_t>(depth));
+
+            if (progress && total && nextFraction < kFractionCount && result.Visited >= kFractions[nextFraction] * total)
+            {
+                const EnumerationProgress::Report report = progress->Read();
+                result.Predicted[nextFraction++] = static_cast<double>(report.Visited + report.EstimatedRemaining);
+            }
+        };
+        if (outward) walker.WalkOutward(visitor, nullptr);
+        else walker.Walk(visitor);
+        result.Seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        done = true;
+        if (reader.joinable()) reader.join();
+        checksum += remainingSum & 1;
+        if (checksum == 0) std::printf("# empty walk\n");
+        return result;
+    }
+
+    // The progress calls of a walk that visited depths, without the walk
+    double Replay(EnumerationProgress& progress, const std::vector<uint32_t>& depths)
+    {
+        std::vector<size_t> children;  // Of the open elements, by depth
+        children.reserve(EnumerationProgress::MaxDepth);
+
+        const auto start = Clock::now();
+        progress.Start();
+        for (uint32_t depth : depths)
+        {
+            while (children.size() > depth)
+            {
+                progress.OnLeave(children.size() - 1, children.back());
+                children.pop_back();
+            }
+            if (!children.empty()) ++children.back();
+            progress.OnEnter(depth);
+            progress.OnAccepted();
+            children.push_back(0);
+        }
+        while (!children.empty())
+        {
+            progress.OnLeave(children.size() - 1, children.back());
+            children.pop_back();
+        }
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    std::vector<size_t> ParseSizes(const char* text)
+    {
+        std::vector<size_t> sizes;
+        while (*text)
+        {
+            char* end = nullptr;
+            size_t size = std::strtoul(text, &end, 10);
+            if (end == text) break;
+            if (size > 0) sizes.push_back(size);
+            text = (*end == ',') ? end + 1 : end;
+        }
+        return sizes;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<size_t> sizes = { 10000, 100000, 1000000 };
+    int reps = 5;
+    long pollMs = 250;
+    long latencyUs = 0;
+#ifdef NDEBUG
+    double maxOverhead = 5.0;
+#else
+    double maxOverhead = 10.0;
+#endif
+    double focusShare = -1.0;
+    SyntheticTreeShape shape;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--sizes") == 0) sizes = ParseSizes(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--reps") == 0) reps = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--poll-ms") == 0) pollMs = std::max(1L, std::strtol(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--latency-us") == 0) latencyUs = std::strtol(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--fanout") == 0) shape.FanOut = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--depth") == 0) shape.MaxDepth = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--focus") == 0) focusShare = std::strtod(argv[i + 1], nullptr);
+        else if (std::strcmp(argv[i], "--max-overhead") == 0) maxOverhead = std::strtod(argv[i + 1], nullptr);
+    }
+
+    SyntheticLatency latency;
+    latency.PerCall = std::chrono::microseconds(latencyUs);
+    const std::chrono::milliseconds poll(pollMs);
+
+    std::printf("# fan-out %zu, max depth %zu, %ld us per simulated call, read every %ld ms, best of %d%s\n",
+                shape.FanOut, shape.MaxDepth, latencyUs, pollMs, reps, focusShare >= 0.0 ? ", outward" : "");
+    std::printf("%-9s %10s %12s %10s %10s %10s %6s   %s\n", "nodes", "plain ms", "progress ms", "walk +%",
+                "calls ms", "calls +%", "reads", "predicted total at 10/25/50/75/90% of the walk");
+
+    bool violated = false;
+    for (size_t size : sizes)
+    {
+        shape.Nodes = size;
+        SyntheticTreeProvider provider(shape, latency);
+        EnumerationProgress progress;
+        const bool outward = focusShare >= 0.0;
+        if (outward) provider.SetFocused(static_cast<size_t>(focusShare * (provider.NodeCount() - 1)));
+
+        // Interleaved, so drift of the machine hits both alike
+        Result plain;
+        Result tracked;
+        double calls = 1e300;
+        plain.Seconds = tracked.Seconds = 1e300;
+        for (int rep = 0; rep < reps; ++rep)
+        {
+            Result run = Run(provider, nullptr, poll, 0, outward);
+            if (run.Seconds < plain.Seconds) plain = std::move(run);
+            run = Run(provider, &progress, poll, plain.Visited, outward);
+            if (run.Seconds < tracked.Seconds) tracked = std::move(run);
+            calls = std::min(calls, Replay(progress, plain.Depths));
+        }
+
+        const double walkOverhead = 100.0 * (tracked.Seconds - plain.Seconds) / plain.Seconds;
+        const double overhead = 100.0 * calls / plain.Seconds;
+        std::printf("%-9zu %10.2f %12.2f %9.1f%% %10.2f %9.2f%% %6llu  ", plain.Visited, plain.Seconds * 1000.0,
+                    tracked.Seconds * 1000.0, walkOverhead, calls * 1000.0, overhead,
+                    static_cast<unsigned long long>(tracked.Reads));
+        for (double predicted : tracked.Predicted)
+        {
+            std::printf(" %5.0f%%", plain.Visited ? 100.0 * predicted / plain.Visited : 0.0);
+        }
+        std::printf("\n");
+
+        if (overhead > maxOverhead)
+        {
+            std::fprintf(stderr, "Progress costs %.1f%% of the %zu node walk, more than %.1f%%\n", overhead, size,
+                         maxOverhead);
+            violated = true;
+        }
+    }
+
+    return violated ? 1 : 0;
+}
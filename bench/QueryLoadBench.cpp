@@ -0,0 +1,186 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// Query API under load: many clients at once against one QueryServer over
+// the loopback transport, serving a published synthetic snapshot. Each
+// client sends batches of requests, mostly Query and Filter with an
+// occasional full Enumerate, and reads the answers before the next batch.
+// Latency is from the batch's Send to each request's Done, what a
+// pipelining client waits; pipeline 1 is a client that does not pipeline.
+//
+// Usage: QueryLoadBench [--nodes N] [--clients 1,8,64] [--pipeline 1,16] [--seconds S]
+
+#include "QueryClient.h"
+#include "QueryServer.h"
+#include "SyntheticTreeProvider.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace UIAListCore;
+using namespace UIAListBench;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    // Substrings typed into a filter: common, rare and absent
+    const char* const kNeedles[] = { "e", "button", "ab", "Edit: ", "zzq" };
+
+    struct ClientResult
+    {
+        uint64_t Requests{ 0 };
+        uint64_t Rows{ 0 };
+        uint64_t Failed{ 0 };
+        std::vector<double> LatencyUs;
+    };
+
+    void RunClient(LoopbackListener& listener, QueryFormat format, size_t pipeline, uint32_t rows,
+                   Clock::time_point end, uint32_t seed, ClientResult& result)
+    {
+        QueryClient client(listener.Connect());
+        std::mt19937 random(seed);
+        QueryResponse response;
+
+        while (client.IsConnected() && Clock::now() < end)
+        {
+            for (size_t i = 0; i < pipeline; ++i)
+            {
+                const uint32_t pick = random() % 32;
+                if (pick == 0) client.Enumerate(0, format);
+                else if (pick < 12) client.Filter(0, kNeedles[random() % std::size(kNeedles)], format);
+                else client.Query(0, random() % rows, format);
+            }
+
+            const auto start = Clock::now();
+            if (!client.Send()) break;
+
+            size_t pending = pipeline;
+            while (pending > 0 && client.Next(response))
+            {
+                if (response.Kind == QueryKind::Row)
+                {
+                    ++result.Rows;
+                    continue;
+                }
+                if (response.Status != QueryStatus::Ok) ++result.Failed;
+                result.LatencyUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+                ++result.Requests;
+                --pending;
+            }
+            if (pending > 0) break;
+        }
+    }
+
+    std::vector<size_t> ParseList(const char* text)
+    {
+        std::vector<size_t> values;
+        while (*text)
+        {
+            char* end = nullptr;
+            size_t value = std::strtoul(text, &end, 10);
+            if (end == text) break;
+            if (value > 0) values.push_back(value);
+            text = (*end == ',') ? end + 1 : end;
+        }
+        return values;
+    }
+
+    double Percentile(std::vector<double>& values, double fraction)
+    {
+        if (values.empty()) return 0.0;
+        const size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t nodes = 10000;
+    std::vector<size_t> clientCounts = { 1, 8, 64 };
+    std::vector<size_t> pipelines = { 1, 16 };
+    double seconds = 1.0;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--nodes") == 0) nodes = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--clients") == 0) clientCounts = ParseList(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--pipeline") == 0) pipelines = ParseList(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--seconds") == 0) seconds = std::strtod(argv[i + 1], nullptr);
+    }
+
+    SyntheticTreeShape shape;
+    shape.Nodes = nodes;
+    SyntheticTreeProvider provider(shape);
+
+    QuerySnapshotCache cache;
+    std::shared_ptr<QuerySnapshot> snapshot = QuerySnapshotCache::Walk(provider, 1);
+    if (!snapshot || snapshot->Rows.empty())
+    {
+        std::fprintf(stderr, "Cannot walk the synthetic tree\n");
+        return 1;
+    }
+    const uint32_t rows = static_cast<uint32_t>(snapshot->Rows.size());
+    cache.Publish(snapshot);
+
+    std::printf("# %u controls, 1 in 32 requests a full Enumerate, %.1f s per run\n", rows, seconds);
+    std::printf("%-8s %-9s %-7s %12s %12s %10s %10s %7s\n",
+                "clients", "pipeline", "format", "requests/s", "rows/s", "p50 us", "p99 us", "failed");
+
+    for (QueryFormat format : { QueryFormat::Binary, QueryFormat::Json })
+    {
+        for (size_t pipeline : pipelines)
+        {
+            for (size_t clientCount : clientCounts)
+            {
+                auto listener = std::make_unique<LoopbackListener>();
+                LoopbackListener& loopback = *listener;
+                QueryServer server(cache);
+                server.Start(std::move(listener));
+
+                std::vector<ClientResult> results(clientCount);
+                std::vector<std::thread> clients;
+                const auto start = Clock::now();
+                const auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+                for (size_t c = 0; c < clientCount; ++c)
+                {
+                    clients.emplace_back(RunClient, std::ref(loopback), format, pipeline, rows, end,
+                                         static_cast<uint32_t>(c + 1), std::ref(results[c]));
+                }
+                for (std::thread& client : clients) client.join();
+                const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+                server.Stop();
+
+                ClientResult total;
+                for (ClientResult& result : results)
+                {
+                    total.Requests += result.Requests;
+                    total.Rows += result.Rows;
+                    total.Failed += result.Failed;
+                    total.LatencyUs.insert(total.LatencyUs.end(), result.LatencyUs.begin(), result.LatencyUs.end());
+                }
+
+                std::printf("%-8zu %-9zu %-7s %12.0f %12.0f %10.1f %10.1f %7llu\n",
+                            clientCount, pipeline, format == QueryFormat::Json ? "json" : "binary",
+                            total.Requests / elapsed, total.Rows / elapsed,
+                            Percentile(total.LatencyUs, 0.50), Percentile(total.LatencyUs, 0.99),
+                            static_cast<unsigned long long>(total.Failed));
+            }
+        }
+    }
+    return 0;
+}
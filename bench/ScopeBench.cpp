@@ -0,0 +1,192 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// Scoped quick lists: for a few focused elements of a synthetic tree, the
+// scoped walk out to the nearest pane, group, window or document, the
+// same with --scope-depth levels below it, the Widen steps out to the
+// root, and a depth-first walk of the whole tree. Widened to the root
+// without a depth limit, the rings in tree order must be the visits of
+// the depth-first walk.
+//
+// Usage: ScopeBench [--sizes 10000,100000] [--latency-us L] [--focus N] [--scope-depth D]
+//                   [--fanout F] [--depth D]
+//   Exits 1 when the widened rings in tree order differ from the depth-first walk
+
+#include "ControlWalker.h"
+#include "SyntheticTreeProvider.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace UIAListCore;
+using namespace UIAListBench;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    const uint32_t kProperties = PropertyControlType | PropertyName | PropertyAutomationId;
+
+    struct Visit
+    {
+        int32_t ControlType;
+        std::wstring Name;
+        std::wstring AutomationId;
+
+        bool operator==(const Visit& other) const
+        {
+            return ControlType == other.ControlType && Name == other.Name && AutomationId == other.AutomationId;
+        }
+    };
+
+    struct Scoped
+    {
+        std::vector<Visit> Visits;
+        std::vector<ControlWalker::Ring> Rings;
+        int32_t ScopeType{ 0 };  // Of the container the walk stopped at, 0 for the root
+        double Milliseconds{ 0.0 };
+    };
+
+    double Milliseconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    Scoped WalkScoped(ControlWalker& walker)
+    {
+        Scoped scoped;
+        int32_t lastType = 0;
+        const auto start = Clock::now();
+        walker.WalkOutward([&](TreeElement&, const ElementProperties& properties, size_t)
+        {
+            scoped.Visits.push_back({ properties.ControlType, properties.Name, properties.AutomationId });
+        }, [&](const ControlWalker::Ring& ring)
+        {
+            // A ring's container is its first visit
+            lastType = ring.Count > 0 ? scoped.Visits[ring.First].ControlType : 0;
+            scoped.Rings.push_back(ring);
+        });
+        scoped.Milliseconds = Milliseconds(start);
+        scoped.ScopeType = walker.Complete() ? 0 : lastType;
+        return scoped;
+    }
+
+    std::vector<size_t> ParseSizes(const char* text)
+    {
+        std::vector<size_t> sizes;
+        while (*text)
+        {
+            char* end = nullptr;
+            size_t size = std::strtoul(text, &end, 10);
+            if (end == text) break;
+            if (size > 0) sizes.push_back(size);
+            text = (*end == ',') ? end + 1 : end;
+        }
+        return sizes;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<size_t> sizes = { 10000, 100000 };
+    long latencyUs = 5;
+    size_t focusCount = 5;
+    size_t scopeDepth = 2;
+    SyntheticTreeShape shape;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--sizes") == 0) sizes = ParseSizes(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--latency-us") == 0) latencyUs = std::strtol(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--focus") == 0) focusCount = std::max<size_t>(1, std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--scope-depth") == 0) scopeDepth = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--fanout") == 0) shape.FanOut = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--depth") == 0) shape.MaxDepth = std::strtoul(argv[i + 1], nullptr, 10);
+    }
+
+    SyntheticLatency latency;
+    latency.PerCall = std::chrono::microseconds(latencyUs);
+
+    std::printf("# fan-out %zu, max depth %zu, %ld us per simulated call, BuildCache, limited to %zu levels\n",
+                shape.FanOut, shape.MaxDepth, latencyUs, scopeDepth);
+    std::printf("%-9s %6s %6s %-9s %8s %9s %8s %10s %7s %10s %10s\n", "nodes", "focus", "depth", "scope",
+                "scoped", "scope ms", "limited", "limited ms", "widens", "widen ms", "walk ms");
+
+    bool violated = false;
+    for (size_t size : sizes)
+    {
+        shape.Nodes = size;
+        SyntheticTreeProvider provider(shape, latency);
+        std::mt19937 random(static_cast<uint32_t>(size));
+
+        for (size_t pick = 0; pick < focusCount; ++pick)
+        {
+            const size_t focus = random() % provider.NodeCount();
+            provider.SetFocused(focus);
+
+            // Scoped, then widened step by step to the root
+            ControlWalker walker(provider, WalkMode::BuildCache, kProperties);
+            walker.SetScoped(true);
+            Scoped scoped = WalkScoped(walker);
+            const size_t scopedCount = scoped.Visits.size();
+
+            size_t widens = 0;
+            const auto start = Clock::now();
+            while (walker.Widen([&](TreeElement&, const ElementProperties& properties, size_t)
+            {
+                scoped.Visits.push_back({ properties.ControlType, properties.Name, properties.AutomationId });
+            }, [&](const ControlWalker::Ring& ring)
+            {
+                scoped.Rings.push_back(ring);
+            }))
+            {
+                ++widens;
+            }
+            const double widened = Milliseconds(start);
+
+            // The quick list with a depth limit
+            ControlWalker limitedWalker(provider, WalkMode::BuildCache, kProperties);
+            limitedWalker.SetScoped(true, scopeDepth);
+            const Scoped limited = WalkScoped(limitedWalker);
+
+            std::vector<Visit> depthFirst;
+            ControlWalker plain(provider, WalkMode::BuildCache, kProperties);
+            const auto walkStart = Clock::now();
+            plain.Walk([&](TreeElement&, const ElementProperties& properties, size_t)
+            {
+                depthFirst.push_back({ properties.ControlType, properties.Name, properties.AutomationId });
+            });
+            const double walked = Milliseconds(walkStart);
+
+            std::vector<size_t> order;
+            ControlWalker::TreeOrder(scoped.Rings, order);
+            bool same = order.size() == depthFirst.size();
+            for (size_t i = 0; same && i < order.size(); ++i) same = scoped.Visits[order[i]] == depthFirst[i];
+            if (!same)
+            {
+                std::fprintf(stderr, "Focus %zu of %zu: the widened rings in tree order are not the depth-first walk\n",
+                             focus, size);
+                violated = true;
+            }
+
+            std::printf("%-9zu %6zu %6zu %-9s %8zu %9.2f %8zu %10.2f %7zu %10.2f %10.2f\n", depthFirst.size(), focus,
+                        provider.Depth(focus), scoped.ScopeType ? ControlTypeName(scoped.ScopeType) : "(root)",
+                        scopedCount, scoped.Milliseconds, limited.Visits.size(), limited.Milliseconds, widens, widened,
+                        walked);
+        }
+    }
+
+    return violated ? 1 : 0;
+}
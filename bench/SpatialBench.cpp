@@ -0,0 +1,285 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// Spatial index over the bounding rectangles of a synthetic list: build
+// time, offscreen flagging, region queries of a 400x300 window area,
+// the 10 nearest controls of a control, and the reading order. Every query
+// is checked against a scan of all rectangles, the reading order to hold
+// every control once. Then runs of the list are spliced, as live updates
+// replace subtrees, and the spliced index is checked the same way.
+//
+// Usage: SpatialBench [--sizes 1000,10000,100000] [--queries Q] [--reps R]
+//   Exits 1 when the index and the scan disagree
+
+#include "ControlWalker.h"
+#include "SpatialIndex.h"
+#include "SyntheticTreeProvider.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace UIAListCore;
+using namespace UIAListBench;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    const ElementRect kScreen = { 0, 0, 1920, 1080 };
+
+    double Seconds(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // The rectangles of the list, in walk order
+    std::vector<ElementRect> Walk(SyntheticTreeProvider& provider)
+    {
+        std::vector<ElementRect> rects;
+        ControlWalker walker(provider, WalkMode::BuildCache, PropertyControlType | PropertyBoundingRectangle);
+        walker.Walk([&](TreeElement&, const ElementProperties& properties, size_t)
+        {
+            rects.push_back(properties.BoundingRectangle);
+        });
+        return rects;
+    }
+
+    int64_t Gap(const ElementRect& a, const ElementRect& b)
+    {
+        const int64_t dx = std::max<int64_t>({ 0, int64_t(b.Left) - a.Right, int64_t(a.Left) - b.Right });
+        const int64_t dy = std::max<int64_t>({ 0, int64_t(b.Top) - a.Bottom, int64_t(a.Top) - b.Bottom });
+        return dx * dx + dy * dy;
+    }
+
+    std::vector<uint32_t> ScanRegion(const std::vector<ElementRect>& rects, const ElementRect& region)
+    {
+        std::vector<uint32_t> items;
+        for (uint32_t i = 0; i < rects.size(); ++i)
+        {
+            if (!rects[i].IsEmpty() && rects[i].Intersects(region)) items.push_back(i);
+        }
+        return items;
+    }
+
+    // The distances of the nearest, as ties may come in any order
+    std::vector<int64_t> ScanNearest(const std::vector<ElementRect>& rects, const ElementRect& target, size_t count)
+    {
+        std::vector<int64_t> gaps;
+        for (const ElementRect& rect : rects)
+        {
+            if (!rect.IsEmpty() && !rect.Contains(target)) gaps.push_back(Gap(rect, target));
+        }
+        std::sort(gaps.begin(), gaps.end());
+        gaps.resize(std::min(count, gaps.size()));
+        return gaps;
+    }
+
+    // The index against scans of rects: flags, regions, nearest and the
+    // reading order of an index built from them
+    bool Agrees(const SpatialIndex& index, const std::vector<ElementRect>& rects, std::mt19937& random, size_t queries)
+    {
+        if (index.Size() != rects.size()) return false;
+        for (uint32_t i = 0; i < rects.size(); ++i)
+        {
+            if (index.IsOffscreen(i) != (rects[i].IsEmpty() || !rects[i].Intersects(kScreen))) return false;
+        }
+
+        std::vector<uint32_t> items;
+        for (size_t q = 0; q < queries && !rects.empty(); ++q)
+        {
+            const int32_t left = static_cast<int32_t>(random() % 1920);
+            const int32_t top = static_cast<int32_t>(random() % 2160);
+            const ElementRect region = { left, top, left + 400, top + 300 };
+            index.Query(region, items);
+            if (items != ScanRegion(rects, region)) return false;
+
+            const ElementRect& target = rects[random() % rects.size()];
+            index.Nearest(target, 10, items);
+            std::vector<int64_t> got;
+            for (uint32_t item : items) got.push_back(Gap(rects[item], target));
+            if (got != ScanNearest(rects, target, 10)) return false;
+        }
+
+        SpatialIndex built;
+        built.Build(rects, kScreen);
+        std::vector<uint32_t> order;
+        built.ReadingOrder(order);
+        index.ReadingOrder(items);
+        return items == order;
+    }
+
+    std::vector<size_t> ParseSizes(const char* text)
+    {
+        std::vector<size_t> sizes;
+        while (*text)
+        {
+            char* end = nullptr;
+            size_t size = std::strtoul(text, &end, 10);
+            if (end == text) break;
+            if (size > 0) sizes.push_back(size);
+            text = (*end == ',') ? end + 1 : end;
+        }
+        return sizes;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<size_t> sizes = { 1000, 10000, 100000 };
+    size_t queries = 1000;
+    int reps = 5;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--sizes") == 0) sizes = ParseSizes(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--queries") == 0) queries = std::max<size_t>(1, std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--reps") == 0) reps = std::max(1, std::atoi(argv[i + 1]));
+    }
+
+    std::printf("# %zu queries each, build and order best of %d, times per call\n", queries, reps);
+    std::printf("%-9s %9s %10s %10s %10s %12s %12s %12s %10s %10s\n", "controls", "offscreen", "build ms", "order ms",
+                "region us", "region scan", "nearest us", "nearest scan", "memory KB", "splice us");
+
+    bool violated = false;
+    for (size_t size : sizes)
+    {
+        SyntheticTreeShape shape;
+        shape.Nodes = size;
+        SyntheticTreeProvider provider(shape);
+        const std::vector<ElementRect> rects = Walk(provider);
+
+        SpatialIndex index;
+        double build = 1e300;
+        for (int rep = 0; rep < reps; ++rep)
+        {
+            const auto start = Clock::now();
+            index.Build(rects, kScreen);
+            build = std::min(build, Seconds(start));
+        }
+
+        size_t offscreen = 0;
+        for (uint32_t i = 0; i < rects.size(); ++i)
+        {
+            const bool expected = rects[i].IsEmpty() || !rects[i].Intersects(kScreen);
+            if (index.IsOffscreen(i) != expected) violated = true;
+            offscreen += expected ? 1 : 0;
+        }
+
+        std::vector<uint32_t> order;
+        double ordering = 1e300;
+        for (int rep = 0; rep < reps; ++rep)
+        {
+            const auto start = Clock::now();
+            index.ReadingOrder(order);
+            ordering = std::min(ordering, Seconds(start));
+        }
+        std::vector<uint32_t> sorted = order;
+        std::sort(sorted.begin(), sorted.end());
+        for (uint32_t i = 0; i < sorted.size(); ++i)
+        {
+            if (sorted[i] != i) violated = true;
+        }
+        if (sorted.size() != rects.size()) violated = true;
+
+        std::mt19937 random(static_cast<uint32_t>(size));
+        std::vector<ElementRect> regions;
+        std::vector<ElementRect> targets;
+        for (size_t q = 0; q < queries; ++q)
+        {
+            const int32_t left = static_cast<int32_t>(random() % 1920);
+            const int32_t top = static_cast<int32_t>(random() % 2160);
+            regions.push_back({ left, top, left + 400, top + 300 });
+            targets.push_back(rects[random() % rects.size()]);
+        }
+
+        std::vector<uint32_t> items;
+        size_t found = 0;
+        auto start = Clock::now();
+        for (const ElementRect& region : regions)
+        {
+            index.Query(region, items);
+            found += items.size();
+        }
+        const double region = Seconds(start) / queries;
+
+        start = Clock::now();
+        for (const ElementRect& target : targets)
+        {
+            index.Nearest(target, 10, items);
+            found += items.size();
+        }
+        const double nearest = Seconds(start) / queries;
+
+        // The scans, timed on a tenth of the queries and checked on those
+        const size_t checked = std::max<size_t>(1, queries / 10);
+        double regionScan = 0.0;
+        double nearestScan = 0.0;
+        for (size_t q = 0; q < checked; ++q)
+        {
+            start = Clock::now();
+            const std::vector<uint32_t> expected = ScanRegion(rects, regions[q]);
+            regionScan += Seconds(start);
+            index.Query(regions[q], items);
+            if (items != expected) violated = true;
+
+            start = Clock::now();
+            const std::vector<int64_t> gaps = ScanNearest(rects, targets[q], 10);
+            nearestScan += Seconds(start);
+            index.Nearest(targets[q], 10, items);
+            std::vector<int64_t> got;
+            for (uint32_t item : items) got.push_back(Gap(rects[item], targets[q]));
+            if (got != gaps) violated = true;
+        }
+
+        const size_t memory = index.MemoryBytes();
+
+        // Live updates: a run of up to 20 controls replaced by up to 20 of
+        // elsewhere in the list, moved; past a quarter of the list spliced
+        // in, the index is built again
+        std::vector<ElementRect> live = rects;
+        const size_t splices = std::max<size_t>(10, rects.size() / 20);
+        double splicing = 0.0;
+        for (size_t n = 0; n < splices; ++n)
+        {
+            const uint32_t first = static_cast<uint32_t>(random() % (live.size() + 1));
+            const uint32_t count = static_cast<uint32_t>(std::min<size_t>(random() % 21, live.size() - first));
+            std::vector<ElementRect> added(random() % 21);
+            const int32_t dx = static_cast<int32_t>(random() % 201) - 100;
+            for (ElementRect& rect : added)
+            {
+                rect = rects[random() % rects.size()];
+                if (!rect.IsEmpty()) rect = { rect.Left + dx, rect.Top, rect.Right + dx, rect.Bottom };
+            }
+
+            start = Clock::now();
+            index.Splice(first, count, added);
+            splicing += Seconds(start);
+            live.erase(live.begin() + first, live.begin() + first + count);
+            live.insert(live.begin() + first, added.begin(), added.end());
+            if (n % (splices / 5) == 0 && !Agrees(index, live, random, checked)) violated = true;
+        }
+        if (!Agrees(index, live, random, checked)) violated = true;
+
+        std::printf("%-9zu %9zu %10.2f %10.2f %10.2f %12.2f %12.2f %12.2f %10zu %10.2f\n", rects.size(), offscreen,
+                    build * 1000.0, ordering * 1000.0, region * 1e6, regionScan / checked * 1e6, nearest * 1e6,
+                    nearestScan / checked * 1e6, memory / 1024, splicing / splices * 1e6);
+        if (found == 0) std::printf("# nothing found\n");
+        if (violated)
+        {
+            std::fprintf(stderr, "The index disagrees with the scan at %zu controls\n", size);
+        }
+    }
+
+    return violated ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// Headless mode throughput: the synthetic tree streamed as JSON Lines, the
+// way UIAListDump writes a window. Compares the walk alone, StreamControls
+// with its fixed-buffer writer and a line built in a std::string and printed
+// with fprintf per control. allocs/node counts heap allocations, the walk's
+// own included, so the walk-only row is the floor.
+//
+// Usage: StreamBench [--sizes 1000,10000,...] [--out FILE] [--flush-ms F]
+//   --out       where the lines go (default: a temporary file)
+//   --flush-ms  JsonLinesWriter flush interval, 0 flushes every line
+
+#include "ControlStream.h"
+#include "SyntheticTreeProvider.h"
+#include "Utf8.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace UIAListCore;
+using namespace UIAListBench;
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<uint64_t> g_allocations{ 0 };
+
+void* operator new(std::size_t size)
+{
+    ++g_allocations;
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+namespace
+{
+    const uint32_t kProperties = PropertyControlType | PropertyName | PropertyAutomationId | PropertyCapabilities;
+
+    struct Result
+    {
+        size_t Nodes{ 0 };
+        uint64_t Bytes{ 0 };
+        uint64_t Allocations{ 0 };
+        double Seconds{ 0 };
+    };
+
+    Result WalkOnly(TreeProvider& provider)
+    {
+        Result result;
+        const uint64_t allocations = g_allocations;
+        const auto start = Clock::now();
+
+        ControlWalker walker(provider, WalkMode::BuildCache, kProperties);
+        walker.Walk([&](TreeElement&, const ElementProperties&, size_t) { ++result.Nodes; });
+
+        result.Seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.Allocations = g_allocations - allocations;
+        return result;
+    }
+
+    Result Streamed(TreeProvider& provider, std::FILE* file, std::chrono::milliseconds flushInterval)
+    {
+        ControlStreamOptions options;
+        options.Properties = kProperties;
+
+        Result result;
+        const uint64_t allocations = g_allocations;
+        const auto start = Clock::now();
+
+        JsonLinesWriter writer(file, flushInterval);
+        const StreamResult streamed = StreamControls(provider, options, writer);
+
+        result.Seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.Allocations = g_allocations - allocations;
+        result.Nodes = streamed.Written;
+        result.Bytes = writer.Bytes();
+        return result;
+    }
+
+    // What a straightforward implementation does: build, convert, print
+    Result Naive(TreeProvider& provider, std::FILE* file)
+    {
+        Result result;
+        const uint64_t allocations = g_allocations;
+        const auto start = Clock::now();
+
+        ControlWalker walker(provider, WalkMode::BuildCache, kProperties);
+        walker.Walk([&](TreeElement&, const ElementProperties& properties, size_t depth)
+        {
+            std::string line = "{\"index\":" + std::to_string(result.Nodes) + ",\"depth\":" + std::to_string(depth);
+            line += ",\"type\":\"" + std::string(ControlTypeName(properties.ControlType)) + "\"";
+            line += ",\"controlType\":" + std::to_string(properties.ControlType);
+            line += ",\"name\":\"" + ToUtf8(properties.Name) + "\"";
+            line += ",\"automationId\":\"" + ToUtf8(properties.AutomationId) + "\"";
+            line += ",\"capabilities\":" + std::to_string(properties.Capabilities) + "}\n";
+            std::fputs(line.c_str(), file);
+            result.Bytes += line.size();
+            ++result.Nodes;
+        });
+        std::fflush(file);
+
+        result.Seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.Allocations = g_allocations - allocations;
+        return result;
+    }
+
+    std::vector<size_t> ParseSizes(const char* text)
+    {
+        std::vector<size_t> sizes;
+        while (*text)
+        {
+            char* end = nullptr;
+            size_t size = std::strtoul(text, &end, 10);
+            if (end == text) break;
+            if (size > 0) sizes.push_back(size);
+            text = (*end == ',') ? end + 1 : end;
+        }
+        return sizes;
+    }
+
+    void PrintResult(const Result& result, size_t size, const char* output)
+    {
+        std::printf("%-9zu %-16s %14.0f %9.1f %12.2f %10.1f\n",
+                    size, output,
+                    result.Seconds > 0 ? result.Nodes / result.Seconds : 0.0,
+                    result.Seconds > 0 ? result.Bytes / result.Seconds / (1024.0 * 1024.0) : 0.0,
+                    result.Nodes ? static_cast<double>(result.Allocations) / result.Nodes : 0.0,
+                    result.Seconds * 1000.0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<size_t> sizes = { 1000, 10000, 100000, 1000000 };
+    const char* outPath = nullptr;
+    long flushMs = JsonLinesWriter::DefaultFlushInterval.count();
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--sizes") == 0) sizes = ParseSizes(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--out") == 0) outPath = argv[i + 1];
+        else if (std::strcmp(argv[i], "--flush-ms") == 0) flushMs = std::strtol(argv[i + 1], nullptr, 10);
+    }
+
+    std::FILE* file = outPath ? std::fopen(outPath, "wb") : std::tmpfile();
+    if (!file)
+    {
+        std::fprintf(stderr, "Cannot open %s\n", outPath ? outPath : "a temporary file");
+        return 1;
+    }
+
+    std::printf("# BuildCache walk, all properties, JsonLinesWriter flush every %ld ms\n", flushMs);
+    std::printf("%-9s %-16s %14s %9s %12s %10s\n", "nodes", "output", "nodes/s", "MB/s", "allocs/node", "ms");
+
+    for (size_t size : sizes)
+    {
+        SyntheticTreeShape shape;
+        shape.Nodes = size;
+        SyntheticTreeProvider provider(shape);
+
+        PrintResult(WalkOnly(provider), size, "walk only");
+        PrintResult(Streamed(provider, file, std::chrono::milliseconds(flushMs)), size, "JsonLinesWriter");
+        PrintResult(Naive(provider, file), size, "string+fputs");
+    }
+
+    std::fclose(file);
+    return 0;
+}
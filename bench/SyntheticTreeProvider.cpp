@@ -0,0 +1,291 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "SyntheticTreeProvider.h"
+#include "ActionStrategy.h"
+
+#include <algorithm>
+#include <deque>
+
+using namespace UIAListCore;
+
+namespace UIAListBench
+{
+    namespace
+    {
+        class SyntheticElement : public TreeElement
+        {
+        public:
+            SyntheticElement(uint32_t index, uint32_t cached) : Index(index), Cached(cached) {}
+
+            uint32_t Index;
+            uint32_t Cached;  // ElementProperty bits fetched with the element
+        };
+
+        // Rough mix of a desktop application window
+        const std::vector<std::pair<int32_t, double>> kDefaultTypeMix =
+        {
+            { TypeText, 25 }, { TypeButton, 18 }, { TypeListItem, 12 }, { TypePane, 10 },
+            { TypeGroup, 8 }, { TypeMenuItem, 8 }, { TypeEdit, 5 }, { TypeHyperlink, 5 },
+            { TypeCheckBox, 4 }, { TypeTreeItem, 3 }, { TypeDataItem, 2 },
+        };
+
+        uint32_t CapabilitiesFor(int32_t controlType)
+        {
+            const uint32_t base = CapabilitiesKnown | CapabilityOnScreen | CapabilityLegacyIAccessible;
+            switch (controlType)
+            {
+            case TypeButton:
+            case TypeHyperlink:
+            case TypeMenuItem: return base | CapabilityInvoke | CapabilityKeyboardFocusable;
+            case TypeCheckBox: return base | CapabilityToggle | CapabilityKeyboardFocusable;
+            case TypeListItem:
+            case TypeTreeItem:
+            case TypeDataItem: return base | CapabilitySelectionItem;
+            case TypeEdit: return base | CapabilityKeyboardFocusable;
+            default: return base;
+            }
+        }
+
+        void SpinFor(std::chrono::nanoseconds duration)
+        {
+            if (duration.count() <= 0) return;
+            const auto end = std::chrono::steady_clock::now() + duration;
+            while (std::chrono::steady_clock::now() < end) {}
+        }
+    }
+
+    SyntheticTreeProvider::SyntheticTreeProvider(const SyntheticTreeShape& shape, SyntheticLatency latency)
+        : m_latency(latency)
+        , m_jitter(shape.Seed)
+    {
+        Generate(shape);
+    }
+
+    void SyntheticTreeProvider::Generate(const SyntheticTreeShape& shape)
+    {
+        std::mt19937 random(shape.Seed);
+        const auto& typeMix = shape.TypeMix.empty() ? kDefaultTypeMix : shape.TypeMix;
+
+        std::vector<double> weights;
+        for (const auto& entry : typeMix) weights.push_back(entry.second);
+        std::discrete_distribution<size_t> pickType(weights.begin(), weights.end());
+        std::uniform_int_distribution<size_t> pickChildren(0, 2 * shape.FanOut);
+        std::uniform_int_distribution<size_t> pickLength(shape.NameLengthMin, shape.NameLengthMax);
+        std::uniform_int_distribution<int> pickLetter(0, 25);
+        std::bernoulli_distribution noName(shape.EmptyNameRatio);
+
+        auto makeNode = [&](int32_t controlType)
+        {
+            Node node;
+            node.ControlType = controlType;
+            node.Capabilities = CapabilitiesFor(controlType);
+            node.HasName = !noName(random);
+            if (node.HasName)
+            {
+                size_t length = pickLength(random);
+                node.Name.reserve(length);
+                for (size_t i = 0; i < length; ++i)
+                {
+                    // Word-like runs so filtering has something to match
+                    node.Name.push_back((i % 7 == 6) ? L' ' : static_cast<wchar_t>((i % 7 == 0 ? L'A' : L'a') + pickLetter(random)));
+                }
+            }
+            if (m_nodes.size() % 3 == 0)
+            {
+                node.AutomationId = L"id" + std::to_wstring(m_nodes.size());
+            }
+            m_nodes.push_back(std::move(node));
+            return static_cast<uint32_t>(m_nodes.size() - 1);
+        };
+
+        m_nodes.clear();
+        m_nodes.reserve(shape.Nodes);
+        makeNode(TypeWindow);
+
+        // Breadth-first so the size target is met before the depth limit
+        std::deque<std::pair<uint32_t, size_t>> open;  // Node, depth
+        open.emplace_back(0, 0);
+
+        while (m_nodes.size() < shape.Nodes && !open.empty())
+        {
+            auto [parent, depth] = open.front();
+            open.pop_front();
+            if (depth >= shape.MaxDepth) continue;
+
+            size_t children = pickChildren(random);
+            if (open.empty() && children == 0) children = 1;  // Never stall short of the target
+
+            uint32_t previous = NoNode;
+            for (size_t i = 0; i < children && m_nodes.size() < shape.Nodes; ++i)
+            {
+                uint32_t child = makeNode(typeMix[pickType(random)].first);
+                m_nodes[child].Parent = parent;
+                if (previous == NoNode) m_nodes[parent].FirstChild = child;
+                else m_nodes[previous].NextSibling = child;
+                previous = child;
+                open.emplace_back(child, depth + 1);
+            }
+        }
+
+        Layout();
+    }
+
+    void SyntheticTreeProvider::Layout()
+    {
+        if (m_nodes.empty()) return;
+
+        // A full HD window split into panes by the top two levels; below,
+        // each pane lists its subtree like a tree view, a row per element
+        // indented by depth, containers spanning their descendants' rows.
+        // Long subtrees run on beyond the window, scrolled out of view.
+        const int32_t RowHeight = 20;
+        const int32_t Indent = 16;
+        const size_t PaneDepth = 2;
+
+        // Children come after their parents, so the subtree sizes sum up backwards
+        std::vector<uint32_t> rows(m_nodes.size(), 1);
+        for (size_t i = m_nodes.size(); i-- > 0;)
+        {
+            for (uint32_t child = m_nodes[i].FirstChild; child != NoNode; child = m_nodes[child].NextSibling)
+            {
+                rows[i] += rows[child];
+            }
+        }
+
+        std::vector<uint8_t> depths(m_nodes.size(), 0);
+        m_nodes[0].Bounds = { 0, 0, 1920, 1080 };
+        for (uint32_t parent = 0; parent < m_nodes.size(); ++parent)
+        {
+            const ElementRect area = m_nodes[parent].Bounds;
+            uint32_t count = 0;
+            for (uint32_t child = m_nodes[parent].FirstChild; child != NoNode; child = m_nodes[child].NextSibling)
+            {
+                ++count;
+            }
+
+            const int32_t columns = count > 2 ? 2 : static_cast<int32_t>(count);
+            int32_t position = 0;
+            int32_t top = area.Top + RowHeight;
+            for (uint32_t child = m_nodes[parent].FirstChild; child != NoNode; child = m_nodes[child].NextSibling)
+            {
+                depths[child] = static_cast<uint8_t>(std::min<size_t>(255, depths[parent] + 1));
+                ElementRect& bounds = m_nodes[child].Bounds;
+                if (depths[parent] < PaneDepth)
+                {
+                    const int32_t cellWidth = static_cast<int32_t>(area.Width() / columns);
+                    const int32_t cellHeight = static_cast<int32_t>(area.Height() / ((count + columns - 1) / columns));
+                    const int32_t left = area.Left + (position % columns) * cellWidth;
+                    const int32_t cellTop = area.Top + (position / columns) * cellHeight;
+                    bounds = { left + 1, cellTop + 1, left + cellWidth - 1, cellTop + cellHeight - 1 };
+                }
+                else
+                {
+                    const int32_t left = std::min(area.Left + Indent, area.Right - Indent);
+                    bounds = { left, top, area.Right, top + static_cast<int32_t>(rows[child]) * RowHeight - 2 };
+                    top += static_cast<int32_t>(rows[child]) * RowHeight;
+                }
+                ++position;
+            }
+        }
+    }
+
+    void SyntheticTreeProvider::Call()
+    {
+        ++m_calls;
+
+        std::chrono::nanoseconds cost = m_latency.PerCall;
+        if (m_latency.Jitter.count() > 0)
+        {
+            std::uniform_int_distribution<long long> jitter(-m_latency.Jitter.count(), m_latency.Jitter.count());
+            cost += std::chrono::nanoseconds(jitter(m_jitter));
+        }
+        SpinFor(cost);
+    }
+
+    bool SyntheticTreeProvider::SetCacheRequest(const CacheRequest& request)
+    {
+        m_request = request;
+        return true;
+    }
+
+    std::unique_ptr<TreeElement> SyntheticTreeProvider::Fetch(uint32_t index, bool viaCall)
+    {
+        if (viaCall) Call();
+        if (index == NoNode) return nullptr;
+        return std::make_unique<SyntheticElement>(index, m_request.Properties);
+    }
+
+    std::unique_ptr<TreeElement> SyntheticTreeProvider::Root()
+    {
+        // With a subtree cache request this one call brings the whole tree
+        return Fetch(m_nodes.empty() ? NoNode : 0, true);
+    }
+
+    std::unique_ptr<TreeElement> SyntheticTreeProvider::FirstChild(TreeElement& parent)
+    {
+        const Node& node = m_nodes[static_cast<SyntheticElement&>(parent).Index];
+        return Fetch(node.FirstChild, !m_request.Subtree);
+    }
+
+    std::unique_ptr<TreeElement> SyntheticTreeProvider::NextSibling(TreeElement& element)
+    {
+        const Node& node = m_nodes[static_cast<SyntheticElement&>(element).Index];
+        return Fetch(node.NextSibling, !m_request.Subtree);
+    }
+
+    bool SyntheticTreeProvider::GetProperties(TreeElement& element, uint32_t properties, ElementProperties& result)
+    {
+        const SyntheticElement& synthetic = static_cast<SyntheticElement&>(element);
+        const Node& node = m_nodes[synthetic.Index];
+
+        // One call per property the cache request did not bring along
+        for (uint32_t property : { PropertyControlType, PropertyName, PropertyAutomationId, PropertyBoundingRectangle })
+        {
+            if ((properties & property) && !(synthetic.Cached & property)) Call();
+        }
+
+        if (properties & PropertyControlType) result.ControlType = node.ControlType;
+        if (properties & PropertyName)
+        {
+            result.HasName = node.HasName;
+            result.Name = node.Name;
+        }
+        if (properties & PropertyAutomationId) result.AutomationId = node.AutomationId;
+        if (properties & PropertyBoundingRectangle) result.BoundingRectangle = node.Bounds;
+
+        // Like UiaTreeProvider: only known when cached, otherwise probed at action time
+        result.Capabilities = (properties & synthetic.Cached & PropertyCapabilities) ? node.Capabilities : CapabilitiesNone;
+        return true;
+    }
+
+    std::unique_ptr<TreeElement> SyntheticTreeProvider::Focused()
+    {
+        return Fetch(m_focused, true);
+    }
+
+    std::unique_ptr<TreeElement> SyntheticTreeProvider::Parent(TreeElement& element)
+    {
+        return Fetch(m_nodes[static_cast<SyntheticElement&>(element).Index].Parent, true);
+    }
+
+    bool SyntheticTreeProvider::IsSameElement(TreeElement& a, TreeElement& b)
+    {
+        // Runtime ids travel with the cache request, so the comparison is local
+        return static_cast<SyntheticElement&>(a).Index == static_cast<SyntheticElement&>(b).Index;
+    }
+
+    size_t SyntheticTreeProvider::Depth(size_t index) const
+    {
+        size_t depth = 0;
+        for (uint32_t node = m_nodes[index].Parent; node != NoNode; node = m_nodes[node].Parent) ++depth;
+        return depth;
+    }
+}
@@ -0,0 +1,130 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "TreeProvider.h"
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace UIAListBench
+{
+    // UIA control type ids, so synthetic trees look like real ones to the core
+    enum SyntheticControlType : int32_t
+    {
+        TypeButton = 50000,
+        TypeCheckBox = 50002,
+        TypeComboBox = 50003,
+        TypeEdit = 50004,
+        TypeHyperlink = 50005,
+        TypeImage = 50006,
+        TypeListItem = 50007,
+        TypeList = 50008,
+        TypeMenu = 50009,
+        TypeMenuBar = 50010,
+        TypeMenuItem = 50011,
+        TypeTab = 50018,
+        TypeTabItem = 50019,
+        TypeText = 50020,
+        TypeToolBar = 50021,
+        TypeTreeItem = 50024,
+        TypeGroup = 50026,
+        TypeDataGrid = 50028,
+        TypeDataItem = 50029,
+        TypeDocument = 50030,
+        TypeSplitButton = 50031,
+        TypeWindow = 50032,
+        TypePane = 50033,
+    };
+
+    struct SyntheticTreeShape
+    {
+        size_t Nodes{ 10000 };
+        size_t MaxDepth{ 12 };
+        size_t FanOut{ 8 };  // Mean children per element, uniform in [0, 2 * FanOut]
+
+        // Names: EmptyNameRatio have none, the rest a length uniform in [min, max]
+        double EmptyNameRatio{ 0.15 };
+        size_t NameLengthMin{ 3 };
+        size_t NameLengthMax{ 32 };
+
+        // Control types with relative weights; empty means a desktop-app default mix
+        std::vector<std::pair<int32_t, double>> TypeMix;
+
+        uint32_t Seed{ 1 };
+    };
+
+    // Simulated cross-process cost, charged per call by busy-waiting
+    struct SyntheticLatency
+    {
+        std::chrono::nanoseconds PerCall{ 0 };
+        std::chrono::nanoseconds Jitter{ 0 };  // Uniform +/- around PerCall
+    };
+
+    // In-process TreeProvider over a generated tree. Counts the calls a real
+    // UIA client would make across the process boundary: navigation, uncached
+    // property reads and the root fetch; cached reads are free.
+    class SyntheticTreeProvider : public UIAListCore::TreeProvider
+    {
+    public:
+        SyntheticTreeProvider(const SyntheticTreeShape& shape, SyntheticLatency latency = {});
+
+        bool SetCacheRequest(const UIAListCore::CacheRequest& request) override;
+        std::unique_ptr<UIAListCore::TreeElement> Root() override;
+        std::unique_ptr<UIAListCore::TreeElement> FirstChild(UIAListCore::TreeElement& parent) override;
+        std::unique_ptr<UIAListCore::TreeElement> NextSibling(UIAListCore::TreeElement& element) override;
+        bool GetProperties(UIAListCore::TreeElement& element, uint32_t properties,
+                           UIAListCore::ElementProperties& result) override;
+        std::unique_ptr<UIAListCore::TreeElement> Focused() override;
+        std::unique_ptr<UIAListCore::TreeElement> Parent(UIAListCore::TreeElement& element) override;
+        bool IsSameElement(UIAListCore::TreeElement& a, UIAListCore::TreeElement& b) override;
+
+        // Focused returns node index, in breadth-first order; none by default
+        void SetFocused(size_t index) { m_focused = index < m_nodes.size() ? static_cast<uint32_t>(index) : NoNode; }
+
+        size_t NodeCount() const { return m_nodes.size(); }
+        size_t Depth(size_t index) const;
+        uint64_t Calls() const override { return m_calls; }
+        void ResetCalls() { m_calls = 0; }
+
+    private:
+        static constexpr uint32_t NoNode = UINT32_MAX;
+
+        struct Node
+        {
+            uint32_t Parent{ NoNode };
+            uint32_t FirstChild{ NoNode };
+            uint32_t NextSibling{ NoNode };
+            int32_t ControlType{ 0 };
+            uint32_t Capabilities{ 0 };
+            UIAListCore::ElementRect Bounds;
+            bool HasName{ false };
+            std::wstring Name;
+            std::wstring AutomationId;
+        };
+
+        void Generate(const SyntheticTreeShape& shape);
+        void Layout();
+        std::unique_ptr<UIAListCore::TreeElement> Fetch(uint32_t index, bool viaCall);
+        void Call();
+
+        std::vector<Node> m_nodes;
+        SyntheticLatency m_latency;
+        UIAListCore::CacheRequest m_request;
+        uint64_t m_calls{ 0 };
+        uint32_t m_focused{ NoNode };
+        std::mt19937 m_jitter;
+    };
+}
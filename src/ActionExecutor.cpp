@@ -0,0 +1,207 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ActionExecutor.h"
+
+#include <algorithm>
+
+namespace UIAListCore
+{
+    const char* ToString(ActionResult result)
+    {
+        switch (result)
+        {
+        case ActionResult::Succeeded: return "Succeeded";
+        case ActionResult::Failed: return "Failed";
+        case ActionResult::TimedOut: return "TimedOut";
+        case ActionResult::Cancelled: return "Cancelled";
+        }
+        return "Unknown";
+    }
+
+    ActionExecutor::ActionExecutor(ThreadHook onThreadStart, ThreadHook onThreadStop)
+        : m_state(std::make_shared<State>())
+    {
+        m_state->OnThreadStart = std::move(onThreadStart);
+        m_state->OnThreadStop = std::move(onThreadStop);
+
+        m_worker = std::thread(&ActionExecutor::WorkerLoop, m_state);
+        m_watchdog = std::thread(&ActionExecutor::WatchdogLoop, this);
+    }
+
+    ActionExecutor::~ActionExecutor()
+    {
+        std::deque<std::shared_ptr<Job>> cancelled;
+        std::shared_ptr<Job> running;
+        {
+            std::lock_guard<std::mutex> lock(m_state->Mutex);
+            cancelled.swap(m_state->Queue);
+            running = m_state->Running;
+            m_state->Stopping = true;
+        }
+        m_state->WorkAvailable.notify_all();
+        m_state->DeadlinesChanged.notify_all();
+
+        for (const auto& job : cancelled)
+        {
+            Complete(*m_state, job, ActionResult::Cancelled);
+        }
+        m_watchdog.join();
+
+        // The running action gets until its deadline; the call into a hung
+        // target application may never return, so joining could block exit
+        bool returned = true;
+        if (running)
+        {
+            std::unique_lock<std::mutex> lock(m_state->Mutex);
+            returned = m_state->WorkerIdle.wait_until(lock, running->Deadline, [this]() { return !m_state->Running; });
+        }
+
+        if (returned)
+        {
+            m_worker.join();
+        }
+        else
+        {
+            // The watchdog is gone, so time it out here
+            Complete(*m_state, running, ActionResult::TimedOut);
+            m_worker.detach();
+
+            // The action may have returned just now, its worker completing it
+            std::unique_lock<std::mutex> lock(m_state->Mutex);
+            m_state->CompletionDone.wait(lock, [this]() { return m_state->Completing == 0; });
+        }
+    }
+
+    std::future<ActionResult> ActionExecutor::Submit(Action action, std::chrono::milliseconds timeout,
+                                                     Completion onComplete)
+    {
+        auto job = std::make_shared<Job>();
+        job->Run = std::move(action);
+        job->OnComplete = std::move(onComplete);
+        job->Deadline = Clock::now() + timeout;
+        std::future<ActionResult> future = job->Promise.get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(m_state->Mutex);
+            m_state->Queue.push_back(job);
+            m_state->Pending.push_back(job);
+        }
+        m_state->WorkAvailable.notify_one();
+        m_state->DeadlinesChanged.notify_one();
+
+        return future;
+    }
+
+    void ActionExecutor::CancelPending()
+    {
+        std::deque<std::shared_ptr<Job>> cancelled;
+        {
+            std::lock_guard<std::mutex> lock(m_state->Mutex);
+            cancelled.swap(m_state->Queue);
+        }
+
+        for (const auto& job : cancelled)
+        {
+            Complete(*m_state, job, ActionResult::Cancelled);
+        }
+    }
+
+    void ActionExecutor::Complete(State& state, const std::shared_ptr<Job>& job, ActionResult result)
+    {
+        {
+            std::lock_guard<std::mutex> lock(state.Mutex);
+            if (job->Completed) return;
+            job->Completed = true;
+            ++state.Completing;
+            state.Pending.erase(std::remove(state.Pending.begin(), state.Pending.end(), job), state.Pending.end());
+        }
+
+        job->Promise.set_value(result);
+        if (job->OnComplete) job->OnComplete(result);
+
+        {
+            std::lock_guard<std::mutex> lock(state.Mutex);
+            --state.Completing;
+        }
+        state.CompletionDone.notify_all();
+    }
+
+    void ActionExecutor::WorkerLoop(std::shared_ptr<State> state)
+    {
+        if (state->OnThreadStart) state->OnThreadStart();
+
+        for (;;)
+        {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(state->Mutex);
+                state->WorkAvailable.wait(lock, [&state]() { return state->Stopping || !state->Queue.empty(); });
+                if (state->Queue.empty()) break;
+
+                job = std::move(state->Queue.front());
+                state->Queue.pop_front();
+
+                // Timed out while waiting behind a slow action
+                if (job->Completed) continue;
+                state->Running = job;
+            }
+
+            bool succeeded = false;
+            try
+            {
+                succeeded = job->Run();
+            }
+            catch (...)
+            {
+                succeeded = false;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(state->Mutex);
+                state->Running.reset();
+            }
+            state->WorkerIdle.notify_all();
+
+            Complete(*state, job, succeeded ? ActionResult::Succeeded : ActionResult::Failed);
+        }
+
+        if (state->OnThreadStop) state->OnThreadStop();
+    }
+
+    void ActionExecutor::WatchdogLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_state->Mutex);
+
+        while (!m_state->Stopping)
+        {
+            if (m_state->Pending.empty())
+            {
+                m_state->DeadlinesChanged.wait(lock);
+                continue;
+            }
+
+            auto earliest = std::min_element(m_state->Pending.begin(), m_state->Pending.end(),
+                [](const auto& a, const auto& b) { return a->Deadline < b->Deadline; });
+            Clock::time_point deadline = (*earliest)->Deadline;
+
+            if (Clock::now() < deadline)
+            {
+                m_state->DeadlinesChanged.wait_until(lock, deadline);
+                continue;
+            }
+
+            std::shared_ptr<Job> expired = *earliest;
+            lock.unlock();
+            Complete(*m_state, expired, ActionResult::TimedOut);
+            lock.lock();
+        }
+    }
+}
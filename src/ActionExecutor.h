@@ -0,0 +1,110 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace UIAListCore
+{
+    enum class ActionResult
+    {
+        Succeeded,
+        Failed,
+        TimedOut,   // Deadline passed, the action may still finish in the background
+        Cancelled   // Dropped from the queue before it started
+    };
+
+    const char* ToString(ActionResult result);
+
+    // Runs control interactions on a dedicated automation thread so a busy
+    // target application can never freeze the UI thread.
+    // Every submitted action completes exactly once, at the latest when its
+    // timeout expires. Completion callbacks run on the executor's threads;
+    // frontends marshal them back to their UI thread.
+    class ActionExecutor
+    {
+    public:
+        using Action = std::function<bool()>;
+        using Completion = std::function<void(ActionResult)>;
+        using ThreadHook = std::function<void()>;
+
+        // onThreadStart/onThreadStop run on the automation thread (COM init/uninit)
+        explicit ActionExecutor(ThreadHook onThreadStart = {}, ThreadHook onThreadStop = {});
+
+        // Cancels the queued actions and waits for the running one until its
+        // deadline. An action still hung then is left behind: its thread is
+        // detached and finishes on its own (or ends with the process), with
+        // its result dropped and onThreadStop run when the call returns. So
+        // an action must own what it uses. Completion callbacks are done
+        // when this returns; none runs later.
+        ~ActionExecutor();
+
+        ActionExecutor(const ActionExecutor&) = delete;
+        ActionExecutor& operator=(const ActionExecutor&) = delete;
+
+        // Queue an action. The timeout counts from submission, including queue time.
+        std::future<ActionResult> Submit(Action action, std::chrono::milliseconds timeout,
+                                         Completion onComplete = {});
+
+        // Complete all queued (not yet started) actions with Cancelled
+        void CancelPending();
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Job
+        {
+            Action Run;
+            Completion OnComplete;
+            std::promise<ActionResult> Promise;
+            Clock::time_point Deadline;
+            bool Completed{ false };  // Guarded by State::Mutex
+        };
+
+        // Everything the threads use. The worker holds its own reference, so
+        // a worker detached inside a hung action outlives the executor safely.
+        struct State
+        {
+            ThreadHook OnThreadStart;
+            ThreadHook OnThreadStop;
+
+            std::mutex Mutex;
+            std::condition_variable WorkAvailable;
+            std::condition_variable DeadlinesChanged;
+            std::condition_variable WorkerIdle;
+            std::condition_variable CompletionDone;
+            std::deque<std::shared_ptr<Job>> Queue;
+            std::vector<std::shared_ptr<Job>> Pending;  // Submitted and not completed, for the watchdog
+            std::shared_ptr<Job> Running;  // Started and not returned yet
+            int Completing{ 0 };  // Completion callbacks under way
+            bool Stopping{ false };
+        };
+
+        static void WorkerLoop(std::shared_ptr<State> state);
+        void WatchdogLoop();
+
+        // Completes the job once; later calls are ignored
+        static void Complete(State& state, const std::shared_ptr<Job>& job, ActionResult result);
+
+        std::shared_ptr<State> m_state;
+
+        std::thread m_worker;
+        std::thread m_watchdog;
+    };
+}
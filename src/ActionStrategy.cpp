@@ -0,0 +1,102 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ActionStrategy.h"
+
+namespace UIAListCore
+{
+    ActionPlan PlanAction(ActionKind kind, uint32_t capabilities)
+    {
+        ActionPlan plan;
+        const bool known = (capabilities & CapabilitiesKnown) != 0;
+        auto has = [known, capabilities](uint32_t capability)
+        {
+            return !known || (capabilities & capability) != 0;
+        };
+
+        switch (kind)
+        {
+        case ActionKind::Click:
+            // Real input first, then the patterns buttons, legacy controls and list items offer
+            if (has(CapabilityOnScreen)) plan.Add(ActionStrategy::Mouse);
+            if (has(CapabilityInvoke)) plan.Add(ActionStrategy::Invoke);
+            if (has(CapabilityLegacyIAccessible)) plan.Add(ActionStrategy::LegacyDefaultAction);
+            if (has(CapabilitySelectionItem)) plan.Add(ActionStrategy::SelectionItem);
+            break;
+
+        case ActionKind::DoubleClick:
+            // Real input first; toggles (checkboxes) take a double-click as one toggle
+            if (has(CapabilityOnScreen)) plan.Add(ActionStrategy::Mouse);
+            if (has(CapabilityToggle)) plan.Add(ActionStrategy::Toggle);
+            if (has(CapabilityLegacyIAccessible)) plan.Add(ActionStrategy::LegacyDefaultAction);
+            if (has(CapabilityInvoke)) plan.Add(ActionStrategy::Invoke);
+            break;
+
+        case ActionKind::Focus:
+            // Tab navigation is the last resort, it cannot aim at the control
+            if (has(CapabilityKeyboardFocusable)) plan.Add(ActionStrategy::SetFocus);
+            if (has(CapabilityOnScreen)) plan.Add(ActionStrategy::Mouse);
+            plan.Add(ActionStrategy::KeyboardTab);
+            break;
+        }
+
+        return plan;
+    }
+
+    bool ExecutePlan(const ActionPlan& plan, ActionKind kind, ActionTarget& target, ActionTrace* trace)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        bool succeeded = false;
+        uint8_t attempts = 0;
+
+        while (attempts < plan.Count && !succeeded)
+        {
+            succeeded = target.Run(plan.Steps[attempts++], kind);
+        }
+
+        if (trace)
+        {
+            trace->Kind = kind;
+            trace->Strategy = attempts > 0 ? plan.Steps[attempts - 1] : ActionStrategy::Mouse;
+            trace->Attempts = attempts;
+            trace->Succeeded = succeeded;
+            trace->Elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+        }
+
+        return succeeded;
+    }
+
+    const char* ToString(ActionKind kind)
+    {
+        switch (kind)
+        {
+        case ActionKind::Click: return "Click";
+        case ActionKind::DoubleClick: return "DoubleClick";
+        case ActionKind::Focus: return "Focus";
+        }
+        return "Unknown";
+    }
+
+    const char* ToString(ActionStrategy strategy)
+    {
+        switch (strategy)
+        {
+        case ActionStrategy::Mouse: return "Mouse";
+        case ActionStrategy::Invoke: return "Invoke";
+        case ActionStrategy::LegacyDefaultAction: return "LegacyDefaultAction";
+        case ActionStrategy::SelectionItem: return "SelectionItem";
+        case ActionStrategy::Toggle: return "Toggle";
+        case ActionStrategy::SetFocus: return "SetFocus";
+        case ActionStrategy::KeyboardTab: return "KeyboardTab";
+        }
+        return "Unknown";
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+// Frontend-neutral code shared by the WinUI and the Qt frontend lives in
+// UIAListCore; the Qt main window class already owns the name UIAList
+namespace UIAListCore
+{
+    // Per-control capability bits, fetched in the enumeration batch
+    // (IsXxxPatternAvailable, IsKeyboardFocusable, IsOffscreen + BoundingRectangle)
+    enum Capability : uint32_t
+    {
+        CapabilitiesNone          = 0,
+        CapabilitiesKnown         = 1u << 0,  // Set when the bits below were prefetched
+        CapabilityInvoke          = 1u << 1,
+        CapabilityLegacyIAccessible = 1u << 2,
+        CapabilitySelectionItem   = 1u << 3,
+        CapabilityToggle          = 1u << 4,
+        CapabilityKeyboardFocusable = 1u << 5,
+        CapabilityOnScreen        = 1u << 6,  // Non-empty bounding rectangle and not offscreen
+    };
+
+    enum class ActionKind : uint8_t
+    {
+        Click,
+        DoubleClick,
+        Focus
+    };
+
+    // One way of performing an action on a control
+    enum class ActionStrategy : uint8_t
+    {
+        Mouse,                  // Simulated mouse input at the bounding rectangle center
+        Invoke,                 // InvokePattern
+        LegacyDefaultAction,    // LegacyIAccessiblePattern::DoDefaultAction
+        SelectionItem,          // SelectionItemPattern::Select
+        Toggle,                 // TogglePattern::Toggle
+        SetFocus,               // IUIAutomationElement::SetFocus
+        KeyboardTab             // Tab key navigation (last resort for focus)
+    };
+
+    // Ordered list of strategies to try until one succeeds
+    struct ActionPlan
+    {
+        std::array<ActionStrategy, 4> Steps{};
+        uint8_t Count{ 0 };
+
+        void Add(ActionStrategy strategy) { Steps[Count++] = strategy; }
+    };
+
+    // Build the strategy order for an action.
+    // Without prefetched capabilities this is the full probe chain;
+    // with them, strategies the control cannot support are skipped up front.
+    ActionPlan PlanAction(ActionKind kind, uint32_t capabilities);
+
+    // Target of an action plan. Implemented over IUIAutomationElement by
+    // UiaActionTarget and by fakes in the benchmarks.
+    class ActionTarget
+    {
+    public:
+        virtual ~ActionTarget() = default;
+
+        // Perform one strategy, returns true on success
+        virtual bool Run(ActionStrategy strategy, ActionKind kind) = 0;
+    };
+
+    // Latency record of one executed plan
+    struct ActionTrace
+    {
+        ActionKind Kind{ ActionKind::Click };
+        ActionStrategy Strategy{ ActionStrategy::Mouse };  // Strategy that succeeded, or the last one tried
+        uint8_t Attempts{ 0 };
+        bool Succeeded{ false };
+        std::chrono::microseconds Elapsed{ 0 };  // Whole plan, including failed attempts
+    };
+
+    // Run the plan's strategies in order until one succeeds.
+    // Fills trace when given.
+    bool ExecutePlan(const ActionPlan& plan, ActionKind kind, ActionTarget& target, ActionTrace* trace = nullptr);
+
+    const char* ToString(ActionKind kind);
+    const char* ToString(ActionStrategy strategy);
+}
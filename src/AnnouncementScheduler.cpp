@@ -0,0 +1,96 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "AnnouncementScheduler.h"
+
+#include <algorithm>
+
+namespace UIAListCore
+{
+    const char* ToString(Announcement announcement)
+    {
+        switch (announcement)
+        {
+        case Announcement::Status: return "Status";
+        case Announcement::Selection: return "Selection";
+        default: return "Unknown";
+        }
+    }
+
+    bool AnnouncementScheduler::Submit(Announcement kind, Clock::time_point now)
+    {
+        State& state = m_states[static_cast<size_t>(kind)];
+        ++m_stats.Submitted;
+
+        if (!state.Held && (!state.Announced || now - state.LastAnnounced >= m_timing.MinInterval))
+        {
+            state.LastAnnounced = now;
+            state.Announced = true;
+            ++m_stats.Announced;
+            return true;
+        }
+
+        if (state.Held)
+        {
+            ++m_stats.Coalesced;
+        }
+        else
+        {
+            state.Held = true;
+            state.FirstHeld = now;
+        }
+        state.LastSubmitted = now;
+        return false;
+    }
+
+    AnnouncementScheduler::Due AnnouncementScheduler::TakeDue(Clock::time_point now)
+    {
+        // Declaration order is priority order
+        Due due;
+        for (size_t i = 0; i < m_states.size(); ++i)
+        {
+            State& state = m_states[i];
+            if (!state.Held || DueAt(state) > now) continue;
+
+            state.Held = false;
+            state.LastAnnounced = now;
+            state.Announced = true;
+            ++m_stats.Announced;
+            due.Kinds[due.Size++] = static_cast<Announcement>(i);
+        }
+        return due;
+    }
+
+    AnnouncementScheduler::Clock::time_point AnnouncementScheduler::NextDue() const
+    {
+        Clock::time_point next = Clock::time_point::max();
+        for (const State& state : m_states)
+        {
+            if (state.Held) next = std::min(next, DueAt(state));
+        }
+        return next;
+    }
+
+    void AnnouncementScheduler::Cancel()
+    {
+        for (State& state : m_states)
+        {
+            if (state.Held) ++m_stats.Coalesced;
+            state.Held = false;
+        }
+    }
+
+    AnnouncementScheduler::Clock::time_point AnnouncementScheduler::DueAt(const State& state) const
+    {
+        // Once the input settles, but a long burst still hears something every MaxDelay
+        const Clock::time_point settled = std::min(state.LastSubmitted + m_timing.Settle, state.FirstHeld + m_timing.MaxDelay);
+        return std::max(settled, state.LastAnnounced + m_timing.MinInterval);
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace UIAListCore
+{
+    // What the list tells the screen reader. Status outranks Selection: when
+    // both are due, the status goes first.
+    enum class Announcement : uint8_t
+    {
+        Status,     // "Showing controls for ...", progress
+        Selection,  // The selected row
+        Count
+    };
+
+    const char* ToString(Announcement announcement);
+
+    // Decides when announcements reach the screen reader, so a held arrow key
+    // or fast typing does not queue up speech it lags behind on. Per kind:
+    //   - the first announcement after a quiet MinInterval goes out at once
+    //   - later ones are coalesced; only the latest is kept, and it goes out
+    //     once the input paused for Settle, or MaxDelay after the first one
+    //     held back, never sooner than MinInterval after the last one sent
+    // So a kind is announced at most once per MinInterval, and the final
+    // state always is. The scheduler holds no text: the caller announces
+    // what is current when a kind is due. Time is passed in; the frontend
+    // drives it from a timer armed for NextDue. Not thread-safe.
+    class AnnouncementScheduler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Timing
+        {
+            std::chrono::milliseconds MinInterval{ 150 };
+            std::chrono::milliseconds Settle{ 80 };
+            std::chrono::milliseconds MaxDelay{ 500 };
+        };
+
+        struct Stats
+        {
+            uint64_t Submitted{ 0 };
+            uint64_t Announced{ 0 };
+            uint64_t Coalesced{ 0 };  // Submitted and superseded before announced
+        };
+
+        // Kinds due, in the order to announce them
+        struct Due
+        {
+            std::array<Announcement, static_cast<size_t>(Announcement::Count)> Kinds{};
+            size_t Size{ 0 };
+
+            const Announcement* begin() const { return Kinds.data(); }
+            const Announcement* end() const { return Kinds.data() + Size; }
+        };
+
+        AnnouncementScheduler() = default;
+        explicit AnnouncementScheduler(const Timing& timing) : m_timing(timing) {}
+
+        // True: announce now. False: held back until a TakeDue says so.
+        bool Submit(Announcement kind, Clock::time_point now);
+
+        // The held back kinds whose time has come; they count as announced
+        Due TakeDue(Clock::time_point now);
+
+        // When the next held back kind is due; Clock::time_point::max() without one
+        Clock::time_point NextDue() const;
+
+        // Drops what is held back (the list was hidden)
+        void Cancel();
+
+        const Stats& GetStats() const { return m_stats; }
+
+    private:
+        struct State
+        {
+            Clock::time_point LastAnnounced{};  // Default: long ago
+            Clock::time_point FirstHeld{};
+            Clock::time_point LastSubmitted{};
+            bool Announced{ false };  // LastAnnounced is valid
+            bool Held{ false };
+        };
+
+        Clock::time_point DueAt(const State& state) const;
+
+        Timing m_timing;
+        std::array<State, static_cast<size_t>(Announcement::Count)> m_states{};
+        Stats m_stats;
+    };
+}
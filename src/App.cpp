@@ -11,6 +11,9 @@
 #include "pch.h"
 #include "App.h"
 #include "MainWindow.h"
+#include "Log.h"
+#include "RegistrySettingsBackend.h"
+#include "Trace.h"
 
 using namespace winrt;
 using namespace Microsoft::UI::Xaml;
@@ -30,6 +33,13 @@ namespace UIAList
     {
         m_running = true;
 
+        // UIALIST_TRACE=<file> records latency spans, written on exit
+        UIAListCore::TraceBuffer::InitializeFromEnvironment();
+        // UIALIST_LOG=<file> receives the structured log on exit and on a crash
+        UIAListCore::LogBuffer::InitializeFromEnvironment();
+        // Settings are read once here, later reads never touch the registry
+        UIAListCore::SettingsStore::Instance().Open(std::make_unique<UIAListCore::RegistrySettingsBackend>());
+
         // Create main window
         MainWindow mainWin;
         m_window = mainWin.GetWindow();
@@ -45,5 +55,12 @@ namespace UIAList
         {
             m_window.Close();
         }
+
+        if (!UIAListCore::SettingsStore::Instance().Flush())
+        {
+            UIALIST_LOG(Warning, "Settings changed last could not be stored");
+        }
+        UIAListCore::TraceBuffer::WriteRequestedFile();
+        UIAListCore::LogBuffer::WriteRequestedFile();
     }
 }
@@ -0,0 +1,136 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "CallStats.h"
+
+#if UIALIST_CALL_STATS
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        std::atomic<CallSite*> s_sites{ nullptr };
+
+        uint64_t NowNanoseconds()
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+    }
+
+    CallSite::CallSite(const char* method)
+        : Method(method)
+    {
+        // Lock-free push; sites are function-local statics and never go away
+        Next = s_sites.load(std::memory_order_relaxed);
+        while (!s_sites.compare_exchange_weak(Next, this, std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+
+    CallTimer::CallTimer(CallSite& site)
+        : m_site(site)
+        , m_start(NowNanoseconds())
+    {
+    }
+
+    CallTimer::~CallTimer()
+    {
+        m_site.Calls.fetch_add(1, std::memory_order_relaxed);
+        m_site.Nanoseconds.fetch_add(NowNanoseconds() - m_start, std::memory_order_relaxed);
+    }
+
+    namespace CallStats
+    {
+        std::vector<CallCount> Snapshot()
+        {
+            std::map<std::string, CallCount> byMethod;
+            for (CallSite* site = s_sites.load(std::memory_order_acquire); site; site = site->Next)
+            {
+                CallCount& count = byMethod.emplace(site->Method, CallCount{ site->Method }).first->second;
+                count.Calls += site->Calls.load(std::memory_order_relaxed);
+                count.Nanoseconds += site->Nanoseconds.load(std::memory_order_relaxed);
+            }
+
+            std::vector<CallCount> counts;
+            counts.reserve(byMethod.size());
+            for (const auto& entry : byMethod) counts.push_back(entry.second);
+            return counts;
+        }
+
+        std::vector<CallCount> Since(const std::vector<CallCount>& before)
+        {
+            std::map<std::string, CallCount> earlier;
+            for (const CallCount& count : before) earlier.emplace(count.Method, count);
+
+            std::vector<CallCount> counts;
+            for (CallCount count : Snapshot())
+            {
+                auto previous = earlier.find(count.Method);
+                if (previous != earlier.end())
+                {
+                    count.Calls -= previous->second.Calls;
+                    count.Nanoseconds -= previous->second.Nanoseconds;
+                }
+                if (count.Calls > 0) counts.push_back(count);
+            }
+
+            std::sort(counts.begin(), counts.end(),
+                      [](const CallCount& a, const CallCount& b) { return a.Nanoseconds > b.Nanoseconds; });
+            return counts;
+        }
+
+        std::string Format(const std::vector<CallCount>& counts, size_t nodes)
+        {
+            uint64_t calls = 0;
+            uint64_t nanoseconds = 0;
+            for (const CallCount& count : counts)
+            {
+                calls += count.Calls;
+                nanoseconds += count.Nanoseconds;
+            }
+
+            char line[256];
+            std::snprintf(line, sizeof(line), "%llu calls (%.2f/node) in %.1f ms\n",
+                          static_cast<unsigned long long>(calls), nodes ? static_cast<double>(calls) / nodes : 0.0,
+                          nanoseconds / 1e6);
+            std::string text = line;
+
+            for (const CallCount& count : counts)
+            {
+                std::snprintf(line, sizeof(line), "%8llu  %9.1f ms  %7.1f us/call  %s\n",
+                              static_cast<unsigned long long>(count.Calls), count.Nanoseconds / 1e6,
+                              count.Nanoseconds / 1e3 / count.Calls, count.Method);
+                text += line;
+            }
+            return text;
+        }
+
+        void Trace(const std::vector<CallCount>& counts)
+        {
+            if (!TraceBuffer::Enabled()) return;
+
+            uint64_t calls = 0;
+            for (const CallCount& count : counts)
+            {
+                TraceBuffer::Instance().RecordCounter(count.Method, "calls", count.Calls);
+                calls += count.Calls;
+            }
+            TraceBuffer::Instance().RecordCounter("UIA calls", "calls", calls);
+        }
+    }
+}
+
+#endif
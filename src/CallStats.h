@@ -0,0 +1,95 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Counts and times UI Automation calls by method, to see how many
+// cross-process calls an enumeration or action makes. On in debug builds,
+// compiled out completely when NDEBUG is defined; define UIALIST_CALL_STATS
+// to 0 or 1 to override.
+#ifndef UIALIST_CALL_STATS
+#ifdef NDEBUG
+#define UIALIST_CALL_STATS 0
+#else
+#define UIALIST_CALL_STATS 1
+#endif
+#endif
+
+namespace UIAListCore
+{
+    struct CallCount
+    {
+        const char* Method;
+        uint64_t Calls{ 0 };
+        uint64_t Nanoseconds{ 0 };
+    };
+
+#if UIALIST_CALL_STATS
+    // One per UIALIST_COUNTED call site, registered on first use
+    class CallSite
+    {
+    public:
+        explicit CallSite(const char* method);
+
+        const char* const Method;
+        std::atomic<uint64_t> Calls{ 0 };
+        std::atomic<uint64_t> Nanoseconds{ 0 };
+        CallSite* Next{ nullptr };
+    };
+
+    class CallTimer
+    {
+    public:
+        explicit CallTimer(CallSite& site);
+        ~CallTimer();
+
+        CallTimer(const CallTimer&) = delete;
+        CallTimer& operator=(const CallTimer&) = delete;
+
+    private:
+        CallSite& m_site;
+        uint64_t m_start;
+    };
+
+    namespace CallStats
+    {
+        // Totals per method since process start (sites of one method are merged)
+        std::vector<CallCount> Snapshot();
+
+        // Calls made after the snapshot was taken, slowest method first
+        std::vector<CallCount> Since(const std::vector<CallCount>& before);
+
+        // "1234 calls (2.1/node) in 812 ms" and one line per method
+        std::string Format(const std::vector<CallCount>& counts, size_t nodes);
+
+        // Total and per-method call counters in the latency trace
+        void Trace(const std::vector<CallCount>& counts);
+    }
+#endif
+}
+
+// HRESULT hr = UIALIST_COUNTED("IUIAutomationElement::SetFocus", element->SetFocus());
+#if UIALIST_CALL_STATS
+#define UIALIST_COUNTED(method, call) \
+    ([&]() -> decltype(auto) \
+    { \
+        static ::UIAListCore::CallSite uialistCallSite(method); \
+        ::UIAListCore::CallTimer uialistCallTimer(uialistCallSite); \
+        return call; \
+    }())
+#else
+#define UIALIST_COUNTED(method, call) (call)
+#endif
@@ -0,0 +1,58 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "CompactSnapshot.h"
+#include "Utf8.h"
+#include "Varint.h"
+
+namespace UIAListCore
+{
+    void CompactSnapshot::Append(const std::wstring& displayText, const std::wstring& name, int32_t controlType,
+                                 std::string_view locator)
+    {
+        PutString(m_data, ToUtf8(displayText));
+        PutString(m_data, ToUtf8(name));
+        PutVarint(m_data, static_cast<uint32_t>(controlType));
+        PutString(m_data, locator);
+        ++m_rows;
+    }
+
+    void CompactSnapshot::ShrinkToFit()
+    {
+        m_data.shrink_to_fit();
+        m_shared.shrink_to_fit();
+    }
+
+    void CompactSnapshot::Clear()
+    {
+        std::string().swap(m_data);
+        std::string().swap(m_shared);
+        m_rows = 0;
+    }
+
+    bool CompactSnapshot::ForEach(const std::function<void(const Row&)>& visit) const
+    {
+        VarintReader reader(m_data);
+        Row row;
+        std::string text;
+        for (size_t i = 0; i < m_rows; ++i)
+        {
+            uint32_t controlType = 0;
+            if (!reader.GetString(text)) return false;
+            row.DisplayText = FromUtf8(text);
+            if (!reader.GetString(text)) return false;
+            row.Name = FromUtf8(text);
+            if (!reader.GetUint32(controlType) || !reader.GetString(row.Locator)) return false;
+            row.ControlType = static_cast<int32_t>(controlType);
+            visit(row);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace UIAListCore
+{
+    // The control list of a window that has been hidden for a while, packed
+    // into one buffer: no element references, no rows, no per-control
+    // allocations. The list is rebuilt from it on the next show, without
+    // waiting for an enumeration. Text is stored as UTF-8, numbers as varints.
+    class CompactSnapshot
+    {
+    public:
+        struct Row
+        {
+            std::wstring DisplayText;
+            std::wstring Name;
+            int32_t ControlType{ 0 };
+            std::string_view Locator;  // Opaque, see ElementLocator::Packer; valid during the visit
+        };
+
+        void Append(const std::wstring& displayText, const std::wstring& name, int32_t controlType,
+                    std::string_view locator);
+
+        // Data the rows' locators refer to, e.g. their shared path steps
+        void SetShared(std::string shared) { m_shared = std::move(shared); }
+        const std::string& Shared() const { return m_shared; }
+
+        void ShrinkToFit();
+        void Clear();
+
+        size_t Rows() const { return m_rows; }
+        bool Empty() const { return m_rows == 0; }
+        size_t Bytes() const { return m_data.capacity() + m_shared.capacity(); }
+
+        // Visits the rows in order; false if the buffer is corrupt
+        bool ForEach(const std::function<void(const Row&)>& visit) const;
+
+    private:
+        std::string m_data;
+        std::string m_shared;
+        size_t m_rows{ 0 };
+    };
+}
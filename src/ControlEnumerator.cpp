@@ -10,12 +10,20 @@
 
 #include "pch.h"
 #include "ControlEnumerator.h"
+#include "ControlWalker.h"
+#include "SettingsManager.h"
+#include "Trace.h"
+#include "UiaTreeProvider.h"
+
+#include <cstdlib>
+#include <ctime>
+
+using namespace UIAListCore;
 
 namespace UIAList
 {
     ControlEnumerator::ControlEnumerator()
         : m_uiAutomation(nullptr)
-        , m_controlViewWalker(nullptr)
         , m_cancelled(false)
     {
         InitializeUIAutomation();
@@ -46,23 +54,11 @@ namespace UIAList
             return false;
         }
 
-        hr = m_uiAutomation->get_ControlViewWalker(&m_controlViewWalker);
-        if (FAILED(hr))
-        {
-            return false;
-        }
-
         return true;
     }
 
     void ControlEnumerator::CleanupUIAutomation()
     {
-        if (m_controlViewWalker)
-        {
-            m_controlViewWalker->Release();
-            m_controlViewWalker = nullptr;
-        }
-
         if (m_uiAutomation)
         {
             m_uiAutomation->Release();
@@ -103,6 +99,8 @@ namespace UIAList
 
     void ControlEnumerator::EnumerateWorker(HWND targetWindow)
     {
+        UIALIST_TRACE_SPAN("EnumerateWorker");
+
         // Initialize COM for this thread
         HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
         bool comInitialized = SUCCEEDED(hr);
@@ -124,28 +122,51 @@ namespace UIAList
         }
 
         // Validate UI Automation objects
-        if (!m_uiAutomation || !m_controlViewWalker)
+        if (!m_uiAutomation)
         {
             if (m_onCancelled) m_onCancelled();
             if (comInitialized) CoUninitialize();
             return;
         }
 
-        // Get UI Automation element for the target window
-        IUIAutomationElement* rootElement = nullptr;
-        hr = m_uiAutomation->ElementFromHandle(targetWindow, &rootElement);
-        if (FAILED(hr) || !rootElement)
+        // Properties travel with each navigation call; the subtree cache would
+        // save more calls but delivers nothing until the whole tree has arrived
+        UiaTreeProvider uiaProvider(m_uiAutomation, targetWindow);
+
+        // UIALIST_RECORD=<directory> saves every enumerated tree for offline replay
+        const char* recordDirectory = std::getenv("UIALIST_RECORD");
+        std::unique_ptr<RecordingTreeProvider> recorder;
+        if (recordDirectory && *recordDirectory)
+        {
+            recorder = std::make_unique<RecordingTreeProvider>(uiaProvider);
+        }
+        TreeProvider& provider = recorder ? static_cast<TreeProvider&>(*recorder) : uiaProvider;
+
+        ControlWalker walker(provider, WalkMode::BuildCache,
+                             PropertyControlType | PropertyName | PropertyAutomationId | PropertyCapabilities);
+
+        EnumerationStatsCollector stats;
+        walker.SetStats(&stats);
+
+        // In tree order, not outward from the focus as the Qt list: rows are
+        // appended to the list view in batches as they arrive (ControlListSource),
+        // and an outer ring's controls ahead of the focus would have to be
+        // inserted before rows the user may already be reading
+        UiaLocatorStack locators(targetWindow);
+        bool walked = walker.Walk([this, &walker, &locators, &recorder](TreeElement& element, const ElementProperties& properties, size_t depth)
+        {
+            TreeElement& uiaTreeElement = recorder ? RecordingTreeProvider::Inner(element) : element;
+            IUIAutomationElement* uiaElement = static_cast<UiaTreeElement&>(uiaTreeElement).Get();
+            OnElement(uiaElement, properties, locators.Visit(walker, uiaElement, depth));
+        }, &m_cancelled);
+
+        if (!walked)
         {
             if (m_onCancelled) m_onCancelled();
             if (comInitialized) CoUninitialize();
             return;
         }
 
-        // Walk through all controls
-        WalkControls(rootElement, m_controlViewWalker);
-
-        rootElement->Release();
-
         // Check if cancelled before calling finished callback
         if (!m_cancelled && m_onFinished)
         {
@@ -156,29 +177,26 @@ namespace UIAList
             m_onCancelled();
         }
 
+        // After the list is complete, so the disk write costs no latency
+        if (!m_cancelled)
+        {
+            RecordStats(targetWindow, stats, provider.Calls());
+        }
+        if (recorder && !m_cancelled)
+        {
+            SaveRecording(*recorder, targetWindow, recordDirectory);
+        }
+
         if (comInitialized) CoUninitialize();
     }
 
-    void ControlEnumerator::WalkControls(IUIAutomationElement* element, IUIAutomationTreeWalker* walker)
+    void ControlEnumerator::OnElement(IUIAutomationElement* element, const ElementProperties& properties,
+                                      const ElementLocator& locator)
     {
-        if (!element || !walker) return;
-
-        // Check if cancelled
-        if (m_cancelled) return;
-
-        // Get control type
-        CONTROLTYPEID controlType;
-        HRESULT hr = element->get_CurrentControlType(&controlType);
-        if (FAILED(hr)) return;
-
-        // Get control name
-        BSTR name = nullptr;
-        element->get_CurrentName(&name);
-        winrt::hstring controlName = name ? winrt::hstring(name) : L"(no name)";
-        if (name) SysFreeString(name);
+        winrt::hstring controlName = properties.HasName ? winrt::hstring(properties.Name) : L"(no name)";
 
         // Get control type string
-        winrt::hstring controlTypeStr = GetControlTypeString(controlType);
+        winrt::hstring controlTypeStr = GetControlTypeString(properties.ControlType);
 
         // Create display text
         winrt::hstring displayText = controlTypeStr + L": " + controlName;
@@ -188,32 +206,55 @@ namespace UIAList
         {
             ControlInfo info;
             info.Name = displayText;
-            info.AutomationId = controlName;
-            info.Type = GetControlTypeString(controlType);
+            info.AutomationId = properties.AutomationId;
+            info.Type = controlTypeStr;
             winrt::com_ptr<IUIAutomationElement> elementPtr;
             elementPtr.copy_from(element);
             info.Element = std::move(elementPtr);
+            info.Capabilities = properties.Capabilities;
+            info.Locator = locator;
             m_onControlFound(info);
         }
+    }
 
-        // Walk child elements
-        IUIAutomationElement* child = nullptr;
-        hr = walker->GetFirstChildElement(element, &child);
-        while (SUCCEEDED(hr) && child)
+    void ControlEnumerator::RecordStats(HWND targetWindow, const EnumerationStatsCollector& stats, uint64_t calls)
+    {
+        std::filesystem::path directory = SettingsManager::GetInstance().GetDataDirectory();
+        if (directory.empty()) return;
+
+        std::string image = UiaTreeProvider::ProcessImageName(targetWindow);
+        EnumerationRecord record = stats.Finish(image.empty() ? std::string("(unknown)") : image,
+                                                ToString(WalkMode::BuildCache), calls);
+
+        EnumerationStatsLog log(directory / L"enumeration-stats.log");
+        if (!log.Append(record)) return;
+
+        // Surface subtrees that dominate every run of this application
+        for (const ApplicationSummary& summary : Summarize(log.Load()))
         {
-            // Check if cancelled before processing child
-            if (m_cancelled)
+            if (summary.ProcessImage != record.ProcessImage) continue;
+            for (const std::string& key : summary.DominantSubtrees())
             {
-                child->Release();
-                return;
+                std::string message = "UIAList: " + summary.ProcessImage + " spends most of each enumeration in " + key + "\n";
+                OutputDebugStringA(message.c_str());
             }
+        }
+    }
+
+    void ControlEnumerator::SaveRecording(RecordingTreeProvider& recorder, HWND targetWindow, const char* directory)
+    {
+        std::string image = UiaTreeProvider::ProcessImageName(targetWindow);
+        recorder.SetProcessImage(image);
 
-            WalkControls(child, walker);
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
 
-            IUIAutomationElement* nextChild = nullptr;
-            hr = walker->GetNextSiblingElement(child, &nextChild);
-            child->Release();
-            child = nextChild;
+        std::string fileName = (image.empty() ? std::string("unknown") : image) + "-" +
+                               std::to_string(static_cast<long long>(std::time(nullptr))) + ".uiatree";
+        std::filesystem::path path = std::filesystem::path(directory) / fileName;
+        if (!recorder.Recording().Save(path))
+        {
+            OutputDebugStringW((L"UIAList: could not write tree recording " + path.wstring() + L"\n").c_str());
         }
     }
 
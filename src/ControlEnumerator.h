@@ -11,6 +11,11 @@
 #pragma once
 
 #include "pch.h"
+#include "ActionStrategy.h"
+#include "ElementLocator.h"
+#include "EnumerationStats.h"
+#include "TreeProvider.h"
+#include "TreeRecording.h"
 
 namespace UIAList
 {
@@ -20,6 +25,8 @@ namespace UIAList
         winrt::hstring Type;
         winrt::hstring AutomationId;
         winrt::com_ptr<IUIAutomationElement> Element;
+        uint32_t Capabilities{ UIAListCore::CapabilitiesNone };  // Prefetched UIAListCore::Capability bits
+        UIAListCore::ElementLocator Locator;  // Finds the control again when Element went stale
     };
 
     class ControlEnumerator
@@ -50,15 +57,21 @@ namespace UIAList
         // Enumeration worker (runs on background thread)
         void EnumerateWorker(HWND targetWindow);
 
-        // Recursive tree walking
-        void WalkControls(IUIAutomationElement* element, IUIAutomationTreeWalker* walker);
+        // Turns one walked element into a ControlInfo
+        void OnElement(IUIAutomationElement* element, const UIAListCore::ElementProperties& properties,
+                       const UIAListCore::ElementLocator& locator);
+
+        // Appends the finished walk to the per-application statistics log
+        void RecordStats(HWND targetWindow, const UIAListCore::EnumerationStatsCollector& stats, uint64_t calls);
+
+        // Writes the recorded tree to <directory>\<image>-<time>.uiatree
+        void SaveRecording(UIAListCore::RecordingTreeProvider& recorder, HWND targetWindow, const char* directory);
 
         // Helper to get control type string
         winrt::hstring GetControlTypeString(CONTROLTYPEID controlType);
 
         // UI Automation objects
         IUIAutomation* m_uiAutomation;
-        IUIAutomationTreeWalker* m_controlViewWalker;
 
         // Threading
         std::unique_ptr<std::thread> m_workerThread;
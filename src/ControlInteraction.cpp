@@ -10,187 +10,61 @@
 
 #include "pch.h"
 #include "ControlInteraction.h"
+#include "Trace.h"
+#include "UiaActionTarget.h"
+
+using namespace UIAListCore;
 
 namespace UIAList
 {
-    // Exact port of Qt implementation (uialist.cpp:715-803)
-    bool ControlInteraction::ClickControl(IUIAutomationElement* element)
+    bool ControlInteraction::ClickControl(IUIAutomationElement* element, uint32_t capabilities)
     {
-        if (!element) return false;
-
-        // Method 1: Try to get bounding rectangle and simulate mouse click
-        if (ClickViaMouse(element)) return true;
-
-        // Method 2: Try invoke pattern
-        if (ClickViaInvokePattern(element)) return true;
-
-        // Method 3: Try legacy action
-        if (ClickViaLegacyPattern(element)) return true;
-
-        // Method 4: Try selection pattern
-        if (ClickViaSelectionPattern(element)) return true;
-
-        return false;
+        return PerformAction(element, ActionKind::Click, capabilities);
     }
 
-    // Exact port of Qt implementation (uialist.cpp:879-979)
-    bool ControlInteraction::DoubleClickControl(IUIAutomationElement* element)
+    bool ControlInteraction::DoubleClickControl(IUIAutomationElement* element, uint32_t capabilities)
     {
-        if (!element) return false;
-
-        // Method 1: Try to get bounding rectangle and simulate mouse double-click
-        RECT rect;
-        HRESULT hr = element->get_CurrentBoundingRectangle(&rect);
-        if (SUCCEEDED(hr))
-        {
-            int x = rect.left + (rect.right - rect.left) / 2;
-            int y = rect.top + (rect.bottom - rect.top) / 2;
-
-            SetCursorPos(x, y);
-            Sleep(50);
-            mouse_event(MOUSEEVENTF_LEFTDOWN, 0, 0, 0, 0);
-            mouse_event(MOUSEEVENTF_LEFTUP, 0, 0, 0, 0);
-            Sleep(50);
-            mouse_event(MOUSEEVENTF_LEFTDOWN, 0, 0, 0, 0);
-            mouse_event(MOUSEEVENTF_LEFTUP, 0, 0, 0, 0);
-
-            return true;
-        }
-
-        // Method 2: Try toggle pattern
-        IUIAutomationTogglePattern* togglePattern = nullptr;
-        hr = element->GetCurrentPatternAs(UIA_TogglePatternId, __uuidof(IUIAutomationTogglePattern), (void**)&togglePattern);
-        if (SUCCEEDED(hr) && togglePattern)
-        {
-            hr = togglePattern->Toggle();
-            togglePattern->Release();
-            if (SUCCEEDED(hr)) return true;
-        }
-
-        // Method 3: Try double click via legacy pattern
-        IUIAutomationLegacyIAccessiblePattern* legacyPattern = nullptr;
-        hr = element->GetCurrentPatternAs(UIA_LegacyIAccessiblePatternId, __uuidof(IUIAutomationLegacyIAccessiblePattern), (void**)&legacyPattern);
-        if (SUCCEEDED(hr) && legacyPattern)
-        {
-            hr = legacyPattern->DoDefaultAction();
-            if (SUCCEEDED(hr))
-            {
-                Sleep(50);
-                legacyPattern->DoDefaultAction();
-            }
-            legacyPattern->Release();
-            if (SUCCEEDED(hr)) return true;
-        }
-
-        // Method 4: Try double invoke
-        IUIAutomationInvokePattern* invokePattern = nullptr;
-        hr = element->GetCurrentPatternAs(UIA_InvokePatternId, __uuidof(IUIAutomationInvokePattern), (void**)&invokePattern);
-        if (SUCCEEDED(hr) && invokePattern)
-        {
-            hr = invokePattern->Invoke();
-            if (SUCCEEDED(hr))
-            {
-                Sleep(50);
-                invokePattern->Invoke();
-            }
-            invokePattern->Release();
-            if (SUCCEEDED(hr)) return true;
-        }
-
-        return false;
+        return PerformAction(element, ActionKind::DoubleClick, capabilities);
     }
 
-    // Exact port of Qt implementation (uialist.cpp:805-877)
-    bool ControlInteraction::FocusControl(IUIAutomationElement* element)
+    bool ControlInteraction::FocusControl(IUIAutomationElement* element, uint32_t capabilities)
     {
-        if (!element) return false;
-
-        // Method 1: Use UI Automation SetFocus
-        HRESULT hr = element->SetFocus();
-        if (SUCCEEDED(hr)) return true;
-
-        // Method 2: Try to get bounding rectangle and click to focus
-        RECT rect;
-        hr = element->get_CurrentBoundingRectangle(&rect);
-        if (SUCCEEDED(hr))
-        {
-            int x = rect.left + (rect.right - rect.left) / 2;
-            int y = rect.top + (rect.bottom - rect.top) / 2;
-
-            SetCursorPos(x, y);
-            Sleep(50);
-            mouse_event(MOUSEEVENTF_LEFTDOWN, 0, 0, 0, 0);
-            mouse_event(MOUSEEVENTF_LEFTUP, 0, 0, 0, 0);
-
-            return true;
-        }
-
-        // Method 3: Try keyboard Tab navigation
-        keybd_event(VK_TAB, 0, 0, 0);
-        keybd_event(VK_TAB, 0, KEYEVENTF_KEYUP, 0);
-        Sleep(100);
-
-        return false;
+        return PerformAction(element, ActionKind::Focus, capabilities);
     }
 
-    bool ControlInteraction::ClickViaMouse(IUIAutomationElement* element)
+    bool ControlInteraction::PerformAction(IUIAutomationElement* element, ActionKind kind, uint32_t capabilities)
     {
-        RECT rect;
-        HRESULT hr = element->get_CurrentBoundingRectangle(&rect);
-        if (SUCCEEDED(hr))
-        {
-            int x = rect.left + (rect.right - rect.left) / 2;
-            int y = rect.top + (rect.bottom - rect.top) / 2;
-
-            SetCursorPos(x, y);
-            Sleep(50);
-            mouse_event(MOUSEEVENTF_LEFTDOWN, 0, 0, 0, 0);
-            mouse_event(MOUSEEVENTF_LEFTUP, 0, 0, 0, 0);
-
-            return true;
-        }
-        return false;
+        return UIAListCore::PerformAction(Automation(), element, kind, capabilities);
     }
 
-    bool ControlInteraction::ClickViaInvokePattern(IUIAutomationElement* element)
+    winrt::com_ptr<IUIAutomationElement> ControlInteraction::EnsureLive(IUIAutomationElement* element,
+                                                                       const ElementLocator& locator)
     {
-        IUIAutomationInvokePattern* invokePattern = nullptr;
-        HRESULT hr = element->GetCurrentPatternAs(UIA_InvokePatternId, __uuidof(IUIAutomationInvokePattern), (void**)&invokePattern);
+        UIALIST_TRACE_SPAN("EnsureLive");
 
-        if (SUCCEEDED(hr) && invokePattern)
+        winrt::com_ptr<IUIAutomationElement> live;
+        if (FAILED(locator.Refresh(Automation(), element, live.put())))
         {
-            hr = invokePattern->Invoke();
-            invokePattern->Release();
-            return SUCCEEDED(hr);
+            OutputDebugStringW(L"UIAList: control is gone and could not be found again\n");
+            return nullptr;
         }
-        return false;
-    }
 
-    bool ControlInteraction::ClickViaLegacyPattern(IUIAutomationElement* element)
-    {
-        IUIAutomationLegacyIAccessiblePattern* legacyPattern = nullptr;
-        HRESULT hr = element->GetCurrentPatternAs(UIA_LegacyIAccessiblePatternId, __uuidof(IUIAutomationLegacyIAccessiblePattern), (void**)&legacyPattern);
-
-        if (SUCCEEDED(hr) && legacyPattern)
+        if (live.get() != element)
         {
-            hr = legacyPattern->DoDefaultAction();
-            legacyPattern->Release();
-            return SUCCEEDED(hr);
+            OutputDebugStringW(L"UIAList: re-resolved stale control\n");
         }
-        return false;
+        return live;
     }
 
-    bool ControlInteraction::ClickViaSelectionPattern(IUIAutomationElement* element)
+    IUIAutomation* ControlInteraction::Automation()
     {
-        IUIAutomationSelectionItemPattern* selectionPattern = nullptr;
-        HRESULT hr = element->GetCurrentPatternAs(UIA_SelectionItemPatternId, __uuidof(IUIAutomationSelectionItemPattern), (void**)&selectionPattern);
-
-        if (SUCCEEDED(hr) && selectionPattern)
+        static winrt::com_ptr<IUIAutomation> automation = []()
         {
-            hr = selectionPattern->Select();
-            selectionPattern->Release();
-            return SUCCEEDED(hr);
-        }
-        return false;
+            winrt::com_ptr<IUIAutomation> instance;
+            CoCreateInstance(__uuidof(CUIAutomation), nullptr, CLSCTX_INPROC_SERVER,
+                             __uuidof(IUIAutomation), instance.put_void());
+            return instance;
+        }();
+        return automation.get();
     }
 }
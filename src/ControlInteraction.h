@@ -11,28 +11,40 @@
 #pragma once
 
 #include "pch.h"
+#include "ActionStrategy.h"
+#include "ElementLocator.h"
 
 namespace UIAList
 {
-    // Static helper class for control interaction
-    // Ports the exact logic from Qt version (uialist.cpp:715-979)
+    // Static helper class for control interaction.
+    // The strategies themselves live in UIAListCore::UiaActionTarget, shared
+    // with the Qt frontend.
     class ControlInteraction
     {
     public:
+        // capabilities: bitmask prefetched during enumeration (see UIAListCore::Capability).
+        // CapabilitiesNone probes every strategy in turn.
+
         // Click control (uses mouse simulation + fallbacks)
-        static bool ClickControl(IUIAutomationElement* element);
+        static bool ClickControl(IUIAutomationElement* element, uint32_t capabilities = UIAListCore::CapabilitiesNone);
 
         // Double-click control
-        static bool DoubleClickControl(IUIAutomationElement* element);
+        static bool DoubleClickControl(IUIAutomationElement* element, uint32_t capabilities = UIAListCore::CapabilitiesNone);
 
         // Focus control
-        static bool FocusControl(IUIAutomationElement* element);
+        static bool FocusControl(IUIAutomationElement* element, uint32_t capabilities = UIAListCore::CapabilitiesNone);
+
+        // Any of the above by kind (for the ActionExecutor)
+        static bool PerformAction(IUIAutomationElement* element, UIAListCore::ActionKind kind,
+                                  uint32_t capabilities = UIAListCore::CapabilitiesNone);
+
+        // element while it is alive, otherwise the control found again through
+        // locator (null when it is gone). Call before acting on a listed control.
+        static winrt::com_ptr<IUIAutomationElement> EnsureLive(IUIAutomationElement* element,
+                                                               const UIAListCore::ElementLocator& locator);
 
     private:
-        // Helper methods
-        static bool ClickViaMouse(IUIAutomationElement* element);
-        static bool ClickViaInvokePattern(IUIAutomationElement* element);
-        static bool ClickViaLegacyPattern(IUIAutomationElement* element);
-        static bool ClickViaSelectionPattern(IUIAutomationElement* element);
+        // Automation instance used to wait for completion events
+        static IUIAutomation* Automation();
     };
 }
@@ -0,0 +1,196 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "pch.h"
+#include "ControlListSource.h"
+
+using namespace winrt;
+using namespace Windows::Foundation;
+using namespace Windows::Foundation::Collections;
+using namespace Microsoft::UI::Xaml::Data;
+
+namespace UIAList
+{
+    namespace
+    {
+        // IObservableVector has no range notifications: a row inserted, or Reset for a new set of rows
+        struct ChangedArgs : implements<ChangedArgs, IVectorChangedEventArgs>
+        {
+            ChangedArgs(Windows::Foundation::Collections::CollectionChange change, uint32_t index)
+                : m_change(change)
+                , m_index(index)
+            {
+            }
+
+            Windows::Foundation::Collections::CollectionChange CollectionChange() const noexcept { return m_change; }
+            uint32_t Index() const noexcept { return m_index; }
+
+        private:
+            Windows::Foundation::Collections::CollectionChange m_change;
+            uint32_t m_index;
+        };
+    }
+
+    ControlListSource::ControlListSource(RowText text)
+        : m_text(std::move(text))
+    {
+    }
+
+    void ControlListSource::AppendControls(const uint32_t* controls, size_t count)
+    {
+        if (count == 0) return;
+
+        const bool caughtUp = m_loaded == m_rows.size();
+        m_rows.insert(m_rows.end(), controls, controls + count);
+        m_items.resize(m_rows.size());
+
+        // A list view that loaded everything asks HasMoreItems no more until
+        // its rows change: insert the batch's first page, which fills an
+        // empty list and otherwise makes it look again once the end is in
+        // view. Behind unloaded rows it finds the batch as it scrolls.
+        if (caughtUp)
+        {
+            Load(m_loaded < PageSize ? PageSize - m_loaded : PageSize);
+        }
+    }
+
+    void ControlListSource::SetControls(const std::vector<uint32_t>& controls)
+    {
+        m_rows.assign(controls.begin(), controls.end());
+        m_items.assign(m_rows.size(), nullptr);
+        m_loaded = std::min<uint32_t>(PageSize, static_cast<uint32_t>(m_rows.size()));
+        RaiseReset();
+    }
+
+    void ControlListSource::EnsureLoaded(uint32_t row)
+    {
+        if (row >= m_loaded && row < m_rows.size())
+        {
+            Load(row + 1 - m_loaded);
+        }
+    }
+
+    IInspectable ControlListSource::GetAt(uint32_t index) const
+    {
+        if (index >= m_loaded) throw hresult_out_of_bounds();
+        return Item(index);
+    }
+
+    IVectorView<IInspectable> ControlListSource::GetView() const
+    {
+        return Copy().GetView();
+    }
+
+    bool ControlListSource::IndexOf(IInspectable const& value, uint32_t& index) const
+    {
+        // By identity: rows with the same text are different controls
+        if (!value) return false;
+        for (uint32_t row = 0; row < m_loaded; ++row)
+        {
+            if (m_items[row] == value)
+            {
+                index = row;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t ControlListSource::GetMany(uint32_t startIndex, array_view<IInspectable> items) const
+    {
+        if (startIndex >= m_loaded) return 0;
+        const uint32_t count = std::min(items.size(), m_loaded - startIndex);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            items[i] = Item(startIndex + i);
+        }
+        return count;
+    }
+
+    void ControlListSource::Clear()
+    {
+        std::vector<uint32_t>().swap(m_rows);
+        std::vector<IInspectable>().swap(m_items);
+        if (m_loaded > 0)
+        {
+            m_loaded = 0;
+            RaiseReset();
+        }
+    }
+
+    void ControlListSource::SetAt(uint32_t, IInspectable const&) { throw hresult_illegal_method_call(); }
+    void ControlListSource::InsertAt(uint32_t, IInspectable const&) { throw hresult_illegal_method_call(); }
+    void ControlListSource::RemoveAt(uint32_t) { throw hresult_illegal_method_call(); }
+    void ControlListSource::Append(IInspectable const&) { throw hresult_illegal_method_call(); }
+    void ControlListSource::RemoveAtEnd() { throw hresult_illegal_method_call(); }
+    void ControlListSource::ReplaceAll(array_view<IInspectable const>) { throw hresult_illegal_method_call(); }
+
+    event_token ControlListSource::VectorChanged(ChangedHandler const& handler)
+    {
+        return m_changed.add(handler);
+    }
+
+    void ControlListSource::VectorChanged(event_token const& token) noexcept
+    {
+        m_changed.remove(token);
+    }
+
+    IIterator<IInspectable> ControlListSource::First() const
+    {
+        // The list view indexes; only other consumers iterate, over a copy
+        return Copy().First();
+    }
+
+    IAsyncOperation<LoadMoreItemsResult> ControlListSource::LoadMoreItemsAsync(uint32_t count)
+    {
+        auto strong = get_strong();
+        // The rows are in memory already, so this completes before it returns
+        co_return LoadMoreItemsResult{ Load(std::max(count, PageSize)) };
+    }
+
+    uint32_t ControlListSource::Load(uint32_t count)
+    {
+        const uint32_t added = std::min<uint32_t>(count, static_cast<uint32_t>(m_rows.size()) - m_loaded);
+        for (uint32_t i = 0; i < added; ++i)
+        {
+            // Counted before the event, so the list view sees the row
+            RaiseInserted(m_loaded++);
+        }
+        return added;
+    }
+
+    void ControlListSource::RaiseReset()
+    {
+        m_changed(*this, make<ChangedArgs>(CollectionChange::Reset, 0));
+    }
+
+    void ControlListSource::RaiseInserted(uint32_t row)
+    {
+        m_changed(*this, make<ChangedArgs>(CollectionChange::ItemInserted, row));
+    }
+
+    IVector<IInspectable> ControlListSource::Copy() const
+    {
+        std::vector<IInspectable> items;
+        items.reserve(m_loaded);
+        for (uint32_t row = 0; row < m_loaded; ++row)
+        {
+            items.push_back(Item(row));
+        }
+        return single_threaded_vector(std::move(items));
+    }
+
+    IInspectable ControlListSource::Item(uint32_t row) const
+    {
+        IInspectable& item = m_items[row];
+        if (!item) item = box_value(m_text(m_rows[row]));
+        return item;
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "pch.h"
+
+namespace UIAList
+{
+    // ItemsSource of the list view: a read-only observable vector over rows
+    // of MainWindow's control list. A row is boxed when the list view
+    // realizes it, not when the control arrives, and keeps that object
+    // until the rows change, so rows with the same text stay apart. Controls are added in
+    // batches; only the rows the list view is shown raise ItemInserted, a
+    // page of a batch at most, and beyond those it pulls rows in through
+    // incremental loading as it scrolls. A new set of rows (the filter
+    // changed) raises one Reset. UI thread only.
+    struct ControlListSource : winrt::implements<ControlListSource,
+        winrt::Windows::Foundation::Collections::IObservableVector<winrt::Windows::Foundation::IInspectable>,
+        winrt::Windows::Foundation::Collections::IVector<winrt::Windows::Foundation::IInspectable>,
+        winrt::Windows::Foundation::Collections::IIterable<winrt::Windows::Foundation::IInspectable>,
+        winrt::Microsoft::UI::Xaml::Data::ISupportIncrementalLoading>
+    {
+        using IInspectable = winrt::Windows::Foundation::IInspectable;
+        using ChangedHandler = winrt::Windows::Foundation::Collections::VectorChangedEventHandler<IInspectable>;
+        using RowText = std::function<winrt::hstring(uint32_t control)>;
+
+        // Rows loaded per request of the list view, and at once into an idle list
+        static constexpr uint32_t PageSize = 64;
+
+        explicit ControlListSource(RowText text);
+
+        // Rows for these controls were added to the end of the list
+        void AppendControls(const uint32_t* controls, size_t count);
+
+        // The rows are these controls now (the filter changed); the first page is loaded
+        void SetControls(const std::vector<uint32_t>& controls);
+
+        // Index into the control list of a row
+        uint32_t ControlAt(uint32_t row) const { return m_rows[row]; }
+
+        // Rows including those not loaded yet
+        uint32_t Available() const { return static_cast<uint32_t>(m_rows.size()); }
+
+        // Loads up to and including row, so it can be selected
+        void EnsureLoaded(uint32_t row);
+
+        // IVector
+        IInspectable GetAt(uint32_t index) const;
+        uint32_t Size() const noexcept { return m_loaded; }
+        winrt::Windows::Foundation::Collections::IVectorView<IInspectable> GetView() const;
+        bool IndexOf(IInspectable const& value, uint32_t& index) const;
+        uint32_t GetMany(uint32_t startIndex, winrt::array_view<IInspectable> items) const;
+        void Clear();
+
+        // The list view never edits its source; these throw
+        void SetAt(uint32_t index, IInspectable const& value);
+        void InsertAt(uint32_t index, IInspectable const& value);
+        void RemoveAt(uint32_t index);
+        void Append(IInspectable const& value);
+        void RemoveAtEnd();
+        void ReplaceAll(winrt::array_view<IInspectable const> items);
+
+        // IObservableVector
+        winrt::event_token VectorChanged(ChangedHandler const& handler);
+        void VectorChanged(winrt::event_token const& token) noexcept;
+
+        // IIterable
+        winrt::Windows::Foundation::Collections::IIterator<IInspectable> First() const;
+
+        // ISupportIncrementalLoading
+        bool HasMoreItems() const noexcept { return m_loaded < m_rows.size(); }
+        winrt::Windows::Foundation::IAsyncOperation<winrt::Microsoft::UI::Xaml::Data::LoadMoreItemsResult>
+            LoadMoreItemsAsync(uint32_t count);
+
+    private:
+        // Grows the loaded rows by up to count, one ItemInserted each; how many were added
+        uint32_t Load(uint32_t count);
+        void RaiseReset();
+        void RaiseInserted(uint32_t row);
+        winrt::Windows::Foundation::Collections::IVector<IInspectable> Copy() const;
+        IInspectable Item(uint32_t row) const;
+
+        RowText m_text;
+        std::vector<uint32_t> m_rows;  // Control indices
+        uint32_t m_loaded{ 0 };        // Rows the list view knows of, a prefix of m_rows
+        mutable std::vector<IInspectable> m_items;  // Boxed rows by row, null until realized
+        winrt::event<ChangedHandler> m_changed;
+    };
+}
@@ -0,0 +1,350 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ControlStream.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+#include <type_traits>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        const char HexDigits[] = "0123456789abcdef";
+
+        bool IsBlank(const std::wstring& text)
+        {
+            return std::all_of(text.begin(), text.end(), [](wchar_t c) { return std::iswspace(c) != 0; });
+        }
+
+        // needle is already lower case; nothing is copied
+        bool ContainsIgnoringCase(const std::wstring& text, const std::wstring& needle)
+        {
+            if (needle.empty()) return true;
+            if (text.size() < needle.size()) return false;
+
+            for (size_t start = 0; start + needle.size() <= text.size(); ++start)
+            {
+                size_t i = 0;
+                while (i < needle.size() && static_cast<wchar_t>(std::towlower(text[start + i])) == needle[i]) ++i;
+                if (i == needle.size()) return true;
+            }
+            return false;
+        }
+    }
+
+    JsonLinesWriter::JsonLinesWriter(std::FILE* file, std::chrono::milliseconds flushInterval)
+        : m_file(file)
+        , m_flushInterval(flushInterval)
+        , m_buffer(new char[BufferSize])
+        , m_lastFlush(std::chrono::steady_clock::now())
+    {
+    }
+
+    JsonLinesWriter::~JsonLinesWriter()
+    {
+        Flush();
+    }
+
+    void JsonLinesWriter::BeginObject()
+    {
+        Put('{');
+        m_firstField = true;
+    }
+
+    void JsonLinesWriter::EndObject()
+    {
+        Put('}');
+        Put('\n');
+        ++m_lines;
+
+        const auto now = std::chrono::steady_clock::now();
+        if (m_flushInterval.count() == 0 || now - m_lastFlush >= m_flushInterval) Flush();
+    }
+
+    void JsonLinesWriter::Field(const char* key, int64_t value)
+    {
+        Key(key);
+        if (value < 0)
+        {
+            Put('-');
+            PutUnsigned(0 - static_cast<uint64_t>(value));
+        }
+        else
+        {
+            PutUnsigned(static_cast<uint64_t>(value));
+        }
+    }
+
+    void JsonLinesWriter::Field(const char* key, uint64_t value)
+    {
+        Key(key);
+        PutUnsigned(value);
+    }
+
+    void JsonLinesWriter::Field(const char* key, bool value)
+    {
+        Key(key);
+        for (const char* text = value ? "true" : "false"; *text; ++text) Put(*text);
+    }
+
+    void JsonLinesWriter::Field(const char* key, std::string_view value)
+    {
+        Key(key);
+        PutString(value.data(), value.size());
+    }
+
+    void JsonLinesWriter::Field(const char* key, std::wstring_view value)
+    {
+        Key(key);
+        PutString(value.data(), value.size());
+    }
+
+    bool JsonLinesWriter::Flush()
+    {
+        if (m_used > 0 && !m_failed)
+        {
+            m_failed = std::fwrite(m_buffer.get(), 1, m_used, m_file) != m_used || std::fflush(m_file) != 0;
+            m_bytes += m_used;
+        }
+        m_used = 0;
+        m_lastFlush = std::chrono::steady_clock::now();
+        return !m_failed;
+    }
+
+    void JsonLinesWriter::Key(const char* key)
+    {
+        const size_t length = std::strlen(key);
+        if (length + 4 > BufferSize - m_used) Flush();
+
+        char* out = m_buffer.get() + m_used;
+        if (!m_firstField) *out++ = ',';
+        m_firstField = false;
+
+        *out++ = '"';
+        std::memcpy(out, key, length);
+        out += length;
+        *out++ = '"';
+        *out++ = ':';
+        m_used = static_cast<size_t>(out - m_buffer.get());
+    }
+
+    void JsonLinesWriter::Put(char c)
+    {
+        if (m_used == BufferSize) Flush();
+        m_buffer[m_used++] = c;
+    }
+
+    template <typename Char>
+    void JsonLinesWriter::PutString(const Char* text, size_t length)
+    {
+        Put('"');
+
+        // Plain ASCII is copied in this loop, everything else goes through PutCodePoint
+        char* out = m_buffer.get() + m_used;
+        for (size_t i = 0; i < length; ++i)
+        {
+            uint32_t c = static_cast<uint32_t>(static_cast<std::make_unsigned_t<Char>>(text[i]));
+            if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\' && out != m_buffer.get() + BufferSize)
+            {
+                *out++ = static_cast<char>(c);
+                continue;
+            }
+
+            m_used = static_cast<size_t>(out - m_buffer.get());
+            if constexpr (sizeof(Char) == 1)
+            {
+                // Already UTF-8
+                if (c >= 0x80) Put(static_cast<char>(c));
+                else PutCodePoint(c);
+            }
+            else
+            {
+                if constexpr (sizeof(Char) == 2)
+                {
+                    if (c >= 0xD800 && c <= 0xDBFF && i + 1 < length)
+                    {
+                        const uint32_t low = static_cast<uint32_t>(text[i + 1]);
+                        if (low >= 0xDC00 && low <= 0xDFFF)
+                        {
+                            c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                            ++i;
+                        }
+                    }
+                }
+                PutCodePoint(c);
+            }
+            out = m_buffer.get() + m_used;
+        }
+        m_used = static_cast<size_t>(out - m_buffer.get());
+
+        Put('"');
+    }
+
+    void JsonLinesWriter::PutCodePoint(uint32_t codePoint)
+    {
+        // Lone surrogates and values beyond Unicode cannot be encoded
+        if ((codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF) codePoint = 0xFFFD;
+
+        // Longest case is \u00XX; one check per character instead of per byte
+        if (BufferSize - m_used < 6) Flush();
+        char* out = m_buffer.get() + m_used;
+
+        if (codePoint >= 0x20 && codePoint < 0x80 && codePoint != '"' && codePoint != '\\')
+        {
+            *out++ = static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x80)
+        {
+            *out++ = '\\';
+            switch (codePoint)
+            {
+            case '"': *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '\n': *out++ = 'n'; break;
+            case '\r': *out++ = 'r'; break;
+            case '\t': *out++ = 't'; break;
+            default:
+                *out++ = 'u';
+                *out++ = '0';
+                *out++ = '0';
+                *out++ = HexDigits[codePoint >> 4];
+                *out++ = HexDigits[codePoint & 0xF];
+                break;
+            }
+        }
+        else if (codePoint < 0x800)
+        {
+            *out++ = static_cast<char>(0xC0 | (codePoint >> 6));
+            *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            *out++ = static_cast<char>(0xE0 | (codePoint >> 12));
+            *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            *out++ = static_cast<char>(0xF0 | (codePoint >> 18));
+            *out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        m_used = static_cast<size_t>(out - m_buffer.get());
+    }
+
+    void JsonLinesWriter::PutUnsigned(uint64_t value)
+    {
+        char digits[20];
+        size_t count = 0;
+        do
+        {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+
+        if (count > BufferSize - m_used) Flush();
+        char* out = m_buffer.get() + m_used;
+        while (count > 0) *out++ = digits[--count];
+        m_used = static_cast<size_t>(out - m_buffer.get());
+    }
+
+    const char* ToString(StreamStatus status)
+    {
+        switch (status)
+        {
+        case StreamStatus::Complete: return "complete";
+        case StreamStatus::TimedOut: return "timed out";
+        case StreamStatus::Cancelled: return "cancelled";
+        case StreamStatus::NoRoot: return "no window";
+        case StreamStatus::WriteFailed: return "write failed";
+        }
+        return "unknown";
+    }
+
+    StreamResult StreamControls(TreeProvider& provider, const ControlStreamOptions& options, JsonLinesWriter& writer,
+                                const std::atomic<bool>* cancelled)
+    {
+        TraceSpan span("StreamControls");
+        const auto start = std::chrono::steady_clock::now();
+
+        uint32_t fetched = options.Properties;
+        if (!options.ControlTypes.empty()) fetched |= PropertyControlType;
+        if (!options.NameContains.empty() || options.NamedOnly) fetched |= PropertyName;
+
+        std::wstring needle = options.NameContains;
+        for (wchar_t& c : needle) c = static_cast<wchar_t>(std::towlower(c));
+
+        ControlWalker walker(provider, options.Mode, fetched);
+        walker.SetMaxDepth(options.MaxDepth);
+        if (options.TimeBudget.count() > 0) walker.SetDeadline(start + options.TimeBudget);
+
+        // Set on cancel and once the reader is gone
+        std::atomic<bool> stop{ false };
+        StreamResult result;
+        const bool walked = walker.Walk([&](TreeElement&, const ElementProperties& properties, size_t depth)
+        {
+            if (cancelled && *cancelled)
+            {
+                stop = true;
+                return;
+            }
+            const size_t index = result.Visited++;
+
+            if (!options.ControlTypes.empty() &&
+                std::find(options.ControlTypes.begin(), options.ControlTypes.end(), properties.ControlType) ==
+                    options.ControlTypes.end())
+            {
+                return;
+            }
+            if (options.NamedOnly && (!properties.HasName || IsBlank(properties.Name))) return;
+            if (!ContainsIgnoringCase(properties.Name, needle)) return;
+
+            writer.BeginObject();
+            writer.Field("index", static_cast<uint64_t>(index));
+            writer.Field("depth", static_cast<uint64_t>(depth));
+            if (options.Properties & PropertyControlType)
+            {
+                writer.Field("type", std::string_view(ControlTypeName(properties.ControlType)));
+                writer.Field("controlType", static_cast<int64_t>(properties.ControlType));
+            }
+            if (options.Properties & PropertyName)
+            {
+                writer.Field("name", std::wstring_view(properties.Name));
+            }
+            if (options.Properties & PropertyAutomationId)
+            {
+                writer.Field("automationId", std::wstring_view(properties.AutomationId));
+            }
+            if (options.Properties & PropertyCapabilities)
+            {
+                writer.Field("capabilities", static_cast<uint64_t>(properties.Capabilities));
+            }
+            writer.EndObject();
+            ++result.Written;
+
+            if (writer.Failed()) stop = true;
+        }, &stop);
+
+        writer.Flush();
+        result.Milliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (!walked) result.Status = StreamStatus::NoRoot;
+        else if (writer.Failed()) result.Status = StreamStatus::WriteFailed;
+        else if (walker.TimedOut()) result.Status = StreamStatus::TimedOut;
+        else if (cancelled && *cancelled) result.Status = StreamStatus::Cancelled;
+        return result;
+    }
+}
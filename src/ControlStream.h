@@ -0,0 +1,122 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "ControlWalker.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UIAListCore
+{
+    // JSON Lines into a FILE*, through one fixed buffer: writing a line
+    // formats in place and allocates nothing. The buffer goes out when it
+    // is full and, at the end of a line, once flushInterval has passed since
+    // the last write, so a reader sees lines while the producer is still busy.
+    class JsonLinesWriter
+    {
+    public:
+        static constexpr size_t BufferSize = 64 * 1024;
+        static constexpr std::chrono::milliseconds DefaultFlushInterval{ 100 };
+
+        // 0 flushes every line
+        explicit JsonLinesWriter(std::FILE* file, std::chrono::milliseconds flushInterval = DefaultFlushInterval);
+        ~JsonLinesWriter();
+
+        JsonLinesWriter(const JsonLinesWriter&) = delete;
+        JsonLinesWriter& operator=(const JsonLinesWriter&) = delete;
+
+        void BeginObject();
+        void EndObject();  // Ends the line
+
+        // key is written as is and must not need escaping
+        void Field(const char* key, int64_t value);
+        void Field(const char* key, uint64_t value);
+        void Field(const char* key, bool value);
+        void Field(const char* key, std::string_view value);   // UTF-8
+        void Field(const char* key, std::wstring_view value);  // UTF-16 or UTF-32, per wchar_t
+
+        // False once a write to the file failed (e.g. the reader closed the pipe)
+        bool Flush();
+        bool Failed() const { return m_failed; }
+
+        uint64_t Lines() const { return m_lines; }
+        uint64_t Bytes() const { return m_bytes; }
+
+    private:
+        void Key(const char* key);
+        void Put(char c);
+        template <typename Char>
+        void PutString(const Char* text, size_t length);
+        void PutCodePoint(uint32_t codePoint);
+        void PutUnsigned(uint64_t value);
+
+        std::FILE* m_file;
+        std::chrono::milliseconds m_flushInterval;
+        std::unique_ptr<char[]> m_buffer;
+        size_t m_used{ 0 };
+        bool m_firstField{ true };
+        bool m_failed{ false };
+        uint64_t m_lines{ 0 };
+        uint64_t m_bytes{ 0 };
+        std::chrono::steady_clock::time_point m_lastFlush;
+    };
+
+    // What the headless mode writes, and for which controls
+    struct ControlStreamOptions
+    {
+        // Written per control; the filters fetch what they need on top
+        uint32_t Properties{ PropertyControlType | PropertyName | PropertyAutomationId };
+        WalkMode Mode{ WalkMode::BuildCache };
+
+        size_t MaxDepth{ SIZE_MAX };
+        std::chrono::milliseconds TimeBudget{ 0 };  // 0 is unlimited
+
+        // Filters only decide what is written; the walk still descends into
+        // controls that are left out
+        std::vector<int32_t> ControlTypes;  // Empty writes every type
+        std::wstring NameContains;          // Case-insensitive, empty matches all
+        bool NamedOnly{ false };            // Skip controls without a non-blank name
+    };
+
+    enum class StreamStatus
+    {
+        Complete,
+        TimedOut,       // The time budget ran out, what was found so far is written
+        Cancelled,
+        NoRoot,         // The window is gone or UI Automation failed
+        WriteFailed
+    };
+
+    const char* ToString(StreamStatus status);
+
+    struct StreamResult
+    {
+        StreamStatus Status{ StreamStatus::Complete };
+        size_t Visited{ 0 };
+        size_t Written{ 0 };
+        double Milliseconds{ 0 };
+    };
+
+    // Walks provider and writes one line per matching control as it is
+    // found: {"index":12,"depth":3,"type":"Button","controlType":50000,
+    // "name":"OK","automationId":"okButton","capabilities":5}. index is the
+    // visit order, so lines can be matched up with the list in the GUI.
+    StreamResult StreamControls(TreeProvider& provider, const ControlStreamOptions& options, JsonLinesWriter& writer,
+                                const std::atomic<bool>* cancelled = nullptr);
+}
@@ -0,0 +1,385 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ControlWalker.h"
+#include "EnumerationProgress.h"
+#include "EnumerationStats.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdint>
+
+namespace UIAListCore
+{
+    const char* ToString(WalkMode mode)
+    {
+        switch (mode)
+        {
+        case WalkMode::Current: return "Current";
+        case WalkMode::BuildCache: return "BuildCache";
+        case WalkMode::SubtreeCache: return "SubtreeCache";
+        }
+        return "Unknown";
+    }
+
+    namespace
+    {
+        // UIA_ButtonControlTypeId (50000) .. UIA_AppBarControlTypeId (50040)
+        const int32_t FirstControlType = 50000;
+        const char* const ControlTypeNames[] =
+        {
+            "Button", "Calendar", "CheckBox", "ComboBox", "Edit", "Hyperlink", "Image", "ListItem",
+            "List", "Menu", "MenuBar", "MenuItem", "ProgressBar", "RadioButton", "ScrollBar", "Slider",
+            "Spinner", "StatusBar", "Tab", "TabItem", "Text", "ToolBar", "ToolTip", "Tree", "TreeItem",
+            "Custom", "Group", "Thumb", "DataGrid", "DataItem", "Document", "SplitButton", "Window",
+            "Pane", "Header", "HeaderItem", "Table", "TitleBar", "Separator", "SemanticZoom", "AppBar",
+        };
+        const int32_t ControlTypeCount = static_cast<int32_t>(sizeof(ControlTypeNames) / sizeof(ControlTypeNames[0]));
+
+        // What a scoped walk stops at
+        constexpr int32_t GroupControlType = 50026;
+        constexpr int32_t DocumentControlType = 50030;
+        constexpr int32_t WindowControlType = 50032;
+        constexpr int32_t PaneControlType = 50033;
+    }
+
+    const char* ControlTypeName(int32_t controlType)
+    {
+        const int32_t index = controlType - FirstControlType;
+        if (index < 0 || index >= ControlTypeCount) return "Unknown";
+        return ControlTypeNames[index];
+    }
+
+    int32_t ControlTypeFromName(std::string_view name)
+    {
+        for (int32_t index = 0; index < ControlTypeCount; ++index)
+        {
+            const std::string_view candidate = ControlTypeNames[index];
+            if (candidate.size() != name.size()) continue;
+
+            bool same = true;
+            for (size_t i = 0; i < name.size() && same; ++i)
+            {
+                same = std::tolower(static_cast<unsigned char>(candidate[i])) ==
+                       std::tolower(static_cast<unsigned char>(name[i]));
+            }
+            if (same) return FirstControlType + index;
+        }
+        return 0;
+    }
+
+    ControlWalker::ControlWalker(TreeProvider& provider, WalkMode mode, uint32_t properties)
+        : m_provider(provider)
+        , m_mode(mode)
+        , m_properties(properties)
+    {
+    }
+
+    bool ControlWalker::Prepare()
+    {
+        CacheRequest request;
+        if (m_mode != WalkMode::Current)
+        {
+            request.Properties = m_properties;
+            request.Subtree = (m_mode == WalkMode::SubtreeCache);
+        }
+        m_timedOut = false;
+        m_visits = 0;
+        return m_provider.SetCacheRequest(request);
+    }
+
+    bool ControlWalker::Walk(const Visitor& visitor, const std::atomic<bool>* cancelled)
+    {
+        if (!Prepare()) return false;
+
+        std::unique_ptr<TreeElement> root = m_provider.Root();
+        if (!root) return false;
+
+        WalkElement(*root, 0, visitor, cancelled);
+        return true;
+    }
+
+    bool ControlWalker::WalkOutward(const Visitor& visitor, const RingVisitor& ringDone, const std::atomic<bool>* cancelled)
+    {
+        m_ancestors.clear();
+        m_ancestorProperties.clear();
+        m_nextRing = 0;
+        if (!Prepare()) return false;
+
+        std::unique_ptr<TreeElement> root = m_provider.Root();
+        if (!root) return false;
+
+        // The focused element's ancestors up to the root, nearest first, and
+        // their properties, read before anything is visited so an ancestor
+        // that went away cannot leave a hole in a ring already delivered
+        bool inside = false;
+        if (m_mode != WalkMode::SubtreeCache)
+        {
+            std::unique_ptr<TreeElement> focused = m_provider.Focused();
+            std::unique_ptr<TreeElement> current = focused ? m_provider.Parent(*focused) : nullptr;
+            while (current && m_ancestors.size() < EnumerationProgress::MaxDepth && !Stopped(cancelled))
+            {
+                ElementProperties properties;
+                if (!m_provider.GetProperties(*current, m_properties, properties)) break;
+
+                const bool top = m_provider.IsSameElement(*current, *root);
+                std::unique_ptr<TreeElement> parent = top ? nullptr : m_provider.Parent(*current);
+                m_ancestors.push_back(std::move(current));
+                m_ancestorProperties.push_back(std::move(properties));
+                if (top)
+                {
+                    inside = true;
+                    break;
+                }
+                current = std::move(parent);
+            }
+        }
+
+        // Focus on the root itself or a child of it: the container is the whole tree
+        const size_t rings = m_ancestors.size();
+        if (!inside || rings < 2 || rings - 1 > m_maxDepth)
+        {
+            m_ancestors.clear();
+            m_ancestorProperties.clear();
+
+            const size_t maxDepth = m_maxDepth;
+            if (m_scoped) m_maxDepth = std::min(m_maxDepth, m_scopeDepth);
+            WalkElement(*root, 0, visitor, cancelled);
+            m_maxDepth = maxDepth;
+            if (ringDone && !Stopped(cancelled)) ringDone(Ring{ 0, 0, m_visits, 0 });
+            return true;
+        }
+        m_ancestors.back() = std::move(root);  // Navigation from the root handle the walk is rooted at
+        if (m_progress) m_progress->OnStartBelow(rings - 1);
+
+        // Stats keys of the ancestors the rings' subtrees hang below
+        if (m_stats)
+        {
+            m_subtreeKeys.clear();
+            for (size_t depth = 1; depth < rings && depth <= EnumerationStatsCollector::TrackedSubtreeDepth; ++depth)
+            {
+                m_subtreeKeys.push_back(EnumerationStatsCollector::SubtreeKey(
+                    m_ancestorProperties[rings - 1 - depth], depth > 1 ? m_subtreeKeys[depth - 2] : std::string()));
+            }
+        }
+
+        WalkRings(visitor, ringDone, cancelled);
+        return true;
+    }
+
+    bool ControlWalker::Widen(const Visitor& visitor, const RingVisitor& ringDone, const std::atomic<bool>* cancelled)
+    {
+        if (Complete()) return false;
+
+        // Everything walked so far counts as one child of the next ring's container
+        if (m_progress) m_progress->OnStartBelow(m_ancestors.size() - m_nextRing);
+        WalkRings(visitor, ringDone, cancelled);
+        return true;
+    }
+
+    void ControlWalker::WalkRings(const Visitor& visitor, const RingVisitor& ringDone, const std::atomic<bool>* cancelled)
+    {
+        const size_t rings = m_ancestors.size();
+        while (m_nextRing < rings)
+        {
+            const size_t index = m_nextRing++;
+            TreeElement& ancestor = *m_ancestors[index];
+            const size_t depth = rings - 1 - index;
+            Ring ring{ index, m_visits, 0, 0 };
+
+            // A scope's depth limit counts from the ring's container
+            const size_t maxDepth = m_maxDepth;
+            if (m_scoped && m_scopeDepth < m_maxDepth - depth) m_maxDepth = depth + m_scopeDepth;
+
+            if (index == 0)
+            {
+                WalkElement(ancestor, depth, visitor, cancelled);
+            }
+            else
+            {
+                if (m_progress) m_progress->OnEnterAncestor(depth);
+                visitor(ancestor, m_ancestorProperties[index], depth);
+                ++m_visits;
+                if (m_stats) m_stats->OnNode(depth);
+                if (m_progress) m_progress->OnAccepted();
+
+                size_t children = 0;
+                bool innerFound = false;
+                auto walkChild = [&](TreeElement& child)
+                {
+                    if (!innerFound && m_provider.IsSameElement(child, *m_ancestors[index - 1]))
+                    {
+                        innerFound = true;
+                        ring.InnerAt = m_visits - ring.First;
+                    }
+                    else
+                    {
+                        WalkElement(child, depth + 1, visitor, cancelled);
+                    }
+                    ++children;
+                };
+
+                // As in WalkElement, the top levels' children are counted first
+                std::unique_ptr<TreeElement> child = depth < m_maxDepth ? m_provider.FirstChild(ancestor) : nullptr;
+                if (m_progress && depth < EnumerationProgress::CountedDepth)
+                {
+                    std::vector<std::unique_ptr<TreeElement>> fetched;
+                    while (child && !Stopped(cancelled))
+                    {
+                        std::unique_ptr<TreeElement> next = m_provider.NextSibling(*child);
+                        fetched.push_back(std::move(child));
+                        child = std::move(next);
+                    }
+                    m_progress->OnChildren(depth, fetched.size());
+                    for (size_t i = 0; i < fetched.size() && !Stopped(cancelled); ++i) walkChild(*fetched[i]);
+                }
+                for (; child && !Stopped(cancelled); child = m_provider.NextSibling(*child))
+                {
+                    walkChild(*child);
+                }
+                if (m_progress) m_progress->OnLeave(depth, children);
+
+                // The inner rings' control is gone from the parent: they come last
+                if (!innerFound) ring.InnerAt = m_visits - ring.First;
+            }
+            m_maxDepth = maxDepth;
+
+            // A ring cut short cannot be widened from
+            ring.Count = m_visits - ring.First;
+            if (Stopped(cancelled))
+            {
+                m_nextRing = rings;
+                return;
+            }
+            if (ringDone) ringDone(ring);
+
+            if (m_scoped && index + 1 < rings && IsScopeContainer(m_ancestorProperties[index].ControlType)) return;
+        }
+    }
+
+    void ControlWalker::TreeOrder(const std::vector<Ring>& rings, std::vector<size_t>& order)
+    {
+        // Outermost first: each ring's visits up to InnerAt, then the inner
+        // rings, then the rest of the ring. The outermost rings not complete
+        // yet are left out, the rings inside them still nest.
+        order.clear();
+        for (size_t index = rings.size(); index-- > 0;)
+        {
+            const Ring& ring = rings[index];
+            const size_t ahead = index == 0 ? ring.Count : std::min(ring.InnerAt, ring.Count);
+            for (size_t visit = 0; visit < ahead; ++visit) order.push_back(ring.First + visit);
+        }
+        for (size_t index = 1; index < rings.size(); ++index)
+        {
+            const Ring& ring = rings[index];
+            for (size_t visit = std::min(ring.InnerAt, ring.Count); visit < ring.Count; ++visit)
+            {
+                order.push_back(ring.First + visit);
+            }
+        }
+    }
+
+    bool ControlWalker::IsScopeContainer(int32_t controlType)
+    {
+        return controlType == GroupControlType || controlType == DocumentControlType ||
+               controlType == WindowControlType || controlType == PaneControlType;
+    }
+
+    void ControlWalker::WalkElement(TreeElement& element, size_t depth, const Visitor& visitor,
+                                    const std::atomic<bool>* cancelled)
+    {
+        if (Stopped(cancelled)) return;
+
+        const bool tracked = m_stats && depth >= 1 && depth <= EnumerationStatsCollector::TrackedSubtreeDepth;
+        const auto start = tracked ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        const size_t nodesBefore = m_stats ? m_stats->Nodes() : 0;
+
+        if (m_progress) m_progress->OnEnter(depth);
+
+        ElementProperties properties;
+        if (!m_provider.GetProperties(element, m_properties, properties))
+        {
+            if (m_progress) m_progress->OnLeave(depth, 0);
+            return;
+        }
+
+        visitor(element, properties, depth);
+        ++m_visits;
+        if (m_stats) m_stats->OnNode(depth);
+        if (m_progress) m_progress->OnAccepted();
+
+        if (tracked)
+        {
+            m_subtreeKeys.resize(depth - 1);
+            m_subtreeKeys.push_back(EnumerationStatsCollector::SubtreeKey(
+                properties, depth > 1 ? m_subtreeKeys[depth - 2] : std::string()));
+        }
+
+        std::unique_ptr<TreeElement> child = depth < m_maxDepth ? m_provider.FirstChild(element) : nullptr;
+        size_t children = 0;
+
+        // The top levels are too few to learn their fan-out from: their
+        // children are fetched first and counted, then walked
+        if (m_progress && depth < EnumerationProgress::CountedDepth)
+        {
+            std::vector<std::unique_ptr<TreeElement>> fetched;
+            while (child)
+            {
+                if (Stopped(cancelled)) return;
+                std::unique_ptr<TreeElement> next = m_provider.NextSibling(*child);
+                fetched.push_back(std::move(child));
+                child = std::move(next);
+            }
+            m_progress->OnChildren(depth, fetched.size());
+
+            for (std::unique_ptr<TreeElement>& counted : fetched)
+            {
+                if (Stopped(cancelled)) return;
+
+                TraceSpan batch(depth == 0 ? "WalkControls batch" : nullptr);
+                WalkElement(*counted, depth + 1, visitor, cancelled);
+                ++children;
+            }
+        }
+
+        while (child)
+        {
+            if (Stopped(cancelled)) return;
+
+            {
+                // One trace span per top-level subtree
+                TraceSpan batch(depth == 0 ? "WalkControls batch" : nullptr);
+                WalkElement(*child, depth + 1, visitor, cancelled);
+            }
+            ++children;
+            child = m_provider.NextSibling(*child);
+        }
+        if (m_progress) m_progress->OnLeave(depth, children);
+
+        if (tracked)
+        {
+            m_stats->OnSubtree(m_subtreeKeys[depth - 1], depth, m_stats->Nodes() - nodesBefore,
+                               std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+    }
+
+    bool ControlWalker::Stopped(const std::atomic<bool>* cancelled)
+    {
+        if (cancelled && *cancelled) return true;
+        if (m_timedOut) return true;
+        if (m_deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= m_deadline)
+        {
+            m_timedOut = true;
+        }
+        return m_timedOut;
+    }
+}
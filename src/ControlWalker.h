@@ -0,0 +1,147 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "TreeProvider.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UIAListCore
+{
+    class EnumerationProgress;
+    class EnumerationStatsCollector;
+
+    // How properties travel with the tree walk
+    enum class WalkMode
+    {
+        Current,       // Plain navigation, one call per property (the original walker)
+        BuildCache,    // Properties cached with each navigation call
+        SubtreeCache   // Whole tree fetched with the root, walked locally
+    };
+
+    const char* ToString(WalkMode mode);
+
+    // "Button" for UIA_ButtonControlTypeId, "Unknown" outside the UIA range
+    const char* ControlTypeName(int32_t controlType);
+
+    // Inverse of ControlTypeName, case-insensitive; 0 when there is no such type
+    int32_t ControlTypeFromName(std::string_view name);
+
+    // Depth-first walk of the control view, in the order the list shows it
+    class ControlWalker
+    {
+    public:
+        // depth is 0 for the root
+        using Visitor = std::function<void(TreeElement& element, const ElementProperties& properties, size_t depth)>;
+
+        // A ring of WalkOutward: an ancestor of the focused element with the
+        // subtrees of its children, less the child the inner rings walked.
+        // Ring 0 is the focused element's container with all of its subtree.
+        struct Ring
+        {
+            size_t Index{ 0 };
+            size_t First{ 0 };    // Visits of the walk before the ring
+            size_t Count{ 0 };    // Visits of the ring
+            size_t InnerAt{ 0 };  // Visits of the ring ahead of the inner rings in tree order
+        };
+        using RingVisitor = std::function<void(const Ring& ring)>;
+
+        ControlWalker(TreeProvider& provider, WalkMode mode, uint32_t properties);
+
+        // False when the root could not be fetched. Elements whose properties
+        // cannot be read are skipped together with their subtree.
+        bool Walk(const Visitor& visitor, const std::atomic<bool>* cancelled = nullptr);
+
+        // The same elements as Walk, outward from the keyboard focus, so the
+        // controls around the user come first: ring by ring, ringDone called
+        // as each one is complete. Walks from the root as a single ring when
+        // the focus is outside the tree, the provider cannot navigate up, or
+        // the mode caches the subtree.
+        bool WalkOutward(const Visitor& visitor, const RingVisitor& ringDone, const std::atomic<bool>* cancelled = nullptr);
+
+        // The visits of the rings so far in Walk's order, as indices into
+        // the visits; complete rings only
+        static void TreeOrder(const std::vector<Ring>& rings, std::vector<size_t>& order);
+
+        // Containers a scoped walk stops at: pane, group, window (dialogs too) and document
+        static bool IsScopeContainer(int32_t controlType);
+
+        // Optional: WalkOutward stops after the first ring whose container
+        // IsScopeContainer, the nearest one around the focus, and leaves out
+        // elements more than scopeDepth below a ring's container. Needs
+        // PropertyControlType among the properties.
+        void SetScoped(bool scoped, size_t scopeDepth = SIZE_MAX)
+        {
+            m_scoped = scoped;
+            m_scopeDepth = scopeDepth;
+        }
+
+        // After a scoped WalkOutward: the rings out to the next scope
+        // container, or the root, their visits numbered on from the walk so
+        // far. False once the whole tree is walked. Progress counts as for a
+        // walk outward from the scope reached: Start it again before.
+        bool Widen(const Visitor& visitor, const RingVisitor& ringDone, const std::atomic<bool>* cancelled = nullptr);
+        bool Complete() const { return m_nextRing >= m_ancestors.size(); }
+
+        // During and after WalkOutward: the focused element's ancestors,
+        // nearest first, the root last, each the container of the ring of
+        // the same index; none when the walk was a single ring from the
+        // root. A ring's elements are visited before the ancestors around it.
+        size_t AncestorCount() const { return m_ancestors.size(); }
+        TreeElement& Ancestor(size_t index) const { return *m_ancestors[index]; }
+        const ElementProperties& AncestorProperties(size_t index) const { return m_ancestorProperties[index]; }
+
+        // Optional: node counts and subtree timings for the statistics log
+        void SetStats(EnumerationStatsCollector* stats) { m_stats = stats; }
+
+        // Optional: counts for a progress display, read by another thread.
+        // Children of the top EnumerationProgress::CountedDepth levels are
+        // then all fetched before the first is walked.
+        void SetProgress(EnumerationProgress* progress) { m_progress = progress; }
+
+        // Optional: elements deeper than maxDepth are not visited, their
+        // children not even fetched (0 visits the root only)
+        void SetMaxDepth(size_t maxDepth) { m_maxDepth = maxDepth; }
+
+        // Optional: the walk stops at deadline, TimedOut tells it did
+        void SetDeadline(std::chrono::steady_clock::time_point deadline) { m_deadline = deadline; }
+        bool TimedOut() const { return m_timedOut; }
+
+    private:
+        bool Prepare();
+        void WalkRings(const Visitor& visitor, const RingVisitor& ringDone, const std::atomic<bool>* cancelled);
+        void WalkElement(TreeElement& element, size_t depth, const Visitor& visitor, const std::atomic<bool>* cancelled);
+        bool Stopped(const std::atomic<bool>* cancelled);
+
+        TreeProvider& m_provider;
+        WalkMode m_mode;
+        uint32_t m_properties;
+        EnumerationStatsCollector* m_stats{ nullptr };
+        EnumerationProgress* m_progress{ nullptr };
+        size_t m_maxDepth{ SIZE_MAX };
+        std::chrono::steady_clock::time_point m_deadline{ std::chrono::steady_clock::time_point::max() };
+        bool m_timedOut{ false };
+        size_t m_visits{ 0 };  // Visitor calls of the running walk
+        bool m_scoped{ false };
+        size_t m_scopeDepth{ SIZE_MAX };
+        std::vector<std::unique_ptr<TreeElement>> m_ancestors;  // Of the focus, nearest first, the root last
+        std::vector<ElementProperties> m_ancestorProperties;
+        size_t m_nextRing{ 0 };  // The ring Widen starts with
+        std::vector<std::string> m_subtreeKeys;  // Keys of the tracked ancestors, by depth - 1
+    };
+}
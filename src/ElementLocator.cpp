@@ -0,0 +1,437 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ElementLocator.h"
+#include "CallStats.h"
+#include "Utf8.h"
+#include "Varint.h"
+
+#include <algorithm>
+
+namespace UIAListCore
+{
+    const PROPERTYID ElementLocator::CachedProperties[] =
+    {
+        UIA_ControlTypePropertyId,
+        UIA_NamePropertyId,
+        UIA_AutomationIdPropertyId,
+        UIA_RuntimeIdPropertyId,
+    };
+
+    const size_t ElementLocator::CachedPropertyCount = sizeof(CachedProperties) / sizeof(CachedProperties[0]);
+
+    namespace
+    {
+        std::wstring CachedString(IUIAutomationElement* element, PROPERTYID property)
+        {
+            std::wstring result;
+            VARIANT value;
+            VariantInit(&value);
+            if (SUCCEEDED(element->GetCachedPropertyValue(property, &value)) &&
+                value.vt == VT_BSTR && value.bstrVal)
+            {
+                result.assign(value.bstrVal, SysStringLen(value.bstrVal));
+            }
+            VariantClear(&value);
+            return result;
+        }
+
+        HRESULT CreateStringCondition(IUIAutomation* automation, PROPERTYID property, const std::wstring& text,
+                                      IUIAutomationCondition** condition)
+        {
+            VARIANT value;
+            value.vt = VT_BSTR;
+            value.bstrVal = SysAllocStringLen(text.c_str(), static_cast<UINT>(text.size()));
+            HRESULT hr = automation->CreatePropertyCondition(property, value, condition);
+            VariantClear(&value);
+            return hr;
+        }
+    }
+
+    ElementLocator ElementLocator::ForWindow(HWND window)
+    {
+        ElementLocator locator;
+        locator.m_rootWindow = window;
+        return locator;
+    }
+
+    ElementLocator ElementLocator::Capture(IUIAutomationElement* element, const ElementLocator& parent)
+    {
+        auto step = std::make_shared<Step>();
+        step->Parent = parent.m_step;
+        step->AutomationId = CachedString(element, UIA_AutomationIdPropertyId);
+        step->Name = CachedString(element, UIA_NamePropertyId);
+        element->get_CachedControlType(&step->ControlType);
+
+        ElementLocator locator;
+        locator.m_rootWindow = parent.m_rootWindow;
+        locator.m_step = std::move(step);
+        locator.m_runtimeId = CachedRuntimeId(element);
+        return locator;
+    }
+
+    std::vector<int> ElementLocator::CachedRuntimeId(IUIAutomationElement* element)
+    {
+        std::vector<int> result;
+        VARIANT value;
+        VariantInit(&value);
+        if (SUCCEEDED(element->GetCachedPropertyValue(UIA_RuntimeIdPropertyId, &value)) &&
+            value.vt == (VT_I4 | VT_ARRAY) && value.parray)
+        {
+            LONG lower = 0;
+            LONG upper = -1;
+            SafeArrayGetLBound(value.parray, 1, &lower);
+            SafeArrayGetUBound(value.parray, 1, &upper);
+
+            int* data = nullptr;
+            if (upper >= lower && SUCCEEDED(SafeArrayAccessData(value.parray, (void**)&data)))
+            {
+                result.assign(data, data + (upper - lower + 1));
+                SafeArrayUnaccessData(value.parray);
+            }
+        }
+        VariantClear(&value);
+        return result;
+    }
+
+    size_t ElementLocator::Depth() const
+    {
+        size_t depth = 0;
+        for (const Step* step = m_step.get(); step; step = step->Parent.get()) ++depth;
+        return depth;
+    }
+
+    size_t ElementLocator::MemoryBytes() const
+    {
+        size_t bytes = m_runtimeId.capacity() * sizeof(int);
+        if (m_step)
+        {
+            // make_shared puts the step and its control block in one allocation
+            bytes += sizeof(Step) + 2 * sizeof(void*);
+            bytes += (m_step->AutomationId.capacity() + m_step->Name.capacity()) * sizeof(wchar_t);
+        }
+        return bytes;
+    }
+
+    bool ElementLocator::IsAlive(IUIAutomationElement* element)
+    {
+        if (!element) return false;
+
+        // Dead providers answer with UIA_E_ELEMENTNOTAVAILABLE
+        CONTROLTYPEID controlType;
+        return SUCCEEDED(UIALIST_COUNTED("IUIAutomationElement::get_CurrentControlType", element->get_CurrentControlType(&controlType)));
+    }
+
+    HRESULT ElementLocator::Refresh(IUIAutomation* automation, IUIAutomationElement* element,
+                                    IUIAutomationElement** liveElement) const
+    {
+        if (!liveElement) return E_POINTER;
+        *liveElement = nullptr;
+
+        if (IsAlive(element))
+        {
+            element->AddRef();
+            *liveElement = element;
+            return S_OK;
+        }
+
+        return Resolve(automation, liveElement);
+    }
+
+    HRESULT ElementLocator::Resolve(IUIAutomation* automation, IUIAutomationElement** found) const
+    {
+        if (!found) return E_POINTER;
+        *found = nullptr;
+        if (!automation || !m_rootWindow || !IsWindow(m_rootWindow)) return E_FAIL;
+
+        IUIAutomationElement* scope = nullptr;
+        HRESULT hr = UIALIST_COUNTED("IUIAutomation::ElementFromHandle", automation->ElementFromHandle(m_rootWindow, &scope));
+        if (FAILED(hr) || !scope) return FAILED(hr) ? hr : E_FAIL;
+
+        if (!m_step)
+        {
+            *found = scope;
+            return S_OK;
+        }
+
+        // Any control of the type would do; better none than the wrong one
+        if (m_step->AutomationId.empty() && m_step->Name.empty())
+        {
+            scope->Release();
+            return UIA_E_ELEMENTNOTAVAILABLE;
+        }
+
+        // One query over the window for the control itself, then the
+        // ancestors of each match are checked against the path's steps. Only
+        // a single match whose whole path agrees is taken.
+        IUIAutomationCondition* condition = nullptr;
+        IUIAutomationCacheRequest* cacheRequest = nullptr;
+        IUIAutomationTreeWalker* walker = nullptr;
+        IUIAutomationElementArray* candidates = nullptr;
+        hr = CreateStepCondition(automation, *m_step, &m_runtimeId, &condition);
+        if (SUCCEEDED(hr)) hr = CreatePathCacheRequest(automation, &cacheRequest);
+        if (SUCCEEDED(hr)) hr = automation->get_ControlViewWalker(&walker);
+        if (SUCCEEDED(hr))
+        {
+            hr = UIALIST_COUNTED("IUIAutomationElement::FindAllBuildCache",
+                                 scope->FindAllBuildCache(TreeScope_Descendants, condition, cacheRequest, &candidates));
+        }
+
+        int length = 0;
+        if (SUCCEEDED(hr) && candidates) candidates->get_Length(&length);
+        bool ambiguous = false;
+        for (int i = 0; i < length && !ambiguous; ++i)
+        {
+            IUIAutomationElement* candidate = nullptr;
+            if (FAILED(candidates->GetElement(i, &candidate)) || !candidate) continue;
+
+            if (!MatchesPath(automation, walker, cacheRequest, scope, candidate))
+            {
+                candidate->Release();
+            }
+            else if (*found)
+            {
+                // Two controls fit the whole path, neither is known to be the one
+                ambiguous = true;
+                candidate->Release();
+                (*found)->Release();
+                *found = nullptr;
+            }
+            else
+            {
+                *found = candidate;
+            }
+        }
+
+        if (candidates) candidates->Release();
+        if (walker) walker->Release();
+        if (cacheRequest) cacheRequest->Release();
+        if (condition) condition->Release();
+        scope->Release();
+
+        if (SUCCEEDED(hr) && !*found) hr = UIA_E_ELEMENTNOTAVAILABLE;
+        return hr;
+    }
+
+    bool ElementLocator::MatchesPath(IUIAutomation* automation, IUIAutomationTreeWalker* walker,
+                                     IUIAutomationCacheRequest* cacheRequest, IUIAutomationElement* root,
+                                     IUIAutomationElement* candidate) const
+    {
+        // The candidate itself matched m_step in the query; each parent up
+        // from it must match the next step, and the last one's parent is the root
+        IUIAutomationElement* parent = nullptr;
+        bool matches = SUCCEEDED(UIALIST_COUNTED("IUIAutomationTreeWalker::GetParentElementBuildCache",
+                                                 walker->GetParentElementBuildCache(candidate, cacheRequest, &parent))) &&
+                       parent;
+
+        for (const Step* step = m_step->Parent.get(); matches && step; step = step->Parent.get())
+        {
+            IUIAutomationElement* next = nullptr;
+            matches = StepMatches(*step, parent) &&
+                      SUCCEEDED(UIALIST_COUNTED("IUIAutomationTreeWalker::GetParentElementBuildCache",
+                                                walker->GetParentElementBuildCache(parent, cacheRequest, &next))) &&
+                      next;
+            parent->Release();
+            parent = next;
+        }
+
+        BOOL same = FALSE;
+        if (matches)
+        {
+            matches = SUCCEEDED(UIALIST_COUNTED("IUIAutomation::CompareElements",
+                                                automation->CompareElements(parent, root, &same))) && same;
+        }
+        if (parent) parent->Release();
+        return matches;
+    }
+
+    bool ElementLocator::StepMatches(const Step& step, IUIAutomationElement* element)
+    {
+        CONTROLTYPEID controlType = 0;
+        if (FAILED(element->get_CachedControlType(&controlType)) || controlType != step.ControlType) return false;
+
+        // What CreateStepCondition would ask for; steps with neither match by type alone
+        if (!step.AutomationId.empty()) return CachedString(element, UIA_AutomationIdPropertyId) == step.AutomationId;
+        if (!step.Name.empty()) return CachedString(element, UIA_NamePropertyId) == step.Name;
+        return true;
+    }
+
+    HRESULT ElementLocator::CreatePathCacheRequest(IUIAutomation* automation, IUIAutomationCacheRequest** cacheRequest)
+    {
+        HRESULT hr = automation->CreateCacheRequest(cacheRequest);
+        if (FAILED(hr)) return hr;
+
+        // The step properties, the runtime id is not compared along the path
+        for (size_t i = 0; SUCCEEDED(hr) && i < CachedPropertyCount; ++i)
+        {
+            if (CachedProperties[i] != UIA_RuntimeIdPropertyId) hr = (*cacheRequest)->AddProperty(CachedProperties[i]);
+        }
+        if (FAILED(hr))
+        {
+            (*cacheRequest)->Release();
+            *cacheRequest = nullptr;
+        }
+        return hr;
+    }
+
+    void ElementLocator::Packer::Pack(const ElementLocator& locator, std::string& out)
+    {
+        PutVarint(out, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(locator.m_rootWindow)));
+        PutVarint(out, StepNumber(locator.m_step));
+        PutVarint(out, locator.m_runtimeId.size());
+        for (int part : locator.m_runtimeId)
+        {
+            PutVarint(out, static_cast<uint32_t>(part));
+        }
+    }
+
+    uint64_t ElementLocator::Packer::StepNumber(const std::shared_ptr<const Step>& step)
+    {
+        if (!step) return 0;
+
+        auto known = m_numbers.find(step.get());
+        if (known != m_numbers.end()) return known->second;
+
+        // Parents first, so the unpacker can link each step as it reads it
+        const uint64_t parent = StepNumber(step->Parent);
+        PutVarint(m_steps, parent);
+        PutVarint(m_steps, static_cast<uint32_t>(step->ControlType));
+        PutString(m_steps, ToUtf8(step->AutomationId));
+        PutString(m_steps, ToUtf8(step->Name));
+
+        const uint64_t number = m_numbers.size() + 1;
+        m_numbers.emplace(step.get(), number);
+        return number;
+    }
+
+    ElementLocator::Unpacker::Unpacker(std::string_view steps)
+    {
+        VarintReader reader(steps);
+        std::string text;
+        while (!reader.AtEnd())
+        {
+            uint64_t parent = 0;
+            uint32_t controlType = 0;
+            auto step = std::make_shared<Step>();
+            if (!reader.GetVarint(parent) || parent > m_steps.size() || !reader.GetUint32(controlType))
+            {
+                m_valid = false;
+                return;
+            }
+            step->Parent = parent ? m_steps[static_cast<size_t>(parent - 1)] : nullptr;
+            step->ControlType = static_cast<CONTROLTYPEID>(controlType);
+            if (!reader.GetString(text))
+            {
+                m_valid = false;
+                return;
+            }
+            step->AutomationId = FromUtf8(text);
+            if (!reader.GetString(text))
+            {
+                m_valid = false;
+                return;
+            }
+            step->Name = FromUtf8(text);
+            m_steps.push_back(std::move(step));
+        }
+    }
+
+    bool ElementLocator::Unpacker::Unpack(std::string_view packed, ElementLocator& locator) const
+    {
+        VarintReader reader(packed);
+        uint64_t window = 0;
+        uint64_t step = 0;
+        uint64_t parts = 0;
+        if (!m_valid || !reader.GetVarint(window) || !reader.GetVarint(step) || step > m_steps.size() ||
+            !reader.GetVarint(parts) || parts > packed.size())
+        {
+            return false;
+        }
+
+        locator = ElementLocator();
+        locator.m_rootWindow = reinterpret_cast<HWND>(static_cast<uintptr_t>(window));
+        locator.m_step = step ? m_steps[static_cast<size_t>(step - 1)] : nullptr;
+        locator.m_runtimeId.resize(static_cast<size_t>(parts));
+        for (int& part : locator.m_runtimeId)
+        {
+            uint32_t value = 0;
+            if (!reader.GetUint32(value)) return false;
+            part = static_cast<int>(value);
+        }
+        return true;
+    }
+
+    HRESULT ElementLocator::CreateStepCondition(IUIAutomation* automation, const Step& step,
+                                                const std::vector<int>* runtimeId, IUIAutomationCondition** condition)
+    {
+        *condition = nullptr;
+
+        VARIANT typeValue;
+        typeValue.vt = VT_I4;
+        typeValue.lVal = step.ControlType;
+        IUIAutomationCondition* typeCondition = nullptr;
+        HRESULT hr = automation->CreatePropertyCondition(UIA_ControlTypePropertyId, typeValue, &typeCondition);
+        if (FAILED(hr)) return hr;
+
+        IUIAutomationCondition* identityCondition = nullptr;
+        hr = step.AutomationId.empty()
+            ? CreateStringCondition(automation, UIA_NamePropertyId, step.Name, &identityCondition)
+            : CreateStringCondition(automation, UIA_AutomationIdPropertyId, step.AutomationId, &identityCondition);
+        if (FAILED(hr))
+        {
+            typeCondition->Release();
+            return hr;
+        }
+
+        IUIAutomationCondition* stepCondition = nullptr;
+        hr = automation->CreateAndCondition(typeCondition, identityCondition, &stepCondition);
+        typeCondition->Release();
+        identityCondition->Release();
+        if (FAILED(hr)) return hr;
+
+        if (!runtimeId || runtimeId->empty())
+        {
+            *condition = stepCondition;
+            return S_OK;
+        }
+
+        // The same element may still be around under its old runtime id
+        // (e.g. only our proxy was disconnected)
+        VARIANT idValue;
+        idValue.vt = VT_I4 | VT_ARRAY;
+        idValue.parray = SafeArrayCreateVector(VT_I4, 0, static_cast<ULONG>(runtimeId->size()));
+        if (!idValue.parray)
+        {
+            *condition = stepCondition;
+            return S_OK;
+        }
+
+        int* data = nullptr;
+        if (SUCCEEDED(SafeArrayAccessData(idValue.parray, (void**)&data)))
+        {
+            std::copy(runtimeId->begin(), runtimeId->end(), data);
+            SafeArrayUnaccessData(idValue.parray);
+        }
+
+        IUIAutomationCondition* idCondition = nullptr;
+        hr = automation->CreatePropertyCondition(UIA_RuntimeIdPropertyId, idValue, &idCondition);
+        VariantClear(&idValue);
+        if (FAILED(hr))
+        {
+            *condition = stepCondition;
+            return S_OK;
+        }
+
+        hr = automation->CreateOrCondition(idCondition, stepCondition, condition);
+        idCondition->Release();
+        stepCondition->Release();
+        return hr;
+    }
+}
@@ -0,0 +1,134 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+// No pch.h here: shared by the WinUI and the Qt frontend
+#include <windows.h>
+#include <UIAutomation.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace UIAListCore
+{
+    // Finds a control again after its IUIAutomationElement went stale, e.g.
+    // because the target application recreated it since the list was built.
+    // Captured from cached properties during enumeration, so building it costs
+    // no extra cross-process calls; resolving costs one FindAll query over
+    // the window and, for each control it returns, a walk up to the window
+    // to check the path, instead of a full re-walk.
+    class ElementLocator
+    {
+        struct Step;
+
+    public:
+        ElementLocator() = default;
+
+        // Properties the enumeration cache request must contain for Capture
+        static const PROPERTYID CachedProperties[];
+        static const size_t CachedPropertyCount;
+
+        // Locator of the enumeration root (the target window itself)
+        static ElementLocator ForWindow(HWND window);
+
+        // Locator of element, a control view child of the control parent locates
+        static ElementLocator Capture(IUIAutomationElement* element, const ElementLocator& parent);
+
+        bool IsEmpty() const { return m_rootWindow == nullptr; }
+
+        // Runtime id read when captured, empty for the root window
+        const std::vector<int>& Id() const { return m_runtimeId; }
+
+        // Levels below the root window: 0 for the root, 1 for its children
+        size_t Depth() const;
+
+        // The runtime id element was fetched with, empty unless cached
+        static std::vector<int> CachedRuntimeId(IUIAutomationElement* element);
+
+        // Heap bytes this locator adds: its own path step and runtime id
+        // (parent steps are shared with, and counted by, the parent's locator)
+        size_t MemoryBytes() const;
+
+        // One cheap call: false once the element's provider is gone
+        static bool IsAlive(IUIAutomationElement* element);
+
+        // The element itself while it is alive, otherwise the re-resolved control.
+        // liveElement is AddRef'd, null when the control no longer exists.
+        HRESULT Refresh(IUIAutomation* automation, IUIAutomationElement* element,
+                        IUIAutomationElement** liveElement) const;
+
+        // Find the control again, starting from the root window. Fails rather
+        // than guess when the control has neither AutomationId nor Name, or
+        // when more than one control matches every step of the path.
+        HRESULT Resolve(IUIAutomation* automation, IUIAutomationElement** found) const;
+
+        // Packs the locators of one list into bytes, for a CompactSnapshot.
+        // Path steps shared between siblings are written once, to Steps().
+        class Packer
+        {
+        public:
+            void Pack(const ElementLocator& locator, std::string& out);
+            const std::string& Steps() const { return m_steps; }
+
+        private:
+            uint64_t StepNumber(const std::shared_ptr<const Step>& step);  // 0 for none
+
+            std::unordered_map<const Step*, uint64_t> m_numbers;
+            std::string m_steps;
+        };
+
+        // Restores packed locators; their steps are shared again
+        class Unpacker
+        {
+        public:
+            explicit Unpacker(std::string_view steps);
+
+            bool IsValid() const { return m_valid; }
+            bool Unpack(std::string_view packed, ElementLocator& locator) const;
+
+        private:
+            std::vector<std::shared_ptr<const Step>> m_steps;
+            bool m_valid{ true };
+        };
+
+    private:
+        // One level of the path from the root; parents are shared between siblings
+        struct Step
+        {
+            std::shared_ptr<const Step> Parent;
+            std::wstring AutomationId;
+            std::wstring Name;
+            CONTROLTYPEID ControlType{ 0 };
+        };
+
+        // AND(ControlType, AutomationId or Name), optionally OR RuntimeId
+        static HRESULT CreateStepCondition(IUIAutomation* automation, const Step& step,
+                                           const std::vector<int>* runtimeId, IUIAutomationCondition** condition);
+
+        // Whether the control view ancestors of candidate match m_step's parents up to root
+        bool MatchesPath(IUIAutomation* automation, IUIAutomationTreeWalker* walker,
+                         IUIAutomationCacheRequest* cacheRequest, IUIAutomationElement* root,
+                         IUIAutomationElement* candidate) const;
+
+        // element's cached properties against one step of the path
+        static bool StepMatches(const Step& step, IUIAutomationElement* element);
+
+        // Caches what StepMatches reads
+        static HRESULT CreatePathCacheRequest(IUIAutomation* automation, IUIAutomationCacheRequest** cacheRequest);
+
+        HWND m_rootWindow{ nullptr };
+        std::shared_ptr<const Step> m_step;  // Null for the root window itself
+        std::vector<int> m_runtimeId;
+    };
+}
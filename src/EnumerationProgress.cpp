@@ -0,0 +1,174 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "EnumerationProgress.h"
+
+#include <algorithm>
+
+namespace UIAListCore
+{
+    void EnumerationProgress::Start(Clock::time_point now)
+    {
+        m_start.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+        m_visited = 0;
+        m_accepted = 0;
+        m_depth = 0;
+        m_deepest = 0;
+        m_unpublished = 0;
+        m_levels.fill(Level());
+        Publish();
+    }
+
+    void EnumerationProgress::OnEnter(size_t depth)
+    {
+        depth = std::min(depth, MaxDepth - 1);
+        if (depth > 0) ++m_levels[depth - 1].OpenChildren;
+        Level& level = m_levels[depth];
+        level.OpenChildren = 0;
+        level.OpenCounted = 0;
+        level.OpenStart = m_visited;
+        m_depth = depth;
+        m_deepest = std::max(m_deepest, depth);
+        ++m_visited;
+        if (++m_unpublished >= PublishInterval) Publish();
+    }
+
+    void EnumerationProgress::OnAccepted()
+    {
+        ++m_accepted;
+    }
+
+    void EnumerationProgress::OnChildren(size_t depth, size_t children)
+    {
+        m_levels[std::min(depth, MaxDepth - 1)].OpenCounted = children;
+    }
+
+    void EnumerationProgress::OnLeave(size_t depth, size_t children)
+    {
+        depth = std::min(depth, MaxDepth - 1);
+        Level& level = m_levels[depth];
+        ++level.Completed;
+        level.CompletedChildren += children;
+        level.CompletedSize += m_visited - level.OpenStart;
+        m_depth = depth > 0 ? depth - 1 : 0;
+    }
+
+    void EnumerationProgress::OnStartBelow(size_t depth)
+    {
+        depth = std::min(depth, MaxDepth - 1);
+        for (size_t ancestor = 0; ancestor < depth; ++ancestor)
+        {
+            // The parent's one child is counted by OnEnter
+            m_levels[ancestor].OpenChildren = ancestor + 1 < depth ? 1 : 0;
+        }
+    }
+
+    void EnumerationProgress::OnEnterAncestor(size_t depth)
+    {
+        depth = std::min(depth, MaxDepth - 1);
+        Level& level = m_levels[depth];
+        level.OpenChildren = 1;
+        level.OpenCounted = 0;
+        level.OpenStart = 0;  // Its subtree so far is everything walked
+        m_depth = depth;
+        m_deepest = std::max(m_deepest, depth);
+        ++m_visited;
+        if (++m_unpublished >= PublishInterval) Publish();
+    }
+
+    void EnumerationProgress::Publish()
+    {
+        m_unpublished = 0;
+        m_publishedVisited.store(m_visited, std::memory_order_relaxed);
+        m_publishedAccepted.store(m_accepted, std::memory_order_relaxed);
+        m_publishedDepth.store(m_depth, std::memory_order_relaxed);
+        m_publishedDeepest.store(m_deepest, std::memory_order_relaxed);
+        for (size_t depth = 0; depth <= m_deepest; ++depth)
+        {
+            const Level& level = m_levels[depth];
+            PublishedLevel& published = m_published[depth];
+            published.Completed.store(level.Completed, std::memory_order_relaxed);
+            published.CompletedChildren.store(level.CompletedChildren, std::memory_order_relaxed);
+            published.CompletedSize.store(level.CompletedSize, std::memory_order_relaxed);
+            published.OpenChildren.store(level.OpenChildren, std::memory_order_relaxed);
+            published.OpenCounted.store(level.OpenCounted, std::memory_order_relaxed);
+            published.OpenStart.store(level.OpenStart, std::memory_order_relaxed);
+        }
+    }
+
+    EnumerationProgress::Report EnumerationProgress::Read(Clock::time_point now) const
+    {
+        Report report;
+        report.Visited = m_publishedVisited.load(std::memory_order_relaxed);
+        report.Accepted = m_publishedAccepted.load(std::memory_order_relaxed);
+        report.Depth = m_publishedDepth.load(std::memory_order_relaxed);
+        const Clock::time_point start{ Clock::duration(m_start.load(std::memory_order_relaxed)) };
+        report.ElapsedSeconds = std::max(0.0, std::chrono::duration<double>(now - start).count());
+
+        const size_t deepest = std::min(m_publishedDeepest.load(std::memory_order_relaxed), MaxDepth - 1);
+        std::array<Level, MaxDepth> levels;
+        for (size_t depth = 0; depth <= deepest; ++depth)
+        {
+            const PublishedLevel& published = m_published[depth];
+            levels[depth].Completed = published.Completed.load(std::memory_order_relaxed);
+            levels[depth].CompletedChildren = published.CompletedChildren.load(std::memory_order_relaxed);
+            levels[depth].CompletedSize = published.CompletedSize.load(std::memory_order_relaxed);
+            levels[depth].OpenChildren = published.OpenChildren.load(std::memory_order_relaxed);
+            levels[depth].OpenCounted = published.OpenCounted.load(std::memory_order_relaxed);
+            levels[depth].OpenStart = published.OpenStart.load(std::memory_order_relaxed);
+        }
+
+        // Mean children and subtree size of the elements walked completely,
+        // by depth. Levels without any yet are taken to branch like the
+        // nearest deeper level that has children.
+        std::array<double, MaxDepth> fanOut{};
+        std::array<double, MaxDepth + 1> subtree{};
+        double branching = 0.0;
+        for (size_t depth = deepest + 1; depth-- > 0;)
+        {
+            const Level& level = levels[depth];
+            if (level.Completed > 0)
+            {
+                fanOut[depth] = static_cast<double>(level.CompletedChildren) / level.Completed;
+                if (fanOut[depth] > 0.0) branching = fanOut[depth];
+            }
+            else
+            {
+                fanOut[depth] = branching;
+            }
+            subtree[depth] = level.Completed > 0 ? static_cast<double>(level.CompletedSize) / level.Completed
+                                                 : 1.0 + fanOut[depth] * subtree[depth + 1];
+        }
+        report.HasEstimate = branching > 0.0;
+        if (!report.HasEstimate) return report;
+
+        // The children each open ancestor has left, each as large as the
+        // ones it had so far, or when none is done yet, as the subtrees of
+        // their level. Siblings tend to be alike, so the near ones go first.
+        double remaining = 0.0;
+        const size_t open = std::min(report.Depth, deepest);
+        for (size_t depth = 0; depth <= open; ++depth)
+        {
+            const Level& level = levels[depth];
+            const double seen = static_cast<double>(level.OpenChildren);
+            const double expected = level.OpenCounted > 0 ? static_cast<double>(level.OpenCounted)
+                                                          : std::max(fanOut[depth], seen);
+
+            // The children before the open one, their subtrees run up to where it started
+            const double walked = depth < open ? std::max(0.0, seen - 1.0) : seen;
+            const uint64_t end = depth < open ? levels[depth + 1].OpenStart : report.Visited;
+            const double walkedSize = static_cast<double>(end - std::min(end, level.OpenStart + 1));
+            const double childSize = walked > 0.0 && walkedSize > 0.0 ? walkedSize / walked : subtree[depth + 1];
+            remaining += (expected - seen) * childSize;
+        }
+        report.EstimatedRemaining = static_cast<uint64_t>(remaining + 0.5);
+        return report;
+    }
+}
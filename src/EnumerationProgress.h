@@ -0,0 +1,119 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace UIAListCore
+{
+    // Progress of a running enumeration. The walking thread keeps plain
+    // counters and copies them for the UI every PublishInterval elements,
+    // so there is no signal or lock per node; the UI reads the copy at its
+    // own cadence. The remaining count is estimated from the children each
+    // open ancestor has left, each worth a subtree as large as the ones
+    // walked so far: its own children walked before, or else the subtrees
+    // of the same level walked anywhere. Walkers count the children of the
+    // top CountedDepth levels before descending, as those levels have too
+    // few elements to learn their fan-out from; other ancestors are taken
+    // to have as many children as the elements of their level walked so
+    // far had on average.
+    class EnumerationProgress
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // Deeper levels are counted as the deepest one
+        static constexpr size_t MaxDepth = 64;
+
+        // Elements above this depth get their children counted up front
+        static constexpr size_t CountedDepth = 2;
+
+        struct Report
+        {
+            uint64_t Visited{ 0 };   // Elements fetched
+            uint64_t Accepted{ 0 };  // Of those, read and listed
+            size_t Depth{ 0 };       // Of the element being walked, 0 for the root
+            double ElapsedSeconds{ 0.0 };
+            uint64_t EstimatedRemaining{ 0 };
+            bool HasEstimate{ false };  // False until some element was walked completely
+        };
+
+        // Walking thread, before the walk; resets the counters
+        void Start(Clock::time_point now = Clock::now());
+
+        // Walking thread: an element at depth was fetched, was read, has
+        // children children (before walking them, optional), had children
+        // children and all of them were walked
+        void OnEnter(size_t depth);
+        void OnAccepted();
+        void OnChildren(size_t depth, size_t children);
+        void OnLeave(size_t depth, size_t children);
+
+        // Walking thread, for walks outward from an element at depth instead
+        // of down from the root: before the walk, the element's ancestors
+        // count as open with the path to it their one child so far. Then,
+        // for each of them the walk returns to, OnEnterAncestor instead of
+        // OnEnter: everything walked so far counts as that one child.
+        void OnStartBelow(size_t depth);
+        void OnEnterAncestor(size_t depth);
+
+        // Any thread
+        Report Read(Clock::time_point now = Clock::now()) const;
+
+        // Elements entered between two copies for Read
+        static constexpr uint64_t PublishInterval = 64;
+
+    private:
+        // Per depth, on the walking thread
+        struct Level
+        {
+            uint64_t Completed{ 0 };          // Walked elements
+            uint64_t CompletedChildren{ 0 };  // Their children
+            uint64_t CompletedSize{ 0 };      // Their subtrees' elements, themselves included
+            uint64_t OpenChildren{ 0 };       // Of the open element, so far
+            uint64_t OpenCounted{ 0 };        // Of it in all when counted, else 0
+            uint64_t OpenStart{ 0 };          // Visited when it was entered
+        };
+
+        // The copy of a Level Read uses
+        struct PublishedLevel
+        {
+            std::atomic<uint64_t> Completed{ 0 };
+            std::atomic<uint64_t> CompletedChildren{ 0 };
+            std::atomic<uint64_t> CompletedSize{ 0 };
+            std::atomic<uint64_t> OpenChildren{ 0 };
+            std::atomic<uint64_t> OpenCounted{ 0 };
+            std::atomic<uint64_t> OpenStart{ 0 };
+        };
+
+        void Publish();
+
+        // Walking thread only
+        uint64_t m_visited{ 0 };
+        uint64_t m_accepted{ 0 };
+        size_t m_depth{ 0 };
+        size_t m_deepest{ 0 };
+        uint64_t m_unpublished{ 0 };  // Elements entered since the last copy
+        std::array<Level, MaxDepth> m_levels{};
+
+        // For Read, written by Start and Publish: relaxed stores, no locked instructions
+        std::atomic<Clock::rep> m_start{ 0 };
+        std::atomic<uint64_t> m_publishedVisited{ 0 };
+        std::atomic<uint64_t> m_publishedAccepted{ 0 };
+        std::atomic<size_t> m_publishedDepth{ 0 };
+        std::atomic<size_t> m_publishedDeepest{ 0 };
+        std::array<PublishedLevel, MaxDepth> m_published{};
+    };
+}
@@ -0,0 +1,336 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "EnumerationStats.h"
+#include "ControlWalker.h"
+#include "Utf8.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <system_error>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        const char* const FormatVersion = "1";
+
+        // At most maxCharacters wide characters, without splitting a surrogate pair
+        std::string Abbreviate(const std::wstring& text, size_t maxCharacters)
+        {
+            if (text.size() <= maxCharacters) return ToUtf8(text);
+
+            size_t length = maxCharacters;
+            if (text[length - 1] >= 0xD800 && text[length - 1] <= 0xDBFF) --length;
+            return ToUtf8(text.substr(0, length)) + "...";
+        }
+
+        // Keeps one record on one line with tab-separated fields
+        std::string Escape(const std::string& text)
+        {
+            std::string out;
+            out.reserve(text.size());
+            for (char c : text)
+            {
+                switch (c)
+                {
+                case '\\': out += "\\\\"; break;
+                case '\t': out += "\\t"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                default: out += c; break;
+                }
+            }
+            return out;
+        }
+
+        std::string Unescape(const std::string& text)
+        {
+            std::string out;
+            out.reserve(text.size());
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                if (text[i] != '\\' || i + 1 == text.size())
+                {
+                    out += text[i];
+                    continue;
+                }
+                switch (text[++i])
+                {
+                case 't': out += '\t'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                default: out += text[i]; break;
+                }
+            }
+            return out;
+        }
+
+        std::vector<std::string> SplitFields(const std::string& line)
+        {
+            std::vector<std::string> fields;
+            size_t start = 0;
+            while (true)
+            {
+                size_t end = line.find('\t', start);
+                fields.push_back(line.substr(start, end == std::string::npos ? std::string::npos : end - start));
+                if (end == std::string::npos) break;
+                start = end + 1;
+            }
+            return fields;
+        }
+
+        double Median(std::vector<double> values)
+        {
+            if (values.empty()) return 0;
+            std::sort(values.begin(), values.end());
+            const size_t middle = values.size() / 2;
+            return (values.size() % 2) ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+        }
+    }
+
+    EnumerationStatsCollector::EnumerationStatsCollector()
+        : m_start(std::chrono::steady_clock::now())
+    {
+    }
+
+    void EnumerationStatsCollector::OnNode(size_t depth)
+    {
+        ++m_nodes;
+        m_maxDepth = std::max(m_maxDepth, depth);
+    }
+
+    void EnumerationStatsCollector::OnSubtree(std::string key, size_t depth, size_t nodes, double milliseconds)
+    {
+        m_subtrees.push_back({ std::move(key), depth, nodes, milliseconds });
+    }
+
+    EnumerationRecord EnumerationStatsCollector::Finish(std::string processImage, const char* mode, uint64_t calls) const
+    {
+        EnumerationRecord record;
+        record.ProcessImage = std::move(processImage);
+        record.Timestamp = static_cast<int64_t>(std::time(nullptr));
+        record.Mode = mode ? mode : "";
+        record.Nodes = m_nodes;
+        record.MaxDepth = m_maxDepth;
+        record.Calls = calls;
+        record.WallMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+
+        record.SlowestSubtrees = m_subtrees;
+        const size_t kept = std::min(record.SlowestSubtrees.size(), MaxSlowestSubtrees);
+        std::partial_sort(record.SlowestSubtrees.begin(), record.SlowestSubtrees.begin() + kept, record.SlowestSubtrees.end(),
+                          [](const SubtreeCost& a, const SubtreeCost& b) { return a.Milliseconds > b.Milliseconds; });
+        record.SlowestSubtrees.resize(kept);
+        return record;
+    }
+
+    std::string EnumerationStatsCollector::SubtreeKey(const ElementProperties& properties, const std::string& parentKey)
+    {
+        std::string key = parentKey.empty() ? std::string() : parentKey + " / ";
+        key += ControlTypeName(properties.ControlType);
+        if (!properties.Name.empty())
+        {
+            key += " \"" + Abbreviate(properties.Name, 48) + "\"";
+        }
+        if (!properties.AutomationId.empty())
+        {
+            key += " #" + Abbreviate(properties.AutomationId, 48);
+        }
+        return key;
+    }
+
+    std::vector<std::string> ApplicationSummary::DominantSubtrees(double minShare, size_t minRuns) const
+    {
+        std::vector<std::string> keys;
+        for (const SubtreeShare& subtree : Subtrees)
+        {
+            if (subtree.Runs >= minRuns && subtree.Runs == Runs && subtree.MinShare >= minShare)
+            {
+                keys.push_back(subtree.Key);
+            }
+        }
+        return keys;
+    }
+
+    std::vector<ApplicationSummary> Summarize(const std::vector<EnumerationRecord>& records)
+    {
+        std::map<std::string, std::vector<const EnumerationRecord*>> byImage;
+        for (const EnumerationRecord& record : records)
+        {
+            byImage[record.ProcessImage].push_back(&record);
+        }
+
+        std::vector<ApplicationSummary> summaries;
+        for (const auto& [image, runs] : byImage)
+        {
+            ApplicationSummary summary;
+            summary.ProcessImage = image;
+            summary.Runs = runs.size();
+
+            std::vector<double> wall;
+            double nodes = 0;
+            double calls = 0;
+            std::map<std::string, SubtreeShare> subtrees;
+            for (const EnumerationRecord* run : runs)
+            {
+                wall.push_back(run->WallMilliseconds);
+                summary.MaxMilliseconds = std::max(summary.MaxMilliseconds, run->WallMilliseconds);
+                summary.MaxDepth = std::max(summary.MaxDepth, static_cast<double>(run->MaxDepth));
+                nodes += run->Nodes;
+                calls += static_cast<double>(run->Calls);
+                summary.MeanMicrosecondsPerNode += run->MicrosecondsPerNode();
+
+                for (const SubtreeCost& cost : run->SlowestSubtrees)
+                {
+                    const double share = run->WallMilliseconds > 0 ? cost.Milliseconds / run->WallMilliseconds : 0;
+                    SubtreeShare& entry = subtrees[cost.Key];
+                    entry.MinShare = entry.Runs ? std::min(entry.MinShare, share) : share;
+                    entry.Key = cost.Key;
+                    entry.Runs++;
+                    entry.MeanShare += share;
+                    entry.MeanMilliseconds += cost.Milliseconds;
+                }
+            }
+
+            summary.MedianMilliseconds = Median(wall);
+            summary.MeanNodes = nodes / runs.size();
+            summary.MeanCallsPerNode = nodes > 0 ? calls / nodes : 0;
+            summary.MeanMicrosecondsPerNode /= runs.size();
+
+            for (auto& [key, subtree] : subtrees)
+            {
+                // Missing from a run's slowest list counts as a negligible share there
+                if (subtree.Runs < summary.Runs) subtree.MinShare = 0;
+                subtree.MeanShare /= summary.Runs;
+                subtree.MeanMilliseconds /= subtree.Runs;
+                summary.Subtrees.push_back(subtree);
+            }
+            std::sort(summary.Subtrees.begin(), summary.Subtrees.end(),
+                      [](const SubtreeShare& a, const SubtreeShare& b) { return a.MeanShare > b.MeanShare; });
+
+            summaries.push_back(std::move(summary));
+        }
+
+        std::sort(summaries.begin(), summaries.end(),
+                  [](const ApplicationSummary& a, const ApplicationSummary& b) { return a.MedianMilliseconds > b.MedianMilliseconds; });
+        return summaries;
+    }
+
+    EnumerationStatsLog::EnumerationStatsLog(std::filesystem::path path, uintmax_t maxBytes)
+        : m_path(std::move(path))
+        , m_maxBytes(maxBytes)
+    {
+    }
+
+    std::string EnumerationStatsLog::Serialize(const EnumerationRecord& record)
+    {
+        char number[64];
+        std::string line = FormatVersion;
+
+        std::snprintf(number, sizeof(number), "\t%lld", static_cast<long long>(record.Timestamp));
+        line += number;
+        line += "\t" + Escape(record.ProcessImage);
+        line += "\t" + Escape(record.Mode);
+        std::snprintf(number, sizeof(number), "\t%zu\t%zu\t%llu\t%.3f\t%zu", record.Nodes, record.MaxDepth,
+                      static_cast<unsigned long long>(record.Calls), record.WallMilliseconds, record.SlowestSubtrees.size());
+        line += number;
+
+        for (const SubtreeCost& subtree : record.SlowestSubtrees)
+        {
+            line += "\t" + Escape(subtree.Key);
+            std::snprintf(number, sizeof(number), "\t%zu\t%zu\t%.3f", subtree.Depth, subtree.Nodes, subtree.Milliseconds);
+            line += number;
+        }
+        return line;
+    }
+
+    bool EnumerationStatsLog::Parse(const std::string& line, EnumerationRecord& record)
+    {
+        std::vector<std::string> fields = SplitFields(line);
+        if (fields.size() < 9 || fields[0] != FormatVersion) return false;
+
+        record = EnumerationRecord();
+        record.Timestamp = std::strtoll(fields[1].c_str(), nullptr, 10);
+        record.ProcessImage = Unescape(fields[2]);
+        record.Mode = Unescape(fields[3]);
+        record.Nodes = static_cast<size_t>(std::strtoull(fields[4].c_str(), nullptr, 10));
+        record.MaxDepth = static_cast<size_t>(std::strtoull(fields[5].c_str(), nullptr, 10));
+        record.Calls = std::strtoull(fields[6].c_str(), nullptr, 10);
+        record.WallMilliseconds = std::strtod(fields[7].c_str(), nullptr);
+
+        const size_t count = static_cast<size_t>(std::strtoull(fields[8].c_str(), nullptr, 10));
+        if (fields.size() != 9 + count * 4) return false;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t base = 9 + i * 4;
+            SubtreeCost subtree;
+            subtree.Key = Unescape(fields[base]);
+            subtree.Depth = static_cast<size_t>(std::strtoull(fields[base + 1].c_str(), nullptr, 10));
+            subtree.Nodes = static_cast<size_t>(std::strtoull(fields[base + 2].c_str(), nullptr, 10));
+            subtree.Milliseconds = std::strtod(fields[base + 3].c_str(), nullptr);
+            record.SlowestSubtrees.push_back(std::move(subtree));
+        }
+        return true;
+    }
+
+    bool EnumerationStatsLog::Append(const EnumerationRecord& record)
+    {
+        {
+            std::ofstream file(m_path, std::ios::binary | std::ios::app);
+            if (!file) return false;
+            file << Serialize(record) << '\n';
+            if (!file) return false;
+        }
+
+        std::error_code error;
+        const uintmax_t size = std::filesystem::file_size(m_path, error);
+        if (!error && size > m_maxBytes) return Trim();
+        return true;
+    }
+
+    std::vector<EnumerationRecord> EnumerationStatsLog::Load() const
+    {
+        std::vector<EnumerationRecord> records;
+        std::ifstream file(m_path, std::ios::binary);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            EnumerationRecord record;
+            if (Parse(line, record)) records.push_back(std::move(record));
+        }
+        return records;
+    }
+
+    bool EnumerationStatsLog::Trim()
+    {
+        std::vector<EnumerationRecord> records = Load();
+        const size_t keep = records.size() / 2;
+
+        std::filesystem::path temporary = m_path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+            for (size_t i = records.size() - keep; i < records.size(); ++i)
+            {
+                file << Serialize(records[i]) << '\n';
+            }
+            if (!file) return false;
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, m_path, error);
+        return !error;
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "TreeProvider.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace UIAListCore
+{
+    // Cost of one subtree near the root, e.g. a ribbon or a document pane
+    struct SubtreeCost
+    {
+        std::string Key;  // "Pane \"Ribbon\" #RibbonId", depth 2 keys are prefixed "parent / "
+        size_t Depth{ 0 };
+        size_t Nodes{ 0 };
+        double Milliseconds{ 0 };
+    };
+
+    // One finished enumeration of one window
+    struct EnumerationRecord
+    {
+        std::string ProcessImage;  // e.g. "WINWORD.EXE"
+        int64_t Timestamp{ 0 };    // Seconds since the Unix epoch
+        std::string Mode;          // ToString(WalkMode)
+        size_t Nodes{ 0 };
+        size_t MaxDepth{ 0 };
+        uint64_t Calls{ 0 };       // Cross-process calls, see TreeProvider::Calls
+        double WallMilliseconds{ 0 };
+        std::vector<SubtreeCost> SlowestSubtrees;  // Slowest first
+
+        double MicrosecondsPerNode() const { return Nodes ? WallMilliseconds * 1000.0 / Nodes : 0.0; }
+    };
+
+    // Filled by ControlWalker (or a frontend's own walker) during one enumeration
+    class EnumerationStatsCollector
+    {
+    public:
+        // Subtrees at depth 1 .. TrackedSubtreeDepth are timed
+        static constexpr size_t TrackedSubtreeDepth = 2;
+        static constexpr size_t MaxSlowestSubtrees = 5;
+
+        EnumerationStatsCollector();
+
+        void OnNode(size_t depth);
+        void OnSubtree(std::string key, size_t depth, size_t nodes, double milliseconds);
+
+        size_t Nodes() const { return m_nodes; }
+
+        EnumerationRecord Finish(std::string processImage, const char* mode, uint64_t calls) const;
+
+        // Readable subtree key from the element's properties
+        static std::string SubtreeKey(const ElementProperties& properties, const std::string& parentKey);
+
+    private:
+        std::chrono::steady_clock::time_point m_start;
+        size_t m_nodes{ 0 };
+        size_t m_maxDepth{ 0 };
+        std::vector<SubtreeCost> m_subtrees;
+    };
+
+    // Per-application summary over all logged enumerations
+    struct SubtreeShare
+    {
+        std::string Key;
+        size_t Runs{ 0 };         // Runs in which the subtree was among the slowest
+        double MeanShare{ 0 };    // Of the run's wall time, 0..1
+        double MinShare{ 0 };
+        double MeanMilliseconds{ 0 };
+    };
+
+    struct ApplicationSummary
+    {
+        std::string ProcessImage;
+        size_t Runs{ 0 };
+        double MedianMilliseconds{ 0 };
+        double MaxMilliseconds{ 0 };
+        double MeanNodes{ 0 };
+        double MaxDepth{ 0 };
+        double MeanCallsPerNode{ 0 };
+        double MeanMicrosecondsPerNode{ 0 };
+        std::vector<SubtreeShare> Subtrees;  // Highest mean share first
+
+        // Subtrees that took at least minShare of the time in every run (and
+        // at least minRuns runs), candidates for pruning or a lazier strategy
+        std::vector<std::string> DominantSubtrees(double minShare = 0.8, size_t minRuns = 3) const;
+    };
+
+    // Slowest applications (by median time) first
+    std::vector<ApplicationSummary> Summarize(const std::vector<EnumerationRecord>& records);
+
+    // Rolling log, one record per line. When the file grows past maxBytes the
+    // older half of the records is dropped.
+    class EnumerationStatsLog
+    {
+    public:
+        explicit EnumerationStatsLog(std::filesystem::path path, uintmax_t maxBytes = 512 * 1024);
+
+        bool Append(const EnumerationRecord& record);
+        std::vector<EnumerationRecord> Load() const;
+
+        const std::filesystem::path& Path() const { return m_path; }
+
+        static std::string Serialize(const EnumerationRecord& record);
+        static bool Parse(const std::string& line, EnumerationRecord& record);
+
+    private:
+        bool Trim();
+
+        std::filesystem::path m_path;
+        uintmax_t m_maxBytes;
+    };
+}
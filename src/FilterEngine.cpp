@@ -0,0 +1,390 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "FilterEngine.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        // UIA control type ids
+        constexpr int32_t MenuControlType = 50009;
+        constexpr int32_t MenuBarControlType = 50010;
+        constexpr int32_t MenuItemControlType = 50011;
+        constexpr int32_t TextControlType = 50020;
+        constexpr int32_t WindowControlType = 50032;
+
+        // Scores of one query word in a row, see BestMatch
+        constexpr uint32_t ScoreAnywhere = 1;
+        constexpr uint32_t ScoreWordStart = 2;
+        constexpr uint32_t ScoreNameStart = 3;
+        constexpr uint32_t ScoreExactName = 100;
+
+        // Simple case folding (CaseFolding.txt, statuses C and S) of the Basic
+        // Multilingual Plane, Unicode 14: every Stride-th unit from First to
+        // Last folds to itself plus Delta. Sorted by First.
+        struct FoldRange
+        {
+            char16_t First;
+            char16_t Last;
+            int32_t Delta;
+            uint8_t Stride;
+        };
+
+        constexpr FoldRange FoldRanges[] =
+        {
+            { 0x00B5, 0x00B5, 775, 1 }, { 0x00C0, 0x00D6, 32, 1 }, { 0x00D8, 0x00DE, 32, 1 }, { 0x0100, 0x012E, 1, 2 },
+            { 0x0132, 0x0136, 1, 2 }, { 0x0139, 0x0147, 1, 2 }, { 0x014A, 0x0176, 1, 2 }, { 0x0178, 0x0178, -121, 1 },
+            { 0x0179, 0x017D, 1, 2 }, { 0x017F, 0x017F, -268, 1 }, { 0x0181, 0x0181, 210, 1 },
+            { 0x0182, 0x0184, 1, 2 }, { 0x0186, 0x0186, 206, 1 }, { 0x0187, 0x0187, 1, 1 }, { 0x0189, 0x018A, 205, 1 },
+            { 0x018B, 0x018B, 1, 1 }, { 0x018E, 0x018E, 79, 1 }, { 0x018F, 0x018F, 202, 1 },
+            { 0x0190, 0x0190, 203, 1 }, { 0x0191, 0x0191, 1, 1 }, { 0x0193, 0x0193, 205, 1 },
+            { 0x0194, 0x0194, 207, 1 }, { 0x0196, 0x0196, 211, 1 }, { 0x0197, 0x0197, 209, 1 },
+            { 0x0198, 0x0198, 1, 1 }, { 0x019C, 0x019C, 211, 1 }, { 0x019D, 0x019D, 213, 1 },
+            { 0x019F, 0x019F, 214, 1 }, { 0x01A0, 0x01A4, 1, 2 }, { 0x01A6, 0x01A6, 218, 1 }, { 0x01A7, 0x01A7, 1, 1 },
+            { 0x01A9, 0x01A9, 218, 1 }, { 0x01AC, 0x01AC, 1, 1 }, { 0x01AE, 0x01AE, 218, 1 }, { 0x01AF, 0x01AF, 1, 1 },
+            { 0x01B1, 0x01B2, 217, 1 }, { 0x01B3, 0x01B5, 1, 2 }, { 0x01B7, 0x01B7, 219, 1 }, { 0x01B8, 0x01B8, 1, 1 },
+            { 0x01BC, 0x01BC, 1, 1 }, { 0x01C4, 0x01C4, 2, 1 }, { 0x01C5, 0x01C5, 1, 1 }, { 0x01C7, 0x01C7, 2, 1 },
+            { 0x01C8, 0x01C8, 1, 1 }, { 0x01CA, 0x01CA, 2, 1 }, { 0x01CB, 0x01DB, 1, 2 }, { 0x01DE, 0x01EE, 1, 2 },
+            { 0x01F1, 0x01F1, 2, 1 }, { 0x01F2, 0x01F4, 1, 2 }, { 0x01F6, 0x01F6, -97, 1 }, { 0x01F7, 0x01F7, -56, 1 },
+            { 0x01F8, 0x021E, 1, 2 }, { 0x0220, 0x0220, -130, 1 }, { 0x0222, 0x0232, 1, 2 },
+            { 0x023A, 0x023A, 10795, 1 }, { 0x023B, 0x023B, 1, 1 }, { 0x023D, 0x023D, -163, 1 },
+            { 0x023E, 0x023E, 10792, 1 }, { 0x0241, 0x0241, 1, 1 }, { 0x0243, 0x0243, -195, 1 },
+            { 0x0244, 0x0244, 69, 1 }, { 0x0245, 0x0245, 71, 1 }, { 0x0246, 0x024E, 1, 2 }, { 0x0345, 0x0345, 116, 1 },
+            { 0x0370, 0x0372, 1, 2 }, { 0x0376, 0x0376, 1, 1 }, { 0x037F, 0x037F, 116, 1 }, { 0x0386, 0x0386, 38, 1 },
+            { 0x0388, 0x038A, 37, 1 }, { 0x038C, 0x038C, 64, 1 }, { 0x038E, 0x038F, 63, 1 }, { 0x0391, 0x03A1, 32, 1 },
+            { 0x03A3, 0x03AB, 32, 1 }, { 0x03C2, 0x03C2, 1, 1 }, { 0x03CF, 0x03CF, 8, 1 }, { 0x03D0, 0x03D0, -30, 1 },
+            { 0x03D1, 0x03D1, -25, 1 }, { 0x03D5, 0x03D5, -15, 1 }, { 0x03D6, 0x03D6, -22, 1 },
+            { 0x03D8, 0x03EE, 1, 2 }, { 0x03F0, 0x03F0, -54, 1 }, { 0x03F1, 0x03F1, -48, 1 },
+            { 0x03F4, 0x03F4, -60, 1 }, { 0x03F5, 0x03F5, -64, 1 }, { 0x03F7, 0x03F7, 1, 1 },
+            { 0x03F9, 0x03F9, -7, 1 }, { 0x03FA, 0x03FA, 1, 1 }, { 0x03FD, 0x03FF, -130, 1 },
+            { 0x0400, 0x040F, 80, 1 }, { 0x0410, 0x042F, 32, 1 }, { 0x0460, 0x0480, 1, 2 }, { 0x048A, 0x04BE, 1, 2 },
+            { 0x04C0, 0x04C0, 15, 1 }, { 0x04C1, 0x04CD, 1, 2 }, { 0x04D0, 0x052E, 1, 2 }, { 0x0531, 0x0556, 48, 1 },
+            { 0x10A0, 0x10C5, 7264, 1 }, { 0x10C7, 0x10C7, 7264, 1 }, { 0x10CD, 0x10CD, 7264, 1 },
+            { 0x13F8, 0x13FD, -8, 1 }, { 0x1C80, 0x1C80, -6222, 1 }, { 0x1C81, 0x1C81, -6221, 1 },
+            { 0x1C82, 0x1C82, -6212, 1 }, { 0x1C83, 0x1C84, -6210, 1 }, { 0x1C85, 0x1C85, -6211, 1 },
+            { 0x1C86, 0x1C86, -6204, 1 }, { 0x1C87, 0x1C87, -6180, 1 }, { 0x1C88, 0x1C88, 35267, 1 },
+            { 0x1C90, 0x1CBA, -3008, 1 }, { 0x1CBD, 0x1CBF, -3008, 1 }, { 0x1E00, 0x1E94, 1, 2 },
+            { 0x1E9B, 0x1E9B, -58, 1 }, { 0x1E9E, 0x1E9E, -7615, 1 }, { 0x1EA0, 0x1EFE, 1, 2 },
+            { 0x1F08, 0x1F0F, -8, 1 }, { 0x1F18, 0x1F1D, -8, 1 }, { 0x1F28, 0x1F2F, -8, 1 }, { 0x1F38, 0x1F3F, -8, 1 },
+            { 0x1F48, 0x1F4D, -8, 1 }, { 0x1F59, 0x1F5F, -8, 2 }, { 0x1F68, 0x1F6F, -8, 1 }, { 0x1F88, 0x1F8F, -8, 1 },
+            { 0x1F98, 0x1F9F, -8, 1 }, { 0x1FA8, 0x1FAF, -8, 1 }, { 0x1FB8, 0x1FB9, -8, 1 },
+            { 0x1FBA, 0x1FBB, -74, 1 }, { 0x1FBC, 0x1FBC, -9, 1 }, { 0x1FBE, 0x1FBE, -7173, 1 },
+            { 0x1FC8, 0x1FCB, -86, 1 }, { 0x1FCC, 0x1FCC, -9, 1 }, { 0x1FD8, 0x1FD9, -8, 1 },
+            { 0x1FDA, 0x1FDB, -100, 1 }, { 0x1FE8, 0x1FE9, -8, 1 }, { 0x1FEA, 0x1FEB, -112, 1 },
+            { 0x1FEC, 0x1FEC, -7, 1 }, { 0x1FF8, 0x1FF9, -128, 1 }, { 0x1FFA, 0x1FFB, -126, 1 },
+            { 0x1FFC, 0x1FFC, -9, 1 }, { 0x2126, 0x2126, -7517, 1 }, { 0x212A, 0x212A, -8383, 1 },
+            { 0x212B, 0x212B, -8262, 1 }, { 0x2132, 0x2132, 28, 1 }, { 0x2160, 0x216F, 16, 1 },
+            { 0x2183, 0x2183, 1, 1 }, { 0x24B6, 0x24CF, 26, 1 }, { 0x2C00, 0x2C2F, 48, 1 }, { 0x2C60, 0x2C60, 1, 1 },
+            { 0x2C62, 0x2C62, -10743, 1 }, { 0x2C63, 0x2C63, -3814, 1 }, { 0x2C64, 0x2C64, -10727, 1 },
+            { 0x2C67, 0x2C6B, 1, 2 }, { 0x2C6D, 0x2C6D, -10780, 1 }, { 0x2C6E, 0x2C6E, -10749, 1 },
+            { 0x2C6F, 0x2C6F, -10783, 1 }, { 0x2C70, 0x2C70, -10782, 1 }, { 0x2C72, 0x2C72, 1, 1 },
+            { 0x2C75, 0x2C75, 1, 1 }, { 0x2C7E, 0x2C7F, -10815, 1 }, { 0x2C80, 0x2CE2, 1, 2 },
+            { 0x2CEB, 0x2CED, 1, 2 }, { 0x2CF2, 0x2CF2, 1, 1 }, { 0xA640, 0xA66C, 1, 2 }, { 0xA680, 0xA69A, 1, 2 },
+            { 0xA722, 0xA72E, 1, 2 }, { 0xA732, 0xA76E, 1, 2 }, { 0xA779, 0xA77B, 1, 2 },
+            { 0xA77D, 0xA77D, -35332, 1 }, { 0xA77E, 0xA786, 1, 2 }, { 0xA78B, 0xA78B, 1, 1 },
+            { 0xA78D, 0xA78D, -42280, 1 }, { 0xA790, 0xA792, 1, 2 }, { 0xA796, 0xA7A8, 1, 2 },
+            { 0xA7AA, 0xA7AA, -42308, 1 }, { 0xA7AB, 0xA7AB, -42319, 1 }, { 0xA7AC, 0xA7AC, -42315, 1 },
+            { 0xA7AD, 0xA7AD, -42305, 1 }, { 0xA7AE, 0xA7AE, -42308, 1 }, { 0xA7B0, 0xA7B0, -42258, 1 },
+            { 0xA7B1, 0xA7B1, -42282, 1 }, { 0xA7B2, 0xA7B2, -42261, 1 }, { 0xA7B3, 0xA7B3, 928, 1 },
+            { 0xA7B4, 0xA7C2, 1, 2 }, { 0xA7C4, 0xA7C4, -48, 1 }, { 0xA7C5, 0xA7C5, -42307, 1 },
+            { 0xA7C6, 0xA7C6, -35384, 1 }, { 0xA7C7, 0xA7C9, 1, 2 }, { 0xA7D0, 0xA7D0, 1, 1 },
+            { 0xA7D6, 0xA7D8, 1, 2 }, { 0xA7F5, 0xA7F5, 1, 1 }, { 0xAB70, 0xABBF, -38864, 1 },
+            { 0xFF21, 0xFF3A, 32, 1 }
+        };
+
+        // What \s matches in the Qt frontend's split
+        bool IsSpace(char16_t c)
+        {
+            if (c <= u' ') return c == u' ' || (c >= u'\t' && c <= u'\r');
+            return c == 0x85 || c == 0xA0 || c == 0x1680 || (c >= 0x2000 && c <= 0x200A) ||
+                   c == 0x2028 || c == 0x2029 || c == 0x202F || c == 0x205F || c == 0x3000;
+        }
+
+        // Letters and digits of ASCII, and everything beyond it
+        bool IsWordCharacter(char16_t c)
+        {
+            if (c >= 0x80) return !IsSpace(c);
+            return (c >= u'a' && c <= u'z') || (c >= u'A' && c <= u'Z') || (c >= u'0' && c <= u'9');
+        }
+
+        void AppendFolded(std::u16string& out, std::u16string_view text)
+        {
+            const size_t start = out.size();
+            out.resize(start + text.size());
+            char16_t* folded = &out[start];
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                folded[i] = FoldCase(text[i]);
+            }
+        }
+
+        std::u16string_view Trimmed(std::u16string_view text)
+        {
+            while (!text.empty() && IsSpace(text.front())) text.remove_prefix(1);
+            while (!text.empty() && IsSpace(text.back())) text.remove_suffix(1);
+            return text;
+        }
+    }
+
+    char16_t FoldCase(char16_t c)
+    {
+        // Most names are ASCII
+        if (c < 0x80) return (c >= u'A' && c <= u'Z') ? static_cast<char16_t>(c + 0x20) : c;
+
+        const FoldRange* range = std::upper_bound(std::begin(FoldRanges), std::end(FoldRanges), c,
+            [](char16_t unit, const FoldRange& candidate) { return unit < candidate.First; });
+        if (range == std::begin(FoldRanges)) return c;
+        --range;
+
+        if (c > range->Last || (c - range->First) % range->Stride != 0) return c;
+        return static_cast<char16_t>(c + range->Delta);
+    }
+
+    bool IsListed(int32_t controlType, std::u16string_view name, const ListOptions& options)
+    {
+        if (controlType == TextControlType || controlType == WindowControlType) return false;
+
+        if (options.HideEmptyTitles)
+        {
+            std::u16string_view trimmed = Trimmed(name);
+            if (trimmed.empty() || trimmed == u"(no name)") return false;
+        }
+
+        if (options.HideMenus &&
+            (controlType == MenuControlType || controlType == MenuBarControlType || controlType == MenuItemControlType))
+        {
+            return false;
+        }
+        return true;
+    }
+
+    void FilterEngine::Clear()
+    {
+        m_folded.clear();
+        m_rows.clear();
+        m_matched.clear();
+        m_matches.clear();
+        m_unused = 0;
+    }
+
+    void FilterEngine::Reserve(size_t rows, size_t textUnits)
+    {
+        m_folded.reserve(textUnits);
+        m_rows.reserve(rows);
+        m_matched.reserve(rows);
+        m_matches.reserve(rows);
+    }
+
+    void FilterEngine::Add(std::u16string_view text, std::u16string_view name)
+    {
+        Row row;
+        row.Text = static_cast<uint32_t>(m_folded.size());
+        row.TextSize = static_cast<uint32_t>(text.size());
+        AppendFolded(m_folded, text);
+        row.Name = static_cast<uint32_t>(m_folded.size());
+        row.NameSize = static_cast<uint32_t>(name.size());
+        AppendFolded(m_folded, name);
+
+        const bool matched = Matches(row);
+        m_matched.push_back(matched ? 1 : 0);
+        if (matched) m_matches.push_back(static_cast<uint32_t>(m_rows.size()));
+        m_rows.push_back(row);
+    }
+
+    void FilterEngine::Splice(size_t first, size_t count, const std::vector<std::u16string_view>& texts,
+                              const std::vector<std::u16string_view>& names)
+    {
+        const size_t end = first + count;
+        for (size_t index = first; index < end; ++index)
+        {
+            m_unused += m_rows[index].TextSize + m_rows[index].NameSize;
+        }
+
+        std::vector<Row> rows(texts.size());
+        std::vector<uint8_t> matched(texts.size());
+        for (size_t i = 0; i < texts.size(); ++i)
+        {
+            Row& row = rows[i];
+            row.Text = static_cast<uint32_t>(m_folded.size());
+            row.TextSize = static_cast<uint32_t>(texts[i].size());
+            AppendFolded(m_folded, texts[i]);
+            row.Name = static_cast<uint32_t>(m_folded.size());
+            row.NameSize = static_cast<uint32_t>(names[i].size());
+            AppendFolded(m_folded, names[i]);
+            matched[i] = Matches(row) ? 1 : 0;
+        }
+
+        m_rows.erase(m_rows.begin() + first, m_rows.begin() + end);
+        m_rows.insert(m_rows.begin() + first, rows.begin(), rows.end());
+        m_matched.erase(m_matched.begin() + first, m_matched.begin() + end);
+        m_matched.insert(m_matched.begin() + first, matched.begin(), matched.end());
+
+        // Still in list order: those before, the new ones, those after moved along
+        std::vector<uint32_t> matches;
+        matches.reserve(m_matches.size() + rows.size());
+        for (uint32_t index : m_matches)
+        {
+            if (index < first) matches.push_back(index);
+        }
+        for (size_t i = 0; i < rows.size(); ++i)
+        {
+            if (matched[i]) matches.push_back(static_cast<uint32_t>(first + i));
+        }
+        for (uint32_t index : m_matches)
+        {
+            if (index >= end) matches.push_back(static_cast<uint32_t>(index - count + rows.size()));
+        }
+        m_matches.swap(matches);
+
+        if (2 * m_unused > m_folded.size())
+        {
+            std::u16string folded;
+            folded.reserve(m_folded.size() - m_unused);
+            for (Row& row : m_rows)
+            {
+                // A row's name is folded right after its text
+                const uint32_t start = static_cast<uint32_t>(folded.size());
+                folded.append(m_folded, row.Text, row.TextSize + row.NameSize);
+                row.Text = start;
+                row.Name = start + row.TextSize;
+            }
+            m_folded.swap(folded);
+            m_unused = 0;
+        }
+    }
+
+    size_t FilterEngine::SetQuery(std::u16string_view query)
+    {
+        std::u16string folded;
+        AppendFolded(folded, query);
+
+        // Every word of a query that was typed on contains a word of the old
+        // one, so only the old matches can still match
+        const bool narrowing = folded.size() >= m_query.size() && folded.compare(0, m_query.size(), m_query) == 0;
+        m_query = std::move(folded);
+
+        m_words.clear();
+        size_t position = 0;
+        while (position < m_query.size())
+        {
+            while (position < m_query.size() && IsSpace(m_query[position])) ++position;
+            size_t end = position;
+            while (end < m_query.size() && !IsSpace(m_query[end])) ++end;
+            if (end > position) m_words.emplace_back(m_query, position, end - position);
+            position = end;
+        }
+
+        if (narrowing)
+        {
+            size_t kept = 0;
+            for (uint32_t index : m_matches)
+            {
+                if (Matches(m_rows[index]))
+                {
+                    m_matches[kept++] = index;
+                }
+                else
+                {
+                    m_matched[index] = 0;
+                }
+            }
+            m_matches.resize(kept);
+        }
+        else
+        {
+            m_matches.clear();
+            for (size_t index = 0; index < m_rows.size(); ++index)
+            {
+                const bool matched = Matches(m_rows[index]);
+                m_matched[index] = matched ? 1 : 0;
+                if (matched) m_matches.push_back(static_cast<uint32_t>(index));
+            }
+        }
+        return m_matches.size();
+    }
+
+    size_t FilterEngine::BestMatch() const
+    {
+        if (m_matches.empty()) return NoMatch;
+        if (m_words.empty()) return m_matches.front();
+
+        size_t best = NoMatch;
+        uint32_t bestScore = 0;
+        for (uint32_t index : m_matches)
+        {
+            const uint32_t score = Score(m_rows[index]);
+            if (score > bestScore)
+            {
+                best = index;
+                bestScore = score;
+            }
+        }
+        return best;
+    }
+
+    bool FilterEngine::Matches(const Row& row) const
+    {
+        const std::u16string_view text = Folded(row.Text, row.TextSize);
+        for (const std::u16string& word : m_words)
+        {
+            if (text.find(word) == std::u16string_view::npos) return false;
+        }
+        return true;
+    }
+
+    uint32_t FilterEngine::Score(const Row& row) const
+    {
+        const std::u16string_view text = Folded(row.Text, row.TextSize);
+        const std::u16string_view name = Folded(row.Name, row.NameSize);
+
+        uint32_t score = Trimmed(name) == Trimmed(m_query) ? ScoreExactName : 0;
+        for (const std::u16string& word : m_words)
+        {
+            if (name.substr(0, word.size()) == word)
+            {
+                score += ScoreNameStart;
+                continue;
+            }
+
+            uint32_t wordScore = ScoreAnywhere;
+            for (size_t found = text.find(word); found != std::u16string_view::npos; found = text.find(word, found + 1))
+            {
+                if (found == 0 || !IsWordCharacter(text[found - 1]))
+                {
+                    wordScore = ScoreWordStart;
+                    break;
+                }
+            }
+            score += wordScore;
+        }
+        return score;
+    }
+
+    size_t FilterEngine::MemoryBytes() const
+    {
+        size_t bytes = m_folded.capacity() * sizeof(char16_t) + m_rows.capacity() * sizeof(Row) +
+                       m_matched.capacity() + m_matches.capacity() * sizeof(uint32_t) +
+                       m_query.capacity() * sizeof(char16_t);
+        for (const std::u16string& word : m_words)
+        {
+            bytes += sizeof(word) + word.capacity() * sizeof(char16_t);
+        }
+        return bytes;
+    }
+
+    std::u16string_view FilterEngine::Folded(uint32_t offset, uint32_t size) const
+    {
+        return std::u16string_view(m_folded).substr(offset, size);
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UIAListCore
+{
+    // Unicode simple case folding of one UTF-16 unit, so the folded text
+    // keeps its length. Characters beyond the BMP are compared as they are.
+    char16_t FoldCase(char16_t c);
+
+    // Which controls get a row before anything is typed
+    struct ListOptions
+    {
+        bool HideEmptyTitles{ false };  // Unnamed controls, and names that are only whitespace
+        bool HideMenus{ false };        // Menus, menu bars and menu items
+    };
+
+    // Text and window controls never get a row: their names repeat their neighbours'
+    bool IsListed(int32_t controlType, std::u16string_view name, const ListOptions& options);
+
+    // The list filter of both frontends. A row stays when its text contains
+    // every whitespace-separated word of the query, ignoring case. Rows are
+    // folded once when they are added, into one buffer; typing on narrows
+    // the previous matches instead of scanning every row again.
+    class FilterEngine
+    {
+    public:
+        static constexpr size_t NoMatch = SIZE_MAX;
+
+        void Clear();
+        void Reserve(size_t rows, size_t textUnits);
+
+        // Rows in list order. name is the control's own name, text what the
+        // list shows ("Button: OK"); a row added while a query is set is
+        // checked against it.
+        void Add(std::u16string_view text, std::u16string_view name);
+        size_t Size() const { return m_rows.size(); }
+
+        // Replaces count rows at first with texts and names, as Add would add
+        // them; the rows after them move along. What the old rows folded to
+        // is reclaimed once it is more than half the buffer.
+        void Splice(size_t first, size_t count, const std::vector<std::u16string_view>& texts,
+                    const std::vector<std::u16string_view>& names);
+
+        // Filters the rows; returns how many match
+        size_t SetQuery(std::u16string_view query);
+        bool HasQuery() const { return !m_words.empty(); }
+
+        bool IsMatch(size_t row) const { return m_matched[row] != 0; }
+
+        // Heap held for the rows, for the memory budget
+        size_t MemoryBytes() const;
+
+        // Matching rows in list order
+        const std::vector<uint32_t>& Matches() const { return m_matches; }
+
+        // The match to select: the name equal to the query, then names
+        // starting with its words, then words starting with them, then any;
+        // the first in list order among equals. NoMatch without matches.
+        size_t BestMatch() const;
+
+    private:
+        struct Row
+        {
+            uint32_t Text;        // Offset into m_folded
+            uint32_t TextSize;
+            uint32_t Name;
+            uint32_t NameSize;
+        };
+
+        bool Matches(const Row& row) const;
+        uint32_t Score(const Row& row) const;
+        std::u16string_view Folded(uint32_t offset, uint32_t size) const;
+
+        std::u16string m_folded;                // Folded texts and names of all rows
+        size_t m_unused{ 0 };                   // Units of m_folded no row uses since Splice
+        std::vector<Row> m_rows;
+        std::vector<uint8_t> m_matched;         // Per row
+        std::vector<uint32_t> m_matches;
+
+        std::u16string m_query;                 // Folded, as last set
+        std::vector<std::u16string> m_words;    // Of m_query
+    };
+}
@@ -0,0 +1,342 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "InputInjector.h"
+#include "ElementLocator.h"
+
+#include <limits.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        // Serializes the gestures and guards the last click below
+        std::mutex g_inputMutex;
+
+        // Time and place of the last injected click
+        DWORD g_lastClickTick = 0;
+        POINT g_lastClickPoint = { LONG_MIN, LONG_MIN };
+
+        INPUT MouseInput(DWORD flags, POINT point)
+        {
+            // Absolute coordinates are normalized to 0..65535 over the virtual desktop
+            int left = GetSystemMetrics(SM_XVIRTUALSCREEN);
+            int top = GetSystemMetrics(SM_YVIRTUALSCREEN);
+            int width = GetSystemMetrics(SM_CXVIRTUALSCREEN);
+            int height = GetSystemMetrics(SM_CYVIRTUALSCREEN);
+
+            INPUT input = {};
+            input.type = INPUT_MOUSE;
+            input.mi.dx = MulDiv(point.x - left, 65535, width > 1 ? width - 1 : 1);
+            input.mi.dy = MulDiv(point.y - top, 65535, height > 1 ? height - 1 : 1);
+            input.mi.dwFlags = flags | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK;
+            return input;
+        }
+
+        // The cached runtime id, else the element's own; empty when unknown
+        std::vector<int> RuntimeIdOf(IUIAutomationElement* element)
+        {
+            std::vector<int> id = ElementLocator::CachedRuntimeId(element);
+            if (!id.empty()) return id;
+
+            SAFEARRAY* array = nullptr;
+            if (FAILED(element->GetRuntimeId(&array)) || !array) return id;
+            LONG lower = 0;
+            LONG upper = -1;
+            SafeArrayGetLBound(array, 1, &lower);
+            SafeArrayGetUBound(array, 1, &upper);
+            int* data = nullptr;
+            if (upper >= lower && SUCCEEDED(SafeArrayAccessData(array, (void**)&data)))
+            {
+                id.assign(data, data + (upper - lower + 1));
+                SafeArrayUnaccessData(array);
+            }
+            SafeArrayDestroy(array);
+            return id;
+        }
+    }
+
+    bool InputInjector::Click(POINT point)
+    {
+        return SendClicks(point, 1);
+    }
+
+    bool InputInjector::DoubleClick(POINT point)
+    {
+        return SendClicks(point, 2);
+    }
+
+    bool InputInjector::SendClicks(POINT point, int clicks)
+    {
+        std::lock_guard<std::mutex> lock(g_inputMutex);
+
+        // A single click right after another one on the same spot would be
+        // read as a double-click; only then wait out the rest of the interval
+        if (clicks == 1 &&
+            abs(point.x - g_lastClickPoint.x) <= GetSystemMetrics(SM_CXDOUBLECLK) / 2 &&
+            abs(point.y - g_lastClickPoint.y) <= GetSystemMetrics(SM_CYDOUBLECLK) / 2)
+        {
+            DWORD elapsed = GetTickCount() - g_lastClickTick;
+            DWORD separation = std::min<DWORD>(GetDoubleClickTime(), MaxClickSeparationMs);
+            if (elapsed <= separation)
+            {
+                Sleep(separation - elapsed + 1);
+            }
+        }
+
+        INPUT inputs[5];
+        UINT count = 0;
+        inputs[count++] = MouseInput(MOUSEEVENTF_MOVE, point);
+        for (int i = 0; i < clicks; ++i)
+        {
+            inputs[count++] = MouseInput(MOUSEEVENTF_LEFTDOWN, point);
+            inputs[count++] = MouseInput(MOUSEEVENTF_LEFTUP, point);
+        }
+
+        UINT sent = SendInput(count, inputs, sizeof(INPUT));
+
+        g_lastClickTick = GetTickCount();
+        g_lastClickPoint = point;
+
+        // Fewer events than requested means input was blocked (UIPI or BlockInput)
+        return sent == count;
+    }
+
+    bool InputInjector::PressKey(WORD virtualKey)
+    {
+        INPUT inputs[2] = {};
+        inputs[0].type = INPUT_KEYBOARD;
+        inputs[0].ki.wVk = virtualKey;
+        inputs[1].type = INPUT_KEYBOARD;
+        inputs[1].ki.wVk = virtualKey;
+        inputs[1].ki.dwFlags = KEYEVENTF_KEYUP;
+
+        std::lock_guard<std::mutex> lock(g_inputMutex);
+        return SendInput(2, inputs, sizeof(INPUT)) == 2;
+    }
+
+
+    // Event handler that signals a Win32 event when the event it is armed
+    // for arrives. UI Automation calls it on its own threads; senders are
+    // told apart by runtime id, read before the lock is taken.
+    class AutomationEventSignal : public IUIAutomationEventHandler, public IUIAutomationFocusChangedEventHandler
+    {
+    public:
+        AutomationEventSignal()
+            : m_refCount(1), m_eventId(0), m_armed(false)
+        {
+            m_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        }
+
+        HANDLE Event() const { return m_event; }
+
+        // Signal for eventId (0 for focus changes) raised by target, by any
+        // element when target is null or its runtime id cannot be read
+        void Arm(IUIAutomationElement* target, EVENTID eventId)
+        {
+            std::vector<int> targetId = target ? RuntimeIdOf(target) : std::vector<int>();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_targetId.swap(targetId);
+            m_eventId = eventId;
+            m_armed = true;
+            ResetEvent(m_event);
+        }
+
+        void Disarm()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_targetId.clear();
+            m_armed = false;
+        }
+
+        // IUnknown
+        ULONG STDMETHODCALLTYPE AddRef() override
+        {
+            return InterlockedIncrement(&m_refCount);
+        }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            ULONG refCount = InterlockedDecrement(&m_refCount);
+            if (refCount == 0) delete this;
+            return refCount;
+        }
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override
+        {
+            if (!ppv) return E_POINTER;
+
+            if (riid == __uuidof(IUnknown) || riid == __uuidof(IUIAutomationEventHandler))
+            {
+                *ppv = static_cast<IUIAutomationEventHandler*>(this);
+            }
+            else if (riid == __uuidof(IUIAutomationFocusChangedEventHandler))
+            {
+                *ppv = static_cast<IUIAutomationFocusChangedEventHandler*>(this);
+            }
+            else
+            {
+                *ppv = nullptr;
+                return E_NOINTERFACE;
+            }
+
+            AddRef();
+            return S_OK;
+        }
+
+        // IUIAutomationEventHandler
+        HRESULT STDMETHODCALLTYPE HandleAutomationEvent(IUIAutomationElement* sender, EVENTID eventId) override
+        {
+            Signal(sender, eventId);
+            return S_OK;
+        }
+
+        // IUIAutomationFocusChangedEventHandler
+        HRESULT STDMETHODCALLTYPE HandleFocusChangedEvent(IUIAutomationElement* sender) override
+        {
+            Signal(sender, 0);
+            return S_OK;
+        }
+
+    private:
+        ~AutomationEventSignal()
+        {
+            if (m_event) CloseHandle(m_event);
+        }
+
+        void Signal(IUIAutomationElement* sender, EVENTID eventId)
+        {
+            // Cached with the handler's cache request, no call to the provider
+            const std::vector<int> senderId = sender ? RuntimeIdOf(sender) : std::vector<int>();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_armed || eventId != m_eventId) return;
+            if (m_targetId.empty() || senderId == m_targetId) SetEvent(m_event);
+        }
+
+        LONG m_refCount;
+        HANDLE m_event;
+
+        std::mutex m_mutex;  // Guards the armed state against the UI Automation threads
+        std::vector<int> m_targetId;
+        EVENTID m_eventId;
+        bool m_armed;
+    };
+
+    namespace
+    {
+        // The calling thread's handlers, see AutomationEventHandlers
+        struct ThreadHandlers
+        {
+            IUIAutomation* Automation{ nullptr };
+            AutomationEventSignal* Signal{ nullptr };
+            IUIAutomationCacheRequest* CacheRequest{ nullptr };  // Senders come with their runtime id
+            bool Attempted{ false };
+            bool Focus{ false };
+        };
+
+        thread_local ThreadHandlers t_handlers;
+
+        // The thread's signal, registering the focus handler on the first call
+        ThreadHandlers& ThreadSignal(IUIAutomation* automation)
+        {
+            ThreadHandlers& handlers = t_handlers;
+            if (!handlers.Attempted && automation)
+            {
+                // A failed registration is not retried for every action
+                handlers.Attempted = true;
+                handlers.Automation = automation;
+                handlers.Automation->AddRef();
+                handlers.Signal = new AutomationEventSignal();
+
+                if (SUCCEEDED(automation->CreateCacheRequest(&handlers.CacheRequest)) &&
+                    FAILED(handlers.CacheRequest->AddProperty(UIA_RuntimeIdPropertyId)))
+                {
+                    handlers.CacheRequest->Release();
+                    handlers.CacheRequest = nullptr;
+                }
+                handlers.Focus = SUCCEEDED(automation->AddFocusChangedEventHandler(handlers.CacheRequest, handlers.Signal));
+            }
+            return handlers;
+        }
+    }
+
+    void AutomationEventHandlers::Unregister()
+    {
+        ThreadHandlers& handlers = t_handlers;
+        if (handlers.Focus) handlers.Automation->RemoveFocusChangedEventHandler(handlers.Signal);
+
+        if (handlers.CacheRequest) handlers.CacheRequest->Release();
+        if (handlers.Signal) handlers.Signal->Release();
+        if (handlers.Automation) handlers.Automation->Release();
+        handlers = ThreadHandlers();
+    }
+
+    AutomationEventWait::AutomationEventWait(IUIAutomation* automation, IUIAutomationElement* element, EVENTID eventId)
+        : m_signal(nullptr), m_automation(nullptr), m_watched(nullptr), m_eventId(eventId)
+    {
+        ThreadHandlers& handlers = ThreadSignal(automation);
+        if (!element || !handlers.Signal || !handlers.Signal->Event()) return;
+
+        // Armed first: the event may come before registering returns
+        handlers.Signal->Arm(element, eventId);
+        if (FAILED(automation->AddAutomationEventHandler(eventId, element, TreeScope_Element, handlers.CacheRequest,
+                                                         handlers.Signal)))
+        {
+            handlers.Signal->Disarm();
+            return;
+        }
+        m_signal = handlers.Signal;
+        m_automation = automation;
+        m_automation->AddRef();
+        m_watched = element;
+        m_watched->AddRef();
+    }
+
+    AutomationEventWait::AutomationEventWait(IUIAutomation* automation, IUIAutomationElement* element)
+        : m_signal(nullptr), m_automation(nullptr), m_watched(nullptr), m_eventId(0)
+    {
+        ThreadHandlers& handlers = ThreadSignal(automation);
+        if (handlers.Focus && handlers.Signal->Event())
+        {
+            m_signal = handlers.Signal;
+            m_signal->Arm(element, 0);
+        }
+    }
+
+    AutomationEventWait::~AutomationEventWait()
+    {
+        if (m_signal) m_signal->Disarm();
+        if (m_watched)
+        {
+            // Blocks until a call of the handler under way returned
+            m_automation->RemoveAutomationEventHandler(m_eventId, m_watched, m_signal);
+            m_watched->Release();
+            m_automation->Release();
+        }
+    }
+
+    bool AutomationEventWait::Wait(DWORD timeoutMs)
+    {
+        if (!m_signal)
+        {
+            Sleep(std::min<DWORD>(timeoutMs, UnconfirmedDelayMs));
+            return false;
+        }
+
+        return WaitForSingleObject(m_signal->Event(), timeoutMs) == WAIT_OBJECT_0;
+    }
+}
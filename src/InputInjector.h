@@ -0,0 +1,89 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+// No pch.h here: shared by the WinUI and the Qt frontend
+#include <windows.h>
+#include <UIAutomation.h>
+
+namespace UIAListCore
+{
+    // Synthesized input via SendInput.
+    // Each gesture (move + button presses) is a single SendInput batch, so no
+    // other input can interleave and no settle delay is needed after the move.
+    // Safe to call from any thread; gestures are injected one at a time.
+    class InputInjector
+    {
+    public:
+        // Left click at a screen point. A click inside the double-click
+        // rectangle of the previous one waits out the rest of the system
+        // double-click time, at most MaxClickSeparationMs, so two separate
+        // clicks on the same spot are not merged into a double-click.
+        static bool Click(POINT point);
+
+        // Left double-click at a screen point, both clicks in one batch so they
+        // always land inside the system double-click time and rectangle
+        static bool DoubleClick(POINT point);
+
+        // Press and release a key
+        static bool PressKey(WORD virtualKey);
+
+        // The Windows default double-click time. A longer system setting can
+        // still merge two clicks within it, but never stalls the caller longer.
+        static constexpr DWORD MaxClickSeparationMs = 500;
+
+    private:
+        static bool SendClicks(POINT point, int clicks);
+    };
+
+    class AutomationEventSignal;
+
+    // The UI Automation event handler of the calling thread for focus
+    // changes anywhere. Registered by the thread's first AutomationEventWait
+    // and kept, so an action does not pay for adding and removing it.
+    // Invoked events are watched on the action's element only, for the
+    // length of its wait. Unregister before the thread uninitializes COM.
+    class AutomationEventHandlers
+    {
+    public:
+        static void Unregister();
+    };
+
+    // Waits for a UI Automation event with a timeout.
+    // Construct before triggering the action so the event cannot be missed.
+    class AutomationEventWait
+    {
+    public:
+        // Wait for eventId (UIA_Invoke_InvokedEventId) raised by element
+        AutomationEventWait(IUIAutomation* automation, IUIAutomationElement* element, EVENTID eventId);
+
+        // Wait for focus to move to element, or to move anywhere when element is null
+        AutomationEventWait(IUIAutomation* automation, IUIAutomationElement* element);
+
+        ~AutomationEventWait();
+
+        AutomationEventWait(const AutomationEventWait&) = delete;
+        AutomationEventWait& operator=(const AutomationEventWait&) = delete;
+
+        // True when the event arrived within timeoutMs. Without a registered
+        // handler this sleeps the short fixed delay the actions used before
+        // (UnconfirmedDelayMs at most) and returns false.
+        bool Wait(DWORD timeoutMs);
+
+        static constexpr DWORD UnconfirmedDelayMs = 50;
+
+    private:
+        AutomationEventSignal* m_signal;  // The thread's, armed for this wait; null without a handler
+        IUIAutomation* m_automation;
+        IUIAutomationElement* m_watched;  // Invoked events are registered on it for this wait
+        EVENTID m_eventId;
+    };
+}
@@ -0,0 +1,481 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        // A record is WordCount words: format pointer, timestamp, a header
+        // (level, argument count, thread, 4 bits of type per argument) and
+        // the packed arguments, 8 bytes each or a length byte and UTF-8
+        constexpr size_t WordCount = 16;
+        constexpr size_t PayloadWord = 3;
+        constexpr size_t PayloadBytes = (WordCount - PayloadWord) * sizeof(uint64_t);
+
+        struct Record
+        {
+            uint64_t Words[WordCount];
+
+            const char* Format() const { return reinterpret_cast<const char*>(static_cast<uintptr_t>(Words[0])); }
+            uint64_t Time() const { return Words[1]; }
+            LogLevel Level() const { return static_cast<LogLevel>(Words[2] & 0xF); }
+            size_t Count() const { return static_cast<size_t>((Words[2] >> 4) & 0xF); }
+            uint32_t Thread() const { return static_cast<uint32_t>((Words[2] >> 8) & 0xFFFF); }
+            LogArgument::Type ArgumentType(size_t index) const
+            {
+                return static_cast<LogArgument::Type>((Words[2] >> (24 + 4 * index)) & 0xF);
+            }
+            const unsigned char* Payload() const { return reinterpret_cast<const unsigned char*>(&Words[PayloadWord]); }
+        };
+
+        const std::chrono::steady_clock::time_point& Epoch()
+        {
+            static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+            return epoch;
+        }
+
+        uint64_t NowMicroseconds()
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - Epoch()).count());
+        }
+
+        std::string& RequestedFile()
+        {
+            static std::string path;
+            return path;
+        }
+
+        // Appends one code point as UTF-8 if it fits, returns the bytes written
+        size_t AppendCodePoint(uint32_t codePoint, unsigned char* out, size_t room)
+        {
+            if (codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) codePoint = 0xFFFD;
+
+            if (codePoint < 0x80)
+            {
+                if (room < 1) return 0;
+                out[0] = static_cast<unsigned char>(codePoint);
+                return 1;
+            }
+            if (codePoint < 0x800)
+            {
+                if (room < 2) return 0;
+                out[0] = static_cast<unsigned char>(0xC0 | (codePoint >> 6));
+                out[1] = static_cast<unsigned char>(0x80 | (codePoint & 0x3F));
+                return 2;
+            }
+            if (codePoint < 0x10000)
+            {
+                if (room < 3) return 0;
+                out[0] = static_cast<unsigned char>(0xE0 | (codePoint >> 12));
+                out[1] = static_cast<unsigned char>(0x80 | ((codePoint >> 6) & 0x3F));
+                out[2] = static_cast<unsigned char>(0x80 | (codePoint & 0x3F));
+                return 3;
+            }
+            if (room < 4) return 0;
+            out[0] = static_cast<unsigned char>(0xF0 | (codePoint >> 18));
+            out[1] = static_cast<unsigned char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out[2] = static_cast<unsigned char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out[3] = static_cast<unsigned char>(0x80 | (codePoint & 0x3F));
+            return 4;
+        }
+
+        // Copies text as UTF-8, cut at a character boundary when it does not fit
+        size_t CopyText(const LogArgument& argument, unsigned char* out, size_t room)
+        {
+            size_t written = 0;
+            switch (argument.GetType())
+            {
+            case LogArgument::Type::Utf8:
+            {
+                const unsigned char* text = static_cast<const unsigned char*>(argument.Pointer());
+                written = std::min(argument.Size(), room);
+                if (written < argument.Size())
+                {
+                    while (written > 0 && (text[written] & 0xC0) == 0x80) --written;
+                }
+                std::memcpy(out, text, written);
+                break;
+            }
+            case LogArgument::Type::Utf16:
+            {
+                const char16_t* text = static_cast<const char16_t*>(argument.Pointer());
+                for (size_t i = 0; i < argument.Size(); ++i)
+                {
+                    uint32_t codePoint = text[i];
+                    if (codePoint >= 0xD800 && codePoint <= 0xDBFF && i + 1 < argument.Size() &&
+                        text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF)
+                    {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (text[++i] - 0xDC00);
+                    }
+                    size_t bytes = AppendCodePoint(codePoint, out + written, room - written);
+                    if (bytes == 0) break;
+                    written += bytes;
+                }
+                break;
+            }
+            case LogArgument::Type::Utf32:
+            {
+                const char32_t* text = static_cast<const char32_t*>(argument.Pointer());
+                for (size_t i = 0; i < argument.Size(); ++i)
+                {
+                    size_t bytes = AppendCodePoint(text[i], out + written, room - written);
+                    if (bytes == 0) break;
+                    written += bytes;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+            return written;
+        }
+
+        bool IsText(LogArgument::Type type)
+        {
+            return type == LogArgument::Type::Utf8 || type == LogArgument::Type::Utf16 ||
+                   type == LogArgument::Type::Utf32;
+        }
+
+        // Renders one record into line (always terminated), returns its length
+        size_t RenderRecord(const Record& record, char* line, size_t size)
+        {
+            const uint64_t time = record.Time();
+            int length = std::snprintf(line, size, "%6llu.%06llu [%u] %-7s ",
+                                       static_cast<unsigned long long>(time / 1000000),
+                                       static_cast<unsigned long long>(time % 1000000),
+                                       record.Thread(), ToString(record.Level()));
+            size_t used = length > 0 ? std::min(static_cast<size_t>(length), size - 1) : 0;
+
+            auto append = [&](const char* text, size_t count) {
+                count = std::min(count, size - 1 - used);
+                std::memcpy(line + used, text, count);
+                used += count;
+            };
+
+            const unsigned char* payload = record.Payload();
+            size_t offset = 0;
+            size_t argument = 0;
+            for (const char* format = record.Format(); *format; ++format)
+            {
+                if (format[0] != '{' || format[1] != '}' || argument >= record.Count())
+                {
+                    append(format, 1);
+                    continue;
+                }
+                ++format;
+
+                LogArgument::Type type = record.ArgumentType(argument++);
+                if (IsText(type))
+                {
+                    size_t bytes = payload[offset];
+                    append(reinterpret_cast<const char*>(payload + offset + 1), bytes);
+                    offset += 1 + bytes;
+                    continue;
+                }
+
+                uint64_t raw;
+                std::memcpy(&raw, payload + offset, sizeof(raw));
+                offset += sizeof(raw);
+
+                char value[32];
+                switch (type)
+                {
+                case LogArgument::Type::Signed:
+                    std::snprintf(value, sizeof(value), "%lld", static_cast<long long>(raw));
+                    break;
+                case LogArgument::Type::Unsigned:
+                    std::snprintf(value, sizeof(value), "%llu", static_cast<unsigned long long>(raw));
+                    break;
+                case LogArgument::Type::Hex:
+                    std::snprintf(value, sizeof(value), "0x%08llX", static_cast<unsigned long long>(raw));
+                    break;
+                case LogArgument::Type::Double:
+                {
+                    double number;
+                    std::memcpy(&number, &raw, sizeof(number));
+                    std::snprintf(value, sizeof(value), "%g", number);
+                    break;
+                }
+                case LogArgument::Type::Bool:
+                    std::snprintf(value, sizeof(value), "%s", raw ? "true" : "false");
+                    break;
+                default:
+                    std::snprintf(value, sizeof(value), "0x%llx", static_cast<unsigned long long>(raw));
+                    break;
+                }
+                append(value, std::strlen(value));
+            }
+
+            append("\n", 1);
+            line[used] = '\0';
+            return used;
+        }
+    }
+
+    const char* ToString(LogLevel level)
+    {
+        switch (level)
+        {
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO";
+        case LogLevel::Warning: return "WARNING";
+        case LogLevel::Error: return "ERROR";
+        }
+        return "?";
+    }
+
+    // Written by its owning thread only. Slots are seqlocked like the trace
+    // buffer's: Sequence is 0 while being written, ticket + 1 after.
+    struct LogBuffer::Ring
+    {
+        static constexpr size_t Capacity = 512;
+
+        struct Slot
+        {
+            std::atomic<uint64_t> Sequence{ 0 };
+            std::atomic<uint64_t> Words[WordCount];
+        };
+
+        Slot Slots[Capacity];
+        std::atomic<uint64_t> Next{ 0 };
+        std::atomic<bool> InUse{ true };
+        uint32_t Thread{ 0 };
+        Ring* NextRing{ nullptr };
+
+        // Copies the slot out, false if it is empty or was overwritten meanwhile
+        bool Read(uint64_t ticket, Record& record) const
+        {
+            const Slot& slot = Slots[ticket % Capacity];
+            if (slot.Sequence.load(std::memory_order_acquire) != ticket + 1) return false;
+            for (size_t i = 0; i < WordCount; ++i)
+            {
+                record.Words[i] = slot.Words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return slot.Sequence.load(std::memory_order_relaxed) == ticket + 1;
+        }
+    };
+
+    LogBuffer& LogBuffer::Instance()
+    {
+        static LogBuffer instance;
+        return instance;
+    }
+
+    void LogBuffer::InitializeFromEnvironment()
+    {
+        Epoch();
+        const char* path = std::getenv("UIALIST_LOG");
+        if (path && *path)
+        {
+            RequestedFile() = path;
+            Instance();
+            std::signal(SIGSEGV, &LogBuffer::OnCrash);
+            std::signal(SIGABRT, &LogBuffer::OnCrash);
+            std::signal(SIGFPE, &LogBuffer::OnCrash);
+            std::signal(SIGILL, &LogBuffer::OnCrash);
+        }
+    }
+
+    bool LogBuffer::WriteRequestedFile()
+    {
+        if (RequestedFile().empty()) return false;
+        return Instance().WriteFile(RequestedFile());
+    }
+
+    LogBuffer::Ring& LogBuffer::ThreadRing()
+    {
+        // Hands the ring back when the thread ends, the next new thread reuses it
+        struct Lease
+        {
+            Ring* Leased{ nullptr };
+            ~Lease()
+            {
+                if (Leased) Leased->InUse.store(false, std::memory_order_release);
+            }
+        };
+        thread_local Lease lease;
+        if (lease.Leased) return *lease.Leased;
+
+        Ring* ring = nullptr;
+        for (Ring* candidate = m_rings.load(std::memory_order_acquire); candidate; candidate = candidate->NextRing)
+        {
+            bool free = false;
+            if (candidate->InUse.compare_exchange_strong(free, true, std::memory_order_acquire))
+            {
+                ring = candidate;
+                break;
+            }
+        }
+
+        if (!ring)
+        {
+            // Once per thread, never freed; readers may walk the list at any time
+            ring = new Ring();
+            ring->NextRing = m_rings.load(std::memory_order_relaxed);
+            while (!m_rings.compare_exchange_weak(ring->NextRing, ring, std::memory_order_release,
+                                                  std::memory_order_relaxed)) {}
+        }
+
+        ring->Thread = m_nextThread.fetch_add(1, std::memory_order_relaxed);
+        lease.Leased = ring;
+        return *ring;
+    }
+
+    void LogBuffer::Write(LogLevel level, const char* format, const LogArgument* arguments, size_t count)
+    {
+        Ring& ring = ThreadRing();
+
+        Record record{};
+        record.Words[0] = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(format));
+        record.Words[1] = NowMicroseconds();
+
+        unsigned char* payload = reinterpret_cast<unsigned char*>(&record.Words[PayloadWord]);
+        size_t used = 0;
+        uint64_t types = 0;
+        size_t packed = 0;
+        for (; packed < count && packed < MaxArguments; ++packed)
+        {
+            const LogArgument& argument = arguments[packed];
+            if (IsText(argument.GetType()))
+            {
+                if (used + 1 > PayloadBytes) break;
+                size_t bytes = CopyText(argument, payload + used + 1, std::min<size_t>(PayloadBytes - used - 1, 255));
+                payload[used] = static_cast<unsigned char>(bytes);
+                used += 1 + bytes;
+                types |= static_cast<uint64_t>(LogArgument::Type::Utf8) << (4 * packed);
+            }
+            else
+            {
+                if (used + sizeof(uint64_t) > PayloadBytes) break;
+                uint64_t raw = 0;
+                switch (argument.GetType())
+                {
+                case LogArgument::Type::Signed:
+                    raw = static_cast<uint64_t>(argument.Signed());
+                    break;
+                case LogArgument::Type::Double:
+                {
+                    double number = argument.Double();
+                    std::memcpy(&raw, &number, sizeof(raw));
+                    break;
+                }
+                case LogArgument::Type::Pointer:
+                    raw = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(argument.Pointer()));
+                    break;
+                default:
+                    raw = argument.Unsigned();
+                    break;
+                }
+                std::memcpy(payload + used, &raw, sizeof(raw));
+                used += sizeof(raw);
+                types |= static_cast<uint64_t>(argument.GetType()) << (4 * packed);
+            }
+        }
+
+        record.Words[2] = static_cast<uint64_t>(level) | (static_cast<uint64_t>(packed) << 4) |
+                          (static_cast<uint64_t>(ring.Thread & 0xFFFF) << 8) | (types << 24);
+
+        const uint64_t ticket = ring.Next.load(std::memory_order_relaxed);
+        Ring::Slot& slot = ring.Slots[ticket % Ring::Capacity];
+
+        slot.Sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WordCount; ++i)
+        {
+            slot.Words[i].store(record.Words[i], std::memory_order_relaxed);
+        }
+        slot.Sequence.store(ticket + 1, std::memory_order_release);
+        ring.Next.store(ticket + 1, std::memory_order_release);
+    }
+
+    std::string LogBuffer::Render() const
+    {
+        std::vector<Record> records;
+        for (const Ring* ring = m_rings.load(std::memory_order_acquire); ring; ring = ring->NextRing)
+        {
+            const uint64_t next = ring->Next.load(std::memory_order_acquire);
+            for (uint64_t ticket = next > Ring::Capacity ? next - Ring::Capacity : 0; ticket < next; ++ticket)
+            {
+                Record record;
+                if (ring->Read(ticket, record)) records.push_back(record);
+            }
+        }
+
+        std::stable_sort(records.begin(), records.end(),
+                         [](const Record& a, const Record& b) { return a.Time() < b.Time(); });
+
+        std::string text;
+        char line[512];
+        for (const Record& record : records)
+        {
+            text.append(line, RenderRecord(record, line, sizeof(line)));
+        }
+        return text;
+    }
+
+    bool LogBuffer::WriteFile(const std::string& path) const
+    {
+        std::string text = Render();
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+        return std::fclose(file) == 0 && written;
+    }
+
+    void LogBuffer::WriteUnsorted(std::FILE* file) const
+    {
+        // No allocation: thread by thread, each oldest first
+        char line[512];
+        for (const Ring* ring = m_rings.load(std::memory_order_acquire); ring; ring = ring->NextRing)
+        {
+            const uint64_t next = ring->Next.load(std::memory_order_acquire);
+            for (uint64_t ticket = next > Ring::Capacity ? next - Ring::Capacity : 0; ticket < next; ++ticket)
+            {
+                Record record;
+                if (ring->Read(ticket, record)) std::fwrite(line, 1, RenderRecord(record, line, sizeof(line)), file);
+            }
+        }
+    }
+
+    void LogBuffer::OnCrash(int signal)
+    {
+        // Best effort, the process is going down anyway
+        if (FILE* file = std::fopen(RequestedFile().c_str(), "wb"))
+        {
+            std::fprintf(file, "Crashed with signal %d\n", signal);
+            Instance().WriteUnsorted(file);
+            std::fclose(file);
+        }
+        std::signal(signal, SIG_DFL);
+        std::raise(signal);
+    }
+
+    void LogBuffer::Clear()
+    {
+        for (Ring* ring = m_rings.load(std::memory_order_acquire); ring; ring = ring->NextRing)
+        {
+            for (size_t i = 0; i < Ring::Capacity; ++i)
+            {
+                ring->Slots[i].Sequence.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
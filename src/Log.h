@@ -0,0 +1,202 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Messages below this level are compiled out: 0 debug, 1 info, 2 warning,
+// 3 error. Debug builds keep everything, release builds start at info.
+#ifndef UIALIST_LOG_LEVEL
+#ifdef NDEBUG
+#define UIALIST_LOG_LEVEL 1
+#else
+#define UIALIST_LOG_LEVEL 0
+#endif
+#endif
+
+namespace UIAListCore
+{
+    enum class LogLevel : uint8_t
+    {
+        Debug,
+        Info,
+        Warning,
+        Error
+    };
+
+    const char* ToString(LogLevel level);
+
+    // Whether UIALIST_LOG keeps messages of this level
+    constexpr bool LogCompiledIn(LogLevel level)
+    {
+        const int value = static_cast<int>(level);
+        return value >= UIALIST_LOG_LEVEL;
+    }
+
+    // One message argument, kept raw until the log is rendered. Text is
+    // referenced here and copied (as UTF-8, truncated) into the record.
+    class LogArgument
+    {
+    public:
+        enum class Type : uint8_t
+        {
+            Signed,
+            Unsigned,
+            Hex,
+            Double,
+            Bool,
+            Pointer,
+            Utf8,
+            Utf16,
+            Utf32
+        };
+
+        template <typename T, std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>, int> = 0>
+        LogArgument(T value)
+        {
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                m_type = Type::Bool;
+                m_unsigned = value ? 1 : 0;
+            }
+            else if constexpr (std::is_enum_v<T>)
+            {
+                m_type = Type::Signed;
+                m_signed = static_cast<int64_t>(value);
+            }
+            else if constexpr (std::is_signed_v<T>)
+            {
+                m_type = Type::Signed;
+                m_signed = value;
+            }
+            else
+            {
+                m_type = Type::Unsigned;
+                m_unsigned = value;
+            }
+        }
+
+        LogArgument(double value) : m_type(Type::Double), m_double(value) {}
+        LogArgument(const void* value) : m_type(Type::Pointer), m_pointer(value) {}
+        LogArgument(const char* text) : LogArgument(std::string_view(text ? text : "(null)")) {}
+        LogArgument(std::string_view text) : m_type(Type::Utf8), m_pointer(text.data()), m_size(text.size()) {}
+        LogArgument(const std::string& text) : LogArgument(std::string_view(text)) {}
+        LogArgument(const char16_t* text) : LogArgument(std::u16string_view(text ? text : u"(null)")) {}
+        LogArgument(std::u16string_view text) : m_type(Type::Utf16), m_pointer(text.data()), m_size(text.size()) {}
+        LogArgument(const wchar_t* text) : LogArgument(std::wstring_view(text ? text : L"(null)")) {}
+        LogArgument(std::wstring_view text)
+            : m_type(sizeof(wchar_t) == 2 ? Type::Utf16 : Type::Utf32), m_pointer(text.data()), m_size(text.size())
+        {
+        }
+
+        // HRESULTs and other status codes read better in hex
+        static LogArgument Hex(uint64_t value)
+        {
+            LogArgument argument(value);
+            argument.m_type = Type::Hex;
+            return argument;
+        }
+
+        Type GetType() const { return m_type; }
+        int64_t Signed() const { return m_signed; }
+        uint64_t Unsigned() const { return m_unsigned; }
+        double Double() const { return m_double; }
+        const void* Pointer() const { return m_pointer; }
+        size_t Size() const { return m_size; }  // Of text, in code units
+
+    private:
+        Type m_type;
+        union
+        {
+            int64_t m_signed;
+            uint64_t m_unsigned;
+            double m_double;
+            const void* m_pointer;
+        };
+        size_t m_size{ 0 };
+    };
+
+    // Structured log for the hot paths. Every thread writes into its own
+    // fixed-size ring (the oldest records are overwritten): a record is the
+    // format string pointer, a timestamp and the raw arguments, so writing
+    // one formats nothing and allocates nothing. Records are rendered only
+    // when the log is dumped, on demand or from the crash handler.
+    //
+    // Set UIALIST_LOG to a file to have the frontends dump it there on exit
+    // and on a crash.
+    class LogBuffer
+    {
+    public:
+        static constexpr size_t MaxArguments = 8;
+
+        static LogBuffer& Instance();
+
+        // Remembers the UIALIST_LOG file and installs the crash handler
+        static void InitializeFromEnvironment();
+
+        // Writes the log to the UIALIST_LOG file, if one was requested
+        static bool WriteRequestedFile();
+
+        // format must be a string literal (stored by pointer), "{}" is
+        // replaced by the next argument
+        void Write(LogLevel level, const char* format, const LogArgument* arguments, size_t count);
+
+        // All threads' records, oldest first, one per line
+        std::string Render() const;
+        bool WriteFile(const std::string& path) const;
+
+        void Clear();
+
+    private:
+        struct Ring;
+
+        LogBuffer() = default;
+
+        Ring& ThreadRing();
+        void WriteUnsorted(std::FILE* file) const;
+        static void OnCrash(int signal);
+
+        std::atomic<Ring*> m_rings{ nullptr };
+        std::atomic<uint32_t> m_nextThread{ 1 };
+    };
+
+    template <typename... Arguments>
+    void Log(LogLevel level, const char* format, const Arguments&... arguments)
+    {
+        static_assert(sizeof...(Arguments) <= LogBuffer::MaxArguments, "Too many log arguments");
+        if constexpr (sizeof...(Arguments) == 0)
+        {
+            LogBuffer::Instance().Write(level, format, nullptr, 0);
+        }
+        else
+        {
+            const LogArgument packed[] = { LogArgument(arguments)... };
+            LogBuffer::Instance().Write(level, format, packed, sizeof...(Arguments));
+        }
+    }
+}
+
+// UIALIST_LOG(Debug, "Clicked {} in {} us", name, elapsed);
+// Below UIALIST_LOG_LEVEL the arguments are not even evaluated.
+#define UIALIST_LOG(level, ...) \
+    do \
+    { \
+        if constexpr (::UIAListCore::LogCompiledIn(::UIAListCore::LogLevel::level)) \
+        { \
+            ::UIAListCore::Log(::UIAListCore::LogLevel::level, __VA_ARGS__); \
+        } \
+    } while (false)
@@ -11,13 +11,28 @@
 #include "pch.h"
 #include "MainWindow.h"
 #include "ControlInteraction.h"
+#include "InputInjector.h"
+#include "SettingsManager.h"
+#include "SystemTrayManager.h"
+#include "Log.h"
+#include "Trace.h"
 
 using namespace winrt;
 using namespace Microsoft::UI::Xaml;
 using namespace Microsoft::UI::Xaml::Controls;
+using namespace UIAListCore;
 
 namespace UIAList
 {
+    namespace
+    {
+        // What the filter engine takes; wchar_t is UTF-16 here
+        std::u16string_view Utf16(const winrt::hstring& text)
+        {
+            return std::u16string_view(reinterpret_cast<const char16_t*>(text.c_str()), text.size());
+        }
+    }
+
     MainWindow::MainWindow()
     {
         // Create the WinUI3 window
@@ -29,10 +44,32 @@ namespace UIAList
 
         // Register for close event
         m_window.Closed({ this, &MainWindow::OnClosed });
+
+        // Interactions run on their own automation thread, which keeps its
+        // event handlers until it stops
+        m_actionExecutor = std::make_unique<ActionExecutor>(
+            []() { CoInitializeEx(nullptr, COINIT_MULTITHREADED); },
+            []() { AutomationEventHandlers::Unregister(); CoUninitialize(); });
+
+        MemoryBudget::Instance().SetLimit(
+            static_cast<size_t>(SettingsManager::GetInstance().GetMemoryBudgetMB()) * 1024 * 1024);
+
+        // Changed by the Qt frontend or by hand while running
+        m_settingsListener = SettingsStore::Instance().Subscribe([](const Settings& settings) {
+            MemoryBudget::Instance().SetLimit(static_cast<size_t>(settings.MemoryBudgetMB) * 1024 * 1024);
+        });
     }
 
     MainWindow::~MainWindow()
     {
+        SettingsStore::Instance().Unsubscribe(m_settingsListener);
+
+        // The budget must not call back into this window
+        if (m_snapshotId)
+        {
+            MemoryBudget::Instance().Remove(m_snapshotId);
+        }
+
         if (m_window)
         {
             m_window.Close();
@@ -53,9 +90,11 @@ namespace UIAList
         m_filterBox.KeyDown({ this, &MainWindow::OnFilterKeyDown });
         root.Children().Append(m_filterBox);
 
-        // Create list view
+        // Create list view over the control list
+        m_listSource = make_self<ControlListSource>([this](uint32_t control) { return RowText(m_allControls[control]); });
         m_listView = ListView();
         m_listView.Height(400);
+        m_listView.ItemsSource(m_listSource.as<winrt::Windows::Foundation::IInspectable>());
         m_listView.SelectionChanged({ this, &MainWindow::OnListSelectionChanged });
         root.Children().Append(m_listView);
 
@@ -81,6 +120,13 @@ namespace UIAList
 
         root.Children().Append(buttonPanel);
 
+#if UIALIST_CALL_STATS
+        m_callStatsText = TextBlock();
+        m_callStatsText.FontFamily(Media::FontFamily(L"Consolas"));
+        m_callStatsText.IsTextSelectionEnabled(true);
+        root.Children().Append(m_callStatsText);
+#endif
+
         m_window.Content(root);
     }
 
@@ -92,44 +138,217 @@ namespace UIAList
 
     void MainWindow::Hide()
     {
-        // Minimize or close window
+        if (m_window)
+        {
+            m_window.AppWindow().Hide();
+        }
+
+        // The list is rebuilt on the next show; until then it only costs memory
+        MemoryBudget& budget = MemoryBudget::Instance();
+        if (m_snapshotId)
+        {
+            budget.SetVisible(m_snapshotId, false);
+        }
+        budget.Enforce();
     }
 
     void MainWindow::StartEnumeration()
     {
-        m_allControls.clear();
-        m_listView.Items().Clear();
+        UIALIST_TRACE_SPAN("StartEnumeration");
+
+        // Cancelled and joined first, so nothing of the old walk arrives after the release
+        m_enumerator.reset();
+        ReleaseSnapshot();
+        ++m_generation;
 
         // Get foreground window
         HWND targetWindow = GetForegroundWindow();
 
+#if UIALIST_CALL_STATS
+        m_callsBefore = CallStats::Snapshot();
+#endif
+
         m_enumerator = std::make_unique<ControlEnumerator>();
         m_enumerator->EnumerateAsync(
             targetWindow,
             [this](const ControlInfo& control) { OnControlFound(control); },
-            [this](const winrt::hstring& message) { OnEnumerationFinished(); },
+            [this, generation = m_generation](const winrt::hstring& message) { OnEnumerationFinished(generation); },
             []() { /* cancelled */ }
         );
     }
 
     void MainWindow::OnControlFound(const ControlInfo& control)
     {
-        m_allControls.push_back(control);
-        // Update UI on dispatcher thread
-        m_window.DispatcherQueue().TryEnqueue([this, control]() {
-            m_listView.Items().Append(box_value(control.Name));
+        // Enumeration thread. One flush is queued at a time; whatever arrives
+        // until the UI thread gets to it goes into the same batch.
+        bool queue = false;
+        {
+            std::lock_guard<std::mutex> lock(m_pendingMutex);
+            m_pendingControls.push_back(control);
+            queue = !m_flushQueued;
+            m_flushQueued = true;
+        }
+        if (queue)
+        {
+            m_window.DispatcherQueue().TryEnqueue([this]() { FlushPendingControls(); });
+        }
+    }
+
+    void MainWindow::FlushPendingControls()
+    {
+        UIALIST_TRACE_SPAN("ListBatch");
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<ControlInfo> batch;
+        {
+            std::lock_guard<std::mutex> lock(m_pendingMutex);
+            batch.swap(m_pendingControls);
+            m_flushQueued = false;
+        }
+        if (batch.empty()) return;
+
+        const uint32_t first = static_cast<uint32_t>(m_allControls.size());
+        m_allControls.insert(m_allControls.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+
+        // Rows that pass the filter typed so far
+        const size_t matched = m_filter.Matches().size();
+        for (size_t control = first; control < m_allControls.size(); ++control)
+        {
+            m_filter.Add(Utf16(RowText(m_allControls[control])), Utf16(m_allControls[control].Name));
+        }
+        m_listSource->AppendControls(m_filter.Matches().data() + matched, m_filter.Matches().size() - matched);
+
+        if (first == 0)
+        {
+            TraceInstant("FirstRow");
+        }
+
+        m_listUiTime += std::chrono::steady_clock::now() - start;
+        ++m_listBatches;
+    }
+
+    winrt::hstring MainWindow::RowText(const ControlInfo& control)
+    {
+        // As the Qt frontend shows it, so both filter the same text
+        return control.Type + L": " + (control.Name.empty() ? winrt::hstring(L"(no name)") : control.Name);
+    }
+
+    void MainWindow::OnEnumerationFinished(uint64_t generation)
+    {
+#if UIALIST_CALL_STATS
+        std::vector<CallCount> calls = CallStats::Since(m_callsBefore);
+        CallStats::Trace(calls);
+#endif
+
+        // Queued behind the pending batch; dropped when a newer list started since
+        m_window.DispatcherQueue().TryEnqueue([=, this]() {
+            if (generation != m_generation) return;
+
+            FlushPendingControls();
+            TraceInstant("ListComplete");
+            AccountSnapshot();
+
+            const auto uiMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(m_listUiTime).count();
+            const size_t rows = m_allControls.size();
+            UIALIST_LOG(Info, "List of {} rows took {} us on the UI thread in {} batches, {} us per 10k rows",
+                        rows, uiMicroseconds, m_listBatches, rows ? uiMicroseconds * 10000 / rows : 0);
+#if UIALIST_CALL_STATS
+            std::string stats = CallStats::Format(calls, rows);
+            m_callStatsText.Text(winrt::to_hstring(stats + MemoryBudget::Instance().Format()));
+#endif
         });
     }
 
-    void MainWindow::OnEnumerationFinished()
+    void MainWindow::AccountSnapshot()
     {
-        // Enumeration complete
+        // The window closed while the list was being finished
+        if (!m_window)
+        {
+            return;
+        }
+
+        // A list item is a boxed reference to the control's name; containers
+        // exist only for the realized rows
+        constexpr size_t listRowBytes = 64;
+        // An hstring buffer carries a header before its characters
+        auto stringBytes = [](const winrt::hstring& text) {
+            return text.empty() ? 0 : 24 + (text.size() + 1) * sizeof(wchar_t);
+        };
+
+        MemoryUsage usage;
+        usage.ArrayBytes = m_allControls.capacity() * sizeof(ControlInfo) + m_filter.MemoryBytes();
+        for (const ControlInfo& control : m_allControls)
+        {
+            usage.StringBytes += stringBytes(control.Name) + stringBytes(control.Type) + stringBytes(control.AutomationId);
+            usage.StringBytes += control.Locator.MemoryBytes();
+            if (control.Element)
+            {
+                ++usage.ComReferences;
+            }
+        }
+        usage.Rows = m_listSource->Size();
+        usage.RowBytes = usage.Rows * listRowBytes;
+
+        MemoryBudget& budget = MemoryBudget::Instance();
+        if (m_snapshotId)
+        {
+            budget.Update(m_snapshotId, usage);
+        }
+        else
+        {
+            m_snapshotId = budget.Add(usage, [this]() { ReleaseSnapshot(); });
+        }
+
+        // Finished after the window was hidden
+        if (!m_window.AppWindow().IsVisible())
+        {
+            budget.SetVisible(m_snapshotId, false);
+            budget.Enforce();
+        }
+    }
+
+    void MainWindow::ReleaseSnapshot()
+    {
+        // Also called by the memory budget when it evicts the hidden list
+        if (m_snapshotId)
+        {
+            MemoryBudget::Instance().Remove(m_snapshotId);
+            m_snapshotId = 0;
+        }
+
+        m_listSource->Clear();
+        m_selectedIndex = -1;
+        std::vector<ControlInfo>().swap(m_allControls);  // Frees the capacity and the COM references
+        m_filter = FilterEngine();
+        m_filter.SetQuery(Utf16(m_filterBox.Text()));
+        {
+            // Rows of an enumeration that is still running belong to the old list
+            std::lock_guard<std::mutex> lock(m_pendingMutex);
+            std::vector<ControlInfo>().swap(m_pendingControls);
+        }
+        m_listUiTime = {};
+        m_listBatches = 0;
     }
 
     void MainWindow::OnFilterTextChanged(winrt::Windows::Foundation::IInspectable const&,
                                         TextChangedEventArgs const&)
     {
-        // Filter the list based on text
+        UIALIST_TRACE_SPAN("FilterChanged");
+
+        m_filter.SetQuery(Utf16(m_filterBox.Text()));
+        m_listSource->SetControls(m_filter.Matches());
+
+        // The best match is selected; its row is its place among the matches
+        const size_t best = m_filter.BestMatch();
+        if (best == FilterEngine::NoMatch)
+        {
+            m_selectedIndex = -1;
+            return;
+        }
+        const auto& matches = m_filter.Matches();
+        m_selectedIndex = static_cast<int>(std::lower_bound(matches.begin(), matches.end(), best) - matches.begin());
+        m_listSource->EnsureLoaded(static_cast<uint32_t>(m_selectedIndex));
+        m_listView.SelectedIndex(m_selectedIndex);
     }
 
     void MainWindow::OnFilterKeyDown(winrt::Windows::Foundation::IInspectable const&,
@@ -140,10 +359,11 @@ namespace UIAList
 
         if (args.Key() == VirtualKey::Down)
         {
-            // Select next item
-            if (m_selectedIndex < static_cast<int>(m_listView.Items().Size()) - 1)
+            // Select next item, loading it if the list view has not yet
+            if (m_selectedIndex < static_cast<int>(m_listSource->Available()) - 1)
             {
                 m_selectedIndex++;
+                m_listSource->EnsureLoaded(static_cast<uint32_t>(m_selectedIndex));
                 m_listView.SelectedIndex(m_selectedIndex);
             }
             args.Handled(true);
@@ -160,8 +380,19 @@ namespace UIAList
         }
         else if (args.Key() == VirtualKey::Enter)
         {
-            // Execute default action (Click)
-            OnClickButtonClick(nullptr, nullptr);
+            // Execute the default action from the settings, as the Qt frontend does
+            switch (SettingsStore::Instance().Get()->DefaultAction)
+            {
+            case 1:
+                RunSelectedAction(ActionKind::DoubleClick);
+                break;
+            case 2:
+                RunSelectedAction(ActionKind::Focus);
+                break;
+            default:
+                RunSelectedAction(ActionKind::Click);
+                break;
+            }
             args.Handled(true);
         }
     }
@@ -175,34 +406,61 @@ namespace UIAList
     void MainWindow::OnClickButtonClick(winrt::Windows::Foundation::IInspectable const&,
                                       RoutedEventArgs const&)
     {
-        if (m_selectedIndex >= 0 && m_selectedIndex < static_cast<int>(m_allControls.size()))
-        {
-            const auto& control = m_allControls[m_selectedIndex];
-            ControlInteraction::ClickControl(control.Element.get());
-            Hide();
-        }
+        RunSelectedAction(ActionKind::Click);
     }
 
     void MainWindow::OnFocusButtonClick(winrt::Windows::Foundation::IInspectable const&,
                                       RoutedEventArgs const&)
     {
-        if (m_selectedIndex >= 0 && m_selectedIndex < static_cast<int>(m_allControls.size()))
-        {
-            const auto& control = m_allControls[m_selectedIndex];
-            ControlInteraction::FocusControl(control.Element.get());
-            Hide();
-        }
+        RunSelectedAction(ActionKind::Focus);
     }
 
     void MainWindow::OnDoubleClickButtonClick(winrt::Windows::Foundation::IInspectable const&,
                                             RoutedEventArgs const&)
     {
-        if (m_selectedIndex >= 0 && m_selectedIndex < static_cast<int>(m_allControls.size()))
+        RunSelectedAction(ActionKind::DoubleClick);
+    }
+
+    void MainWindow::RunSelectedAction(ActionKind kind)
+    {
+        if (m_selectedIndex < 0 || m_selectedIndex >= static_cast<int>(m_listSource->Size()))
         {
-            const auto& control = m_allControls[m_selectedIndex];
-            ControlInteraction::DoubleClickControl(control.Element.get());
-            Hide();
+            return;
         }
+
+        // Copy holds its own reference to the element for the automation thread
+        ControlInfo control = m_allControls[m_listSource->ControlAt(static_cast<uint32_t>(m_selectedIndex))];
+
+        // Hide first, the action result is announced when it arrives
+        Hide();
+
+        auto dispatcher = m_window.DispatcherQueue();
+        m_actionExecutor->Submit(
+            [control, kind]()
+            {
+                // The list may be older than the control, find it again if needed
+                winrt::com_ptr<IUIAutomationElement> element = ControlInteraction::EnsureLive(control.Element.get(), control.Locator);
+                if (!element) return false;
+
+                return ControlInteraction::PerformAction(element.get(), kind, control.Capabilities);
+            },
+            std::chrono::milliseconds(SettingsManager::GetInstance().GetActionTimeoutMs()),
+            [dispatcher, name = control.Name, kind](ActionResult result)
+            {
+                // Success speaks for itself in the target application
+                if (result == ActionResult::Succeeded || result == ActionResult::Cancelled) return;
+
+                dispatcher.TryEnqueue([name, kind, result]()
+                {
+                    std::wstring text = (result == ActionResult::TimedOut)
+                        ? L"The application did not respond to "
+                        : L"Could not perform ";
+                    text += (kind == ActionKind::Focus) ? L"focus on " :
+                            (kind == ActionKind::DoubleClick) ? L"double click on " : L"click on ";
+                    text += name.c_str();
+                    SystemTrayManager::GetInstance().ShowNotification(L"UIAList", text.c_str());
+                });
+            });
     }
 
     void MainWindow::OnClosed(winrt::Windows::Foundation::IInspectable const&,
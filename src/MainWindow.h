@@ -13,6 +13,12 @@
 #include <winrt/Microsoft.UI.Xaml.h>
 #include <winrt/Microsoft.UI.Xaml.Controls.h>
 #include "ControlEnumerator.h"
+#include "ControlListSource.h"
+#include "ActionExecutor.h"
+#include "CallStats.h"
+#include "FilterEngine.h"
+#include "MemoryBudget.h"
+#include "SettingsStore.h"
 
 namespace UIAList
 {
@@ -44,8 +50,13 @@ namespace UIAList
                      winrt::Microsoft::UI::Xaml::WindowEventArgs const& args);
 
         void StartEnumeration();
+        void RunSelectedAction(UIAListCore::ActionKind kind);
         void OnControlFound(const ControlInfo& control);
-        void OnEnumerationFinished();
+        void FlushPendingControls();
+        static winrt::hstring RowText(const ControlInfo& control);
+        void OnEnumerationFinished(uint64_t generation);
+        void AccountSnapshot();
+        void ReleaseSnapshot();
 
         winrt::Microsoft::UI::Xaml::Window m_window{ nullptr };
         winrt::Microsoft::UI::Xaml::Controls::TextBox m_filterBox{ nullptr };
@@ -53,9 +64,29 @@ namespace UIAList
         winrt::Microsoft::UI::Xaml::Controls::Button m_clickButton{ nullptr };
         winrt::Microsoft::UI::Xaml::Controls::Button m_focusButton{ nullptr };
         winrt::Microsoft::UI::Xaml::Controls::Button m_doubleClickButton{ nullptr };
+#if UIALIST_CALL_STATS
+        // Debug builds: UI Automation calls of the last enumeration
+        winrt::Microsoft::UI::Xaml::Controls::TextBlock m_callStatsText{ nullptr };
+        std::vector<UIAListCore::CallCount> m_callsBefore;
+#endif
 
         std::unique_ptr<ControlEnumerator> m_enumerator;
-        std::vector<ControlInfo> m_allControls;
+        std::unique_ptr<UIAListCore::ActionExecutor> m_actionExecutor;
+        winrt::com_ptr<ControlListSource> m_listSource;
+        std::vector<ControlInfo> m_allControls;  // UI thread only
+        UIAListCore::FilterEngine m_filter;       // One row per control of m_allControls
+
+        // Controls found by the enumeration thread, taken over by the UI thread in batches
+        std::mutex m_pendingMutex;
+        std::vector<ControlInfo> m_pendingControls;
+        bool m_flushQueued{ false };  // A FlushPendingControls is in the dispatcher queue
+        uint64_t m_generation{ 0 };   // Of the current list, bumped by StartEnumeration
+
+        // UI thread time spent adding the rows of the current list
+        std::chrono::steady_clock::duration m_listUiTime{};
+        uint32_t m_listBatches{ 0 };
+        UIAListCore::MemoryBudget::SnapshotId m_snapshotId{ 0 };  // 0 while no finished list is held
+        UIAListCore::SettingsStore::ListenerId m_settingsListener{ 0 };
         int m_selectedIndex{ -1 };
     };
 }
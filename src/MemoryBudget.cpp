@@ -0,0 +1,155 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "MemoryBudget.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        double Megabytes(uint64_t bytes)
+        {
+            return bytes / (1024.0 * 1024.0);
+        }
+    }
+
+    MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other)
+    {
+        StringBytes += other.StringBytes;
+        ArrayBytes += other.ArrayBytes;
+        ComReferences += other.ComReferences;
+        Rows += other.Rows;
+        RowBytes += other.RowBytes;
+        return *this;
+    }
+
+    MemoryBudget& MemoryBudget::Instance()
+    {
+        static MemoryBudget instance;
+        return instance;
+    }
+
+    void MemoryBudget::SetLimit(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_limit = bytes;
+    }
+
+    size_t MemoryBudget::Limit() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_limit;
+    }
+
+    MemoryBudget::SnapshotId MemoryBudget::Add(const MemoryUsage& usage, std::function<void()> release)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        SnapshotId id = m_nextId++;
+        Snapshot& snapshot = m_snapshots[id];
+        snapshot.Usage = usage;
+        snapshot.Release = std::move(release);
+        return id;
+    }
+
+    void MemoryBudget::Update(SnapshotId id, const MemoryUsage& usage)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_snapshots.find(id);
+        if (found != m_snapshots.end()) found->second.Usage = usage;
+    }
+
+    void MemoryBudget::SetVisible(SnapshotId id, bool visible)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_snapshots.find(id);
+        if (found == m_snapshots.end() || found->second.Visible == visible) return;
+
+        found->second.Visible = visible;
+        if (!visible) found->second.HiddenAt = ++m_hideCount;
+    }
+
+    void MemoryBudget::Remove(SnapshotId id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_snapshots.erase(id);
+    }
+
+    size_t MemoryBudget::Enforce()
+    {
+        std::vector<std::function<void()>> releases;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            size_t total = 0;
+            std::vector<std::pair<uint64_t, SnapshotId>> hidden;
+            for (const auto& [id, snapshot] : m_snapshots)
+            {
+                total += snapshot.Usage.Bytes();
+                if (!snapshot.Visible) hidden.emplace_back(snapshot.HiddenAt, id);
+            }
+            std::sort(hidden.begin(), hidden.end());
+
+            for (const auto& [hiddenAt, id] : hidden)
+            {
+                if (total <= m_limit && m_limit > 0) break;
+
+                auto found = m_snapshots.find(id);
+                const size_t bytes = found->second.Usage.Bytes();
+                total -= bytes;
+                ++m_evictions;
+                m_evictedBytes += bytes;
+                releases.push_back(std::move(found->second.Release));
+                m_snapshots.erase(found);
+            }
+        }
+
+        // The owners may call back into the budget
+        for (auto& release : releases)
+        {
+            if (release) release();
+        }
+        return releases.size();
+    }
+
+    MemoryBudget::Report MemoryBudget::GetReport() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Report report;
+        report.LimitBytes = m_limit;
+        report.Snapshots = m_snapshots.size();
+        for (const auto& [id, snapshot] : m_snapshots)
+        {
+            report.Total += snapshot.Usage;
+            if (snapshot.Visible) ++report.VisibleSnapshots;
+        }
+        report.Evictions = m_evictions;
+        report.EvictedBytes = m_evictedBytes;
+        return report;
+    }
+
+    std::string MemoryBudget::Format() const
+    {
+        const Report report = GetReport();
+        const MemoryUsage& total = report.Total;
+
+        char text[512];
+        std::snprintf(text, sizeof(text),
+                      "%zu snapshots (%zu visible), %.1f of %.1f MB: strings %.1f MB, arrays %.1f MB, "
+                      "%zu COM references %.1f MB, %zu rows %.1f MB; %zu evicted (%.1f MB)",
+                      report.Snapshots, report.VisibleSnapshots, Megabytes(total.Bytes()), Megabytes(report.LimitBytes),
+                      Megabytes(total.StringBytes), Megabytes(total.ArrayBytes), total.ComReferences,
+                      Megabytes(total.ComReferences * MemoryUsage::ComReferenceBytes), total.Rows,
+                      Megabytes(total.RowBytes), report.Evictions, Megabytes(report.EvictedBytes));
+        return text;
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace UIAListCore
+{
+    // What one snapshot holds: the controls of one enumerated window and the
+    // list rows showing them
+    struct MemoryUsage
+    {
+        // Client-side proxy and cached properties of one held element; an
+        // estimate, the proxies live in UIAutomationCore's heap
+        static constexpr size_t ComReferenceBytes = 1024;
+
+        size_t StringBytes{ 0 };    // Names, types, locator paths
+        size_t ArrayBytes{ 0 };     // Control lists and maps
+        size_t ComReferences{ 0 };  // Held IUIAutomationElement references
+        size_t Rows{ 0 };
+        size_t RowBytes{ 0 };       // List items, without the shared text
+
+        size_t Bytes() const { return StringBytes + ArrayBytes + ComReferences * ComReferenceBytes + RowBytes; }
+
+        MemoryUsage& operator+=(const MemoryUsage& other);
+    };
+
+    // Global budget over all snapshots. Visible snapshots are never evicted;
+    // when the total is over the limit, hidden ones are released, the one
+    // hidden longest first. A limit of 0 releases every hidden snapshot.
+    class MemoryBudget
+    {
+    public:
+        using SnapshotId = uint64_t;  // 0 is never a valid id
+
+        static constexpr size_t DefaultLimitMegabytes = 64;
+
+        struct Report
+        {
+            size_t LimitBytes{ 0 };
+            size_t Snapshots{ 0 };
+            size_t VisibleSnapshots{ 0 };
+            MemoryUsage Total;
+            size_t Evictions{ 0 };        // Since process start
+            uint64_t EvictedBytes{ 0 };
+        };
+
+        static MemoryBudget& Instance();
+
+        void SetLimit(size_t bytes);
+        size_t Limit() const;
+
+        // release frees the snapshot's strings, arrays, COM references and
+        // rows; Enforce calls it on its own thread, without holding the lock
+        SnapshotId Add(const MemoryUsage& usage, std::function<void()> release);
+        void Update(SnapshotId id, const MemoryUsage& usage);
+        void SetVisible(SnapshotId id, bool visible);
+
+        // The owner released the snapshot itself
+        void Remove(SnapshotId id);
+
+        // Evicts hidden snapshots until the total is within the limit,
+        // returns how many were released
+        size_t Enforce();
+
+        Report GetReport() const;
+
+        // "2 snapshots (1 visible), 14.2 of 64.0 MB: ..." for the stats panel
+        std::string Format() const;
+
+    private:
+        struct Snapshot
+        {
+            MemoryUsage Usage;
+            std::function<void()> Release;
+            bool Visible{ true };
+            uint64_t HiddenAt{ 0 };  // Order in which snapshots were hidden
+        };
+
+        MemoryBudget() = default;
+
+        mutable std::mutex m_mutex;
+        std::map<SnapshotId, Snapshot> m_snapshots;
+        size_t m_limit{ DefaultLimitMegabytes * 1024 * 1024 };
+        SnapshotId m_nextId{ 1 };
+        uint64_t m_hideCount{ 0 };
+        size_t m_evictions{ 0 };
+        uint64_t m_evictedBytes{ 0 };
+    };
+}
@@ -0,0 +1,203 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "NamedPipeTransport.h"
+#include "Log.h"
+
+#include <algorithm>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        constexpr DWORD PipeBufferBytes = 64 * 1024;
+        constexpr DWORD BusyWaitMs = 2000;
+
+        // Both ends are opened for overlapped I/O, so Close can interrupt a
+        // blocked Read or Write from another thread
+        class NamedPipeConnection : public QueryConnection
+        {
+        public:
+            NamedPipeConnection(HANDLE pipe, bool server)
+                : m_pipe(pipe)
+                , m_server(server)
+                , m_closed(CreateEventW(nullptr, TRUE, FALSE, nullptr))
+                , m_readDone(CreateEventW(nullptr, TRUE, FALSE, nullptr))
+                , m_writeDone(CreateEventW(nullptr, TRUE, FALSE, nullptr))
+            {
+            }
+
+            ~NamedPipeConnection() override
+            {
+                Close();
+                CloseHandle(m_pipe);
+                CloseHandle(m_closed);
+                CloseHandle(m_readDone);
+                CloseHandle(m_writeDone);
+            }
+
+            size_t Read(char* data, size_t size) override
+            {
+                const DWORD wanted = static_cast<DWORD>(std::min<size_t>(size, MAXDWORD));
+                DWORD read = 0;
+                if (!Complete(ReadFile(m_pipe, data, wanted, nullptr, Start(m_readDone)), m_readDone, read)) return 0;
+                return read;
+            }
+
+            bool Write(const char* data, size_t size) override
+            {
+                while (size > 0)
+                {
+                    const DWORD wanted = static_cast<DWORD>(std::min<size_t>(size, MAXDWORD));
+                    DWORD written = 0;
+                    if (!Complete(WriteFile(m_pipe, data, wanted, nullptr, Start(m_writeDone)), m_writeDone, written)) return false;
+                    data += written;
+                    size -= written;
+                }
+                return true;
+            }
+
+            void Close() override
+            {
+                SetEvent(m_closed);
+                // The client sees the end right away, not only when the handle goes
+                if (m_server) DisconnectNamedPipe(m_pipe);
+            }
+
+        private:
+            OVERLAPPED* Start(HANDLE done)
+            {
+                OVERLAPPED& overlapped = done == m_readDone ? m_readOverlapped : m_writeOverlapped;
+                overlapped = {};
+                overlapped.hEvent = done;
+                return &overlapped;
+            }
+
+            // Waits for the started operation unless Close comes first
+            bool Complete(BOOL started, HANDLE done, DWORD& transferred)
+            {
+                OVERLAPPED& overlapped = done == m_readDone ? m_readOverlapped : m_writeOverlapped;
+                if (!started && GetLastError() != ERROR_IO_PENDING) return false;
+
+                const HANDLE events[] = { done, m_closed };
+                if (WaitForMultipleObjects(2, events, FALSE, INFINITE) != WAIT_OBJECT_0)
+                {
+                    CancelIoEx(m_pipe, &overlapped);
+                    GetOverlappedResult(m_pipe, &overlapped, &transferred, TRUE);
+                    return false;
+                }
+                return GetOverlappedResult(m_pipe, &overlapped, &transferred, FALSE) && transferred > 0;
+            }
+
+            HANDLE m_pipe;
+            bool m_server;
+            HANDLE m_closed;
+            HANDLE m_readDone;
+            HANDLE m_writeDone;
+            OVERLAPPED m_readOverlapped{};
+            OVERLAPPED m_writeOverlapped{};
+        };
+    }
+
+    std::wstring QueryPipeName()
+    {
+        DWORD session = 0;
+        ProcessIdToSessionId(GetCurrentProcessId(), &session);
+        return L"\\\\.\\pipe\\UIAList-" + std::to_wstring(session);
+    }
+
+    std::unique_ptr<QueryConnection> ConnectQueryPipe(const std::wstring& name)
+    {
+        for (;;)
+        {
+            HANDLE pipe = CreateFileW(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+                                      FILE_FLAG_OVERLAPPED, nullptr);
+            if (pipe != INVALID_HANDLE_VALUE) return std::make_unique<NamedPipeConnection>(pipe, false);
+
+            // All instances taken: the server creates the next one as soon as it accepted
+            if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeW(name.c_str(), BusyWaitMs)) return nullptr;
+        }
+    }
+
+    NamedPipeListener::NamedPipeListener(std::wstring name)
+        : m_name(std::move(name))
+        , m_stop(CreateEventW(nullptr, TRUE, FALSE, nullptr))
+    {
+    }
+
+    NamedPipeListener::~NamedPipeListener()
+    {
+        CloseHandle(m_stop);
+    }
+
+    std::unique_ptr<QueryConnection> NamedPipeListener::Accept()
+    {
+        if (WaitForSingleObject(m_stop, 0) == WAIT_OBJECT_0) return nullptr;
+
+        // The first instance claims the name, so another process cannot pose as the tray
+        const DWORD openMode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (m_created ? 0 : FILE_FLAG_FIRST_PIPE_INSTANCE);
+        HANDLE pipe = CreateNamedPipeW(m_name.c_str(), openMode,
+                                       PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                       PIPE_UNLIMITED_INSTANCES, PipeBufferBytes, PipeBufferBytes, 0, nullptr);
+        if (pipe == INVALID_HANDLE_VALUE)
+        {
+            UIALIST_LOG(Warning, "Cannot create the query pipe (error {})", static_cast<uint32_t>(GetLastError()));
+            return nullptr;
+        }
+        m_created = true;
+
+        HANDLE connected = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = connected;
+
+        bool accepted = ConnectNamedPipe(pipe, &overlapped) != FALSE;
+        if (!accepted)
+        {
+            switch (GetLastError())
+            {
+            case ERROR_PIPE_CONNECTED:
+                accepted = true;
+                break;
+            case ERROR_IO_PENDING:
+            {
+                const HANDLE events[] = { connected, m_stop };
+                if (WaitForMultipleObjects(2, events, FALSE, INFINITE) == WAIT_OBJECT_0)
+                {
+                    DWORD ignored = 0;
+                    accepted = GetOverlappedResult(pipe, &overlapped, &ignored, FALSE) != FALSE;
+                }
+                else
+                {
+                    CancelIoEx(pipe, &overlapped);
+                    DWORD ignored = 0;
+                    GetOverlappedResult(pipe, &overlapped, &ignored, TRUE);
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+        CloseHandle(connected);
+
+        if (!accepted)
+        {
+            CloseHandle(pipe);
+            // A client that gave up before it was accepted is not the end of the listener
+            return WaitForSingleObject(m_stop, 0) == WAIT_OBJECT_0 ? nullptr : Accept();
+        }
+        return std::make_unique<NamedPipeConnection>(pipe, true);
+    }
+
+    void NamedPipeListener::Close()
+    {
+        SetEvent(m_stop);
+    }
+}
@@ -0,0 +1,46 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+// No pch.h here: shared by the WinUI and the Qt frontend
+#include <windows.h>
+
+#include "QueryTransport.h"
+
+#include <memory>
+#include <string>
+
+namespace UIAListCore
+{
+    // \\.\pipe\UIAList-<session id>: one tray process per logon session
+    std::wstring QueryPipeName();
+
+    // The client end of the query pipe; null when no UIAList is running
+    std::unique_ptr<QueryConnection> ConnectQueryPipe(const std::wstring& name);
+
+    // Serves the query pipe to local clients. Pipes are created with the
+    // default security descriptor, which only lets the owner, SYSTEM and
+    // administrators open them for writing, and remote clients are rejected.
+    class NamedPipeListener : public QueryListener
+    {
+    public:
+        explicit NamedPipeListener(std::wstring name);
+        ~NamedPipeListener() override;
+
+        std::unique_ptr<QueryConnection> Accept() override;
+        void Close() override;
+
+    private:
+        std::wstring m_name;
+        HANDLE m_stop{ nullptr };
+        bool m_created{ false };  // The first instance exists, so nobody else owns the name
+    };
+}
@@ -0,0 +1,37 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ProcessMemory.h"
+
+#include <windows.h>
+#include <psapi.h>
+
+namespace UIAListCore
+{
+    ProcessMemory ProcessMemory::Current()
+    {
+        ProcessMemory memory;
+        PROCESS_MEMORY_COUNTERS_EX counters = {};
+        counters.cb = sizeof(counters);
+        if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters),
+                                 sizeof(counters)))
+        {
+            memory.WorkingSetBytes = counters.WorkingSetSize;
+            memory.PrivateBytes = counters.PrivateUsage;
+        }
+        return memory;
+    }
+
+    bool ProcessMemory::TrimWorkingSet()
+    {
+        // Both -1: remove as many pages as possible
+        return SetProcessWorkingSetSize(GetCurrentProcess(), static_cast<SIZE_T>(-1), static_cast<SIZE_T>(-1)) != FALSE;
+    }
+}
@@ -0,0 +1,30 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+// No pch.h here: shared by the WinUI and the Qt frontend
+#include <cstddef>
+
+namespace UIAListCore
+{
+    // Resident and committed memory of this process, to measure what the
+    // idle trim gives back
+    struct ProcessMemory
+    {
+        size_t WorkingSetBytes{ 0 };
+        size_t PrivateBytes{ 0 };
+
+        static ProcessMemory Current();
+
+        // Pages the working set out; they are faulted back in when touched
+        static bool TrimWorkingSet();
+    };
+}
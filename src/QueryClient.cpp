@@ -0,0 +1,142 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "QueryClient.h"
+
+namespace UIAListCore
+{
+    namespace
+    {
+        constexpr size_t ReadChunkBytes = 64 * 1024;
+    }
+
+    QueryClient::QueryClient(std::unique_ptr<QueryConnection> connection)
+        : m_connection(std::move(connection))
+    {
+    }
+
+    QueryClient::~QueryClient()
+    {
+        if (m_connection) m_connection->Close();
+    }
+
+    uint32_t QueryClient::Enumerate(uint64_t window, QueryFormat format)
+    {
+        QueryRequest request;
+        request.Kind = QueryKind::Enumerate;
+        request.Format = format;
+        request.Window = window;
+        return Queue(request);
+    }
+
+    uint32_t QueryClient::Filter(uint64_t window, const std::string& text, QueryFormat format)
+    {
+        QueryRequest request;
+        request.Kind = QueryKind::Filter;
+        request.Format = format;
+        request.Window = window;
+        request.Text = text;
+        return Queue(request);
+    }
+
+    uint32_t QueryClient::Query(uint64_t window, uint32_t index, QueryFormat format)
+    {
+        QueryRequest request;
+        request.Kind = QueryKind::Query;
+        request.Format = format;
+        request.Window = window;
+        request.Index = index;
+        return Queue(request);
+    }
+
+    uint32_t QueryClient::Invoke(uint64_t window, uint32_t index, ActionKind action)
+    {
+        QueryRequest request;
+        request.Kind = QueryKind::Invoke;
+        request.Window = window;
+        request.Index = index;
+        request.Action = action;
+        return Queue(request);
+    }
+
+    bool QueryClient::Send()
+    {
+        if (!m_connection) return false;
+        if (m_outgoing.empty()) return true;
+
+        const bool written = m_connection->Write(m_outgoing.data(), m_outgoing.size());
+        m_outgoing.clear();
+        if (!written) m_connection.reset();
+        return written;
+    }
+
+    bool QueryClient::Next(QueryResponse& response)
+    {
+        if (!m_connection) return false;
+
+        for (;;)
+        {
+            const std::string_view pending = std::string_view(m_incoming).substr(m_offset);
+            const size_t size = QueryFrame::Complete(pending);
+            if (size == SIZE_MAX)
+            {
+                m_connection.reset();
+                return false;
+            }
+            if (size > 0)
+            {
+                m_offset += size;
+                if (QueryFrame::ParseResponse(pending.substr(0, size), response)) return true;
+                m_connection.reset();
+                return false;
+            }
+
+            // Drop what was consumed before reading more
+            m_incoming.erase(0, m_offset);
+            m_offset = 0;
+
+            char chunk[ReadChunkBytes];
+            const size_t read = m_connection->Read(chunk, sizeof(chunk));
+            if (read == 0)
+            {
+                m_connection.reset();
+                return false;
+            }
+            m_incoming.append(chunk, read);
+        }
+    }
+
+    QueryStatus QueryClient::Fetch(uint32_t id, std::vector<QueryRow>& rows)
+    {
+        if (!Send()) return QueryStatus::NoSnapshot;
+
+        QueryResponse response;
+        while (Next(response))
+        {
+            if (response.Id != id) continue;
+            if (response.Kind == QueryKind::Row)
+            {
+                if (response.Json.empty()) rows.push_back(std::move(response.Row));
+            }
+            else
+            {
+                return response.Status;
+            }
+        }
+        return QueryStatus::NoSnapshot;
+    }
+
+    uint32_t QueryClient::Queue(QueryRequest& request)
+    {
+        request.Id = m_nextId++;
+        QueryFrame::AppendRequest(m_outgoing, request);
+        return request.Id;
+    }
+}
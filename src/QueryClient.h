@@ -0,0 +1,72 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "QueryProtocol.h"
+#include "QueryTransport.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace UIAListCore
+{
+    // Client side of the query API, for screen reader add-ons and test
+    // scripts. Requests are queued and go out with Send, so a client can
+    // pipeline as many as it likes and then read the answers in order:
+    //
+    //   QueryClient client(ConnectQueryPipe(QueryPipeName()));
+    //   uint32_t buttons = client.Filter(0, "button");
+    //   uint32_t first = client.Query(0, 0);
+    //   client.Send();
+    //   QueryResponse response;
+    //   while (client.Next(response)) ...  // Rows of buttons, its Done, then first's
+    //
+    // Not thread-safe; use one client per thread.
+    class QueryClient
+    {
+    public:
+        explicit QueryClient(std::unique_ptr<QueryConnection> connection);
+        ~QueryClient();
+
+        QueryClient(const QueryClient&) = delete;
+        QueryClient& operator=(const QueryClient&) = delete;
+
+        bool IsConnected() const { return m_connection != nullptr; }
+
+        // Queue a request, return its id. window 0 is the window the list was last shown for.
+        uint32_t Enumerate(uint64_t window, QueryFormat format = QueryFormat::Binary);
+        uint32_t Filter(uint64_t window, const std::string& text, QueryFormat format = QueryFormat::Binary);
+        uint32_t Query(uint64_t window, uint32_t index, QueryFormat format = QueryFormat::Binary);
+        uint32_t Invoke(uint64_t window, uint32_t index, ActionKind action);
+
+        // Writes the queued requests; false once the connection is gone
+        bool Send();
+
+        // Blocks for the next response frame; false once the connection is gone
+        // or the server sent something unreadable
+        bool Next(QueryResponse& response);
+
+        // Sends what is queued and collects the binary rows of request id, for
+        // clients that do not pipeline; answers to other requests are skipped
+        QueryStatus Fetch(uint32_t id, std::vector<QueryRow>& rows);
+
+    private:
+        uint32_t Queue(QueryRequest& request);
+
+        std::unique_ptr<QueryConnection> m_connection;
+        std::string m_outgoing;
+        std::string m_incoming;
+        size_t m_offset{ 0 };  // Start of the next frame in m_incoming
+        uint32_t m_nextId{ 1 };
+    };
+}
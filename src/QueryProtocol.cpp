@@ -0,0 +1,264 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "QueryProtocol.h"
+#include "ControlWalker.h"
+#include "Varint.h"
+
+#include <cstdio>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        void PutUint32(std::string& out, uint32_t value)
+        {
+            for (int shift = 0; shift < 32; shift += 8)
+            {
+                out += static_cast<char>((value >> shift) & 0xFF);
+            }
+        }
+
+        uint32_t GetUint32(std::string_view data)
+        {
+            uint32_t value = 0;
+            for (int i = 3; i >= 0; --i)
+            {
+                value = (value << 8) | static_cast<unsigned char>(data[static_cast<size_t>(i)]);
+            }
+            return value;
+        }
+
+        // Starts a frame; EndFrame fills in the size
+        size_t BeginFrame(std::string& out, uint32_t id, QueryKind kind)
+        {
+            const size_t start = out.size();
+            PutUint32(out, 0);
+            PutUint32(out, id);
+            out += static_cast<char>(kind);
+            return start;
+        }
+
+        void EndFrame(std::string& out, size_t start)
+        {
+            const uint32_t size = static_cast<uint32_t>(out.size() - start - 4);
+            for (int i = 0; i < 4; ++i)
+            {
+                out[start + static_cast<size_t>(i)] = static_cast<char>((size >> (8 * i)) & 0xFF);
+            }
+        }
+
+        // Text is UTF-8 already, only JSON's specials need escaping
+        void PutJsonString(std::string& out, std::string_view text)
+        {
+            out += '"';
+            for (char c : text)
+            {
+                const unsigned char byte = static_cast<unsigned char>(c);
+                if (c == '"' || c == '\\')
+                {
+                    out += '\\';
+                    out += c;
+                }
+                else if (byte < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", byte);
+                    out += escaped;
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+            out += '"';
+        }
+    }
+
+    const char* ToString(QueryKind kind)
+    {
+        switch (kind)
+        {
+        case QueryKind::Enumerate: return "Enumerate";
+        case QueryKind::Filter: return "Filter";
+        case QueryKind::Query: return "Query";
+        case QueryKind::Invoke: return "Invoke";
+        case QueryKind::Row: return "Row";
+        case QueryKind::Done: return "Done";
+        case QueryKind::Error: return "Error";
+        }
+        return "Unknown";
+    }
+
+    const char* ToString(QueryStatus status)
+    {
+        switch (status)
+        {
+        case QueryStatus::Ok: return "Ok";
+        case QueryStatus::NoSnapshot: return "NoSnapshot";
+        case QueryStatus::NoSuchControl: return "NoSuchControl";
+        case QueryStatus::BadRequest: return "BadRequest";
+        case QueryStatus::ActionFailed: return "ActionFailed";
+        case QueryStatus::TimedOut: return "TimedOut";
+        }
+        return "Unknown";
+    }
+
+    namespace QueryFrame
+    {
+        size_t Complete(std::string_view data)
+        {
+            if (data.size() < 4) return 0;
+            const size_t size = static_cast<size_t>(GetUint32(data)) + 4;
+            if (size < HeaderSize || size > MaxSize) return SIZE_MAX;
+            return data.size() >= size ? size : 0;
+        }
+
+        void AppendRequest(std::string& out, const QueryRequest& request)
+        {
+            const size_t start = BeginFrame(out, request.Id, request.Kind);
+            out += static_cast<char>(request.Format);
+            PutVarint(out, request.Window);
+            switch (request.Kind)
+            {
+            case QueryKind::Filter:
+                PutString(out, request.Text);
+                break;
+            case QueryKind::Query:
+                PutVarint(out, request.Index);
+                break;
+            case QueryKind::Invoke:
+                PutVarint(out, request.Index);
+                PutVarint(out, static_cast<uint64_t>(request.Action));
+                break;
+            default:
+                break;
+            }
+            EndFrame(out, start);
+        }
+
+        bool ParseRequest(std::string_view frame, QueryRequest& request)
+        {
+            if (frame.size() < HeaderSize + 1) return false;
+            request = QueryRequest();
+            request.Id = GetUint32(frame.substr(4));
+            request.Kind = static_cast<QueryKind>(frame[8]);
+            const uint8_t format = static_cast<uint8_t>(frame[9]);
+            if (format > static_cast<uint8_t>(QueryFormat::Json)) return false;
+            request.Format = static_cast<QueryFormat>(format);
+
+            VarintReader reader(frame, HeaderSize + 1);
+            if (!reader.GetVarint(request.Window)) return false;
+            switch (request.Kind)
+            {
+            case QueryKind::Enumerate:
+                return true;
+            case QueryKind::Filter:
+                return reader.GetString(request.Text);
+            case QueryKind::Query:
+                return reader.GetUint32(request.Index);
+            case QueryKind::Invoke:
+            {
+                uint32_t action = 0;
+                if (!reader.GetUint32(request.Index) || !reader.GetUint32(action)) return false;
+                if (action > static_cast<uint32_t>(ActionKind::Focus)) return false;
+                request.Action = static_cast<ActionKind>(action);
+                return true;
+            }
+            default:
+                return false;
+            }
+        }
+
+        void AppendRow(std::string& out, uint32_t id, QueryFormat format, const QueryRow& row)
+        {
+            const size_t start = BeginFrame(out, id, QueryKind::Row);
+            out += static_cast<char>(format);
+            if (format == QueryFormat::Json)
+            {
+                out += "{\"index\":";
+                out += std::to_string(row.Index);
+                out += ",\"type\":";
+                PutJsonString(out, ControlTypeName(row.ControlType));
+                out += ",\"controlType\":";
+                out += std::to_string(row.ControlType);
+                out += ",\"name\":";
+                PutJsonString(out, row.Name);
+                out += ",\"text\":";
+                PutJsonString(out, row.Text);
+                out += '}';
+            }
+            else
+            {
+                PutVarint(out, row.Index);
+                PutVarint(out, static_cast<uint32_t>(row.ControlType));
+                PutString(out, row.Name);
+                PutString(out, row.Text);
+            }
+            EndFrame(out, start);
+        }
+
+        void AppendDone(std::string& out, uint32_t id, QueryStatus status, uint64_t count)
+        {
+            const size_t start = BeginFrame(out, id, QueryKind::Done);
+            out += static_cast<char>(status);
+            PutVarint(out, count);
+            EndFrame(out, start);
+        }
+
+        void AppendError(std::string& out, uint32_t id, QueryStatus status, std::string_view message)
+        {
+            const size_t start = BeginFrame(out, id, QueryKind::Error);
+            out += static_cast<char>(status);
+            PutString(out, message);
+            EndFrame(out, start);
+        }
+
+        bool ParseResponse(std::string_view frame, QueryResponse& response)
+        {
+            if (frame.size() < HeaderSize) return false;
+            response.Id = GetUint32(frame.substr(4));
+            response.Kind = static_cast<QueryKind>(frame[8]);
+            response.Json.clear();
+            response.Status = QueryStatus::Ok;
+            response.Count = 0;
+            response.Message.clear();
+
+            switch (response.Kind)
+            {
+            case QueryKind::Row:
+            {
+                if (frame.size() < HeaderSize + 1) return false;
+                if (static_cast<QueryFormat>(frame[HeaderSize]) == QueryFormat::Json)
+                {
+                    response.Json.assign(frame.substr(HeaderSize + 1));
+                    return true;
+                }
+                VarintReader reader(frame, HeaderSize + 1);
+                uint32_t controlType = 0;
+                if (!reader.GetUint32(response.Row.Index) || !reader.GetUint32(controlType)) return false;
+                response.Row.ControlType = static_cast<int32_t>(controlType);
+                return reader.GetString(response.Row.Name) && reader.GetString(response.Row.Text);
+            }
+            case QueryKind::Done:
+            case QueryKind::Error:
+            {
+                if (frame.size() < HeaderSize + 1) return false;
+                response.Status = static_cast<QueryStatus>(frame[HeaderSize]);
+                VarintReader rest(frame, HeaderSize + 1);
+                if (response.Kind == QueryKind::Done) return rest.GetVarint(response.Count);
+                return rest.GetString(response.Message);
+            }
+            default:
+                return false;
+            }
+        }
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "ActionStrategy.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UIAListCore
+{
+    // Wire format of the query API, shared by QueryServer and QueryClient.
+    //
+    // Every message is a frame: u32 size (of the rest, little endian), u32
+    // request id, u8 kind, payload. A client may send any number of requests
+    // before reading; the server answers them in order, each with zero or
+    // more Row frames and one Done or Error frame carrying the request's id.
+    //
+    // Request payloads start with the response format and the window
+    // (varint HWND, 0 for the window the list was last shown for):
+    //   Enumerate  format window
+    //   Filter     format window text           (UTF-8, case-insensitive substring)
+    //   Query      format window index
+    //   Invoke     format window index action   (ActionKind)
+    // Row payloads start with the format: then varint index, varint control
+    // type, name and text as length-prefixed UTF-8, or one JSON object.
+    // Done carries the status and the row count, Error the status and a message.
+    enum class QueryKind : uint8_t
+    {
+        Enumerate = 1,
+        Filter = 2,
+        Query = 3,
+        Invoke = 4,
+
+        Row = 16,
+        Done = 17,
+        Error = 18
+    };
+
+    enum class QueryFormat : uint8_t
+    {
+        Binary,
+        Json
+    };
+
+    enum class QueryStatus : uint8_t
+    {
+        Ok,
+        NoSnapshot,      // Nothing enumerated for the window, and it could not be walked
+        NoSuchControl,   // Index outside the snapshot
+        BadRequest,
+        ActionFailed,
+        TimedOut
+    };
+
+    const char* ToString(QueryKind kind);
+    const char* ToString(QueryStatus status);
+
+    // One control as served: UTF-8, the way it appears in the list
+    struct QueryRow
+    {
+        uint32_t Index{ 0 };      // Position in the snapshot, what Query and Invoke take
+        int32_t ControlType{ 0 };
+        std::string Name;
+        std::string Text;         // List text, e.g. "Button: OK"
+    };
+
+    // The controls of one window, immutable once published
+    struct QuerySnapshot
+    {
+        uint64_t Window{ 0 };
+        std::string Title;
+        std::vector<QueryRow> Rows;
+    };
+
+    struct QueryRequest
+    {
+        uint32_t Id{ 0 };
+        QueryKind Kind{ QueryKind::Enumerate };
+        QueryFormat Format{ QueryFormat::Binary };
+        uint64_t Window{ 0 };
+        std::string Text;    // Filter
+        uint32_t Index{ 0 }; // Query, Invoke
+        ActionKind Action{ ActionKind::Click };
+    };
+
+    struct QueryResponse
+    {
+        uint32_t Id{ 0 };
+        QueryKind Kind{ QueryKind::Done };
+        QueryRow Row;        // Row, binary format
+        std::string Json;    // Row, JSON format
+        QueryStatus Status{ QueryStatus::Ok };
+        uint64_t Count{ 0 }; // Done: rows sent
+        std::string Message; // Error
+    };
+
+    namespace QueryFrame
+    {
+        constexpr size_t HeaderSize = 9;
+        constexpr size_t MaxSize = 16 * 1024 * 1024;
+
+        // Size of the complete frame at the start of data, 0 while more is
+        // needed, SIZE_MAX for a frame over MaxSize (the stream is broken)
+        size_t Complete(std::string_view data);
+
+        void AppendRequest(std::string& out, const QueryRequest& request);
+        bool ParseRequest(std::string_view frame, QueryRequest& request);
+
+        void AppendRow(std::string& out, uint32_t id, QueryFormat format, const QueryRow& row);
+        void AppendDone(std::string& out, uint32_t id, QueryStatus status, uint64_t count);
+        void AppendError(std::string& out, uint32_t id, QueryStatus status, std::string_view message);
+        bool ParseResponse(std::string_view frame, QueryResponse& response);
+    }
+}
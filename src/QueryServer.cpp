@@ -0,0 +1,374 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "QueryServer.h"
+#include "ControlWalker.h"
+#include "Log.h"
+#include "Trace.h"
+#include "Utf8.h"
+
+#include <algorithm>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        // Answers are written once this much is pending, or when no more requests are in
+        constexpr size_t WriteBatchBytes = 64 * 1024;
+        constexpr size_t ReadChunkBytes = 16 * 1024;
+
+        char FoldAscii(char c)
+        {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        std::string FoldAscii(std::string_view text)
+        {
+            std::string folded(text);
+            for (char& c : folded) c = FoldAscii(c);
+            return folded;
+        }
+
+        // needle already folded. Skips to the positions where its first
+        // byte occurs before comparing the rest.
+        bool ContainsFolded(std::string_view text, std::string_view needle)
+        {
+            if (needle.empty()) return true;
+            if (needle.size() > text.size()) return false;
+
+            const char lower = needle[0];
+            const char upper = (lower >= 'a' && lower <= 'z') ? static_cast<char>(lower - 'a' + 'A') : lower;
+            const size_t last = text.size() - needle.size();
+            for (size_t start = 0; start <= last; ++start)
+            {
+                if (text[start] != lower && text[start] != upper) continue;
+
+                size_t i = 1;
+                while (i < needle.size() && FoldAscii(text[start + i]) == needle[i]) ++i;
+                if (i == needle.size()) return true;
+            }
+            return false;
+        }
+
+        bool EndsWith(std::string_view text, std::string_view suffix)
+        {
+            return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+        }
+
+        bool MatchesFolded(const QueryRow& row, std::string_view needle)
+        {
+            // Text is "Button: OK": a match in the name is one in the text too
+            if (ContainsFolded(row.Text, needle)) return true;
+            return !EndsWith(row.Text, row.Name) && ContainsFolded(row.Name, needle);
+        }
+    }
+
+    QuerySnapshotCache::QuerySnapshotCache(ProviderFactory factory, Invoker invoker)
+        : m_factory(std::move(factory))
+        , m_invoker(std::move(invoker))
+    {
+    }
+
+    void QuerySnapshotCache::Publish(std::shared_ptr<const QuerySnapshot> snapshot)
+    {
+        if (!snapshot) return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_published = snapshot->Window;
+        Insert(std::move(snapshot));
+    }
+
+    void QuerySnapshotCache::Remove(uint64_t window)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_snapshots.remove_if([window](const auto& snapshot) { return snapshot->Window == window; });
+    }
+
+    std::shared_ptr<const QuerySnapshot> QuerySnapshotCache::Snapshot(uint64_t window)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (window == 0) window = m_published;
+
+            auto found = std::find_if(m_snapshots.begin(), m_snapshots.end(),
+                                      [window](const auto& snapshot) { return snapshot->Window == window; });
+            if (found != m_snapshots.end())
+            {
+                m_snapshots.splice(m_snapshots.begin(), m_snapshots, found);
+                return m_snapshots.front();
+            }
+        }
+        if (window == 0 || !m_factory) return nullptr;
+
+        // Not under the lock: a slow window must not hold up the other clients
+        TraceSpan span("QueryWalk");
+        std::unique_ptr<TreeProvider> provider = m_factory(window);
+        std::shared_ptr<QuerySnapshot> snapshot = provider ? Walk(*provider, window) : nullptr;
+        if (!snapshot) return nullptr;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Insert(snapshot);
+        return snapshot;
+    }
+
+    QueryStatus QuerySnapshotCache::Invoke(uint64_t window, uint32_t index, ActionKind action)
+    {
+        if (!m_invoker) return QueryStatus::ActionFailed;
+        if (window == 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            window = m_published;
+        }
+        return m_invoker(window, index, action);
+    }
+
+    std::shared_ptr<QuerySnapshot> QuerySnapshotCache::Walk(TreeProvider& provider, uint64_t window)
+    {
+        auto snapshot = std::make_shared<QuerySnapshot>();
+        snapshot->Window = window;
+
+        ControlWalker walker(provider, WalkMode::BuildCache, PropertyControlType | PropertyName);
+        const bool walked = walker.Walk([&snapshot](TreeElement&, const ElementProperties& properties, size_t depth)
+        {
+            QueryRow row;
+            row.Index = static_cast<uint32_t>(snapshot->Rows.size());
+            row.ControlType = properties.ControlType;
+            row.Name = ToUtf8(properties.Name);
+            row.Text = ControlTypeName(properties.ControlType);
+            row.Text += ": ";
+            row.Text += properties.HasName ? row.Name : std::string("(no name)");
+            if (depth == 0) snapshot->Title = row.Name;
+            snapshot->Rows.push_back(std::move(row));
+        });
+        if (!walked) return nullptr;
+        return snapshot;
+    }
+
+    void QuerySnapshotCache::Insert(std::shared_ptr<const QuerySnapshot> snapshot)
+    {
+        const uint64_t window = snapshot->Window;
+        m_snapshots.remove_if([window](const auto& held) { return held->Window == window; });
+        m_snapshots.push_front(std::move(snapshot));
+        if (m_snapshots.size() > Capacity) m_snapshots.pop_back();
+    }
+
+    QueryServer::QueryServer(QuerySource& source, ThreadHook onThreadStart, ThreadHook onThreadStop)
+        : m_source(source)
+        , m_onThreadStart(std::move(onThreadStart))
+        , m_onThreadStop(std::move(onThreadStop))
+    {
+    }
+
+    QueryServer::~QueryServer()
+    {
+        Stop();
+    }
+
+    void QueryServer::Start(std::unique_ptr<QueryListener> listener)
+    {
+        Stop();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = false;
+        }
+        m_listener = std::move(listener);
+        m_acceptThread = std::thread(&QueryServer::AcceptLoop, this);
+    }
+
+    void QueryServer::Stop()
+    {
+        if (!m_acceptThread.joinable()) return;
+
+        std::list<std::unique_ptr<Session>> sessions;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            for (const auto& session : m_sessions)
+            {
+                session->Connection->Close();
+            }
+        }
+        m_listener->Close();
+        m_acceptThread.join();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            sessions.swap(m_sessions);
+        }
+        for (const auto& session : sessions)
+        {
+            session->Connection->Close();
+            session->Thread.join();
+        }
+        m_listener.reset();
+    }
+
+    QueryServer::Stats QueryServer::GetStats() const
+    {
+        Stats stats;
+        stats.Connections = m_connections;
+        stats.Requests = m_requests;
+        stats.Rows = m_rows;
+        return stats;
+    }
+
+    bool QueryServer::Matches(const QueryRow& row, std::string_view text)
+    {
+        return text.empty() || MatchesFolded(row, FoldAscii(text));
+    }
+
+    void QueryServer::AcceptLoop()
+    {
+        for (;;)
+        {
+            std::unique_ptr<QueryConnection> connection = m_listener->Accept();
+            if (!connection) break;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping)
+            {
+                connection->Close();
+                break;
+            }
+
+            // Threads of clients that went away
+            for (auto it = m_sessions.begin(); it != m_sessions.end();)
+            {
+                if ((*it)->Finished)
+                {
+                    (*it)->Thread.join();
+                    it = m_sessions.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            ++m_connections;
+            auto session = std::make_unique<Session>();
+            session->Connection = std::move(connection);
+            Session& started = *session;
+            m_sessions.push_back(std::move(session));
+            started.Thread = std::thread([this, &started]() {
+                if (m_onThreadStart) m_onThreadStart();
+                Serve(started);
+                if (m_onThreadStop) m_onThreadStop();
+                started.Finished = true;
+            });
+        }
+    }
+
+    void QueryServer::Serve(Session& session)
+    {
+        QueryConnection& connection = *session.Connection;
+        std::string input;
+        std::string output;
+        char chunk[ReadChunkBytes];
+
+        for (;;)
+        {
+            const size_t read = connection.Read(chunk, sizeof(chunk));
+            if (read == 0) break;
+            input.append(chunk, read);
+
+            // Every complete request that arrived, then one write for all answers
+            size_t offset = 0;
+            for (;;)
+            {
+                const std::string_view pending = std::string_view(input).substr(offset);
+                const size_t size = QueryFrame::Complete(pending);
+                if (size == SIZE_MAX)
+                {
+                    UIALIST_LOG(Warning, "Query client sent an oversized frame, closing the connection");
+                    connection.Close();
+                    return;
+                }
+                if (size == 0) break;
+
+                QueryRequest request;
+                if (QueryFrame::ParseRequest(pending.substr(0, size), request))
+                {
+                    if (!Handle(request, output, connection)) return;
+                }
+                else
+                {
+                    QueryFrame::AppendError(output, request.Id, QueryStatus::BadRequest, "Malformed request");
+                }
+                offset += size;
+                ++m_requests;
+            }
+            input.erase(0, offset);
+
+            if (!output.empty())
+            {
+                if (!connection.Write(output.data(), output.size())) return;
+                output.clear();
+            }
+        }
+        connection.Close();
+    }
+
+    bool QueryServer::Handle(const QueryRequest& request, std::string& out, QueryConnection& connection)
+    {
+        if (request.Kind == QueryKind::Invoke)
+        {
+            const QueryStatus status = m_source.Invoke(request.Window, request.Index, request.Action);
+            QueryFrame::AppendDone(out, request.Id, status, 0);
+            return true;
+        }
+
+        std::shared_ptr<const QuerySnapshot> snapshot = m_source.Snapshot(request.Window);
+        if (!snapshot)
+        {
+            QueryFrame::AppendError(out, request.Id, QueryStatus::NoSnapshot, "No controls for this window");
+            return true;
+        }
+
+        uint64_t count = 0;
+        switch (request.Kind)
+        {
+        case QueryKind::Enumerate:
+        case QueryKind::Filter:
+        {
+            // Folded once, not per row
+            const std::string needle = FoldAscii(request.Text);
+            const bool filtered = request.Kind == QueryKind::Filter && !needle.empty();
+            for (const QueryRow& row : snapshot->Rows)
+            {
+                if (filtered && !MatchesFolded(row, needle)) continue;
+                QueryFrame::AppendRow(out, request.Id, request.Format, row);
+                ++count;
+
+                // Large snapshots stream out instead of piling up
+                if (out.size() >= WriteBatchBytes)
+                {
+                    if (!connection.Write(out.data(), out.size())) return false;
+                    out.clear();
+                }
+            }
+            break;
+        }
+        case QueryKind::Query:
+            if (request.Index >= snapshot->Rows.size())
+            {
+                QueryFrame::AppendError(out, request.Id, QueryStatus::NoSuchControl, "No control at this index");
+                return true;
+            }
+            QueryFrame::AppendRow(out, request.Id, request.Format, snapshot->Rows[request.Index]);
+            count = 1;
+            break;
+        default:
+            break;
+        }
+        m_rows += count;
+        QueryFrame::AppendDone(out, request.Id, QueryStatus::Ok, count);
+        return true;
+    }
+}
@@ -0,0 +1,141 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "QueryProtocol.h"
+#include "QueryTransport.h"
+#include "TreeProvider.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace UIAListCore
+{
+    // What the query API serves. Called on the server's connection threads.
+    class QuerySource
+    {
+    public:
+        virtual ~QuerySource() = default;
+
+        // The controls of window (0: the one the list was last shown for);
+        // null when there is none
+        virtual std::shared_ptr<const QuerySnapshot> Snapshot(uint64_t window) = 0;
+
+        // Performs the action on a control of the snapshot, blocking until it finished
+        virtual QueryStatus Invoke(uint64_t window, uint32_t index, ActionKind action) = 0;
+    };
+
+    // The snapshots a frontend already has, so clients reuse its warm list
+    // instead of walking the tree again. The frontend publishes its list
+    // when an enumeration finishes; windows it has no list for are walked
+    // on the requesting thread through the provider factory and kept, the
+    // least recently used dropped beyond Capacity.
+    class QuerySnapshotCache : public QuerySource
+    {
+    public:
+        using ProviderFactory = std::function<std::unique_ptr<TreeProvider>(uint64_t window)>;
+        using Invoker = std::function<QueryStatus(uint64_t window, uint32_t index, ActionKind action)>;
+
+        static constexpr size_t Capacity = 4;
+
+        // Without a factory only published snapshots are served, without an
+        // invoker Invoke fails
+        explicit QuerySnapshotCache(ProviderFactory factory = {}, Invoker invoker = {});
+
+        // Becomes the answer for window 0, replaces an older one of the same window
+        void Publish(std::shared_ptr<const QuerySnapshot> snapshot);
+        void Remove(uint64_t window);
+
+        std::shared_ptr<const QuerySnapshot> Snapshot(uint64_t window) override;
+        QueryStatus Invoke(uint64_t window, uint32_t index, ActionKind action) override;
+
+        // Rows the way the lists show them, "Button: OK"
+        static std::shared_ptr<QuerySnapshot> Walk(TreeProvider& provider, uint64_t window);
+
+    private:
+        void Insert(std::shared_ptr<const QuerySnapshot> snapshot);
+
+        ProviderFactory m_factory;
+        Invoker m_invoker;
+
+        std::mutex m_mutex;
+        std::list<std::shared_ptr<const QuerySnapshot>> m_snapshots;  // Most recently used first
+        uint64_t m_published{ 0 };  // Window of the last Publish
+    };
+
+    // Serves the query API on every connection the listener accepts, one
+    // thread per connection. Requests on a connection are answered in order;
+    // answers are written in batches, once per read of pipelined requests.
+    class QueryServer
+    {
+    public:
+        using ThreadHook = std::function<void()>;
+
+        struct Stats
+        {
+            uint64_t Connections{ 0 };
+            uint64_t Requests{ 0 };
+            uint64_t Rows{ 0 };
+        };
+
+        // onThreadStart/onThreadStop run on every connection thread (COM init/uninit)
+        explicit QueryServer(QuerySource& source, ThreadHook onThreadStart = {}, ThreadHook onThreadStop = {});
+        ~QueryServer();
+
+        QueryServer(const QueryServer&) = delete;
+        QueryServer& operator=(const QueryServer&) = delete;
+
+        void Start(std::unique_ptr<QueryListener> listener);
+
+        // Closes the listener and every connection, waits for their threads
+        void Stop();
+
+        Stats GetStats() const;
+
+        // Case-insensitive for ASCII, exact beyond
+        static bool Matches(const QueryRow& row, std::string_view text);
+
+    private:
+        struct Session
+        {
+            std::unique_ptr<QueryConnection> Connection;
+            std::thread Thread;
+            std::atomic<bool> Finished{ false };
+        };
+
+        void AcceptLoop();
+        void Serve(Session& session);
+
+        // False when the connection broke while writing
+        bool Handle(const QueryRequest& request, std::string& out, QueryConnection& connection);
+
+        QuerySource& m_source;
+        ThreadHook m_onThreadStart;
+        ThreadHook m_onThreadStop;
+
+        std::unique_ptr<QueryListener> m_listener;
+        std::thread m_acceptThread;
+
+        std::mutex m_mutex;
+        std::list<std::unique_ptr<Session>> m_sessions;
+        bool m_stopping{ false };
+
+        std::atomic<uint64_t> m_connections{ 0 };
+        std::atomic<uint64_t> m_requests{ 0 };
+        std::atomic<uint64_t> m_rows{ 0 };
+    };
+}
@@ -0,0 +1,147 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "QueryTransport.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        // One direction of a loopback connection
+        struct LoopbackPipe
+        {
+            std::mutex Mutex;
+            std::condition_variable Changed;
+            std::string Data;
+            size_t Offset{ 0 };  // Read up to here
+            bool Closed{ false };
+
+            void Close()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(Mutex);
+                    Closed = true;
+                }
+                Changed.notify_all();
+            }
+        };
+
+        class LoopbackConnection : public QueryConnection
+        {
+        public:
+            LoopbackConnection(std::shared_ptr<LoopbackPipe> in, std::shared_ptr<LoopbackPipe> out)
+                : m_in(std::move(in))
+                , m_out(std::move(out))
+            {
+            }
+
+            ~LoopbackConnection() override
+            {
+                Close();
+            }
+
+            size_t Read(char* data, size_t size) override
+            {
+                LoopbackPipe& pipe = *m_in;
+                std::unique_lock<std::mutex> lock(pipe.Mutex);
+                pipe.Changed.wait(lock, [&pipe]() { return pipe.Offset < pipe.Data.size() || pipe.Closed; });
+                if (pipe.Offset == pipe.Data.size()) return 0;
+
+                const size_t count = std::min(size, pipe.Data.size() - pipe.Offset);
+                std::memcpy(data, pipe.Data.data() + pipe.Offset, count);
+                pipe.Offset += count;
+                if (pipe.Offset == pipe.Data.size())
+                {
+                    pipe.Data.clear();
+                    pipe.Offset = 0;
+                }
+                else if (pipe.Offset >= LoopbackListener::Capacity)
+                {
+                    // A reader that never quite catches up must not grow the buffer forever
+                    pipe.Data.erase(0, pipe.Offset);
+                    pipe.Offset = 0;
+                }
+                lock.unlock();
+                pipe.Changed.notify_all();
+                return count;
+            }
+
+            bool Write(const char* data, size_t size) override
+            {
+                LoopbackPipe& pipe = *m_out;
+                while (size > 0)
+                {
+                    std::unique_lock<std::mutex> lock(pipe.Mutex);
+                    pipe.Changed.wait(lock, [&pipe]() {
+                        return pipe.Data.size() - pipe.Offset < LoopbackListener::Capacity || pipe.Closed;
+                    });
+                    if (pipe.Closed) return false;
+
+                    const size_t count = std::min(size, LoopbackListener::Capacity - (pipe.Data.size() - pipe.Offset));
+                    pipe.Data.append(data, count);
+                    data += count;
+                    size -= count;
+                    lock.unlock();
+                    pipe.Changed.notify_all();
+                }
+                return true;
+            }
+
+            void Close() override
+            {
+                m_in->Close();
+                m_out->Close();
+            }
+
+        private:
+            std::shared_ptr<LoopbackPipe> m_in;
+            std::shared_ptr<LoopbackPipe> m_out;
+        };
+    }
+
+    std::unique_ptr<QueryConnection> LoopbackListener::Connect()
+    {
+        auto toServer = std::make_shared<LoopbackPipe>();
+        auto toClient = std::make_shared<LoopbackPipe>();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_closed) return nullptr;
+            m_pending.push_back(std::make_unique<LoopbackConnection>(toServer, toClient));
+        }
+        m_changed.notify_one();
+        return std::make_unique<LoopbackConnection>(toClient, toServer);
+    }
+
+    std::unique_ptr<QueryConnection> LoopbackListener::Accept()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this]() { return !m_pending.empty() || m_closed; });
+        if (m_closed) return nullptr;
+
+        std::unique_ptr<QueryConnection> connection = std::move(m_pending.front());
+        m_pending.pop_front();
+        return connection;
+    }
+
+    void LoopbackListener::Close()
+    {
+        std::deque<std::unique_ptr<QueryConnection>> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+            pending.swap(m_pending);
+        }
+        m_changed.notify_all();
+        // Dropping the pending server ends closes them for their clients
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace UIAListCore
+{
+    // One byte stream between a query client and the server. Implemented over
+    // named pipes on Windows (NamedPipeTransport) and in-process by Loopback.
+    class QueryConnection
+    {
+    public:
+        virtual ~QueryConnection() = default;
+
+        // Blocks until at least one byte is there; 0 once the other side or
+        // Close ended the connection
+        virtual size_t Read(char* data, size_t size) = 0;
+
+        // All of it, blocking while the other side does not read; false once closed
+        virtual bool Write(const char* data, size_t size) = 0;
+
+        // Ends the connection, wakes blocked Read and Write calls; any thread
+        virtual void Close() = 0;
+    };
+
+    class QueryListener
+    {
+    public:
+        virtual ~QueryListener() = default;
+
+        // Blocks for the next client; null once closed
+        virtual std::unique_ptr<QueryConnection> Accept() = 0;
+
+        // Wakes a blocked Accept; any thread
+        virtual void Close() = 0;
+    };
+
+    // In-process stand-in for the named pipe, where there is none (Linux,
+    // the load benchmark). Each direction buffers up to Capacity bytes, then
+    // Write blocks like a full pipe does.
+    class LoopbackListener : public QueryListener
+    {
+    public:
+        static constexpr size_t Capacity = 1024 * 1024;
+
+        // The client end; null once the listener is closed
+        std::unique_ptr<QueryConnection> Connect();
+
+        std::unique_ptr<QueryConnection> Accept() override;
+        void Close() override;
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_changed;
+        std::deque<std::unique_ptr<QueryConnection>> m_pending;  // Server ends not accepted yet
+        bool m_closed{ false };
+    };
+}
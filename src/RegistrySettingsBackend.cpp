@@ -0,0 +1,133 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "RegistrySettingsBackend.h"
+#include "Utf8.h"
+
+#include <vector>
+
+namespace UIAListCore
+{
+    RegistrySettingsBackend::RegistrySettingsBackend()
+    {
+        m_changed = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        m_wake = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    }
+
+    RegistrySettingsBackend::~RegistrySettingsBackend()
+    {
+        if (m_watchedKey) RegCloseKey(m_watchedKey);
+        if (m_changed) CloseHandle(m_changed);
+        if (m_wake) CloseHandle(m_wake);
+    }
+
+    SettingValues RegistrySettingsBackend::Load()
+    {
+        SettingValues values;
+        HKEY key;
+        if (RegOpenKeyExW(HKEY_CURRENT_USER, KeyPath, 0, KEY_QUERY_VALUE, &key) != ERROR_SUCCESS) return values;
+
+        DWORD maxNameLength = 0;
+        DWORD maxDataBytes = 0;
+        RegQueryInfoKeyW(key, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &maxNameLength,
+                         &maxDataBytes, nullptr, nullptr);
+        std::vector<wchar_t> name(maxNameLength + 1);
+        std::vector<BYTE> data(maxDataBytes + sizeof(wchar_t));
+
+        for (DWORD index = 0;; ++index)
+        {
+            DWORD nameLength = static_cast<DWORD>(name.size());
+            DWORD dataBytes = static_cast<DWORD>(data.size());
+            DWORD type = 0;
+            const LONG result = RegEnumValueW(key, index, name.data(), &nameLength, nullptr, &type, data.data(), &dataBytes);
+            if (result != ERROR_SUCCESS) break;
+
+            const std::string valueName = ToUtf8(std::wstring(name.data(), nameLength));
+            if (type == REG_DWORD && dataBytes == sizeof(DWORD))
+            {
+                values[valueName] = *reinterpret_cast<const DWORD*>(data.data());
+            }
+            else if (type == REG_SZ)
+            {
+                std::wstring text(reinterpret_cast<const wchar_t*>(data.data()), dataBytes / sizeof(wchar_t));
+                while (!text.empty() && text.back() == L'\0') text.pop_back();
+                values[valueName] = std::move(text);
+            }
+        }
+
+        RegCloseKey(key);
+        return values;
+    }
+
+    bool RegistrySettingsBackend::Store(const SettingValues& values)
+    {
+        HKEY key;
+        if (RegCreateKeyExW(HKEY_CURRENT_USER, KeyPath, 0, nullptr, REG_OPTION_NON_VOLATILE, KEY_SET_VALUE, nullptr,
+                            &key, nullptr) != ERROR_SUCCESS)
+        {
+            return false;
+        }
+
+        bool stored = true;
+        for (const auto& [name, value] : values)
+        {
+            const std::wstring valueName = FromUtf8(name);
+            LONG result;
+            if (const uint32_t* number = std::get_if<uint32_t>(&value))
+            {
+                const DWORD dword = *number;
+                result = RegSetValueExW(key, valueName.c_str(), 0, REG_DWORD, reinterpret_cast<const BYTE*>(&dword),
+                                        sizeof(dword));
+            }
+            else
+            {
+                const std::wstring& text = std::get<std::wstring>(value);
+                result = RegSetValueExW(key, valueName.c_str(), 0, REG_SZ, reinterpret_cast<const BYTE*>(text.c_str()),
+                                        static_cast<DWORD>((text.size() + 1) * sizeof(wchar_t)));
+            }
+            stored = stored && result == ERROR_SUCCESS;
+        }
+
+        RegCloseKey(key);
+        return stored;
+    }
+
+    bool RegistrySettingsBackend::WaitForChange(std::chrono::milliseconds timeout)
+    {
+        if (!m_watchedKey &&
+            RegCreateKeyExW(HKEY_CURRENT_USER, KeyPath, 0, nullptr, REG_OPTION_NON_VOLATILE, KEY_NOTIFY, nullptr,
+                            &m_watchedKey, nullptr) != ERROR_SUCCESS)
+        {
+            m_watchedKey = nullptr;
+        }
+
+        // One notification per signal; re-armed by the next wait after it fired
+        if (m_watchedKey && !m_armed)
+        {
+            m_armed = RegNotifyChangeKeyValue(m_watchedKey, FALSE, REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET,
+                                              m_changed, TRUE) == ERROR_SUCCESS;
+        }
+
+        const HANDLE handles[] = { m_changed, m_wake };
+        const DWORD result = WaitForMultipleObjects(m_armed ? 2 : 1, m_armed ? handles : handles + 1, FALSE,
+                                                    static_cast<DWORD>(timeout.count()));
+        if (m_armed && result == WAIT_OBJECT_0)
+        {
+            m_armed = false;
+            return true;
+        }
+        return false;
+    }
+
+    void RegistrySettingsBackend::Wake()
+    {
+        SetEvent(m_wake);
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+// No pch.h here: shared by the WinUI and the Qt frontend
+#include <windows.h>
+
+#include "SettingsStore.h"
+
+namespace UIAListCore
+{
+    // Settings under HKCU\Software\UIAList\Settings, where QSettings("UIAList",
+    // "Settings") keeps them too. Changes are noticed through
+    // RegNotifyChangeKeyValue.
+    class RegistrySettingsBackend : public SettingsBackend
+    {
+    public:
+        RegistrySettingsBackend();
+        ~RegistrySettingsBackend() override;
+
+        SettingValues Load() override;
+        bool Store(const SettingValues& values) override;
+        bool WaitForChange(std::chrono::milliseconds timeout) override;
+        void Wake() override;
+
+    private:
+        static constexpr const wchar_t* KeyPath = L"Software\\UIAList\\Settings";
+
+        HKEY m_watchedKey{ nullptr };
+        HANDLE m_changed{ nullptr };
+        HANDLE m_wake{ nullptr };
+        bool m_armed{ false };  // A notification is registered and not signaled yet
+    };
+}
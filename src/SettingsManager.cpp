@@ -11,6 +11,8 @@
 #include "pch.h"
 #include "SettingsManager.h"
 
+#include <ShlObj.h>
+
 namespace UIAList
 {
     SettingsManager& SettingsManager::GetInstance()
@@ -21,12 +23,12 @@ namespace UIAList
 
     int SettingsManager::GetDefaultAction()
     {
-        return static_cast<int>(ReadDWORD(L"defaultAction", 0));  // 0 = Click by default
+        return m_store.Get()->DefaultAction;
     }
 
     void SettingsManager::SetDefaultAction(int action)
     {
-        WriteDWORD(L"defaultAction", static_cast<DWORD>(action));
+        m_store.Update([action](UIAListCore::Settings& settings) { settings.DefaultAction = action; });
     }
 
     bool SettingsManager::GetAutoStart()
@@ -68,81 +70,86 @@ namespace UIAList
 
     winrt::hstring SettingsManager::GetHotkeyString()
     {
-        return ReadString(L"shortcutKey", L"Ctrl+Alt+U");
+        return winrt::hstring(m_store.Get()->ShortcutKey);
     }
 
     void SettingsManager::SetHotkeyString(const winrt::hstring& hotkey)
     {
-        WriteString(L"shortcutKey", hotkey.c_str());
+        m_store.Update([&hotkey](UIAListCore::Settings& settings) { settings.ShortcutKey = hotkey.c_str(); });
     }
 
     bool SettingsManager::GetWelcomeShown()
     {
-        return ReadDWORD(L"welcomeShown", 0) != 0;
+        return m_store.Get()->WelcomeShown;
     }
 
     void SettingsManager::SetWelcomeShown(bool shown)
     {
-        WriteDWORD(L"welcomeShown", shown ? 1 : 0);
+        m_store.Update([shown](UIAListCore::Settings& settings) { settings.WelcomeShown = shown; });
     }
 
-    DWORD SettingsManager::ReadDWORD(const wchar_t* valueName, DWORD defaultValue)
+    int SettingsManager::GetActionTimeoutMs()
     {
-        HKEY hKey;
-        LONG result = RegOpenKeyExW(HKEY_CURRENT_USER, REG_KEY_PATH, 0, KEY_QUERY_VALUE, &hKey);
-        if (result != ERROR_SUCCESS) return defaultValue;
-
-        DWORD value = defaultValue;
-        DWORD dataSize = sizeof(DWORD);
-        DWORD type;
-
-        result = RegQueryValueExW(hKey, valueName, nullptr, &type, (LPBYTE)&value, &dataSize);
-        RegCloseKey(hKey);
+        return m_store.Get()->ActionTimeoutMs;
+    }
 
-        if (result != ERROR_SUCCESS || type != REG_DWORD)
-            return defaultValue;
+    void SettingsManager::SetActionTimeoutMs(int timeoutMs)
+    {
+        m_store.Update([timeoutMs](UIAListCore::Settings& settings) { settings.ActionTimeoutMs = timeoutMs; });
+    }
 
-        return value;
+    int SettingsManager::GetMemoryBudgetMB()
+    {
+        return m_store.Get()->MemoryBudgetMB;
     }
 
-    void SettingsManager::WriteDWORD(const wchar_t* valueName, DWORD value)
+    void SettingsManager::SetMemoryBudgetMB(int megabytes)
     {
-        HKEY hKey;
-        LONG result = RegCreateKeyExW(HKEY_CURRENT_USER, REG_KEY_PATH, 0, nullptr,
-                                      REG_OPTION_NON_VOLATILE, KEY_WRITE, nullptr, &hKey, nullptr);
-        if (result != ERROR_SUCCESS) return;
+        m_store.Update([megabytes](UIAListCore::Settings& settings) { settings.MemoryBudgetMB = megabytes; });
+    }
 
-        RegSetValueExW(hKey, valueName, 0, REG_DWORD, (const BYTE*)&value, sizeof(DWORD));
-        RegCloseKey(hKey);
+    int SettingsManager::GetIdleTrimSeconds()
+    {
+        return m_store.Get()->IdleTrimSeconds;
     }
 
-    winrt::hstring SettingsManager::ReadString(const wchar_t* valueName, const wchar_t* defaultValue)
+    void SettingsManager::SetIdleTrimSeconds(int seconds)
     {
-        HKEY hKey;
-        LONG result = RegOpenKeyExW(HKEY_CURRENT_USER, REG_KEY_PATH, 0, KEY_QUERY_VALUE, &hKey);
-        if (result != ERROR_SUCCESS) return defaultValue;
+        m_store.Update([seconds](UIAListCore::Settings& settings) { settings.IdleTrimSeconds = seconds; });
+    }
 
-        wchar_t buffer[256] = {0};
-        DWORD dataSize = sizeof(buffer);
-        DWORD type;
+    int SettingsManager::GetQuickScopeDepth()
+    {
+        return m_store.Get()->QuickScopeDepth;
+    }
 
-        result = RegQueryValueExW(hKey, valueName, nullptr, &type, (LPBYTE)buffer, &dataSize);
-        RegCloseKey(hKey);
+    void SettingsManager::SetQuickScopeDepth(int levels)
+    {
+        m_store.Update([levels](UIAListCore::Settings& settings) { settings.QuickScopeDepth = levels; });
+    }
 
-        if (result != ERROR_SUCCESS || type != REG_SZ)
-            return defaultValue;
+    winrt::hstring SettingsManager::GetQuickHotkeyString()
+    {
+        return winrt::hstring(m_store.Get()->QuickShortcutKey);
+    }
 
-        return buffer;
+    void SettingsManager::SetQuickHotkeyString(const winrt::hstring& hotkey)
+    {
+        m_store.Update([&hotkey](UIAListCore::Settings& settings) { settings.QuickShortcutKey = hotkey.c_str(); });
     }
 
-    void SettingsManager::WriteString(const wchar_t* valueName, const wchar_t* value)
+    std::filesystem::path SettingsManager::GetDataDirectory()
     {
-        HKEY hKey;
-        LONG result = RegCreateKeyExW(HKEY_CURRENT_USER, REG_KEY_PATH, 0, nullptr,
-                                      REG_OPTION_NON_VOLATILE, KEY_WRITE, nullptr, &hKey, nullptr);
-        if (result != ERROR_SUCCESS) return;
+        PWSTR localAppData = nullptr;
+        if (FAILED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &localAppData)))
+        {
+            return std::filesystem::path();
+        }
+        std::filesystem::path directory = std::filesystem::path(localAppData) / L"UIAList";
+        CoTaskMemFree(localAppData);
 
-        RegSetValueExW(hKey, valueName, 0, REG_SZ, (const BYTE*)value, (wcslen(value) + 1) * sizeof(wchar_t));
-        RegCloseKey(hKey);
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        return error ? std::filesystem::path() : directory;
     }
 }
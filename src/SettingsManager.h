@@ -11,11 +11,15 @@
 #pragma once
 
 #include "pch.h"
+#include "SettingsStore.h"
+
+#include <filesystem>
 
 namespace UIAList
 {
     // Settings manager using Windows Registry
-    // Replaces Qt's QSettings
+    // Replaces Qt's QSettings. Getters read the in-memory snapshot of
+    // UIAListCore::SettingsStore; setters update it and return at once.
     class SettingsManager
     {
     public:
@@ -34,19 +38,32 @@ namespace UIAList
         bool GetWelcomeShown();
         void SetWelcomeShown(bool shown);
 
+        int GetActionTimeoutMs();  // Click/focus/double-click give up after this long
+        void SetActionTimeoutMs(int timeoutMs);
+
+        int GetMemoryBudgetMB();  // Hidden control lists are released beyond this
+        void SetMemoryBudgetMB(int megabytes);
+
+        int GetIdleTrimSeconds();
+        void SetIdleTrimSeconds(int seconds);
+
+        int GetQuickScopeDepth();  // Levels below its container a quick list goes; 0 all
+        void SetQuickScopeDepth(int levels);
+
+        winrt::hstring GetQuickHotkeyString();  // Opens a quick list; empty for none
+        void SetQuickHotkeyString(const winrt::hstring& hotkey);
+
+        // %LOCALAPPDATA%\UIAList, created on first use; empty if unavailable
+        std::filesystem::path GetDataDirectory();
+
     private:
         SettingsManager() = default;
         ~SettingsManager() = default;
         SettingsManager(const SettingsManager&) = delete;
         SettingsManager& operator=(const SettingsManager&) = delete;
 
-        // Registry helpers
-        DWORD ReadDWORD(const wchar_t* valueName, DWORD defaultValue);
-        void WriteDWORD(const wchar_t* valueName, DWORD value);
-        winrt::hstring ReadString(const wchar_t* valueName, const wchar_t* defaultValue);
-        void WriteString(const wchar_t* valueName, const wchar_t* value);
+        UIAListCore::SettingsStore& m_store{ UIAListCore::SettingsStore::Instance() };
 
-        static constexpr const wchar_t* REG_KEY_PATH = L"Software\\UIAList\\Settings";
         static constexpr const wchar_t* REG_AUTOSTART_PATH = L"Software\\Microsoft\\Windows\\CurrentVersion\\Run";
         static constexpr const wchar_t* REG_AUTOSTART_NAME = L"UIAList";
     };
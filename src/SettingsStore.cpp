@@ -0,0 +1,405 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "SettingsStore.h"
+#include "Utf8.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cwchar>
+#include <fstream>
+#include <vector>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        // Registry value names, shared by both frontends
+        const char* const DefaultActionName = "defaultAction";
+        const char* const ShortcutKeyName = "shortcutKey";
+        const char* const WelcomeShownName = "welcomeShown";
+        const char* const ActionTimeoutName = "actionTimeoutMs";
+        const char* const MemoryBudgetName = "memoryBudgetMB";
+        const char* const IdleTrimName = "idleTrimSeconds";
+        const char* const QuickScopeDepthName = "quickScopeDepth";
+        const char* const QuickShortcutKeyName = "quickShortcutKey";
+
+        // How often the file backend looks at the file
+        constexpr std::chrono::milliseconds FilePollInterval{ 100 };
+
+        // QSettings stores booleans as "true"/"false" strings
+        uint32_t Number(const SettingValues& values, const char* name, uint32_t fallback)
+        {
+            auto found = values.find(name);
+            if (found == values.end()) return fallback;
+            if (const uint32_t* number = std::get_if<uint32_t>(&found->second)) return *number;
+
+            const std::wstring& text = std::get<std::wstring>(found->second);
+            if (text == L"true") return 1;
+            if (text == L"false") return 0;
+            wchar_t* end = nullptr;
+            const unsigned long value = std::wcstoul(text.c_str(), &end, 10);
+            return (!text.empty() && end && *end == L'\0') ? static_cast<uint32_t>(value) : fallback;
+        }
+
+        std::wstring Text(const SettingValues& values, const char* name, const std::wstring& fallback)
+        {
+            auto found = values.find(name);
+            if (found == values.end()) return fallback;
+            if (const uint32_t* number = std::get_if<uint32_t>(&found->second)) return std::to_wstring(*number);
+            return std::get<std::wstring>(found->second);
+        }
+    }
+
+    Settings SettingsStore::FromValues(const SettingValues& values)
+    {
+        const Settings defaults;
+        Settings settings;
+        settings.DefaultAction = static_cast<int>(Number(values, DefaultActionName, defaults.DefaultAction));
+        settings.ShortcutKey = Text(values, ShortcutKeyName, defaults.ShortcutKey);
+        settings.WelcomeShown = Number(values, WelcomeShownName, defaults.WelcomeShown) != 0;
+        settings.ActionTimeoutMs = static_cast<int>(Number(values, ActionTimeoutName, defaults.ActionTimeoutMs));
+        settings.MemoryBudgetMB = static_cast<int>(Number(values, MemoryBudgetName, defaults.MemoryBudgetMB));
+        settings.IdleTrimSeconds = static_cast<int>(Number(values, IdleTrimName, defaults.IdleTrimSeconds));
+        settings.QuickScopeDepth = static_cast<int>(Number(values, QuickScopeDepthName, defaults.QuickScopeDepth));
+        settings.QuickShortcutKey = Text(values, QuickShortcutKeyName, defaults.QuickShortcutKey);
+        return settings;
+    }
+
+    SettingValues SettingsStore::ToValues(const Settings& settings)
+    {
+        return {
+            { DefaultActionName, static_cast<uint32_t>(settings.DefaultAction) },
+            { ShortcutKeyName, settings.ShortcutKey },
+            { WelcomeShownName, static_cast<uint32_t>(settings.WelcomeShown ? 1 : 0) },
+            { ActionTimeoutName, static_cast<uint32_t>(settings.ActionTimeoutMs) },
+            { MemoryBudgetName, static_cast<uint32_t>(settings.MemoryBudgetMB) },
+            { IdleTrimName, static_cast<uint32_t>(settings.IdleTrimSeconds) },
+            { QuickScopeDepthName, static_cast<uint32_t>(settings.QuickScopeDepth) },
+            { QuickShortcutKeyName, settings.QuickShortcutKey },
+        };
+    }
+
+    FileSettingsBackend::FileSettingsBackend(std::filesystem::path path)
+        : m_path(std::move(path))
+    {
+    }
+
+    SettingValues FileSettingsBackend::Load()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_seen = Current();
+        return Read();
+    }
+
+    bool FileSettingsBackend::Store(const SettingValues& values)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        SettingValues merged = Read();
+        for (const auto& [name, value] : values)
+        {
+            merged[name] = value;
+        }
+
+        // Readers never see a half-written file
+        std::filesystem::path temporary = m_path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+            for (const auto& [name, value] : merged)
+            {
+                if (const uint32_t* number = std::get_if<uint32_t>(&value))
+                {
+                    file << "u " << name << ' ' << *number << '\n';
+                }
+                else
+                {
+                    file << "s " << name << ' ' << ToUtf8(std::get<std::wstring>(value)) << '\n';
+                }
+            }
+            if (!file.flush()) return false;
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, m_path, error);
+        if (error) return false;
+
+        m_seen = Current();
+        return true;
+    }
+
+    bool FileSettingsBackend::WaitForChange(std::chrono::milliseconds timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            const Stamp current = Current();
+            if (!(current == m_seen))
+            {
+                m_seen = current;
+                return true;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (m_woken || now >= deadline) break;
+            m_wake.wait_for(lock, std::min<std::chrono::steady_clock::duration>(FilePollInterval, deadline - now),
+                            [this]() { return m_woken; });
+        }
+        m_woken = false;
+        return false;
+    }
+
+    void FileSettingsBackend::Wake()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_woken = true;
+        }
+        m_wake.notify_all();
+    }
+
+    FileSettingsBackend::Stamp FileSettingsBackend::Current() const
+    {
+        Stamp stamp;
+        std::error_code error;
+        stamp.Time = std::filesystem::last_write_time(m_path, error);
+        if (error) return Stamp();
+        stamp.Size = std::filesystem::file_size(m_path, error);
+        stamp.Exists = !error;
+        return stamp;
+    }
+
+    SettingValues FileSettingsBackend::Read() const
+    {
+        SettingValues values;
+        std::ifstream file(m_path, std::ios::binary);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            // "<type> <name> <value>"; the value may contain spaces
+            const size_t nameEnd = line.find(' ', 2);
+            if (line.size() < 3 || line[1] != ' ' || nameEnd == std::string::npos) continue;
+
+            const std::string name = line.substr(2, nameEnd - 2);
+            const std::string value = line.substr(nameEnd + 1);
+            if (line[0] == 'u')
+            {
+                values[name] = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+            }
+            else if (line[0] == 's')
+            {
+                values[name] = FromUtf8(value);
+            }
+        }
+        return values;
+    }
+
+    SettingsStore& SettingsStore::Instance()
+    {
+        static SettingsStore instance;
+        return instance;
+    }
+
+    SettingsStore::~SettingsStore()
+    {
+        Close();
+    }
+
+    void SettingsStore::Open(std::unique_ptr<SettingsBackend> backend, std::chrono::milliseconds writeDelay)
+    {
+        Close();
+
+        SettingValues values = backend->Load();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // Changes made before Open win over what was stored
+            for (const auto& [name, value] : m_pending)
+            {
+                values[name] = value;
+            }
+            m_settings = std::make_shared<const Settings>(FromValues(values));
+            m_backend = std::move(backend);
+            m_writeDelay = writeDelay;
+            m_due = Clock::now();
+            m_stopping = false;
+            ++m_loads;
+        }
+        m_worker = std::thread(&SettingsStore::WorkerLoop, this);
+    }
+
+    void SettingsStore::Close()
+    {
+        if (!m_worker.joinable()) return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_backend->Wake();
+        m_worker.join();
+        m_backend.reset();
+    }
+
+    std::shared_ptr<const Settings> SettingsStore::Get() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_settings;
+    }
+
+    void SettingsStore::Update(const std::function<void(Settings&)>& change)
+    {
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Settings changed = *m_settings;
+            change(changed);
+            if (changed == *m_settings) return;
+
+            const bool batchStarts = m_pending.empty();
+            const SettingValues before = ToValues(*m_settings);
+            for (const auto& [name, value] : ToValues(changed))
+            {
+                if (before.at(name) != value) m_pending[name] = value;
+            }
+            m_settings = std::make_shared<const Settings>(std::move(changed));
+
+            // The first change of a batch starts the clock
+            if (batchStarts && !m_pending.empty())
+            {
+                m_due = Clock::now() + m_writeDelay;
+                wake = true;
+            }
+        }
+        if (wake && m_backend) m_backend->Wake();
+    }
+
+    bool SettingsStore::Flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_backend) return m_pending.empty();
+
+        // A store under way may have begun before the last change
+        const uint64_t begun = m_attempts;
+        m_due = Clock::now();
+        lock.unlock();
+        m_backend->Wake();
+        lock.lock();
+        m_stored.wait(lock, [this, begun]() {
+            return (m_pending.empty() && !m_storing) || m_failedAttempt > begun;
+        });
+        return m_failedAttempt <= begun && m_pending.empty() && !m_storing;
+    }
+
+    SettingsStore::ListenerId SettingsStore::Subscribe(Listener listener)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const ListenerId id = m_nextListener++;
+        m_listeners.emplace(id, std::move(listener));
+        return id;
+    }
+
+    void SettingsStore::Unsubscribe(ListenerId id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_listeners.erase(id);
+    }
+
+    uint64_t SettingsStore::Loads() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_loads;
+    }
+
+    uint64_t SettingsStore::Stores() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stores;
+    }
+
+    void SettingsStore::WorkerLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            if (!m_pending.empty() && (m_stopping || Clock::now() >= m_due))
+            {
+                SettingValues batch;
+                batch.swap(m_pending);
+                m_storing = true;
+                const uint64_t attempt = ++m_attempts;
+                lock.unlock();
+
+                const bool stored = m_backend->Store(batch);
+
+                lock.lock();
+                m_storing = false;
+                if (stored)
+                {
+                    ++m_stores;
+                }
+                else
+                {
+                    m_failedAttempt = attempt;
+                    if (!m_stopping)
+                    {
+                        // Retry later; newer changes of the same values win
+                        m_pending.insert(batch.begin(), batch.end());
+                        m_due = Clock::now() + m_writeDelay;
+                    }
+                }
+                m_stored.notify_all();
+                continue;
+            }
+            if (m_stopping) break;
+
+            const auto wait = m_pending.empty()
+                ? std::chrono::milliseconds(1000)
+                : std::chrono::ceil<std::chrono::milliseconds>(m_due - Clock::now());
+            lock.unlock();
+
+            if (m_backend->WaitForChange(wait)) Reload();
+
+            lock.lock();
+        }
+        m_stored.notify_all();
+    }
+
+    void SettingsStore::Reload()
+    {
+        SettingValues values = m_backend->Load();
+
+        std::vector<Listener> listeners;
+        Settings settings;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_loads;
+            for (const auto& [name, value] : m_pending)
+            {
+                values[name] = value;
+            }
+            settings = FromValues(values);
+            if (settings == *m_settings) return;  // Our own write coming back
+
+            m_settings = std::make_shared<const Settings>(settings);
+            for (const auto& [id, listener] : m_listeners)
+            {
+                listeners.push_back(listener);
+            }
+        }
+
+        for (const Listener& listener : listeners)
+        {
+            listener(settings);
+        }
+    }
+}
@@ -0,0 +1,172 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "MemoryBudget.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <variant>
+
+namespace UIAListCore
+{
+    // Everything UIAList keeps between runs, as one typed snapshot
+    struct Settings
+    {
+        int DefaultAction{ 0 };                   // 0=Click, 1=DoubleClick, 2=Focus
+        std::wstring ShortcutKey{ L"Ctrl+Alt+U" };
+        bool WelcomeShown{ false };
+        int ActionTimeoutMs{ 5000 };              // Click/focus/double-click give up after this long
+        int IdleTrimSeconds{ 30 };                // Hidden this long, the list is compacted; 0 never
+        int QuickScopeDepth{ 0 };                 // Levels below its container a quick list goes; 0 all
+        std::wstring QuickShortcutKey{ L"Ctrl+Alt+Shift+U" };  // Opens a quick list; empty for none
+
+        // Hidden control lists are released beyond this
+        int MemoryBudgetMB{ static_cast<int>(MemoryBudget::DefaultLimitMegabytes) };
+
+        bool operator==(const Settings& other) const = default;
+    };
+
+    // Raw stored value: a DWORD or a string
+    using SettingValue = std::variant<uint32_t, std::wstring>;
+    using SettingValues = std::map<std::string, SettingValue>;
+
+    // Where settings live: the registry on Windows, a file elsewhere
+    class SettingsBackend
+    {
+    public:
+        virtual ~SettingsBackend() = default;
+
+        virtual SettingValues Load() = 0;
+
+        // One batch of changed values
+        virtual bool Store(const SettingValues& values) = 0;
+
+        // Blocks until the settings change outside this process (true), the
+        // timeout passes or Wake is called (false)
+        virtual bool WaitForChange(std::chrono::milliseconds timeout) = 0;
+        virtual void Wake() = 0;
+    };
+
+    // Settings in a text file, one "<u|s> name value" line per setting (UTF-8).
+    // Changes are noticed by polling the file's time and size.
+    class FileSettingsBackend : public SettingsBackend
+    {
+    public:
+        explicit FileSettingsBackend(std::filesystem::path path);
+
+        SettingValues Load() override;
+        bool Store(const SettingValues& values) override;
+        bool WaitForChange(std::chrono::milliseconds timeout) override;
+        void Wake() override;
+
+    private:
+        struct Stamp
+        {
+            std::filesystem::file_time_type Time{};
+            uintmax_t Size{ 0 };
+            bool Exists{ false };
+
+            bool operator==(const Stamp& other) const = default;
+        };
+
+        Stamp Current() const;
+        SettingValues Read() const;
+
+        std::filesystem::path m_path;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        Stamp m_seen;  // Of the last Load or Store
+        bool m_woken{ false };
+    };
+
+    // Settings loaded once into memory. Reads take the snapshot, writes
+    // change it at once and reach the backend in batches from a background
+    // thread, which also picks up changes made by other processes (the other
+    // frontend, the installer, regedit) and tells the listeners.
+    class SettingsStore
+    {
+    public:
+        using Listener = std::function<void(const Settings&)>;
+        using ListenerId = uint64_t;
+
+        static constexpr std::chrono::milliseconds DefaultWriteDelay{ 200 };
+
+        // The process-wide store; until Open it serves the defaults
+        static SettingsStore& Instance();
+
+        SettingsStore() = default;
+        ~SettingsStore();
+
+        SettingsStore(const SettingsStore&) = delete;
+        SettingsStore& operator=(const SettingsStore&) = delete;
+
+        // Loads everything from backend and starts watching it
+        void Open(std::unique_ptr<SettingsBackend> backend, std::chrono::milliseconds writeDelay = DefaultWriteDelay);
+
+        // Writes what is pending and stops watching
+        void Close();
+
+        // Never touches the backend
+        std::shared_ptr<const Settings> Get() const;
+
+        // Applies change to the snapshot now, stores it within the write delay
+        void Update(const std::function<void(Settings&)>& change);
+
+        // Stores every change so far now. False when a store begun for it
+        // failed: the changes stay pending, retried within the write delay.
+        // Waits for one store at most, so a failing backend cannot hang exit.
+        bool Flush();
+
+        // Called on the store's thread after another process changed the settings
+        ListenerId Subscribe(Listener listener);
+        void Unsubscribe(ListenerId id);
+
+        uint64_t Loads() const;
+        uint64_t Stores() const;
+
+        static Settings FromValues(const SettingValues& values);
+        static SettingValues ToValues(const Settings& settings);
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void WorkerLoop();
+        void Reload();
+
+        std::unique_ptr<SettingsBackend> m_backend;
+        std::chrono::milliseconds m_writeDelay{ DefaultWriteDelay };
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_stored;
+        std::shared_ptr<const Settings> m_settings{ std::make_shared<Settings>() };
+        SettingValues m_pending;         // Changed and not stored yet
+        Clock::time_point m_due{};       // When m_pending is stored
+        bool m_storing{ false };
+        uint64_t m_attempts{ 0 };        // Stores begun
+        uint64_t m_failedAttempt{ 0 };   // The last store that failed, 0 none
+        bool m_stopping{ false };
+        uint64_t m_loads{ 0 };
+        uint64_t m_stores{ 0 };
+        std::map<ListenerId, Listener> m_listeners;
+        ListenerId m_nextListener{ 1 };
+
+        std::thread m_worker;
+    };
+}
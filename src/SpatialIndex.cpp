@@ -0,0 +1,370 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "SpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <tuple>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        // Twice the centre, so it stays integral
+        int64_t CenterX(const ElementRect& rect) { return static_cast<int64_t>(rect.Left) + rect.Right; }
+        int64_t CenterY(const ElementRect& rect) { return static_cast<int64_t>(rect.Top) + rect.Bottom; }
+
+        ElementRect Union(const ElementRect& a, const ElementRect& b)
+        {
+            return { std::min(a.Left, b.Left), std::min(a.Top, b.Top), std::max(a.Right, b.Right), std::max(a.Bottom, b.Bottom) };
+        }
+
+        // Union with bounds that may be those of an emptied node
+        ElementRect Enlarged(const ElementRect& bounds, const ElementRect& rect)
+        {
+            return bounds.IsEmpty() ? rect : Union(bounds, rect);
+        }
+
+        int64_t Area(const ElementRect& rect)
+        {
+            return rect.IsEmpty() ? 0 : rect.Width() * rect.Height();
+        }
+
+        double Distance(const ElementRect& a, const ElementRect& b)
+        {
+            const double dx = std::max<int64_t>({ 0, static_cast<int64_t>(a.Left) - b.Right, static_cast<int64_t>(b.Left) - a.Right });
+            const double dy = std::max<int64_t>({ 0, static_cast<int64_t>(a.Top) - b.Bottom, static_cast<int64_t>(b.Top) - a.Bottom });
+            return std::sqrt(dx * dx + dy * dy);
+        }
+
+        // Sort-tile-recursive order of entries with Bounds: vertical slices by
+        // centre x, each sorted by centre y, so runs of NodeCapacity are compact
+        template <typename Entry>
+        void Tile(typename std::vector<Entry>::iterator begin, typename std::vector<Entry>::iterator end)
+        {
+            const size_t count = static_cast<size_t>(end - begin);
+            const size_t nodes = (count + SpatialIndex::NodeCapacity - 1) / SpatialIndex::NodeCapacity;
+            const size_t slices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nodes))));
+            const size_t sliceSize = slices * SpatialIndex::NodeCapacity;
+
+            std::sort(begin, end, [](const Entry& a, const Entry& b) { return CenterX(a.Bounds) < CenterX(b.Bounds); });
+            for (size_t start = 0; start < count; start += sliceSize)
+            {
+                auto sliceEnd = begin + static_cast<ptrdiff_t>(std::min(count, start + sliceSize));
+                std::sort(begin + static_cast<ptrdiff_t>(start), sliceEnd,
+                          [](const Entry& a, const Entry& b) { return CenterY(a.Bounds) < CenterY(b.Bounds); });
+            }
+        }
+    }
+
+    void SpatialIndex::Build(const std::vector<ElementRect>& rects, const ElementRect& screen)
+    {
+        Clear();
+        m_screen = screen;
+        m_built = rects.size();
+        m_offscreen.resize(rects.size());
+        m_items.reserve(rects.size());
+
+        for (uint32_t index = 0; index < rects.size(); ++index)
+        {
+            const ElementRect& rect = rects[index];
+            if (rect.IsEmpty())
+            {
+                m_offscreen[index] = 1;
+                m_unbounded.push_back(index);
+                continue;
+            }
+            m_offscreen[index] = (!screen.IsEmpty() && !screen.Intersects(rect)) ? 1 : 0;
+            m_items.push_back({ rect, index });
+        }
+        if (m_items.empty()) return;
+
+        // Leaves over runs of tiled items
+        Tile<Item>(m_items.begin(), m_items.end());
+        for (size_t first = 0; first < m_items.size(); first += NodeCapacity)
+        {
+            const size_t count = std::min(NodeCapacity, m_items.size() - first);
+            Node node{ m_items[first].Bounds, static_cast<uint32_t>(first), static_cast<uint32_t>(count) };
+            for (size_t i = first + 1; i < first + count; ++i) node.Bounds = Union(node.Bounds, m_items[i].Bounds);
+            m_nodes.push_back(node);
+        }
+        m_leaves = static_cast<uint32_t>(m_nodes.size());
+
+        // Each level over the tiled level below, up to a single root
+        size_t levelStart = 0;
+        while (m_nodes.size() - levelStart > 1)
+        {
+            const size_t levelEnd = m_nodes.size();
+            Tile<Node>(m_nodes.begin() + static_cast<ptrdiff_t>(levelStart), m_nodes.begin() + static_cast<ptrdiff_t>(levelEnd));
+            for (size_t first = levelStart; first < levelEnd; first += NodeCapacity)
+            {
+                const size_t count = std::min(NodeCapacity, levelEnd - first);
+                Node node{ m_nodes[first].Bounds, static_cast<uint32_t>(first), static_cast<uint32_t>(count) };
+                for (size_t i = first + 1; i < first + count; ++i) node.Bounds = Union(node.Bounds, m_nodes[i].Bounds);
+                m_nodes.push_back(node);
+            }
+            levelStart = levelEnd;
+        }
+    }
+
+    void SpatialIndex::Clear()
+    {
+        m_items.clear();
+        m_nodes.clear();
+        m_leaves = 0;
+        m_unbounded.clear();
+        m_offscreen.clear();
+        m_built = 0;
+        m_spliced = 0;
+    }
+
+    void SpatialIndex::Splice(uint32_t first, uint32_t count, const std::vector<ElementRect>& rects)
+    {
+        const uint32_t end = first + count;
+        const uint32_t added = static_cast<uint32_t>(rects.size());
+        auto moved = [&](uint32_t index) { return index < end ? index : index - count + added; };
+
+        m_spliced += rects.size();
+        if (m_nodes.empty() || 4 * m_spliced > m_built)
+        {
+            // Built again from the rectangles held, unbounded ones empty
+            std::vector<ElementRect> all(Size());
+            for (const Item& item : m_items) all[item.Index] = item.Bounds;
+            all.erase(all.begin() + first, all.begin() + end);
+            all.insert(all.begin() + first, rects.begin(), rects.end());
+            Build(all, m_screen);
+            return;
+        }
+
+        // The leaf of each new item, chosen before the old ones leave
+        std::vector<std::pair<uint32_t, Item>> inserted;  // Leaf, item
+        std::vector<uint32_t> unbounded;
+        std::vector<uint8_t> offscreen(added);
+        for (uint32_t i = 0; i < added; ++i)
+        {
+            const ElementRect& rect = rects[i];
+            if (rect.IsEmpty())
+            {
+                offscreen[i] = 1;
+                unbounded.push_back(first + i);
+                continue;
+            }
+            offscreen[i] = (!m_screen.IsEmpty() && !m_screen.Intersects(rect)) ? 1 : 0;
+            inserted.emplace_back(ChooseLeaf(rect), Item{ rect, first + i });
+        }
+        std::stable_sort(inserted.begin(), inserted.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        m_offscreen.erase(m_offscreen.begin() + first, m_offscreen.begin() + end);
+        m_offscreen.insert(m_offscreen.begin() + first, offscreen.begin(), offscreen.end());
+
+        std::vector<uint32_t> kept;
+        kept.reserve(m_unbounded.size() + unbounded.size());
+        for (uint32_t index : m_unbounded)
+        {
+            if (index < first) kept.push_back(index);
+        }
+        kept.insert(kept.end(), unbounded.begin(), unbounded.end());
+        for (uint32_t index : m_unbounded)
+        {
+            if (index >= end) kept.push_back(moved(index));
+        }
+        m_unbounded.swap(kept);
+
+        // Leaves in the order of their items: the leaf level was tiled as nodes
+        std::vector<uint32_t> leaves(m_leaves);
+        for (uint32_t leaf = 0; leaf < m_leaves; ++leaf) leaves[leaf] = leaf;
+        std::sort(leaves.begin(), leaves.end(), [this](uint32_t a, uint32_t b) { return m_nodes[a].First < m_nodes[b].First; });
+
+        std::vector<Item> items;
+        items.reserve(m_items.size() + inserted.size());
+        for (uint32_t leaf : leaves)
+        {
+            Node& node = m_nodes[leaf];
+            const size_t start = items.size();
+            for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+            {
+                const Item& item = m_items[i];
+                if (item.Index < first || item.Index >= end) items.push_back({ item.Bounds, moved(item.Index) });
+            }
+            auto [from, to] = std::equal_range(inserted.begin(), inserted.end(), std::make_pair(leaf, Item{}),
+                                               [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (; from != to; ++from) items.push_back(from->second);
+
+            node.First = static_cast<uint32_t>(start);
+            node.Count = static_cast<uint32_t>(items.size() - start);
+            node.Bounds = {};
+            for (size_t i = start; i < items.size(); ++i) node.Bounds = Enlarged(node.Bounds, items[i].Bounds);
+        }
+        m_items.swap(items);
+
+        // Children come before their parents, level by level
+        for (size_t parent = m_leaves; parent < m_nodes.size(); ++parent)
+        {
+            Node& node = m_nodes[parent];
+            node.Bounds = {};
+            for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+            {
+                if (!m_nodes[i].Bounds.IsEmpty()) node.Bounds = Enlarged(node.Bounds, m_nodes[i].Bounds);
+            }
+        }
+    }
+
+    uint32_t SpatialIndex::ChooseLeaf(const ElementRect& bounds)
+    {
+        // Down from the root to the child growing least, then the smaller;
+        // the path takes bounds in, for the next item's choice
+        uint32_t node = static_cast<uint32_t>(m_nodes.size() - 1);
+        while (true)
+        {
+            m_nodes[node].Bounds = Enlarged(m_nodes[node].Bounds, bounds);
+            if (IsLeaf(node)) return node;
+
+            const Node& parent = m_nodes[node];
+            uint32_t best = parent.First;
+            int64_t bestGrowth = INT64_MAX;
+            int64_t bestArea = INT64_MAX;
+            for (uint32_t i = parent.First; i < parent.First + parent.Count; ++i)
+            {
+                const int64_t area = Area(m_nodes[i].Bounds);
+                const int64_t growth = Area(Enlarged(m_nodes[i].Bounds, bounds)) - area;
+                if (growth < bestGrowth || (growth == bestGrowth && area < bestArea))
+                {
+                    best = i;
+                    bestGrowth = growth;
+                    bestArea = area;
+                }
+            }
+            node = best;
+        }
+    }
+
+    void SpatialIndex::Query(const ElementRect& region, std::vector<uint32_t>& items) const
+    {
+        items.clear();
+        if (m_nodes.empty() || region.IsEmpty()) return;
+
+        std::vector<uint32_t> pending{ static_cast<uint32_t>(m_nodes.size() - 1) };
+        while (!pending.empty())
+        {
+            const Node& node = m_nodes[pending.back()];
+            const bool leaf = IsLeaf(pending.back());
+            pending.pop_back();
+            if (!node.Bounds.Intersects(region)) continue;
+
+            for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+            {
+                if (!leaf) pending.push_back(i);
+                else if (m_items[i].Bounds.Intersects(region)) items.push_back(m_items[i].Index);
+            }
+        }
+        std::sort(items.begin(), items.end());
+    }
+
+    void SpatialIndex::Nearest(const ElementRect& target, size_t count, std::vector<uint32_t>& items) const
+    {
+        items.clear();
+        if (m_nodes.empty() || count == 0) return;
+
+        // Best first: nodes and items by distance, items ahead of nodes and
+        // lower indices first at equal distance
+        using Candidate = std::tuple<double, bool, uint32_t>;  // Distance, is a node, index
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+        const uint32_t root = static_cast<uint32_t>(m_nodes.size() - 1);
+        candidates.emplace(Distance(m_nodes[root].Bounds, target), true, root);
+
+        while (!candidates.empty() && items.size() < count)
+        {
+            const auto [distance, isNode, index] = candidates.top();
+            candidates.pop();
+            if (!isNode)
+            {
+                items.push_back(index);
+                continue;
+            }
+
+            const Node& node = m_nodes[index];
+            for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+            {
+                if (!IsLeaf(index))
+                {
+                    candidates.emplace(Distance(m_nodes[i].Bounds, target), true, i);
+                }
+                else if (!m_items[i].Bounds.Contains(target))
+                {
+                    candidates.emplace(Distance(m_items[i].Bounds, target), false, m_items[i].Index);
+                }
+            }
+        }
+    }
+
+    void SpatialIndex::ReadingOrder(std::vector<uint32_t>& items) const
+    {
+        // Top down; the row of each item is decided among the rows still
+        // reaching down to it
+        std::vector<uint32_t> order(m_items.size());
+        for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+        {
+            const ElementRect& ra = m_items[a].Bounds;
+            const ElementRect& rb = m_items[b].Bounds;
+            return std::tie(ra.Top, ra.Left, m_items[a].Index) < std::tie(rb.Top, rb.Left, m_items[b].Index);
+        });
+
+        std::vector<ElementRect> rows;        // The first item's bounds, by row
+        std::vector<uint32_t> open;           // Rows that may still take items
+        std::vector<uint32_t> rowOf(m_items.size());
+        for (uint32_t i : order)
+        {
+            const ElementRect& bounds = m_items[i].Bounds;
+            open.erase(std::remove_if(open.begin(), open.end(),
+                                      [&](uint32_t row) { return rows[row].Bottom <= bounds.Top; }),
+                       open.end());
+
+            uint32_t joined = UINT32_MAX;
+            for (uint32_t row : open)
+            {
+                const int64_t overlap = static_cast<int64_t>(std::min(rows[row].Bottom, bounds.Bottom)) -
+                                        std::max(rows[row].Top, bounds.Top);
+                if (2 * overlap >= std::max(rows[row].Height(), bounds.Height()))
+                {
+                    joined = row;
+                    break;
+                }
+            }
+            if (joined == UINT32_MAX)
+            {
+                joined = static_cast<uint32_t>(rows.size());
+                rows.push_back(bounds);
+                open.push_back(joined);
+            }
+            rowOf[i] = joined;
+        }
+
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+        {
+            return std::tie(rowOf[a], m_items[a].Bounds.Left, m_items[a].Index) <
+                   std::tie(rowOf[b], m_items[b].Bounds.Left, m_items[b].Index);
+        });
+
+        items.clear();
+        items.reserve(Size());
+        for (uint32_t i : order) items.push_back(m_items[i].Index);
+        items.insert(items.end(), m_unbounded.begin(), m_unbounded.end());
+    }
+
+    size_t SpatialIndex::MemoryBytes() const
+    {
+        return m_items.capacity() * sizeof(Item) + m_nodes.capacity() * sizeof(Node) +
+               m_unbounded.capacity() * sizeof(uint32_t) + m_offscreen.capacity();
+    }
+}
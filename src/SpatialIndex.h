@@ -0,0 +1,91 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "TreeProvider.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace UIAListCore
+{
+    // The bounding rectangles of one list, for questions about where controls
+    // are rather than where they sit in the tree: what lies in a region, what
+    // is nearest to a control, and the order a sighted user reads them in.
+    // A packed R-tree, loaded once per list sort-tile-recursive; items are
+    // indices into the rectangles given to Build. Empty rectangles are kept
+    // out of the tree.
+    class SpatialIndex
+    {
+    public:
+        // Entries per tree node
+        static constexpr size_t NodeCapacity = 16;
+
+        // Items that do not intersect screen, the virtual screen, are flagged
+        // offscreen on the way; with an empty screen only those without bounds are
+        void Build(const std::vector<ElementRect>& rects, const ElementRect& screen = {});
+        void Clear();
+
+        // Replaces count items at first with rects, as a live update replaces
+        // rows of the list; the items after them move along. New items go to
+        // the leaves they enlarge least, which loosens the tree: it is built
+        // again once a quarter as many items were spliced in as were built.
+        void Splice(uint32_t first, uint32_t count, const std::vector<ElementRect>& rects);
+
+        // Every item given to Build, with bounds or without
+        size_t Size() const { return m_offscreen.size(); }
+        bool IsOffscreen(uint32_t item) const { return m_offscreen[item] != 0; }
+
+        // Items intersecting region, ascending
+        void Query(const ElementRect& region, std::vector<uint32_t>& items) const;
+
+        // Up to count items nearest to target, nearest first. The distance is
+        // the gap between the rectangles, 0 when they touch or overlap; items
+        // containing target, its containers and itself, are skipped.
+        void Nearest(const ElementRect& target, size_t count, std::vector<uint32_t>& items) const;
+
+        // Every item, in rows top to bottom and left to right within a row.
+        // An item joins a row when it overlaps the row's first item
+        // vertically by half the taller one's height; items without bounds
+        // come last, ascending.
+        void ReadingOrder(std::vector<uint32_t>& items) const;
+
+        // Heap held, for the memory budget
+        size_t MemoryBytes() const;
+
+    private:
+        struct Item
+        {
+            ElementRect Bounds;
+            uint32_t Index;
+        };
+
+        struct Node
+        {
+            ElementRect Bounds;
+            uint32_t First;  // Into m_items for leaves, into m_nodes above
+            uint32_t Count;
+        };
+
+        bool IsLeaf(uint32_t node) const { return node < m_leaves; }
+        uint32_t ChooseLeaf(const ElementRect& bounds);
+
+        std::vector<Item> m_items;     // Tiled, a leaf's items adjacent
+        std::vector<Node> m_nodes;     // Level by level from the leaves, the root last
+        uint32_t m_leaves{ 0 };
+        std::vector<uint32_t> m_unbounded;  // Items with empty rectangles, ascending
+        std::vector<uint8_t> m_offscreen;
+        ElementRect m_screen;          // As given to Build
+        size_t m_built{ 0 };           // Items Build was given
+        size_t m_spliced{ 0 };         // Items spliced in since
+    };
+}
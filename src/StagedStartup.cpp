@@ -0,0 +1,138 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "StagedStartup.h"
+#include "Trace.h"
+
+#include <cstdio>
+
+namespace UIAListCore
+{
+    StagedStartup::StagedStartup(ThreadHook onThreadStart, ThreadHook onThreadStop)
+        : m_onThreadStart(std::move(onThreadStart))
+        , m_onThreadStop(std::move(onThreadStop))
+        , m_created(Clock::now())
+    {
+        m_worker = std::thread(&StagedStartup::WorkerLoop, this);
+    }
+
+    StagedStartup::~StagedStartup()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_workAvailable.notify_all();
+
+        // Queued phases still run: owners expect what they set up to exist
+        m_worker.join();
+    }
+
+    void StagedStartup::Run(const char* name, const Phase& phase)
+    {
+        Time(name, phase, false);
+    }
+
+    void StagedStartup::Defer(const char* name, Phase phase)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.emplace_back(name, std::move(phase));
+            ++m_running;
+        }
+        m_workAvailable.notify_one();
+    }
+
+    bool StagedStartup::IsReady() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_running == 0;
+    }
+
+    bool StagedStartup::WaitReady(std::chrono::milliseconds timeout) const
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_idle.wait_for(lock, timeout, [this]() { return m_running == 0; });
+    }
+
+    std::vector<StagedStartup::Timing> StagedStartup::Timings() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_timings;
+    }
+
+    std::string StagedStartup::Format() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string text;
+        char entry[128];
+        for (const Timing& timing : m_timings)
+        {
+            std::snprintf(entry, sizeof(entry), "%s%s%s %.1f ms%s", text.empty() ? "" : ", ",
+                          timing.Deferred ? "[" : "", timing.Name, timing.DurationMicroseconds / 1000.0,
+                          timing.Deferred ? "]" : "");
+            text += entry;
+        }
+        if (m_running == 0)
+        {
+            std::snprintf(entry, sizeof(entry), "; ready after %.1f ms", m_readyMicroseconds / 1000.0);
+            text += entry;
+        }
+        return text;
+    }
+
+    void StagedStartup::Time(const char* name, const Phase& phase, bool deferred)
+    {
+        const Clock::time_point start = Clock::now();
+        {
+            TraceSpan span(name, "startup");
+            phase();
+        }
+        const Clock::time_point end = Clock::now();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_timings.push_back({ name,
+                              static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(start - m_created).count()),
+                              static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()),
+                              deferred });
+        if (deferred || m_running == 0)
+        {
+            m_readyMicroseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - m_created).count());
+        }
+    }
+
+    void StagedStartup::WorkerLoop()
+    {
+        if (m_onThreadStart) m_onThreadStart();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            m_workAvailable.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty()) break;
+
+            auto [name, phase] = std::move(m_queue.front());
+            m_queue.pop_front();
+            lock.unlock();
+
+            Time(name, phase, true);
+
+            lock.lock();
+            if (--m_running == 0)
+            {
+                TraceInstant("StartupReady", "startup");
+                m_idle.notify_all();
+            }
+        }
+        lock.unlock();
+
+        if (m_onThreadStop) m_onThreadStop();
+    }
+}
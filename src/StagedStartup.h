@@ -0,0 +1,88 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace UIAListCore
+{
+    // Startup in stages. What the user needs at once (tray icon, hotkey) runs
+    // on the calling thread; everything else is deferred to a background
+    // thread and is ready before the first hotkey in the common case. Every
+    // phase is timed and recorded as a trace span.
+    class StagedStartup
+    {
+    public:
+        using Phase = std::function<void()>;
+        using ThreadHook = std::function<void()>;
+
+        struct Timing
+        {
+            const char* Name;
+            uint64_t StartMicroseconds;     // Since the StagedStartup was created
+            uint64_t DurationMicroseconds;
+            bool Deferred;
+        };
+
+        // onThreadStart/onThreadStop run on the background thread (COM
+        // init/uninit); the thread lives as long as this object, so what the
+        // deferred phases create stays in a live apartment
+        explicit StagedStartup(ThreadHook onThreadStart = {}, ThreadHook onThreadStop = {});
+        ~StagedStartup();
+
+        StagedStartup(const StagedStartup&) = delete;
+        StagedStartup& operator=(const StagedStartup&) = delete;
+
+        // name must be a string literal (kept by pointer)
+        void Run(const char* name, const Phase& phase);
+        void Defer(const char* name, Phase phase);
+
+        // Whether every deferred phase so far has finished
+        bool IsReady() const;
+
+        // Blocks until IsReady; false on timeout
+        bool WaitReady(std::chrono::milliseconds timeout) const;
+
+        std::vector<Timing> Timings() const;
+
+        // "Tray 2.1 ms, [Automation 14.0 ms], ...; ready after 18.3 ms"
+        std::string Format() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void Time(const char* name, const Phase& phase, bool deferred);
+        void WorkerLoop();
+
+        ThreadHook m_onThreadStart;
+        ThreadHook m_onThreadStop;
+        Clock::time_point m_created;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_workAvailable;
+        mutable std::condition_variable m_idle;
+        std::deque<std::pair<const char*, Phase>> m_queue;
+        std::vector<Timing> m_timings;
+        size_t m_running{ 0 };  // Deferred phases queued or running
+        uint64_t m_readyMicroseconds{ 0 };
+        bool m_stopping{ false };
+
+        std::thread m_worker;
+    };
+}
@@ -11,6 +11,7 @@
 #include "pch.h"
 #include "SystemTrayManager.h"
 #include "SettingsManager.h"
+#include "Trace.h"
 
 #define WM_TRAYICON (WM_USER + 1)
 #define HOTKEY_ID 1
@@ -104,6 +105,18 @@ namespace UIAList
         }
     }
 
+    void SystemTrayManager::ShowNotification(const wchar_t* title, const wchar_t* text)
+    {
+        if (!m_trayWindow) return;
+
+        NOTIFYICONDATAW nid = m_nid;
+        nid.uFlags = NIF_INFO;
+        nid.dwInfoFlags = NIIF_INFO;
+        wcsncpy_s(nid.szInfoTitle, title, _TRUNCATE);
+        wcsncpy_s(nid.szInfo, text, _TRUNCATE);
+        Shell_NotifyIconW(NIM_MODIFY, &nid);
+    }
+
     bool SystemTrayManager::RegisterGlobalHotkey(UINT modifiers, UINT vk)
     {
         UnregisterGlobalHotkey();
@@ -160,6 +173,8 @@ namespace UIAList
 
     void SystemTrayManager::HandleHotkeyMessage()
     {
+        UIALIST_TRACE_SPAN("Hotkey");
+
         // Get foreground window before activating our window
         HWND foregroundWindow = GetForegroundWindowBeforeActivation();
 
@@ -28,6 +28,9 @@ namespace UIAList
         bool RegisterGlobalHotkey(UINT modifiers, UINT vk);
         void UnregisterGlobalHotkey();
 
+        // Balloon notification from the tray icon (read by screen readers)
+        void ShowNotification(const wchar_t* title, const wchar_t* text);
+
     private:
         SystemTrayManager() = default;
         ~SystemTrayManager();
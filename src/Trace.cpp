@@ -0,0 +1,203 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace UIAListCore
+{
+    std::atomic<bool> TraceBuffer::s_enabled{ false };
+
+    namespace
+    {
+        const std::chrono::steady_clock::time_point& Epoch()
+        {
+            static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+            return epoch;
+        }
+
+        std::string& RequestedFile()
+        {
+            static std::string path;
+            return path;
+        }
+
+        struct Event
+        {
+            uint64_t Sequence;
+            const char* Name;
+            const char* Category;
+            uint64_t Start;
+            uint64_t Duration;
+            uint32_t Thread;
+            char Phase;
+        };
+    }
+
+    TraceBuffer::TraceBuffer()
+        : m_slots(new Slot[Capacity])
+    {
+        Epoch();
+    }
+
+    TraceBuffer& TraceBuffer::Instance()
+    {
+        static TraceBuffer instance;
+        return instance;
+    }
+
+    void TraceBuffer::InitializeFromEnvironment()
+    {
+        const char* path = std::getenv("UIALIST_TRACE");
+        if (path && *path)
+        {
+            RequestedFile() = path;
+            Instance();
+            SetEnabled(true);
+        }
+    }
+
+    bool TraceBuffer::WriteRequestedFile()
+    {
+        if (RequestedFile().empty()) return false;
+        return Instance().WriteChromeJson(RequestedFile());
+    }
+
+    uint64_t TraceBuffer::Now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - Epoch()).count());
+    }
+
+    uint32_t TraceBuffer::ThreadId()
+    {
+        // Small stable ids read better in the trace viewer than native ones
+        static std::atomic<uint32_t> nextId{ 1 };
+        thread_local uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    void TraceBuffer::Record(const char* name, const char* category, uint64_t startUs, uint64_t durationUs)
+    {
+        Write('X', name, category, startUs, durationUs);
+    }
+
+    void TraceBuffer::RecordInstant(const char* name, const char* category)
+    {
+        Write('i', name, category, Now(), 0);
+    }
+
+    void TraceBuffer::RecordCounter(const char* name, const char* category, uint64_t value)
+    {
+        Write('C', name, category, Now(), value);
+    }
+
+    void TraceBuffer::Write(char phase, const char* name, const char* category, uint64_t startUs, uint64_t durationUs)
+    {
+        const uint64_t ticket = m_next.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = m_slots[ticket % Capacity];
+
+        slot.Sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.Name.store(name, std::memory_order_relaxed);
+        slot.Category.store(category, std::memory_order_relaxed);
+        slot.Start.store(startUs, std::memory_order_relaxed);
+        slot.Duration.store(durationUs, std::memory_order_relaxed);
+        slot.Thread.store(ThreadId(), std::memory_order_relaxed);
+        slot.Phase.store(phase, std::memory_order_relaxed);
+
+        slot.Sequence.store(ticket + 1, std::memory_order_release);
+    }
+
+    void TraceBuffer::Clear()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+        {
+            m_slots[i].Sequence.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    std::string TraceBuffer::ToChromeJson() const
+    {
+        std::vector<Event> events;
+        events.reserve(Capacity);
+
+        for (size_t i = 0; i < Capacity; ++i)
+        {
+            const Slot& slot = m_slots[i];
+            Event event;
+            event.Sequence = slot.Sequence.load(std::memory_order_acquire);
+            if (event.Sequence == 0) continue;
+
+            event.Name = slot.Name.load(std::memory_order_relaxed);
+            event.Category = slot.Category.load(std::memory_order_relaxed);
+            event.Start = slot.Start.load(std::memory_order_relaxed);
+            event.Duration = slot.Duration.load(std::memory_order_relaxed);
+            event.Thread = slot.Thread.load(std::memory_order_relaxed);
+            event.Phase = slot.Phase.load(std::memory_order_relaxed);
+
+            // Skip slots overwritten while we were reading them
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.Sequence.load(std::memory_order_relaxed) != event.Sequence || !event.Name) continue;
+
+            events.push_back(event);
+        }
+
+        std::sort(events.begin(), events.end(),
+                  [](const Event& a, const Event& b) { return a.Sequence < b.Sequence; });
+
+        // Names are string literals from our own code, no escaping needed
+        std::string json = "{\"traceEvents\":[\n";
+        char line[512];
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            const Event& event = events[i];
+            if (event.Phase == 'i')
+            {
+                std::snprintf(line, sizeof(line),
+                              "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%llu,\"pid\":1,\"tid\":%u}",
+                              event.Name, event.Category, static_cast<unsigned long long>(event.Start), event.Thread);
+            }
+            else if (event.Phase == 'C')
+            {
+                std::snprintf(line, sizeof(line),
+                              "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"C\",\"ts\":%llu,\"pid\":1,\"args\":{\"value\":%llu}}",
+                              event.Name, event.Category, static_cast<unsigned long long>(event.Start),
+                              static_cast<unsigned long long>(event.Duration));
+            }
+            else
+            {
+                std::snprintf(line, sizeof(line),
+                              "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%u}",
+                              event.Name, event.Category, static_cast<unsigned long long>(event.Start),
+                              static_cast<unsigned long long>(event.Duration), event.Thread);
+            }
+            json += line;
+            json += (i + 1 < events.size()) ? ",\n" : "\n";
+        }
+        json += "]}\n";
+        return json;
+    }
+
+    bool TraceBuffer::WriteChromeJson(const std::string& path) const
+    {
+        std::string json = ToChromeJson();
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        bool written = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+        return std::fclose(file) == 0 && written;
+    }
+}
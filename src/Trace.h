@@ -0,0 +1,122 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace UIAListCore
+{
+    // Latency tracing from hotkey to first row, complete list and action.
+    // Spans are recorded into a fixed-size lock-free ring buffer (the oldest
+    // are overwritten) and dumped as Chrome trace-event JSON, viewable in
+    // chrome://tracing or ui.perfetto.dev.
+    //
+    // Off by default. Set UIALIST_TRACE to an output file to record; the
+    // frontends write the file on exit. When off, a span costs one relaxed
+    // atomic load.
+    class TraceBuffer
+    {
+    public:
+        static TraceBuffer& Instance();
+
+        static bool Enabled() { return s_enabled.load(std::memory_order_relaxed); }
+        static void SetEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+
+        // Enables tracing when UIALIST_TRACE is set
+        static void InitializeFromEnvironment();
+
+        // Writes the Chrome JSON to the UIALIST_TRACE file, if tracing was requested
+        static bool WriteRequestedFile();
+
+        // Microseconds since the trace epoch (process start of tracing)
+        static uint64_t Now();
+
+        // name and category must be string literals (stored by pointer)
+        void Record(const char* name, const char* category, uint64_t startUs, uint64_t durationUs);
+        void RecordInstant(const char* name, const char* category);
+        void RecordCounter(const char* name, const char* category, uint64_t value);
+
+        std::string ToChromeJson() const;
+        bool WriteChromeJson(const std::string& path) const;
+
+        void Clear();
+
+    private:
+        // Seqlock slot: Sequence is 0 while being written, ticket + 1 after.
+        // Fields are relaxed atomics so a concurrent dump is well-defined.
+        struct Slot
+        {
+            std::atomic<uint64_t> Sequence{ 0 };
+            std::atomic<const char*> Name{ nullptr };
+            std::atomic<const char*> Category{ nullptr };
+            std::atomic<uint64_t> Start{ 0 };
+            std::atomic<uint64_t> Duration{ 0 };  // The value for counter events
+            std::atomic<uint32_t> Thread{ 0 };
+            std::atomic<char> Phase{ 'X' };       // Chrome trace phase: 'X' span, 'i' instant, 'C' counter
+        };
+
+        static constexpr size_t Capacity = 16384;
+
+        TraceBuffer();
+
+        void Write(char phase, const char* name, const char* category, uint64_t startUs, uint64_t durationUs);
+        static uint32_t ThreadId();
+
+        static std::atomic<bool> s_enabled;
+
+        std::unique_ptr<Slot[]> m_slots;
+        std::atomic<uint64_t> m_next{ 0 };
+    };
+
+    // Records the enclosing scope as a complete ("X") event; a null name records nothing
+    class TraceSpan
+    {
+    public:
+        explicit TraceSpan(const char* name, const char* category = "uialist")
+            : m_name(TraceBuffer::Enabled() ? name : nullptr)
+            , m_category(category)
+            , m_start(m_name ? TraceBuffer::Now() : 0)
+        {
+        }
+
+        ~TraceSpan()
+        {
+            if (m_name)
+            {
+                TraceBuffer::Instance().Record(m_name, m_category, m_start, TraceBuffer::Now() - m_start);
+            }
+        }
+
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+
+    private:
+        const char* m_name;
+        const char* m_category;
+        uint64_t m_start;
+    };
+
+    // A point in time, e.g. the first row appearing
+    inline void TraceInstant(const char* name, const char* category = "uialist")
+    {
+        if (TraceBuffer::Enabled()) TraceBuffer::Instance().RecordInstant(name, category);
+    }
+}
+
+#define UIALIST_TRACE_CONCAT_INNER(a, b) a##b
+#define UIALIST_TRACE_CONCAT(a, b) UIALIST_TRACE_CONCAT_INNER(a, b)
+
+// UIALIST_TRACE_SPAN("StartEnumeration");
+#define UIALIST_TRACE_SPAN(name) UIAListCore::TraceSpan UIALIST_TRACE_CONCAT(uialistTraceSpan, __LINE__)(name)
@@ -0,0 +1,115 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace UIAListCore
+{
+    // Element properties the enumeration reads
+    enum ElementProperty : uint32_t
+    {
+        PropertyNone = 0,
+        PropertyControlType = 1 << 0,
+        PropertyName = 1 << 1,
+        PropertyAutomationId = 1 << 2,
+        PropertyCapabilities = 1 << 3,  // Capability bits (pattern availability, on-screen)
+        PropertyBoundingRectangle = 1 << 4,
+    };
+
+    // Screen rectangle in physical pixels, right and bottom exclusive
+    struct ElementRect
+    {
+        int32_t Left{ 0 };
+        int32_t Top{ 0 };
+        int32_t Right{ 0 };
+        int32_t Bottom{ 0 };
+
+        bool IsEmpty() const { return Right <= Left || Bottom <= Top; }
+        int64_t Width() const { return static_cast<int64_t>(Right) - Left; }
+        int64_t Height() const { return static_cast<int64_t>(Bottom) - Top; }
+
+        bool Intersects(const ElementRect& other) const
+        {
+            return Left < other.Right && other.Left < Right && Top < other.Bottom && other.Top < Bottom;
+        }
+
+        bool Contains(const ElementRect& other) const
+        {
+            return Left <= other.Left && Top <= other.Top && other.Right <= Right && other.Bottom <= Bottom;
+        }
+    };
+
+    struct ElementProperties
+    {
+        int32_t ControlType{ 0 };
+        std::wstring Name;
+        bool HasName{ false };  // The provider returned a name at all
+        std::wstring AutomationId;
+        uint32_t Capabilities{ 0 };  // CapabilitiesNone unless cached, see ActionStrategy.h
+        ElementRect BoundingRectangle;  // Empty for controls without a place on screen
+    };
+
+    // What navigation calls fetch along with each element
+    struct CacheRequest
+    {
+        uint32_t Properties{ PropertyNone };
+
+        // Root() fetches the whole tree in one call, navigation is then served locally
+        bool Subtree{ false };
+    };
+
+    // Provider-specific element handle
+    class TreeElement
+    {
+    public:
+        virtual ~TreeElement() = default;
+    };
+
+    // The part of UI Automation the enumeration walker needs. Implemented over
+    // IUIAutomation on Windows (UiaTreeProvider) and by in-process fakes, so the
+    // walker can be measured without a desktop.
+    class TreeProvider
+    {
+    public:
+        virtual ~TreeProvider() = default;
+
+        // Applies to every later Root/FirstChild/NextSibling call
+        virtual bool SetCacheRequest(const CacheRequest& request) = 0;
+
+        // The target window, null when it is gone
+        virtual std::unique_ptr<TreeElement> Root() = 0;
+
+        // Control view navigation, null at the end
+        virtual std::unique_ptr<TreeElement> FirstChild(TreeElement& parent) = 0;
+        virtual std::unique_ptr<TreeElement> NextSibling(TreeElement& element) = 0;
+
+        // Fills the requested properties, from the cache where the cache request
+        // has them. False when the element is no longer available.
+        virtual bool GetProperties(TreeElement& element, uint32_t properties, ElementProperties& result) = 0;
+
+        // For walks that start where the user is; providers that cannot
+        // navigate up keep the defaults and are walked from the root.
+        // The element with keyboard focus, anywhere on the desktop; null when unknown
+        virtual std::unique_ptr<TreeElement> Focused() { return nullptr; }
+
+        // Control view parent, null at the top
+        virtual std::unique_ptr<TreeElement> Parent(TreeElement&) { return nullptr; }
+
+        // Whether a and b are the same control
+        virtual bool IsSameElement(TreeElement&, TreeElement&) { return false; }
+
+        // Cross-process calls made so far, 0 when the provider does not count them
+        virtual uint64_t Calls() const { return 0; }
+    };
+}
@@ -0,0 +1,337 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "TreeRecording.h"
+#include "ActionStrategy.h"
+#include "Utf8.h"
+#include "Varint.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        // "UIATREE" and a format version byte
+        const char Magic[8] = { 'U', 'I', 'A', 'T', 'R', 'E', 'E', 1 };
+
+        enum NodeFlags : uint32_t
+        {
+            FlagAvailable = 1 << 0,
+            FlagHasName = 1 << 1,
+        };
+
+        class RecordingElement : public TreeElement
+        {
+        public:
+            RecordingElement(std::unique_ptr<TreeElement> inner, uint32_t index) : Inner(std::move(inner)), Index(index) {}
+
+            std::unique_ptr<TreeElement> Inner;
+            uint32_t Index;
+        };
+
+        class ReplayElement : public TreeElement
+        {
+        public:
+            explicit ReplayElement(uint32_t index) : Index(index) {}
+
+            uint32_t Index;
+        };
+
+        void PutCost(std::string& out, const TreeRecording::Cost& cost)
+        {
+            PutVarint(out, cost.Microseconds);
+            PutVarint(out, cost.Calls);
+        }
+
+        bool GetCost(VarintReader& reader, TreeRecording::Cost& cost)
+        {
+            return reader.GetUint32(cost.Microseconds) && reader.GetUint32(cost.Calls);
+        }
+
+        // Zigzag, screen coordinates left of or above the primary monitor are negative
+        void PutSigned(std::string& out, int32_t value)
+        {
+            PutVarint(out, (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+        }
+
+        bool GetSigned(VarintReader& reader, int32_t& value)
+        {
+            uint32_t encoded = 0;
+            if (!reader.GetUint32(encoded)) return false;
+            value = static_cast<int32_t>((encoded >> 1) ^ (0u - (encoded & 1)));
+            return true;
+        }
+
+        // Only in recordings that read them, so older files load unchanged
+        void PutBounds(std::string& out, const ElementRect& bounds)
+        {
+            PutSigned(out, bounds.Left);
+            PutSigned(out, bounds.Top);
+            PutSigned(out, bounds.Right);
+            PutSigned(out, bounds.Bottom);
+        }
+
+        bool GetBounds(VarintReader& reader, ElementRect& bounds)
+        {
+            return GetSigned(reader, bounds.Left) && GetSigned(reader, bounds.Top) &&
+                   GetSigned(reader, bounds.Right) && GetSigned(reader, bounds.Bottom);
+        }
+
+        void WaitFor(std::chrono::microseconds duration)
+        {
+            // Sleep the bulk, spin the rest: sleeps are too coarse for single calls
+            const auto end = std::chrono::steady_clock::now() + duration;
+            if (duration > std::chrono::milliseconds(2))
+            {
+                std::this_thread::sleep_for(duration - std::chrono::milliseconds(1));
+            }
+            while (std::chrono::steady_clock::now() < end) {}
+        }
+    }
+
+    bool TreeRecording::Save(const std::filesystem::path& path) const
+    {
+        std::string out(Magic, sizeof(Magic));
+        PutString(out, ProcessImage);
+        PutString(out, Mode);
+        PutVarint(out, Properties);
+        PutCost(out, RootCost);
+        PutVarint(out, Nodes.size());
+
+        for (const Node& node : Nodes)
+        {
+            // Links are stored + 1 so that "none" is the one-byte 0
+            PutVarint(out, node.FirstChild == NoNode ? 0 : static_cast<uint64_t>(node.FirstChild) + 1);
+            PutVarint(out, node.NextSibling == NoNode ? 0 : static_cast<uint64_t>(node.NextSibling) + 1);
+            PutVarint(out, (node.Available ? static_cast<uint32_t>(FlagAvailable) : 0u) |
+                           (node.Properties.HasName ? static_cast<uint32_t>(FlagHasName) : 0u));
+            PutVarint(out, static_cast<uint32_t>(node.Properties.ControlType));
+            PutString(out, ToUtf8(node.Properties.Name));
+            PutString(out, ToUtf8(node.Properties.AutomationId));
+            PutVarint(out, node.Properties.Capabilities);
+            PutCost(out, node.FirstChildCost);
+            PutCost(out, node.NextSiblingCost);
+            PutCost(out, node.PropertiesCost);
+            if (Properties & PropertyBoundingRectangle) PutBounds(out, node.Properties.BoundingRectangle);
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        return static_cast<bool>(file);
+    }
+
+    bool TreeRecording::Load(const std::filesystem::path& path, TreeRecording& recording)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (data.size() < sizeof(Magic) || std::memcmp(data.data(), Magic, sizeof(Magic)) != 0) return false;
+
+        TreeRecording result;
+        uint64_t count = 0;
+        VarintReader body(data, sizeof(Magic));
+        if (!body.GetString(result.ProcessImage) || !body.GetString(result.Mode) ||
+            !body.GetUint32(result.Properties) || !GetCost(body, result.RootCost) || !body.GetVarint(count))
+        {
+            return false;
+        }
+        if (count > data.size()) return false;  // At least one byte per node
+
+        result.Nodes.resize(static_cast<size_t>(count));
+        for (Node& node : result.Nodes)
+        {
+            uint32_t firstChild = 0;
+            uint32_t nextSibling = 0;
+            uint32_t flags = 0;
+            uint32_t controlType = 0;
+            std::string name;
+            std::string automationId;
+            if (!body.GetUint32(firstChild) || !body.GetUint32(nextSibling) || !body.GetUint32(flags) ||
+                !body.GetUint32(controlType) || !body.GetString(name) || !body.GetString(automationId) ||
+                !body.GetUint32(node.Properties.Capabilities) || !GetCost(body, node.FirstChildCost) ||
+                !GetCost(body, node.NextSiblingCost) || !GetCost(body, node.PropertiesCost) ||
+                ((result.Properties & PropertyBoundingRectangle) && !GetBounds(body, node.Properties.BoundingRectangle)))
+            {
+                return false;
+            }
+            if (firstChild > count || nextSibling > count) return false;
+
+            node.FirstChild = firstChild ? firstChild - 1 : NoNode;
+            node.NextSibling = nextSibling ? nextSibling - 1 : NoNode;
+            node.Available = (flags & FlagAvailable) != 0;
+            node.Properties.HasName = (flags & FlagHasName) != 0;
+            node.Properties.ControlType = static_cast<int32_t>(controlType);
+            node.Properties.Name = FromUtf8(name);
+            node.Properties.AutomationId = FromUtf8(automationId);
+        }
+
+        recording = std::move(result);
+        return true;
+    }
+
+    RecordingTreeProvider::RecordingTreeProvider(TreeProvider& inner)
+        : m_inner(inner)
+    {
+    }
+
+    TreeElement& RecordingTreeProvider::Inner(TreeElement& element)
+    {
+        return *static_cast<RecordingElement&>(element).Inner;
+    }
+
+    uint32_t RecordingTreeProvider::AddNode()
+    {
+        m_recording.Nodes.emplace_back();
+        return static_cast<uint32_t>(m_recording.Nodes.size() - 1);
+    }
+
+    TreeRecording::Cost RecordingTreeProvider::Measure(std::chrono::steady_clock::time_point start, uint64_t callsBefore) const
+    {
+        TreeRecording::Cost cost;
+        cost.Microseconds = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        cost.Calls = static_cast<uint32_t>(m_inner.Calls() - callsBefore);
+        return cost;
+    }
+
+    bool RecordingTreeProvider::SetCacheRequest(const CacheRequest& request)
+    {
+        m_recording.Mode = request.Subtree ? "SubtreeCache" : request.Properties != PropertyNone ? "BuildCache" : "Current";
+        return m_inner.SetCacheRequest(request);
+    }
+
+    std::unique_ptr<TreeElement> RecordingTreeProvider::Root()
+    {
+        m_recording.Nodes.clear();
+
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t calls = m_inner.Calls();
+        std::unique_ptr<TreeElement> root = m_inner.Root();
+        m_recording.RootCost = Measure(start, calls);
+
+        if (!root) return nullptr;
+        return std::make_unique<RecordingElement>(std::move(root), AddNode());
+    }
+
+    std::unique_ptr<TreeElement> RecordingTreeProvider::FirstChild(TreeElement& parent)
+    {
+        RecordingElement& recorded = static_cast<RecordingElement&>(parent);
+
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t calls = m_inner.Calls();
+        std::unique_ptr<TreeElement> child = m_inner.FirstChild(*recorded.Inner);
+        m_recording.Nodes[recorded.Index].FirstChildCost = Measure(start, calls);
+
+        if (!child) return nullptr;
+        const uint32_t index = AddNode();
+        m_recording.Nodes[recorded.Index].FirstChild = index;
+        return std::make_unique<RecordingElement>(std::move(child), index);
+    }
+
+    std::unique_ptr<TreeElement> RecordingTreeProvider::NextSibling(TreeElement& element)
+    {
+        RecordingElement& recorded = static_cast<RecordingElement&>(element);
+
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t calls = m_inner.Calls();
+        std::unique_ptr<TreeElement> sibling = m_inner.NextSibling(*recorded.Inner);
+        m_recording.Nodes[recorded.Index].NextSiblingCost = Measure(start, calls);
+
+        if (!sibling) return nullptr;
+        const uint32_t index = AddNode();
+        m_recording.Nodes[recorded.Index].NextSibling = index;
+        return std::make_unique<RecordingElement>(std::move(sibling), index);
+    }
+
+    bool RecordingTreeProvider::GetProperties(TreeElement& element, uint32_t properties, ElementProperties& result)
+    {
+        RecordingElement& recorded = static_cast<RecordingElement&>(element);
+
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t calls = m_inner.Calls();
+        const bool available = m_inner.GetProperties(*recorded.Inner, properties, result);
+
+        TreeRecording::Node& node = m_recording.Nodes[recorded.Index];
+        node.PropertiesCost = Measure(start, calls);
+        node.Available = available;
+        if (available) node.Properties = result;
+        m_recording.Properties |= properties;
+        return available;
+    }
+
+    ReplayTreeProvider::ReplayTreeProvider(const TreeRecording& recording, Timing timing)
+        : m_recording(recording)
+        , m_timing(timing)
+    {
+    }
+
+    void ReplayTreeProvider::Charge(const TreeRecording::Cost& cost)
+    {
+        m_calls += cost.Calls;
+        if (m_timing == Timing::Original && cost.Microseconds > 0)
+        {
+            WaitFor(std::chrono::microseconds(cost.Microseconds));
+        }
+    }
+
+    std::unique_ptr<TreeElement> ReplayTreeProvider::Serve(uint32_t index, const TreeRecording::Cost& cost)
+    {
+        Charge(cost);
+        if (index == TreeRecording::NoNode || index >= m_recording.Nodes.size()) return nullptr;
+        return std::make_unique<ReplayElement>(index);
+    }
+
+    bool ReplayTreeProvider::SetCacheRequest(const CacheRequest&)
+    {
+        return true;
+    }
+
+    std::unique_ptr<TreeElement> ReplayTreeProvider::Root()
+    {
+        return Serve(m_recording.Nodes.empty() ? TreeRecording::NoNode : 0, m_recording.RootCost);
+    }
+
+    std::unique_ptr<TreeElement> ReplayTreeProvider::FirstChild(TreeElement& parent)
+    {
+        const TreeRecording::Node& node = m_recording.Nodes[static_cast<ReplayElement&>(parent).Index];
+        return Serve(node.FirstChild, node.FirstChildCost);
+    }
+
+    std::unique_ptr<TreeElement> ReplayTreeProvider::NextSibling(TreeElement& element)
+    {
+        const TreeRecording::Node& node = m_recording.Nodes[static_cast<ReplayElement&>(element).Index];
+        return Serve(node.NextSibling, node.NextSiblingCost);
+    }
+
+    bool ReplayTreeProvider::GetProperties(TreeElement& element, uint32_t properties, ElementProperties& result)
+    {
+        const TreeRecording::Node& node = m_recording.Nodes[static_cast<ReplayElement&>(element).Index];
+        Charge(node.PropertiesCost);
+        if (!node.Available) return false;
+
+        // Only what was recorded; the rest keeps its default
+        const uint32_t served = properties & m_recording.Properties;
+        if (served & PropertyControlType) result.ControlType = node.Properties.ControlType;
+        if (served & PropertyName)
+        {
+            result.Name = node.Properties.Name;
+            result.HasName = node.Properties.HasName;
+        }
+        if (served & PropertyAutomationId) result.AutomationId = node.Properties.AutomationId;
+        result.Capabilities = (served & PropertyCapabilities) ? node.Properties.Capabilities : CapabilitiesNone;
+        if (served & PropertyBoundingRectangle) result.BoundingRectangle = node.Properties.BoundingRectangle;
+        return true;
+    }
+}
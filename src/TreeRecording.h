@@ -0,0 +1,118 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "TreeProvider.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace UIAListCore
+{
+    // A control tree as one enumeration saw it: properties, structure and the
+    // measured cost of every provider call. Recorded on a user's machine and
+    // replayed anywhere, so problem windows can be profiled without the
+    // application that produced them.
+    struct TreeRecording
+    {
+        static constexpr uint32_t NoNode = UINT32_MAX;
+
+        // Cost of one provider call
+        struct Cost
+        {
+            uint32_t Microseconds{ 0 };
+            uint32_t Calls{ 0 };  // Cross-process calls it made, see TreeProvider::Calls
+        };
+
+        struct Node
+        {
+            uint32_t FirstChild{ NoNode };
+            uint32_t NextSibling{ NoNode };
+            bool Available{ false };  // GetProperties succeeded
+            ElementProperties Properties;
+            Cost FirstChildCost;
+            Cost NextSiblingCost;
+            Cost PropertiesCost;
+        };
+
+        std::string ProcessImage;
+        std::string Mode;                          // ToString(WalkMode) of the recorded walk
+        uint32_t Properties{ PropertyNone };       // ElementProperty bits that were read
+        Cost RootCost;
+        std::vector<Node> Nodes;                   // Nodes[0] is the root, empty if it was not found
+
+        // Compact binary file (varints, UTF-8 strings)
+        bool Save(const std::filesystem::path& path) const;
+        static bool Load(const std::filesystem::path& path, TreeRecording& recording);
+    };
+
+    // Passes every call through to another provider and records it
+    class RecordingTreeProvider : public TreeProvider
+    {
+    public:
+        explicit RecordingTreeProvider(TreeProvider& inner);
+
+        bool SetCacheRequest(const CacheRequest& request) override;
+        std::unique_ptr<TreeElement> Root() override;
+        std::unique_ptr<TreeElement> FirstChild(TreeElement& parent) override;
+        std::unique_ptr<TreeElement> NextSibling(TreeElement& element) override;
+        bool GetProperties(TreeElement& element, uint32_t properties, ElementProperties& result) override;
+        uint64_t Calls() const override { return m_inner.Calls(); }
+
+        // The inner provider's element, for visitors that need the real one
+        static TreeElement& Inner(TreeElement& element);
+
+        const TreeRecording& Recording() const { return m_recording; }
+        void SetProcessImage(std::string image) { m_recording.ProcessImage = std::move(image); }
+
+    private:
+        uint32_t AddNode();
+        TreeRecording::Cost Measure(std::chrono::steady_clock::time_point start, uint64_t callsBefore) const;
+
+        TreeProvider& m_inner;
+        TreeRecording m_recording;
+    };
+
+    // Serves a recording through the TreeProvider interface. With original
+    // timing every call waits as long as it took when recorded; the cache
+    // request is ignored, the recorded mode decided what was cached.
+    class ReplayTreeProvider : public TreeProvider
+    {
+    public:
+        enum class Timing
+        {
+            Original,
+            AsFastAsPossible
+        };
+
+        ReplayTreeProvider(const TreeRecording& recording, Timing timing);
+
+        bool SetCacheRequest(const CacheRequest& request) override;
+        std::unique_ptr<TreeElement> Root() override;
+        std::unique_ptr<TreeElement> FirstChild(TreeElement& parent) override;
+        std::unique_ptr<TreeElement> NextSibling(TreeElement& element) override;
+        bool GetProperties(TreeElement& element, uint32_t properties, ElementProperties& result) override;
+        uint64_t Calls() const override { return m_calls; }
+
+        void ResetCalls() { m_calls = 0; }
+
+    private:
+        std::unique_ptr<TreeElement> Serve(uint32_t index, const TreeRecording::Cost& cost);
+        void Charge(const TreeRecording::Cost& cost);
+
+        const TreeRecording& m_recording;
+        Timing m_timing;
+        uint64_t m_calls{ 0 };
+    };
+}
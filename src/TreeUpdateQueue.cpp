@@ -0,0 +1,162 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "TreeUpdateQueue.h"
+
+#include <algorithm>
+
+namespace UIAListCore
+{
+    void TreeUpdateQueue::Post(RuntimeId id, uint32_t changes, std::shared_ptr<TreeElement> element, Clock::time_point now)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_closed) return;
+
+            ++m_stats.Events;
+            if (m_events++ == 0) m_first = now;
+            m_last = now;
+
+            if (!m_wholeTree)
+            {
+                Change& change = m_pending[std::move(id)];
+                change.Changes |= changes;
+                if (element) change.Element = std::move(element);
+
+                // A storm: walking everything once is cheaper than chasing it
+                if (m_pending.size() > m_timing.StormElements || m_events > m_timing.StormEvents)
+                {
+                    m_wholeTree = true;
+                    m_pending.clear();
+                }
+            }
+        }
+        m_changed.notify_one();
+    }
+
+    bool TreeUpdateQueue::Take(Clock::time_point now, Batch& batch)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_events == 0 || DueAt() > now) return false;
+
+        batch.Changes.clear();
+        batch.Changes.reserve(m_pending.size());
+        for (auto& [id, change] : m_pending)
+        {
+            change.Id = id;
+            batch.Changes.push_back(std::move(change));
+        }
+        batch.WholeTree = m_wholeTree;
+        batch.Events = m_events;
+
+        ++m_stats.Batches;
+        if (m_wholeTree) ++m_stats.WholeTree;
+        m_earliest = now + (m_wholeTree ? m_timing.StormInterval : m_timing.MinInterval);
+        m_pending.clear();
+        m_wholeTree = false;
+        m_events = 0;
+        return true;
+    }
+
+    TreeUpdateQueue::Clock::time_point TreeUpdateQueue::NextDue() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_events == 0 ? Clock::time_point::max() : DueAt();
+    }
+
+    bool TreeUpdateQueue::Wait(Batch& batch)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            if (m_closed) return false;
+            if (m_events == 0)
+            {
+                m_changed.wait(lock);
+                continue;
+            }
+
+            const Clock::time_point due = DueAt();
+            if (Clock::now() < due)
+            {
+                // Woken early by every Post; the due time moves with them
+                m_changed.wait_until(lock, due);
+                continue;
+            }
+
+            lock.unlock();
+            if (Take(Clock::now(), batch)) return true;
+            lock.lock();
+        }
+    }
+
+    void TreeUpdateQueue::Reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.clear();
+        m_wholeTree = false;
+        m_events = 0;
+    }
+
+    void TreeUpdateQueue::Close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+            m_pending.clear();
+            m_wholeTree = false;
+            m_events = 0;
+        }
+        m_changed.notify_all();
+    }
+
+    void TreeUpdateQueue::Open()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = false;
+    }
+
+    TreeUpdateQueue::Stats TreeUpdateQueue::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    TreeUpdateQueue::Clock::time_point TreeUpdateQueue::DueAt() const
+    {
+        const Clock::time_point settled = std::min(m_last + m_timing.Settle, m_first + m_timing.MaxDelay);
+        return std::max(settled, m_earliest);
+    }
+
+    size_t SubtreeEnd(const std::vector<uint32_t>& depths, size_t row)
+    {
+        if (row >= depths.size()) return depths.size();
+        size_t end = row + 1;
+        while (end < depths.size() && depths[end] > depths[row]) ++end;
+        return end;
+    }
+
+    std::vector<size_t> OutermostSubtrees(const std::vector<uint32_t>& depths, std::vector<size_t> rows)
+    {
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+        std::vector<size_t> outermost;
+        size_t coveredEnd = 0;
+        for (size_t row : rows)
+        {
+            if (row >= depths.size()) continue;
+            if (!outermost.empty() && row < coveredEnd) continue;
+            outermost.push_back(row);
+            coveredEnd = SubtreeEnd(depths, row);
+        }
+        return outermost;
+    }
+}
@@ -0,0 +1,131 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "TreeProvider.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace UIAListCore
+{
+    // UI Automation runtime id of an element
+    using RuntimeId = std::vector<int32_t>;
+
+    enum TreeChange : uint32_t
+    {
+        TreeChangeNone = 0,
+        TreeChangeStructure = 1 << 0,  // Children added, removed or reordered: re-walk the subtree
+        TreeChangeName = 1 << 1,       // Re-read the element alone
+    };
+
+    // Change events of the target application, coalesced per element until
+    // they are worth a re-walk. Events arrive on UI Automation's threads;
+    // one background thread takes them in batches:
+    //   - a batch is due once events paused for Settle, or MaxDelay after
+    //     its first event, never sooner than MinInterval after the last batch
+    //   - events of the same element merge, keeping the latest element
+    //   - beyond StormElements elements or StormEvents events a batch
+    //     becomes one whole tree refresh, and the next waits StormInterval
+    class TreeUpdateQueue
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Timing
+        {
+            std::chrono::milliseconds Settle{ 100 };
+            std::chrono::milliseconds MaxDelay{ 500 };
+            std::chrono::milliseconds MinInterval{ 250 };
+            std::chrono::milliseconds StormInterval{ 2000 };
+            size_t StormElements{ 64 };
+            size_t StormEvents{ 2000 };
+        };
+
+        struct Change
+        {
+            RuntimeId Id;
+            uint32_t Changes{ TreeChangeNone };
+            std::shared_ptr<TreeElement> Element;  // Fresh from the event, may be null
+        };
+
+        struct Batch
+        {
+            std::vector<Change> Changes;  // Empty for a whole tree refresh
+            bool WholeTree{ false };
+            uint64_t Events{ 0 };
+        };
+
+        struct Stats
+        {
+            uint64_t Events{ 0 };
+            uint64_t Batches{ 0 };
+            uint64_t WholeTree{ 0 };  // Batches that were storms
+        };
+
+        TreeUpdateQueue() = default;
+        explicit TreeUpdateQueue(const Timing& timing) : m_timing(timing) {}
+
+        TreeUpdateQueue(const TreeUpdateQueue&) = delete;
+        TreeUpdateQueue& operator=(const TreeUpdateQueue&) = delete;
+
+        // Any thread
+        void Post(RuntimeId id, uint32_t changes, std::shared_ptr<TreeElement> element,
+                  Clock::time_point now = Clock::now());
+
+        // What is pending, if it is due at now
+        bool Take(Clock::time_point now, Batch& batch);
+
+        // When the pending changes are due; Clock::time_point::max() without any
+        Clock::time_point NextDue() const;
+
+        // Blocks until a batch is due; false once closed
+        bool Wait(Batch& batch);
+
+        // Drops what is pending, e.g. when the list is hidden
+        void Reset();
+
+        // Wakes Wait for good, until Open
+        void Close();
+        void Open();
+
+        Stats GetStats() const;
+
+    private:
+        Clock::time_point DueAt() const;
+
+        Timing m_timing;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_changed;
+        std::map<RuntimeId, Change> m_pending;
+        bool m_wholeTree{ false };
+        uint64_t m_events{ 0 };  // Of the pending batch
+        Clock::time_point m_first{};
+        Clock::time_point m_last{};
+        Clock::time_point m_earliest{};  // Of the next batch, after the rate limit
+        bool m_closed{ false };
+        Stats m_stats;
+    };
+
+    // For the preorder depths of a list (0 for the root): row's subtree is
+    // the rows [row, SubtreeEnd(depths, row))
+    size_t SubtreeEnd(const std::vector<uint32_t>& depths, size_t row);
+
+    // rows sorted, without duplicates and rows inside another row's subtree
+    std::vector<size_t> OutermostSubtrees(const std::vector<uint32_t>& depths, std::vector<size_t> rows);
+}
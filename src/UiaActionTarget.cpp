@@ -0,0 +1,222 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "UiaActionTarget.h"
+#include "CallStats.h"
+#include "InputInjector.h"
+#include "Log.h"
+#include "Trace.h"
+
+namespace UIAListCore
+{
+    UiaActionTarget::UiaActionTarget(IUIAutomation* automation, IUIAutomationElement* element)
+        : m_automation(automation)
+        , m_element(element)
+    {
+    }
+
+    bool UiaActionTarget::Run(ActionStrategy strategy, ActionKind kind)
+    {
+        const bool doubleClick = (kind == ActionKind::DoubleClick);
+
+        switch (strategy)
+        {
+        case ActionStrategy::Mouse:
+            return doubleClick ? DoubleClickViaMouse() : ClickViaMouse();
+        case ActionStrategy::Invoke:
+            return doubleClick ? DoubleClickViaInvokePattern() : ClickViaInvokePattern();
+        case ActionStrategy::LegacyDefaultAction:
+            return doubleClick ? DoubleClickViaLegacyPattern() : ClickViaLegacyPattern();
+        case ActionStrategy::SelectionItem:
+            return ClickViaSelectionPattern();
+        case ActionStrategy::Toggle:
+            return DoubleClickViaTogglePattern();
+        case ActionStrategy::SetFocus:
+            return FocusViaSetFocus();
+        case ActionStrategy::KeyboardTab:
+            return FocusViaKeyboard();
+        }
+        return false;
+    }
+
+    bool UiaActionTarget::GetClickPoint(POINT& point)
+    {
+        RECT rect;
+        HRESULT hr = UIALIST_COUNTED("IUIAutomationElement::get_CurrentBoundingRectangle", m_element->get_CurrentBoundingRectangle(&rect));
+        if (FAILED(hr)) return false;
+
+        // Offscreen elements report an empty rectangle, clicking it would hit (0,0)
+        if (rect.right <= rect.left || rect.bottom <= rect.top) return false;
+
+        point.x = rect.left + (rect.right - rect.left) / 2;
+        point.y = rect.top + (rect.bottom - rect.top) / 2;
+        return true;
+    }
+
+    bool UiaActionTarget::ClickViaMouse()
+    {
+        POINT point;
+        if (!GetClickPoint(point)) return false;
+
+        // Unconfirmed: true means the input was sent. Controls raise no common
+        // event for a click, and waiting on one that never comes would only
+        // add the timeout to every mouse click.
+        return InputInjector::Click(point);
+    }
+
+    bool UiaActionTarget::ClickViaInvokePattern()
+    {
+        IUIAutomationInvokePattern* invokePattern = nullptr;
+        HRESULT hr = UIALIST_COUNTED("IUIAutomationElement::GetCurrentPatternAs",
+                                     m_element->GetCurrentPatternAs(UIA_InvokePatternId, __uuidof(IUIAutomationInvokePattern), (void**)&invokePattern));
+
+        if (SUCCEEDED(hr) && invokePattern)
+        {
+            hr = UIALIST_COUNTED("IUIAutomationInvokePattern::Invoke", invokePattern->Invoke());
+            invokePattern->Release();
+            return SUCCEEDED(hr);
+        }
+        return false;
+    }
+
+    bool UiaActionTarget::ClickViaLegacyPattern()
+    {
+        IUIAutomationLegacyIAccessiblePattern* legacyPattern = nullptr;
+        HRESULT hr = UIALIST_COUNTED("IUIAutomationElement::GetCurrentPatternAs",
+                                     m_element->GetCurrentPatternAs(UIA_LegacyIAccessiblePatternId, __uuidof(IUIAutomationLegacyIAccessiblePattern), (void**)&legacyPattern));
+
+        if (SUCCEEDED(hr) && legacyPattern)
+        {
+            hr = UIALIST_COUNTED("IUIAutomationLegacyIAccessiblePattern::DoDefaultAction", legacyPattern->DoDefaultAction());
+            legacyPattern->Release();
+            return SUCCEEDED(hr);
+        }
+        return false;
+    }
+
+    bool UiaActionTarget::ClickViaSelectionPattern()
+    {
+        IUIAutomationSelectionItemPattern* selectionPattern = nullptr;
+        HRESULT hr = UIALIST_COUNTED("IUIAutomationElement::GetCurrentPatternAs",
+                                     m_element->GetCurrentPatternAs(UIA_SelectionItemPatternId, __uuidof(IUIAutomationSelectionItemPattern), (void**)&selectionPattern));
+
+        if (SUCCEEDED(hr) && selectionPattern)
+        {
+            hr = UIALIST_COUNTED("IUIAutomationSelectionItemPattern::Select", selectionPattern->Select());
+            selectionPattern->Release();
+            return SUCCEEDED(hr);
+        }
+        return false;
+    }
+
+    bool UiaActionTarget::DoubleClickViaMouse()
+    {
+        POINT point;
+        if (!GetClickPoint(point)) return false;
+
+        // Unconfirmed, as ClickViaMouse
+        return InputInjector::DoubleClick(point);
+    }
+
+    bool UiaActionTarget::DoubleClickViaTogglePattern()
+    {
+        IUIAutomationTogglePattern* togglePattern = nullptr;
+        HRESULT hr = UIALIST_COUNTED("IUIAutomationElement::GetCurrentPatternAs",
+                                     m_element->GetCurrentPatternAs(UIA_TogglePatternId, __uuidof(IUIAutomationTogglePattern), (void**)&togglePattern));
+
+        if (SUCCEEDED(hr) && togglePattern)
+        {
+            hr = UIALIST_COUNTED("IUIAutomationTogglePattern::Toggle", togglePattern->Toggle());
+            togglePattern->Release();
+            return SUCCEEDED(hr);
+        }
+        return false;
+    }
+
+    bool UiaActionTarget::DoubleClickViaLegacyPattern()
+    {
+        IUIAutomationLegacyIAccessiblePattern* legacyPattern = nullptr;
+        HRESULT hr = UIALIST_COUNTED("IUIAutomationElement::GetCurrentPatternAs",
+                                     m_element->GetCurrentPatternAs(UIA_LegacyIAccessiblePatternId, __uuidof(IUIAutomationLegacyIAccessiblePattern), (void**)&legacyPattern));
+
+        if (SUCCEEDED(hr) && legacyPattern)
+        {
+            // Let the first action complete before the second, but no longer than needed
+            AutomationEventWait invoked(m_automation, m_element, UIA_Invoke_InvokedEventId);
+            hr = UIALIST_COUNTED("IUIAutomationLegacyIAccessiblePattern::DoDefaultAction", legacyPattern->DoDefaultAction());
+            if (SUCCEEDED(hr))
+            {
+                invoked.Wait(SecondActionTimeoutMs);
+                UIALIST_COUNTED("IUIAutomationLegacyIAccessiblePattern::DoDefaultAction", legacyPattern->DoDefaultAction());
+            }
+            legacyPattern->Release();
+            return SUCCEEDED(hr);
+        }
+        return false;
+    }
+
+    bool UiaActionTarget::DoubleClickViaInvokePattern()
+    {
+        IUIAutomationInvokePattern* invokePattern = nullptr;
+        HRESULT hr = UIALIST_COUNTED("IUIAutomationElement::GetCurrentPatternAs",
+                                     m_element->GetCurrentPatternAs(UIA_InvokePatternId, __uuidof(IUIAutomationInvokePattern), (void**)&invokePattern));
+
+        if (SUCCEEDED(hr) && invokePattern)
+        {
+            AutomationEventWait invoked(m_automation, m_element, UIA_Invoke_InvokedEventId);
+            hr = UIALIST_COUNTED("IUIAutomationInvokePattern::Invoke", invokePattern->Invoke());
+            if (SUCCEEDED(hr))
+            {
+                invoked.Wait(SecondActionTimeoutMs);
+                UIALIST_COUNTED("IUIAutomationInvokePattern::Invoke", invokePattern->Invoke());
+            }
+            invokePattern->Release();
+            return SUCCEEDED(hr);
+        }
+        return false;
+    }
+
+    bool UiaActionTarget::FocusViaSetFocus()
+    {
+        return SUCCEEDED(UIALIST_COUNTED("IUIAutomationElement::SetFocus", m_element->SetFocus()));
+    }
+
+    bool UiaActionTarget::FocusViaKeyboard()
+    {
+        // Tab cannot aim at the control; it worked when focus moved at all
+        AutomationEventWait focusChanged(m_automation, nullptr);
+        return InputInjector::PressKey(VK_TAB) && focusChanged.Wait(FocusChangeTimeoutMs);
+    }
+
+    bool PerformAction(IUIAutomation* automation, IUIAutomationElement* element, ActionKind kind, uint32_t capabilities)
+    {
+        UIALIST_TRACE_SPAN("PerformAction");
+
+        if (!element) return false;
+
+        // With prefetched capabilities the plan only holds strategies the
+        // control supports, so no cross-process call is spent on failed probes
+        UiaActionTarget target(automation, element);
+        ActionTrace trace;
+        const bool succeeded = ExecutePlan(PlanAction(kind, capabilities), kind, target, &trace);
+
+        if (succeeded)
+        {
+            UIALIST_LOG(Debug, "{} via {} after {} attempt(s) in {} us", ToString(trace.Kind),
+                        ToString(trace.Strategy), trace.Attempts, trace.Elapsed.count());
+        }
+        else
+        {
+            UIALIST_LOG(Warning, "{} failed after {} attempt(s) in {} us", ToString(trace.Kind), trace.Attempts,
+                        trace.Elapsed.count());
+        }
+        return succeeded;
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+// No pch.h here: shared by the WinUI and the Qt frontend
+#include <windows.h>
+#include <UIAutomation.h>
+
+#include "ActionStrategy.h"
+
+#include <cstdint>
+
+namespace UIAListCore
+{
+    // ActionTarget over a live control: synthesized mouse input at the
+    // center of its bounding rectangle, its control patterns, SetFocus and
+    // Tab navigation. Runs on the thread that performs the actions.
+    class UiaActionTarget : public ActionTarget
+    {
+    public:
+        // automation is used to wait for the events confirming a step
+        UiaActionTarget(IUIAutomation* automation, IUIAutomationElement* element);
+
+        bool Run(ActionStrategy strategy, ActionKind kind) override;
+
+    private:
+        bool ClickViaMouse();
+        bool ClickViaInvokePattern();
+        bool ClickViaLegacyPattern();
+        bool ClickViaSelectionPattern();
+
+        bool DoubleClickViaMouse();
+        bool DoubleClickViaTogglePattern();
+        bool DoubleClickViaLegacyPattern();
+        bool DoubleClickViaInvokePattern();
+
+        bool FocusViaSetFocus();
+        bool FocusViaKeyboard();
+
+        bool GetClickPoint(POINT& point);
+
+        // Upper bounds for event-confirmed waits
+        static constexpr DWORD SecondActionTimeoutMs = 50;
+        static constexpr DWORD FocusChangeTimeoutMs = 100;
+
+        IUIAutomation* m_automation;
+        IUIAutomationElement* m_element;
+    };
+
+    // Plans kind from the capabilities prefetched during enumeration
+    // (CapabilitiesNone probes every strategy in turn) and runs the plan
+    // on element. Logs which strategy worked and how long it took.
+    bool PerformAction(IUIAutomation* automation, IUIAutomationElement* element, ActionKind kind, uint32_t capabilities);
+}
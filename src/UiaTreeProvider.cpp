@@ -0,0 +1,404 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "UiaTreeProvider.h"
+#include "ActionStrategy.h"
+#include "CallStats.h"
+#include "ElementLocator.h"
+
+namespace UIAListCore
+{
+    UiaTreeElement::UiaTreeElement(IUIAutomationElement* element, IUIAutomationElementArray* siblings, int index)
+        : m_element(element)
+        , m_siblings(siblings)
+        , m_index(index)
+    {
+        if (m_siblings) m_siblings->AddRef();
+    }
+
+    UiaTreeElement::~UiaTreeElement()
+    {
+        if (m_siblings) m_siblings->Release();
+        if (m_element) m_element->Release();
+    }
+
+    UiaTreeProvider::UiaTreeProvider(IUIAutomation* automation, HWND window)
+        : m_automation(automation)
+        , m_walker(nullptr)
+        , m_cacheRequest(nullptr)
+        , m_window(window)
+        , m_root(nullptr)
+        , m_calls(0)
+        , m_focusNoted(false)
+    {
+        if (m_automation)
+        {
+            m_automation->AddRef();
+            m_automation->get_ControlViewWalker(&m_walker);
+        }
+    }
+
+    UiaTreeProvider::~UiaTreeProvider()
+    {
+        if (m_root) m_root->Release();
+        if (m_cacheRequest) m_cacheRequest->Release();
+        if (m_walker) m_walker->Release();
+        if (m_automation) m_automation->Release();
+    }
+
+    bool UiaTreeProvider::SetCacheRequest(const CacheRequest& request)
+    {
+        if (!m_automation || !m_walker) return false;
+
+        // Every walk sets it; event handlers may have been given the one there is
+        if (m_cacheRequest && request.Properties == m_request.Properties && request.Subtree == m_request.Subtree)
+        {
+            return true;
+        }
+
+        if (m_cacheRequest)
+        {
+            m_cacheRequest->Release();
+            m_cacheRequest = nullptr;
+        }
+        m_request = request;
+
+        if (request.Properties == PropertyNone && !request.Subtree) return true;
+
+        HRESULT hr = m_automation->CreateCacheRequest(&m_cacheRequest);
+        if (FAILED(hr)) return false;
+
+        // The locator reads control type, name, AutomationId and RuntimeId
+        for (size_t i = 0; i < ElementLocator::CachedPropertyCount; ++i)
+        {
+            if (FAILED(m_cacheRequest->AddProperty(ElementLocator::CachedProperties[i]))) return false;
+        }
+
+        if (request.Properties & PropertyCapabilities)
+        {
+            static const PROPERTYID capabilityProperties[] =
+            {
+                UIA_BoundingRectanglePropertyId,
+                UIA_IsOffscreenPropertyId,
+                UIA_IsKeyboardFocusablePropertyId,
+                UIA_IsInvokePatternAvailablePropertyId,
+                UIA_IsLegacyIAccessiblePatternAvailablePropertyId,
+                UIA_IsSelectionItemPatternAvailablePropertyId,
+                UIA_IsTogglePatternAvailablePropertyId,
+            };
+
+            for (PROPERTYID property : capabilityProperties)
+            {
+                if (FAILED(m_cacheRequest->AddProperty(property))) return false;
+            }
+        }
+        else if ((request.Properties & PropertyBoundingRectangle) &&
+                 FAILED(m_cacheRequest->AddProperty(UIA_BoundingRectanglePropertyId)))
+        {
+            return false;
+        }
+
+        // The default tree filter is the control view, matching m_walker
+        if (request.Subtree && FAILED(m_cacheRequest->put_TreeScope(TreeScope_Subtree))) return false;
+
+        return true;
+    }
+
+    std::unique_ptr<TreeElement> UiaTreeProvider::Wrap(HRESULT hr, IUIAutomationElement* element)
+    {
+        if (FAILED(hr) || !element) return nullptr;
+        return std::make_unique<UiaTreeElement>(element);
+    }
+
+    void UiaTreeProvider::SetRoot(IUIAutomationElement* root)
+    {
+        if (root) root->AddRef();
+        if (m_root) m_root->Release();
+        m_root = root;
+    }
+
+    std::unique_ptr<TreeElement> UiaTreeProvider::Root()
+    {
+        if (m_root)
+        {
+            m_root->AddRef();
+            return Wrap(S_OK, m_root);
+        }
+        if (!m_automation) return nullptr;
+
+        IUIAutomationElement* root = nullptr;
+        ++m_calls;
+        HRESULT hr = m_cacheRequest
+            ? UIALIST_COUNTED("IUIAutomation::ElementFromHandleBuildCache",
+                              m_automation->ElementFromHandleBuildCache(m_window, m_cacheRequest, &root))
+            : UIALIST_COUNTED("IUIAutomation::ElementFromHandle", m_automation->ElementFromHandle(m_window, &root));
+        return Wrap(hr, root);
+    }
+
+    std::unique_ptr<TreeElement> UiaTreeProvider::FirstChild(TreeElement& parent)
+    {
+        IUIAutomationElement* element = static_cast<UiaTreeElement&>(parent).Get();
+        IUIAutomationElement* child = nullptr;
+
+        if (m_request.Subtree)
+        {
+            // Served from the cache fetched with the root, no cross-process call
+            IUIAutomationElementArray* children = nullptr;
+            int length = 0;
+            if (FAILED(element->GetCachedChildren(&children)) || !children) return nullptr;
+
+            std::unique_ptr<TreeElement> result;
+            if (SUCCEEDED(children->get_Length(&length)) && length > 0 &&
+                SUCCEEDED(children->GetElement(0, &child)) && child)
+            {
+                result = std::make_unique<UiaTreeElement>(child, children, 0);
+            }
+            children->Release();
+            return result;
+        }
+
+        ++m_calls;
+        HRESULT hr = m_cacheRequest
+            ? UIALIST_COUNTED("IUIAutomationTreeWalker::GetFirstChildElementBuildCache",
+                              m_walker->GetFirstChildElementBuildCache(element, m_cacheRequest, &child))
+            : UIALIST_COUNTED("IUIAutomationTreeWalker::GetFirstChildElement", m_walker->GetFirstChildElement(element, &child));
+        return Wrap(hr, child);
+    }
+
+    std::unique_ptr<TreeElement> UiaTreeProvider::NextSibling(TreeElement& element)
+    {
+        UiaTreeElement& current = static_cast<UiaTreeElement&>(element);
+        IUIAutomationElement* sibling = nullptr;
+
+        if (m_request.Subtree)
+        {
+            int length = 0;
+            if (!current.m_siblings || FAILED(current.m_siblings->get_Length(&length)) ||
+                current.m_index + 1 >= length)
+            {
+                return nullptr;
+            }
+            if (FAILED(current.m_siblings->GetElement(current.m_index + 1, &sibling)) || !sibling) return nullptr;
+            return std::make_unique<UiaTreeElement>(sibling, current.m_siblings, current.m_index + 1);
+        }
+
+        ++m_calls;
+        HRESULT hr = m_cacheRequest
+            ? UIALIST_COUNTED("IUIAutomationTreeWalker::GetNextSiblingElementBuildCache",
+                              m_walker->GetNextSiblingElementBuildCache(current.Get(), m_cacheRequest, &sibling))
+            : UIALIST_COUNTED("IUIAutomationTreeWalker::GetNextSiblingElement", m_walker->GetNextSiblingElement(current.Get(), &sibling));
+        return Wrap(hr, sibling);
+    }
+
+    bool UiaTreeProvider::GetProperties(TreeElement& treeElement, uint32_t properties, ElementProperties& result)
+    {
+        IUIAutomationElement* element = static_cast<UiaTreeElement&>(treeElement).Get();
+        const uint32_t cached = m_cacheRequest ? m_request.Properties : PropertyNone;
+
+        if (properties & PropertyControlType)
+        {
+            CONTROLTYPEID controlType = 0;
+            if (!(cached & PropertyControlType)) ++m_calls;
+            HRESULT hr = (cached & PropertyControlType)
+                ? element->get_CachedControlType(&controlType)
+                : UIALIST_COUNTED("IUIAutomationElement::get_CurrentControlType", element->get_CurrentControlType(&controlType));
+            if (FAILED(hr)) return false;
+            result.ControlType = controlType;
+        }
+
+        if (properties & PropertyName)
+        {
+            BSTR name = nullptr;
+            if (cached & PropertyName) element->get_CachedName(&name);
+            else { UIALIST_COUNTED("IUIAutomationElement::get_CurrentName", element->get_CurrentName(&name)); ++m_calls; }
+
+            result.HasName = (name != nullptr);
+            result.Name.assign(name ? name : L"", name ? SysStringLen(name) : 0);
+            if (name) SysFreeString(name);
+        }
+
+        if (properties & PropertyAutomationId)
+        {
+            BSTR automationId = nullptr;
+            if (cached & PropertyAutomationId) element->get_CachedAutomationId(&automationId);
+            else { UIALIST_COUNTED("IUIAutomationElement::get_CurrentAutomationId", element->get_CurrentAutomationId(&automationId)); ++m_calls; }
+
+            result.AutomationId.assign(automationId ? automationId : L"", automationId ? SysStringLen(automationId) : 0);
+            if (automationId) SysFreeString(automationId);
+        }
+
+        if (properties & PropertyBoundingRectangle)
+        {
+            RECT rect{};
+            if (!(cached & PropertyBoundingRectangle)) ++m_calls;
+            HRESULT hr = (cached & PropertyBoundingRectangle)
+                ? element->get_CachedBoundingRectangle(&rect)
+                : UIALIST_COUNTED("IUIAutomationElement::get_CurrentBoundingRectangle", element->get_CurrentBoundingRectangle(&rect));
+            result.BoundingRectangle = SUCCEEDED(hr) ? ElementRect{ rect.left, rect.top, rect.right, rect.bottom } : ElementRect{};
+        }
+
+        // Uncached, the action layer probes patterns when it needs them
+        result.Capabilities = (properties & cached & PropertyCapabilities)
+            ? GetCachedCapabilities(element)
+            : CapabilitiesNone;
+
+        return true;
+    }
+
+    std::unique_ptr<TreeElement> UiaTreeProvider::Focused()
+    {
+        // A subtree cache request would fetch everything below the focus
+        if (!m_automation || m_request.Subtree) return nullptr;
+
+        if (m_focusNoted)
+        {
+            m_focusNoted = false;
+            return std::move(m_noted);
+        }
+
+        IUIAutomationElement* focused = nullptr;
+        ++m_calls;
+        HRESULT hr = m_cacheRequest
+            ? UIALIST_COUNTED("IUIAutomation::GetFocusedElementBuildCache",
+                              m_automation->GetFocusedElementBuildCache(m_cacheRequest, &focused))
+            : UIALIST_COUNTED("IUIAutomation::GetFocusedElement", m_automation->GetFocusedElement(&focused));
+        return Wrap(hr, focused);
+    }
+
+    void UiaTreeProvider::NoteFocus()
+    {
+        m_noted.reset();
+        m_focusNoted = true;
+        if (!m_automation) return;
+
+        // Nothing cached yet: the walk's cache request applies to its ancestors
+        IUIAutomationElement* focused = nullptr;
+        ++m_calls;
+        m_noted = Wrap(UIALIST_COUNTED("IUIAutomation::GetFocusedElement", m_automation->GetFocusedElement(&focused)),
+                       focused);
+    }
+
+    std::unique_ptr<TreeElement> UiaTreeProvider::Parent(TreeElement& element)
+    {
+        if (m_request.Subtree) return nullptr;
+
+        IUIAutomationElement* parent = nullptr;
+        ++m_calls;
+        HRESULT hr = m_cacheRequest
+            ? UIALIST_COUNTED("IUIAutomationTreeWalker::GetParentElementBuildCache",
+                              m_walker->GetParentElementBuildCache(static_cast<UiaTreeElement&>(element).Get(),
+                                                                   m_cacheRequest, &parent))
+            : UIALIST_COUNTED("IUIAutomationTreeWalker::GetParentElement",
+                              m_walker->GetParentElement(static_cast<UiaTreeElement&>(element).Get(), &parent));
+        return Wrap(hr, parent);
+    }
+
+    bool UiaTreeProvider::IsSameElement(TreeElement& a, TreeElement& b)
+    {
+        // Compares runtime ids, which the cache request brings along
+        BOOL same = FALSE;
+        HRESULT hr = m_automation->CompareElements(static_cast<UiaTreeElement&>(a).Get(),
+                                                   static_cast<UiaTreeElement&>(b).Get(), &same);
+        return SUCCEEDED(hr) && same;
+    }
+
+    std::string UiaTreeProvider::ProcessImageName(HWND window)
+    {
+        DWORD processId = 0;
+        if (!GetWindowThreadProcessId(window, &processId) || !processId) return std::string();
+
+        HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+        if (!process) return std::string();
+
+        wchar_t path[MAX_PATH];
+        DWORD length = MAX_PATH;
+        BOOL queried = QueryFullProcessImageNameW(process, 0, path, &length);
+        CloseHandle(process);
+        if (!queried) return std::string();
+
+        const wchar_t* fileName = wcsrchr(path, L'\\');
+        fileName = fileName ? fileName + 1 : path;
+
+        int size = WideCharToMultiByte(CP_UTF8, 0, fileName, -1, nullptr, 0, nullptr, nullptr);
+        if (size <= 1) return std::string();
+        std::string image(static_cast<size_t>(size - 1), '\0');
+        WideCharToMultiByte(CP_UTF8, 0, fileName, -1, image.data(), size, nullptr, nullptr);
+        return image;
+    }
+
+    uint32_t UiaTreeProvider::GetCachedCapabilities(IUIAutomationElement* element)
+    {
+        static const struct
+        {
+            PROPERTYID Property;
+            uint32_t Capability;
+        } patternProperties[] =
+        {
+            { UIA_IsKeyboardFocusablePropertyId, CapabilityKeyboardFocusable },
+            { UIA_IsInvokePatternAvailablePropertyId, CapabilityInvoke },
+            { UIA_IsLegacyIAccessiblePatternAvailablePropertyId, CapabilityLegacyIAccessible },
+            { UIA_IsSelectionItemPatternAvailablePropertyId, CapabilitySelectionItem },
+            { UIA_IsTogglePatternAvailablePropertyId, CapabilityToggle },
+        };
+
+        uint32_t capabilities = CapabilitiesKnown;
+
+        for (const auto& entry : patternProperties)
+        {
+            VARIANT value;
+            VariantInit(&value);
+            HRESULT hr = element->GetCachedPropertyValue(entry.Property, &value);
+            if (FAILED(hr))
+            {
+                // Not in the cache, let the action layer probe as before
+                return CapabilitiesNone;
+            }
+            if (value.vt == VT_BOOL && value.boolVal == VARIANT_TRUE)
+            {
+                capabilities |= entry.Capability;
+            }
+            VariantClear(&value);
+        }
+
+        RECT rect;
+        BOOL offscreen = FALSE;
+        if (SUCCEEDED(element->get_CachedBoundingRectangle(&rect)) &&
+            SUCCEEDED(element->get_CachedIsOffscreen(&offscreen)) &&
+            !offscreen && rect.right > rect.left && rect.bottom > rect.top)
+        {
+            capabilities |= CapabilityOnScreen;
+        }
+
+        return capabilities;
+    }
+
+    UiaLocatorStack::UiaLocatorStack(HWND window)
+    {
+        m_locators.push_back(ElementLocator::ForWindow(window));
+    }
+
+    const ElementLocator& UiaLocatorStack::Visit(const ControlWalker& walker, IUIAutomationElement* element, size_t depth)
+    {
+        // Ancestors not visited yet, between the window and a ring's elements
+        const size_t ancestors = walker.AncestorCount();
+        for (size_t level = m_locators.size(); level < depth && level < ancestors; ++level)
+        {
+            IUIAutomationElement* ancestor = static_cast<UiaTreeElement&>(walker.Ancestor(ancestors - 1 - level)).Get();
+            m_locators.push_back(ElementLocator::Capture(ancestor, m_locators[level - 1]));
+        }
+
+        m_locators.resize(depth + 1);
+        if (depth > 0)
+        {
+            m_locators[depth] = ElementLocator::Capture(element, m_locators[depth - 1]);
+        }
+        return m_locators[depth];
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+// No pch.h here: shared by the WinUI and the Qt frontend
+#include <windows.h>
+#include <UIAutomation.h>
+
+#include "ControlWalker.h"
+#include "ElementLocator.h"
+#include "TreeProvider.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace UIAListCore
+{
+    class UiaTreeElement : public TreeElement
+    {
+    public:
+        // Takes over the reference to element. siblings/index are set when the
+        // element came from a cached children array (subtree cache).
+        UiaTreeElement(IUIAutomationElement* element, IUIAutomationElementArray* siblings = nullptr, int index = 0);
+        ~UiaTreeElement() override;
+
+        UiaTreeElement(const UiaTreeElement&) = delete;
+        UiaTreeElement& operator=(const UiaTreeElement&) = delete;
+
+        IUIAutomationElement* Get() const { return m_element; }
+
+    private:
+        friend class UiaTreeProvider;
+
+        IUIAutomationElement* m_element;
+        IUIAutomationElementArray* m_siblings;
+        int m_index;
+    };
+
+    // TreeProvider over the control view of a window.
+    // Also caches the properties ElementLocator::Capture reads.
+    class UiaTreeProvider : public TreeProvider
+    {
+    public:
+        UiaTreeProvider(IUIAutomation* automation, HWND window);
+        ~UiaTreeProvider() override;
+
+        UiaTreeProvider(const UiaTreeProvider&) = delete;
+        UiaTreeProvider& operator=(const UiaTreeProvider&) = delete;
+
+        bool SetCacheRequest(const CacheRequest& request) override;
+        std::unique_ptr<TreeElement> Root() override;
+        std::unique_ptr<TreeElement> FirstChild(TreeElement& parent) override;
+        std::unique_ptr<TreeElement> NextSibling(TreeElement& element) override;
+        bool GetProperties(TreeElement& element, uint32_t properties, ElementProperties& result) override;
+        std::unique_ptr<TreeElement> Focused() override;
+        std::unique_ptr<TreeElement> Parent(TreeElement& element) override;
+        bool IsSameElement(TreeElement& a, TreeElement& b) override;
+        uint64_t Calls() const override { return m_calls; }
+
+        // Fetches the focused element now, for the next Focused call: the
+        // focus may have moved by the time the walk asks, e.g. to the list
+        void NoteFocus();
+
+        // Walks start at root instead of the window, e.g. a subtree that
+        // changed; null for the window again. root must come with this
+        // provider's cache request, as the senders of event handlers given
+        // GetCacheRequest do. Not with a subtree cache, which comes with the
+        // window.
+        void SetRoot(IUIAutomationElement* root);
+
+        // What navigation fetches along, set by SetCacheRequest; null when
+        // nothing is cached. Kept while the request stays the same.
+        IUIAutomationCacheRequest* GetCacheRequest() const { return m_cacheRequest; }
+
+        // Executable name of the window's process, e.g. "WINWORD.EXE"; empty when unknown
+        static std::string ProcessImageName(HWND window);
+
+    private:
+        // Capability bits from cached pattern availability and position
+        static uint32_t GetCachedCapabilities(IUIAutomationElement* element);
+
+        static std::unique_ptr<TreeElement> Wrap(HRESULT hr, IUIAutomationElement* element);
+
+        IUIAutomation* m_automation;
+        IUIAutomationTreeWalker* m_walker;
+        IUIAutomationCacheRequest* m_cacheRequest;  // Null when nothing is cached
+        CacheRequest m_request;
+        HWND m_window;
+        IUIAutomationElement* m_root;  // Instead of the window when set
+        uint64_t m_calls;
+        std::unique_ptr<TreeElement> m_noted;  // Focused returns it once
+        bool m_focusNoted;
+    };
+
+    // The locators of a ControlWalker's visits over a UiaTreeProvider, each
+    // captured from its parent's. A walk outward from the focus visits the
+    // elements below an ancestor first; the ancestor's locator is then
+    // captured from the walker's ancestors.
+    class UiaLocatorStack
+    {
+    public:
+        explicit UiaLocatorStack(HWND window);
+
+        // The locator of element, visited at depth by walker
+        const ElementLocator& Visit(const ControlWalker& walker, IUIAutomationElement* element, size_t depth);
+
+    private:
+        std::vector<ElementLocator> m_locators;  // By depth, the window's first
+    };
+}
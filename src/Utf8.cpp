@@ -0,0 +1,120 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "Utf8.h"
+
+#include <cstdint>
+
+namespace UIAListCore
+{
+    namespace
+    {
+        const uint32_t ReplacementCharacter = 0xFFFD;
+
+        void AppendUtf8(std::string& out, uint32_t codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                out += static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (codePoint >> 6));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | (codePoint >> 12));
+                out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | (codePoint >> 18));
+                out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+
+        void AppendWide(std::wstring& out, uint32_t codePoint)
+        {
+            if (sizeof(wchar_t) == 2 && codePoint >= 0x10000)
+            {
+                codePoint -= 0x10000;
+                out += static_cast<wchar_t>(0xD800 + (codePoint >> 10));
+                out += static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF));
+            }
+            else
+            {
+                out += static_cast<wchar_t>(codePoint);
+            }
+        }
+    }
+
+    std::string ToUtf8(const std::wstring& text)
+    {
+        std::string out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            uint32_t codePoint = static_cast<uint32_t>(text[i]);
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF && i + 1 < text.size())
+            {
+                uint32_t low = static_cast<uint32_t>(text[i + 1]);
+                if (low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    ++i;
+                }
+            }
+            if ((codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+            {
+                codePoint = ReplacementCharacter;
+            }
+            AppendUtf8(out, codePoint);
+        }
+        return out;
+    }
+
+    std::wstring FromUtf8(const std::string& text)
+    {
+        std::wstring out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size();)
+        {
+            const unsigned char lead = static_cast<unsigned char>(text[i]);
+            size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+            if (length == 0 || i + length > text.size())
+            {
+                AppendWide(out, ReplacementCharacter);
+                ++i;
+                continue;
+            }
+
+            uint32_t codePoint = length == 1 ? lead : (lead & (0x7F >> length));
+            bool valid = true;
+            for (size_t k = 1; k < length; ++k)
+            {
+                const unsigned char next = static_cast<unsigned char>(text[i + k]);
+                if ((next & 0xC0) != 0x80)
+                {
+                    valid = false;
+                    break;
+                }
+                codePoint = (codePoint << 6) | (next & 0x3F);
+            }
+
+            AppendWide(out, valid ? codePoint : ReplacementCharacter);
+            i += valid ? length : 1;
+        }
+        return out;
+    }
+}
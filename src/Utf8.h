@@ -0,0 +1,21 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace UIAListCore
+{
+    // wchar_t is UTF-16 on Windows and UTF-32 elsewhere; files written by the
+    // core store UTF-8 so they read the same on both
+    std::string ToUtf8(const std::wstring& text);
+    std::wstring FromUtf8(const std::string& text);
+}
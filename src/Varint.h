@@ -0,0 +1,89 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace UIAListCore
+{
+    // Building blocks of the core's compact binary formats (tree recordings,
+    // compacted snapshots): LEB128 varints and length-prefixed strings
+    inline void PutVarint(std::string& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out += static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+
+    inline void PutString(std::string& out, std::string_view text)
+    {
+        PutVarint(out, text.size());
+        out += text;
+    }
+
+    // Bounds-checked reader, every Get fails once the input is exhausted
+    class VarintReader
+    {
+    public:
+        explicit VarintReader(std::string_view data, size_t position = 0) : m_data(data), m_position(position) {}
+
+        bool GetVarint(uint64_t& value)
+        {
+            value = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                if (m_position >= m_data.size()) return false;
+                const unsigned char byte = static_cast<unsigned char>(m_data[m_position++]);
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return true;
+            }
+            return false;
+        }
+
+        bool GetUint32(uint32_t& value)
+        {
+            uint64_t wide = 0;
+            if (!GetVarint(wide) || wide > UINT32_MAX) return false;
+            value = static_cast<uint32_t>(wide);
+            return true;
+        }
+
+        // The view points into the reader's data
+        bool GetString(std::string_view& text)
+        {
+            uint64_t length = 0;
+            if (!GetVarint(length) || length > m_data.size() - m_position) return false;
+            text = m_data.substr(m_position, static_cast<size_t>(length));
+            m_position += static_cast<size_t>(length);
+            return true;
+        }
+
+        bool GetString(std::string& text)
+        {
+            std::string_view view;
+            if (!GetString(view)) return false;
+            text.assign(view);
+            return true;
+        }
+
+        bool AtEnd() const { return m_position >= m_data.size(); }
+
+    private:
+        std::string_view m_data;
+        size_t m_position;
+    };
+}
@@ -18,12 +18,12 @@
 
 #include "aboutdialog.h"
 #include "uialist.h"
+#include "SettingsStore.h"
 #include <QDesktopServices>
 #include <QUrl>
 #include <QApplication>
 #include <QIcon>
 #include <QMessageBox>
-#include <QSettings>
 #include <QProcess>
 
 #include <windows.h>
@@ -172,10 +172,11 @@ void AboutDialog::resetSettings()
         // Remove from Windows startup registry
         removeFromAutoStart();
         
-        // Clear all application settings
-        QSettings settings("UIAList", "Settings");
-        settings.clear();
-        settings.sync();
+        // Reset all application settings to their defaults
+        UIAListCore::SettingsStore::Instance().Update([](UIAListCore::Settings& settings) {
+            settings = UIAListCore::Settings();
+        });
+        UIAListCore::SettingsStore::Instance().Flush();
         
         // Find the main window - try parent first, then search all top-level widgets
         UIAList *mainWindow = nullptr;
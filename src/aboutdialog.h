@@ -26,7 +26,6 @@
 #include <QPushButton>
 #include <QPixmap>
 #include <QTextBrowser>
-#include <QSettings>
 
 class UIAList;
 
@@ -17,6 +17,7 @@
  */
 
 #include "settingsdialog.h"
+#include "SettingsStore.h"
 #include <QApplication>
 #include <QMessageBox>
 #include <QDebug>
@@ -30,9 +31,8 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     : QDialog(parent), m_mainLayout(nullptr), m_autoStartCheckBox(nullptr),
       m_defaultActionLabel(nullptr), m_defaultActionComboBox(nullptr),
       m_shortcutLabel(nullptr), m_shortcutButton(nullptr), m_buttonBox(nullptr),
-      m_settings(nullptr), m_currentShortcut(QKeySequence("Ctrl+Alt+U")), m_capturingShortcut(false)
+      m_currentShortcut(QKeySequence("Ctrl+Alt+U")), m_capturingShortcut(false)
 {
-    m_settings = new QSettings("UIAList", "Settings", this);
     setupUI();
     loadSettings();
 }
@@ -93,13 +93,13 @@ void SettingsDialog::loadSettings()
     // Load auto-start setting from registry
     m_autoStartCheckBox->setChecked(getAutoStartRegistry());
 
+    std::shared_ptr<const UIAListCore::Settings> settings = UIAListCore::SettingsStore::Instance().Get();
+
     // Load default action
-    int defaultAction = m_settings->value("defaultAction", ActionClick).toInt();
-    m_defaultActionComboBox->setCurrentIndex(defaultAction);
+    m_defaultActionComboBox->setCurrentIndex(settings->DefaultAction);
 
     // Load shortcut key
-    QString shortcutString = m_settings->value("shortcutKey", "Ctrl+Alt+U").toString();
-    m_currentShortcut = QKeySequence::fromString(shortcutString);
+    m_currentShortcut = QKeySequence::fromString(QString::fromStdWString(settings->ShortcutKey));
     m_shortcutButton->setText(m_currentShortcut.toString());
 }
 
@@ -108,13 +108,13 @@ void SettingsDialog::saveSettings()
     // Save auto-start setting to registry
     setAutoStartRegistry(m_autoStartCheckBox->isChecked());
 
-    // Save default action
-    m_settings->setValue("defaultAction", m_defaultActionComboBox->currentIndex());
-
-    // Save shortcut key
-    m_settings->setValue("shortcutKey", m_currentShortcut.toString());
-    
-    m_settings->sync();
+    // Save default action and shortcut key; written to the registry in the background
+    int defaultAction = m_defaultActionComboBox->currentIndex();
+    std::wstring shortcutKey = m_currentShortcut.toString().toStdWString();
+    UIAListCore::SettingsStore::Instance().Update([&](UIAListCore::Settings& settings) {
+        settings.DefaultAction = defaultAction;
+        settings.ShortcutKey = shortcutKey;
+    });
 }
 
 void SettingsDialog::accept()
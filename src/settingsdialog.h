@@ -27,7 +27,6 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QDialogButtonBox>
-#include <QSettings>
 
 class SettingsDialog : public QDialog
 {
@@ -69,7 +68,6 @@ private:
     QPushButton *m_shortcutButton;
     QDialogButtonBox *m_buttonBox;
 
-    QSettings *m_settings;
     QKeySequence m_currentShortcut;
     bool m_capturingShortcut;
 };
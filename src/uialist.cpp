@@ -19,45 +19,250 @@
 #include "uialist.h"
 #include "uialisticon.h"
 #include "welcomedialog.h"
+#include "InputInjector.h"
+#include "Log.h"
+#include "NamedPipeTransport.h"
+#include "ProcessMemory.h"
+#include "RegistrySettingsBackend.h"
+#include "Trace.h"
+#include "UiaActionTarget.h"
+#include "UiaTreeProvider.h"
 #include <QDebug>
+#include <QFontDatabase>
+#include <QLocale>
 #include <QListWidgetItem>
 #include <QVariant>
 #include <QKeyEvent>
+#include <QHideEvent>
 #include <QAccessible>
-#include <QRegularExpression>
 #include <QIcon>
+#include <QDir>
+#include <QStandardPaths>
+#include <QScrollBar>
 
 #include <comdef.h>
 #include <atlbase.h>
+#include <algorithm>
+#include <climits>
+
+// Progress of a slow enumeration: the overlay is refreshed every
+// ProgressIntervalMs, a screen reader hears it first after
+// ProgressFirstAnnounceSeconds and again every ProgressAnnounceSeconds
+static const int ProgressIntervalMs = 250;
+static const double ProgressFirstAnnounceSeconds = 2.0;
+static const double ProgressAnnounceSeconds = 5.0;
+
+// The window waits this long for the worker to note the focused control
+// before it takes the focus; the enumeration then starts at that control
+static const int FocusNoteTimeoutMs = 100;
+
+// The UTF-16 of a QString, without a copy
+static std::u16string_view utf16View(const QString& text)
+{
+    return std::u16string_view(reinterpret_cast<const char16_t*>(text.utf16()), static_cast<size_t>(text.size()));
+}
+
+// A QString as log argument; the log copies it without allocating
+static std::u16string_view logText(const QString& text)
+{
+    return utf16View(text);
+}
+
+// The bounding rectangle element was fetched with; empty when it was not cached
+static UIAListCore::ElementRect cachedBounds(IUIAutomationElement* element)
+{
+    RECT rect = {};
+    if (!element || FAILED(element->get_CachedBoundingRectangle(&rect))) {
+        return {};
+    }
+    return { rect.left, rect.top, rect.right, rect.bottom };
+}
+
+// What a row of the list is made of, read as the enumeration and the live
+// updates walk the window
+static const uint32_t listedProperties = UIAListCore::PropertyControlType | UIAListCore::PropertyName |
+                                         UIAListCore::PropertyAutomationId | UIAListCore::PropertyCapabilities;
+
+// Controls are acted on from the automation thread through these, not the
+// window: an action hung past its deadline is left behind by
+// ~ActionExecutor and may still run after the window is gone.
+
+// Finds the control again through its locator when its element went stale
+static bool ensureLiveControl(IUIAutomation* automation, ControlInfo& controlInfo)
+{
+    UIALIST_TRACE_SPAN("EnsureLive");
+    
+    IUIAutomationElement* liveElement = nullptr;
+    HRESULT hr = controlInfo.locator.Refresh(automation, controlInfo.element, &liveElement);
+    if (FAILED(hr) || !liveElement) {
+        UIALIST_LOG(Warning, "Control is gone and could not be found again: {}", logText(controlInfo.displayText));
+        return false;
+    }
+    
+    if (liveElement != controlInfo.element) {
+        UIALIST_LOG(Info, "Re-resolved stale control: {}", logText(controlInfo.displayText));
+        ControlInfo resolved(controlInfo.displayText, controlInfo.originalName, liveElement, controlInfo.controlType);
+        resolved.locator = controlInfo.locator;
+        resolved.capabilities = controlInfo.capabilities;
+        controlInfo = resolved;
+    }
+    
+    liveElement->Release();
+    return true;
+}
+
+// The job for one action. It holds its own references to the automation
+// and the control, so a new enumeration or the window's cleanup cannot
+// release them under it.
+static UIAListCore::ActionExecutor::Action controlAction(IUIAutomation* automation, const ControlInfo& controlInfo,
+                                                         UIAListCore::ActionKind kind)
+{
+    CComPtr<IUIAutomation> ownedAutomation(automation);
+    return [ownedAutomation, controlInfo, kind]() {
+        ControlInfo liveInfo = controlInfo;
+        if (!ensureLiveControl(ownedAutomation, liveInfo)) {
+            return false;
+        }
+        
+        UIALIST_LOG(Debug, "Attempting to {} control: {}", UIAListCore::ToString(kind), logText(liveInfo.displayText));
+        
+        // The capabilities prefetched during enumeration skip the strategies
+        // the control cannot support; restored controls probe them all
+        return UIAListCore::PerformAction(ownedAutomation, liveInfo.element, kind, liveInfo.capabilities);
+    };
+}
 
 UIAList::UIAList(QWidget *parent)
     : QMainWindow(parent), m_trayIcon(nullptr), m_centralWidget(nullptr), m_stackedWidget(nullptr),
       m_mainWidget(nullptr), m_loadingWidget(nullptr), m_layout(nullptr), m_buttonLayout(nullptr),
       m_windowTitleLabel(nullptr), m_filterEdit(nullptr), m_listWidget(nullptr),
-      m_hideEmptyTitlesCheckBox(nullptr), m_hideMenusCheckBox(nullptr), m_clickButton(nullptr), m_focusButton(nullptr),
-      m_doubleClickButton(nullptr), m_loadingLayout(nullptr), m_loadingLabel(nullptr), m_progressBar(nullptr),
-      m_cancelButton(nullptr), m_uiAutomation(nullptr), m_controlViewWalker(nullptr), m_workerThread(nullptr),
-      m_worker(nullptr), m_settings(nullptr)
+      m_hideEmptyTitlesCheckBox(nullptr), m_hideMenusCheckBox(nullptr),
+      m_readingOrderCheckBox(nullptr), m_clickButton(nullptr), m_focusButton(nullptr),
+      m_doubleClickButton(nullptr), m_widenButton(nullptr), m_loadingLayout(nullptr), m_loadingLabel(nullptr), m_progressBar(nullptr),
+      m_cancelButton(nullptr), m_progressTimer(nullptr), m_progressAnnounced(0.0), m_uiAutomation(nullptr),
+      m_controlViewWalker(nullptr), m_startupLogged(false),
+      m_workerThread(nullptr),
+      m_worker(nullptr), m_selectedIndex(-1), m_snapshotId(0), m_targetWindow(nullptr),
+      m_listRestored(false), m_listPartial(false), m_scopeElement(nullptr), m_listLimited(false), m_idleTrimTimer(nullptr), m_compactWindow(nullptr), m_compactSnapshotId(0), m_settingsListener(0),
+      m_servedWindow(nullptr), m_announceTimer(nullptr), m_liveThread(nullptr), m_liveWatcher(nullptr),
+      m_liveGeneration(0)
 {
-    m_settings = new QSettings("UIAList", "Settings", this);
+    // UIALIST_TRACE=<file> records latency spans, written on exit
+    UIAListCore::TraceBuffer::InitializeFromEnvironment();
+    // UIALIST_LOG=<file> receives the structured log on exit and on a crash
+    UIAListCore::LogBuffer::InitializeFromEnvironment();
+    
+    // Stage 1, on the startup path: settings, tray icon and hotkey.
+    // UI Automation is created on the startup thread and used from every
+    // thread. Its objects live in the MTA, which must outlive that thread's
+    // CoUninitialize: hold it for the life of the process.
+    CO_MTA_USAGE_COOKIE mtaUsage = nullptr;
+    CoIncrementMTAUsage(&mtaUsage);
+    m_startup = std::make_unique<UIAListCore::StagedStartup>(
+        []() { CoInitializeEx(nullptr, COINIT_MULTITHREADED); },
+        []() { CoUninitialize(); });
+    
+    m_startup->Run("Settings", [this]() {
+        // Read once; later reads use the in-memory snapshot
+        UIAListCore::SettingsStore& store = UIAListCore::SettingsStore::Instance();
+        store.Open(std::make_unique<UIAListCore::RegistrySettingsBackend>());
+        UIAListCore::MemoryBudget::Instance().SetLimit(static_cast<size_t>(store.Get()->MemoryBudgetMB) * 1024 * 1024);
+        
+        // Changed by the other frontend or by hand while running
+        m_settingsListener = store.Subscribe([this](const UIAListCore::Settings& settings) {
+            QMetaObject::invokeMethod(this, [this, settings]() { applySettings(settings); }, Qt::QueuedConnection);
+        });
+    });
+    
+    m_startup->Run("Tray", [this]() {
+        m_trayIcon = new UIAListIcon(
+            QKeySequence::fromString(QString::fromStdWString(UIAListCore::SettingsStore::Instance().Get()->ShortcutKey)), this);
+        connect(m_trayIcon, &UIAListIcon::activateRequested, this, &UIAList::showWindow);
+        connect(m_trayIcon, &UIAListIcon::quickActivateRequested, this, &UIAList::showQuickWindow);
+        m_trayIcon->show();
+    });
+    
+    // Stage 2, in the background: UI Automation
+    m_startup->Defer("Automation", [this]() { initializeUIAutomation(); });
+    
+    // Stage 2, too: the query API. Windows without a published list are
+    // walked on the connection thread.
+    m_querySnapshots = std::make_unique<UIAListCore::QuerySnapshotCache>(
+        [this](uint64_t window) -> std::unique_ptr<UIAListCore::TreeProvider> {
+            HWND hwnd = reinterpret_cast<HWND>(static_cast<uintptr_t>(window));
+            if (!m_uiAutomation || !IsWindow(hwnd)) {
+                return nullptr;
+            }
+            return std::make_unique<UIAListCore::UiaTreeProvider>(m_uiAutomation, hwnd);
+        },
+        [this](uint64_t window, uint32_t index, UIAListCore::ActionKind action) {
+            return invokeServedControl(window, index, action);
+        });
+    m_queryServer = std::make_unique<UIAListCore::QueryServer>(*m_querySnapshots,
+        []() { CoInitializeEx(nullptr, COINIT_MULTITHREADED); },
+        []() { CoUninitialize(); });
+    m_startup->Defer("Query", [this]() {
+        m_queryServer->Start(std::make_unique<UIAListCore::NamedPipeListener>(UIAListCore::QueryPipeName()));
+    });
     
-    setupUI();
-    setupLoadingOverlay();
-    initializeUIAutomation();
+    // Hidden for idleTrimSeconds: compact the list and give the memory back
+    m_idleTrimTimer = new QTimer(this);
+    m_idleTrimTimer->setSingleShot(true);
+    connect(m_idleTrimTimer, &QTimer::timeout, this, &UIAList::trimIdle);
     
-    m_trayIcon = new UIAListIcon(this);
-    connect(m_trayIcon, &UIAListIcon::activateRequested, this, &UIAList::showWindow);
-    m_trayIcon->show();
+    // Held back announcements go out when the scheduler says they are due
+    m_announceTimer = new QTimer(this);
+    m_announceTimer->setSingleShot(true);
+    m_announceTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_announceTimer, &QTimer::timeout, this, &UIAList::flushAnnouncements);
+    
+    // Reads the enumeration's counters; the worker sends nothing per node for it
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setInterval(ProgressIntervalMs);
+    connect(m_progressTimer, &QTimer::timeout, this, &UIAList::updateProgress);
+    
+    // Control interactions run here so a hung target application cannot
+    // freeze the UI. The thread keeps its event handlers until it stops.
+    m_actionExecutor = std::make_unique<UIAListCore::ActionExecutor>(
+        []() { CoInitializeEx(nullptr, COINIT_MULTITHREADED); },
+        []() { UIAListCore::AutomationEventHandlers::Unregister(); CoUninitialize(); });
     
     // Hide the main window by default, only show tray icon
     hide();
     
-    // Check if we should show the welcome screen
-    checkAndShowWelcome();
+    // Stage 3: the list window is built by the first openWindow, so a tray
+    // icon that is never used costs nothing more. The welcome screen on
+    // first run waits for the event loop.
+    QTimer::singleShot(0, this, [this]() { checkAndShowWelcome(); });
 }
 
 UIAList::~UIAList()
 {
+    UIAListCore::SettingsStore::Instance().Unsubscribe(m_settingsListener);
+    
+    // Clients may be waiting on an action; both go before the automation does
+    m_startup->WaitReady(std::chrono::seconds(10));
+    m_queryServer->Stop();
+    
+    // Wait for a running action before its elements and automation go away;
+    // one still hung at its deadline is left behind (see ~ActionExecutor)
+    m_actionExecutor.reset();
+    
+    // The budget must not call back into this window
+    if (m_snapshotId) {
+        UIAListCore::MemoryBudget::Instance().Remove(m_snapshotId);
+    }
+    if (m_compactSnapshotId) {
+        UIAListCore::MemoryBudget::Instance().Remove(m_compactSnapshotId);
+    }
+    
+    // The watcher may be in the middle of a walk
+    QThread* liveThread = m_liveThread;
+    stopLiveUpdates();
+    if (liveThread && !liveThread->wait(3000)) {
+        liveThread->terminate();
+    }
+    
     // Clean up worker thread
     if (m_workerThread && m_workerThread->isRunning()) {
         if (m_worker) {
@@ -70,7 +275,16 @@ UIAList::~UIAList()
         }
     }
 
+    // Automation may still be in the making on the startup thread
+    m_startup->WaitReady(std::chrono::seconds(10));
+    releaseScope();
     cleanupUIAutomation();
+    
+    if (!UIAListCore::SettingsStore::Instance().Flush()) {
+        UIALIST_LOG(Warning, "Settings changed last could not be stored");
+    }
+    UIAListCore::TraceBuffer::WriteRequestedFile();
+    UIAListCore::LogBuffer::WriteRequestedFile();
 }
 
 void UIAList::setupUI()
@@ -110,6 +324,11 @@ void UIAList::setupUI()
     m_hideMenusCheckBox->setChecked(true); // Enabled by default
     connect(m_hideMenusCheckBox, &QCheckBox::toggled, this, &UIAList::onHideMenusChanged);
     
+    // Reading order checkbox: top to bottom and left to right on screen instead of tree order
+    m_readingOrderCheckBox = new QCheckBox(tr("Sort in reading order"), this);
+    m_readingOrderCheckBox->setChecked(false);
+    connect(m_readingOrderCheckBox, &QCheckBox::toggled, this, &UIAList::onReadingOrderChanged);
+    
     // Buttons layout
     m_buttonLayout = new QHBoxLayout();
     
@@ -122,9 +341,16 @@ void UIAList::setupUI()
     connect(m_focusButton, &QPushButton::clicked, this, &UIAList::onFocusButtonClicked);
     connect(m_doubleClickButton, &QPushButton::clicked, this, &UIAList::onDoubleClickButtonClicked);
     
+    // Widen a quick list to the next enclosing pane, group, dialog or document
+    m_widenButton = new QPushButton(tr("&Widen"), this);
+    m_widenButton->setAccessibleDescription(tr("List the controls of the enclosing container too"));
+    m_widenButton->setVisible(false);
+    connect(m_widenButton, &QPushButton::clicked, this, &UIAList::onWidenButtonClicked);
+    
     m_buttonLayout->addWidget(m_doubleClickButton);
     m_buttonLayout->addWidget(m_clickButton);
     m_buttonLayout->addWidget(m_focusButton);
+    m_buttonLayout->addWidget(m_widenButton);
     m_buttonLayout->addStretch(); // Add stretch to push buttons to the left
     
     m_layout->addWidget(m_windowTitleLabel);
@@ -132,8 +358,17 @@ void UIAList::setupUI()
     m_layout->addWidget(m_listWidget);
     m_layout->addWidget(m_hideEmptyTitlesCheckBox);
     m_layout->addWidget(m_hideMenusCheckBox);
+    m_layout->addWidget(m_readingOrderCheckBox);
     m_layout->addLayout(m_buttonLayout);
 
+#if UIALIST_CALL_STATS
+    m_callStatsLabel = new QLabel(this);
+    m_callStatsLabel->setFocusPolicy(Qt::TabFocus);
+    m_callStatsLabel->setTextInteractionFlags(Qt::TextSelectableByMouse | Qt::TextSelectableByKeyboard);
+    m_callStatsLabel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_layout->addWidget(m_callStatsLabel);
+#endif
+
     // Add main widget to stacked widget
     m_stackedWidget->addWidget(m_mainWidget);
 
@@ -187,13 +422,8 @@ void UIAList::setupLoadingOverlay()
 
 void UIAList::initializeUIAutomation()
 {
-    HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
-    if (FAILED(hr)) {
-        qDebug() << "Failed to initialize COM";
-        return;
-    }
-    
-    hr = CoCreateInstance(__uuidof(CUIAutomation), nullptr, CLSCTX_INPROC_SERVER,
+    // Runs on the startup thread, must not touch widgets
+    HRESULT hr = CoCreateInstance(__uuidof(CUIAutomation), nullptr, CLSCTX_INPROC_SERVER,
                          __uuidof(IUIAutomation), (void**)&m_uiAutomation);
     if (FAILED(hr)) {
         qDebug() << "Failed to create UI Automation instance";
@@ -209,12 +439,47 @@ void UIAList::initializeUIAutomation()
     qDebug() << "UI Automation initialized successfully";
 }
 
+bool UIAList::waitForAutomation()
+{
+    // Only a hotkey in the first moments after login ever waits here
+    if (!m_startup->WaitReady(std::chrono::seconds(10))) {
+        UIALIST_LOG(Warning, "UI Automation is still initializing");
+        return false;
+    }
+    
+    if (!m_startupLogged) {
+        m_startupLogged = true;
+        UIALIST_LOG(Info, "Startup: {}", m_startup->Format());
+    }
+    return m_uiAutomation != nullptr;
+}
+
+void UIAList::applySettings(const UIAListCore::Settings& settings)
+{
+    UIAListCore::MemoryBudget::Instance().SetLimit(static_cast<size_t>(settings.MemoryBudgetMB) * 1024 * 1024);
+    m_trayIcon->updateShortcut(QKeySequence::fromString(QString::fromStdWString(settings.ShortcutKey)));
+}
+
+void UIAList::ensureWindowCreated()
+{
+    if (m_centralWidget) {
+        return;
+    }
+    
+    m_startup->Run("Window", [this]() {
+        setupUI();
+        setupLoadingOverlay();
+    });
+}
+
 void UIAList::showLoadingOverlay()
 {
     if (!m_stackedWidget || !m_loadingWidget) {
         return;
     }
 
+    m_loadingLabel->setText(tr("Listing controls..."));
+    m_loadingLabel->setAccessibleName(QString());
     m_stackedWidget->setCurrentWidget(m_loadingWidget);
     if (m_cancelButton) {
         m_cancelButton->setFocus();
@@ -227,26 +492,84 @@ void UIAList::hideLoadingOverlay()
     m_filterEdit->setFocus();
 }
 
+void UIAList::updateProgress()
+{
+    if (!m_progress || m_stackedWidget->currentWidget() != m_loadingWidget) {
+        return;
+    }
+    
+    const UIAListCore::EnumerationProgress::Report report = m_progress->Read();
+    const QLocale locale;
+    QString text = tr("Listing controls...\n%1 found, depth %2, %3 s")
+                       .arg(locale.toString(static_cast<qulonglong>(report.Accepted)))
+                       .arg(report.Depth)
+                       .arg(static_cast<int>(report.ElapsedSeconds));
+    if (report.HasEstimate) {
+        // Subtrees differ too much for a time or a bar, the count is a rough guide
+        text += tr("\nPerhaps %1 more").arg(locale.toString(static_cast<qulonglong>(report.EstimatedRemaining)));
+    }
+    m_loadingLabel->setText(text);
+    
+    // Only a wait long enough to wonder about is announced, and not often
+    const double announceAt = m_progressAnnounced > 0.0 ? m_progressAnnounced + ProgressAnnounceSeconds
+                                                        : ProgressFirstAnnounceSeconds;
+    if (report.ElapsedSeconds >= announceAt) {
+        m_progressAnnounced = report.ElapsedSeconds;
+        announceText(tr("%1 controls found").arg(locale.toString(static_cast<qulonglong>(report.Accepted))));
+    }
+}
+
+void UIAList::stopProgress()
+{
+    m_progressTimer->stop();
+    m_progress.reset();
+}
+
 void UIAList::showWindow(void* foregroundWindow)
 {
+    openWindow(foregroundWindow, false);
+}
+
+void UIAList::showQuickWindow(void* foregroundWindow)
+{
+    openWindow(foregroundWindow, true);
+}
+
+void UIAList::openWindow(void* foregroundWindow, bool quick)
+{
+    ensureWindowCreated();
+    if (!waitForAutomation()) {
+        return;
+    }
+    
+    // Start background enumeration; before the window shows, as the worker
+    // first notes the control focused in the target window
+    startEnumeration(foregroundWindow, quick);
+    
     show();
     raise();
     activateWindow();
+    m_idleTrimTimer->stop();
 
     // Clear previous data
-    m_allControls.clear();
-    m_controlMap.clear();
-    m_listWidget->clear();
-
-    // Show loading overlay
-    showLoadingOverlay();
+    releaseSnapshot();
 
-    // Start background enumeration
-    startEnumeration(foregroundWindow);
+    // A compacted list of the same window shows at once, the enumeration
+    // refreshes it; not for a quick list, which would replace it with less
+    if (!quick && restoreCompactSnapshot(foregroundWindow)) {
+        hideLoadingOverlay();
+    } else {
+        showLoadingOverlay();
+    }
 }
 
-void UIAList::startEnumeration(void* windowHandle)
+void UIAList::startEnumeration(void* windowHandle, bool quick)
 {
+    UIALIST_TRACE_SPAN("StartEnumeration");
+    
+    // The list is about to be replaced; it is watched again once it is
+    stopLiveUpdates();
+    
     // Clean up previous worker if any
     if (m_workerThread && m_workerThread->isRunning()) {
         if (m_worker) {
@@ -261,45 +584,167 @@ void UIAList::startEnumeration(void* windowHandle)
         qDebug() << "ERROR: m_uiAutomation is null!";
         return;
     }
-    if (!m_controlViewWalker) {
-        qDebug() << "ERROR: m_controlViewWalker is null!";
-        return;
-    }
+
+    m_targetWindow = windowHandle;
+    const int quickDepth = UIAListCore::SettingsStore::Instance().Get()->QuickScopeDepth;
+    m_incomingControls.clear();
+    m_incomingRings.clear();
+    m_listPartial = false;
+    m_listLimited = quick && quickDepth > 0;
+
+    // Shared with the worker, which may still be writing when the window lets go of it
+    m_progress = std::make_shared<UIAListCore::EnumerationProgress>();
+    m_progressAnnounced = 0.0;
+    m_progressTimer->start();
 
     // Create new worker thread
     m_workerThread = new QThread(this);
-    m_worker = new ControlEnumerationWorker(m_uiAutomation, m_controlViewWalker, windowHandle);
+    m_worker = new ControlEnumerationWorker(m_uiAutomation, windowHandle, m_progress);
+    if (quick) {
+        m_worker->setScope(quickDepth > 0 ? quickDepth : -1);
+    }
     m_worker->moveToThread(m_workerThread);
+    releaseScope();
 
     // Connect signals
     connect(m_workerThread, &QThread::started, m_worker, &ControlEnumerationWorker::enumerateControls);
     connect(m_worker, &ControlEnumerationWorker::controlFound, this, &UIAList::onControlFound);
+    connect(m_worker, &ControlEnumerationWorker::ringCompleted, this, &UIAList::onRingCompleted);
     connect(m_worker, &ControlEnumerationWorker::enumerationFinished, this, &UIAList::onEnumerationFinished);
     connect(m_worker, &ControlEnumerationWorker::enumerationCancelled, this, &UIAList::onEnumerationCancelled);
+    connect(m_worker, &ControlEnumerationWorker::scopeReached, this, &UIAList::onScopeReached);
+    connect(m_worker, &ControlEnumerationWorker::scopeLost, this, &UIAList::onScopeLost);
+    connect(m_workerThread, &QThread::finished, m_worker, &ControlEnumerationWorker::releaseWalker, Qt::DirectConnection);
     connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
     connect(m_workerThread, &QThread::finished, m_workerThread, &QObject::deleteLater);
 
+#if UIALIST_CALL_STATS
+    m_callsBefore = UIAListCore::CallStats::Snapshot();
+#endif
+
     // Start the worker thread
     m_workerThread->start();
+    if (!m_worker->waitForFocus(FocusNoteTimeoutMs)) {
+        UIALIST_LOG(Warning, "Focus not noted within {} ms, listing from the window", FocusNoteTimeoutMs);
+    }
 }
 
-void UIAList::onControlFound(const QString& displayText, const QString& originalName, void* element, int controlType)
+void UIAList::onControlFound(const QString& displayText, const QString& originalName, void* element, int controlType,
+                             uint capabilities, const UIAListCore::ElementLocator& locator)
 {
     // Create ControlInfo and add to list
     IUIAutomationElement* uiaElement = static_cast<IUIAutomationElement*>(element);
     ControlInfo controlInfo(displayText, originalName, uiaElement, static_cast<CONTROLTYPEID>(controlType));
-    m_allControls.append(controlInfo);
+    controlInfo.capabilities = capabilities;
+    controlInfo.locator = locator;
+    controlInfo.bounds = cachedBounds(uiaElement);
+    m_incomingControls.append(controlInfo);
+}
+
+void UIAList::replaceControls(QList<ControlInfo> controls)
+{
+    // The selected control, to select it again wherever it ends up
+    std::vector<int> selectedId;
+    QString selectedText;
+    int selectedRow = m_listWidget->currentRow();
+    if (m_selectedIndex >= 0 && m_selectedIndex < m_allControls.size()) {
+        selectedId = m_allControls[m_selectedIndex].locator.Id();
+        selectedText = m_allControls[m_selectedIndex].displayText;
+    }
+    int scrollPosition = m_listWidget->verticalScrollBar()->value();
+    
+    m_allControls.swap(controls);
+    
+    // Same filter, no best match selected over the user's choice
+    m_selectedIndex = -1;
+    populateListWidget(false);
+    
+    int restoredRow = -1;
+    int nearestRow = -1;
+    for (int i = 0; i < m_listWidget->count() && selectedRow >= 0; ++i) {
+        QListWidgetItem* item = m_listWidget->item(i);
+        if (item->isHidden()) {
+            continue;
+        }
+        const ControlInfo& controlInfo = m_allControls[item->data(Qt::UserRole).toInt()];
+        bool same = selectedId.empty() ? controlInfo.displayText == selectedText : controlInfo.locator.Id() == selectedId;
+        if (same) {
+            restoredRow = i;
+            break;
+        }
+        if (nearestRow < selectedRow) {
+            nearestRow = i;
+        }
+    }
+    
+    if (restoredRow >= 0) {
+        m_listWidget->setCurrentRow(restoredRow);
+    } else if (nearestRow >= 0) {
+        // The selected control is gone: its neighbour, which is news
+        m_listWidget->setCurrentRow(nearestRow);
+        announceSelectedItem(m_listWidget->item(nearestRow)->text());
+    }
+    m_listWidget->verticalScrollBar()->setValue(scrollPosition);
 }
 
 void UIAList::onEnumerationFinished(const QString& windowTitle)
 {
     m_targetWindowTitle = windowTitle;
+    stopProgress();
 
     // Update the window title label
     m_windowTitleLabel->setText(QString("Controls for: %1").arg(m_targetWindowTitle));
 
+    // Replaces a restored list; the user may already be working in it
+    bool wasRestored = m_listRestored;
+    bool wasPartial = m_listPartial;
+    QString selectedText = m_listWidget->currentItem() ? m_listWidget->currentItem()->text() : QString();
+    m_listRestored = false;
+    m_listPartial = false;
+    QList<ControlInfo> controls = incomingInTreeOrder();
+    m_incomingControls = QList<ControlInfo>();
+    m_incomingRings.clear();
+
     // Populate the list widget
-    populateListWidget();
+    if (wasPartial) {
+        replaceControls(controls);
+    } else {
+        m_allControls.swap(controls);
+        populateListWidget();
+    }
+    accountSnapshot(true);
+    publishSnapshot();
+
+#if UIALIST_CALL_STATS
+    std::vector<UIAListCore::CallCount> calls = UIAListCore::CallStats::Since(m_callsBefore);
+    UIAListCore::CallStats::Trace(calls);
+    m_callStatsLabel->setText(QString::fromStdString(UIAListCore::CallStats::Format(calls, m_allControls.size()) +
+                                                     UIAListCore::MemoryBudget::Instance().Format()));
+#endif
+
+    if (wasRestored) {
+        // Keep the filter, focus and selection; the list was announced on restore
+        onFilterChanged(m_filterEdit->text());
+        QList<QListWidgetItem*> items = m_listWidget->findItems(selectedText, Qt::MatchExactly);
+        if (!selectedText.isEmpty() && !items.isEmpty() && !items.first()->isHidden()) {
+            m_listWidget->setCurrentItem(items.first());
+        }
+        startLiveUpdates();
+        UIAListCore::TraceInstant("ListComplete");
+        return;
+    }
+
+    if (wasPartial) {
+        // The user may already be working in the list around the focus
+        if (m_scopeElement) {
+            announceText(QString("Showing %1 controls in %2").arg(m_allControls.size()).arg(m_scopeDescription));
+        } else {
+            announceText(QString("All %1 controls listed").arg(m_allControls.size()));
+        }
+        startLiveUpdates();
+        UIAListCore::TraceInstant("ListComplete");
+        return;
+    }
 
     // Hide loading overlay and show main UI
     hideLoadingOverlay();
@@ -309,11 +754,157 @@ void UIAList::onEnumerationFinished(const QString& windowTitle)
     m_filterEdit->setFocus();
 
     // Announce to screen reader
-    announceText(QString("Showing controls for %1").arg(m_targetWindowTitle));
+    if (m_scopeElement) {
+        announceText(QString("Showing %1 controls in %2").arg(m_allControls.size()).arg(m_scopeDescription));
+    } else {
+        announceText(QString("Showing %1 controls for %2").arg(m_allControls.size()).arg(m_targetWindowTitle));
+    }
+    
+    startLiveUpdates();
+    UIAListCore::TraceInstant("ListComplete");
+}
+
+void UIAList::onRingCompleted(int first, int count, int innerAt)
+{
+    UIAListCore::ControlWalker::Ring ring;
+    ring.Index = m_incomingRings.size();
+    ring.First = static_cast<size_t>(first);
+    ring.Count = static_cast<size_t>(count);
+    ring.InnerAt = static_cast<size_t>(innerAt);
+    m_incomingRings.push_back(ring);
+    
+    // A restored list is replaced only by the whole window's
+    if (m_listRestored || !isVisible()) {
+        return;
+    }
+    UIALIST_TRACE_SPAN("ListRing");
+    
+    if (m_listPartial) {
+        replaceControls(incomingInTreeOrder());
+        if (m_listWidget->currentItem()) {
+            m_listWidget->scrollToItem(m_listWidget->currentItem());
+        }
+        return;
+    }
+    
+    // The controls around the focus are usable while the rest is walked
+    m_listPartial = true;
+    m_allControls = incomingInTreeOrder();
+    m_filterEdit->clear();
+    populateListWidget(false);
+    hideLoadingOverlay();
+    
+    // Start at the focused control's container rather than the window
+    std::vector<size_t> order;
+    UIAListCore::ControlWalker::TreeOrder(m_incomingRings, order);
+    const int container = static_cast<int>(std::find(order.begin(), order.end(), m_incomingRings.front().First) - order.begin());
+    int row = -1;
+    for (int i = 0; i < m_listWidget->count() && row < 0; ++i) {
+        QListWidgetItem* item = m_listWidget->item(i);
+        if (!item->isHidden() && item->data(Qt::UserRole).toInt() >= container) {
+            row = i;
+        }
+    }
+    if (row >= 0) {
+        m_listWidget->setCurrentRow(row);
+        m_listWidget->scrollToItem(m_listWidget->item(row), QAbstractItemView::PositionAtCenter);
+    }
+    
+    announceText(QString("Showing %1 controls near the focus, listing the rest").arg(m_allControls.size()));
+    UIAListCore::TraceInstant("ListNearFocus");
+}
+
+QList<ControlInfo> UIAList::incomingInTreeOrder() const
+{
+    if (m_incomingRings.empty()) {
+        return m_incomingControls;
+    }
+    
+    std::vector<size_t> order;
+    UIAListCore::ControlWalker::TreeOrder(m_incomingRings, order);
+    QList<ControlInfo> controls;
+    controls.reserve(static_cast<int>(order.size()));
+    for (size_t visit : order) {
+        if (visit < static_cast<size_t>(m_incomingControls.size())) {
+            controls.append(m_incomingControls.at(static_cast<int>(visit)));
+        }
+    }
+    return controls;
+}
+
+void UIAList::onScopeReached(void* scope, const QString& description)
+{
+    releaseScope();
+    m_scopeElement = static_cast<IUIAutomationElement*>(scope);
+    m_scopeDescription = description;
+    m_widenButton->setVisible(true);
+}
+
+void UIAList::onScopeLost()
+{
+    // The container went away: the whole window instead, what is shown stays until it is listed
+    announceText(QString("%1 is gone, listing the whole window").arg(m_scopeDescription));
+    startEnumeration(m_targetWindow);
+}
+
+void UIAList::onWidenButtonClicked()
+{
+    // Only a finished quick list; a running enumeration has no scope yet
+    if (!m_scopeElement || !m_targetWindow) {
+        return;
+    }
+    UIALIST_TRACE_SPAN("WidenScope");
+    
+    // Away from the button, which is hidden until the next scope is reached
+    if (m_widenButton->hasFocus()) {
+        m_listWidget->setFocus();
+    }
+    widenEnumeration();
+}
+
+void UIAList::widenEnumeration()
+{
+    // The worker that reached the scope walks on from it
+    if (!m_worker) {
+        startEnumeration(m_targetWindow);
+        return;
+    }
+    stopLiveUpdates();
+    
+    // The list shown stays, as the innermost ring of the widened walk
+    const size_t listed = static_cast<size_t>(m_allControls.size());
+    m_incomingControls = m_allControls;
+    m_incomingRings.assign(1, UIAListCore::ControlWalker::Ring{ 0, 0, listed, listed });
+    m_listPartial = true;
+    m_progressAnnounced = 0.0;
+    m_progressTimer->start();
+    releaseScope();
+
+#if UIALIST_CALL_STATS
+    m_callsBefore = UIAListCore::CallStats::Snapshot();
+#endif
+
+    ControlEnumerationWorker* worker = m_worker;
+    const int found = m_incomingControls.size();
+    QMetaObject::invokeMethod(worker, [worker, found]() { worker->widenScope(found); }, Qt::QueuedConnection);
+}
+
+void UIAList::releaseScope()
+{
+    if (m_scopeElement) {
+        m_scopeElement->Release();
+        m_scopeElement = nullptr;
+    }
+    if (m_widenButton) {
+        m_widenButton->setVisible(false);
+    }
 }
 
 void UIAList::onEnumerationCancelled()
 {
+    stopProgress();
+    m_listPartial = false;
+    
     // Hide loading overlay
     hideLoadingOverlay();
 
@@ -328,6 +919,214 @@ void UIAList::onCancelButtonClicked()
     }
 }
 
+void UIAList::onSubtreesChanged(quint64 generation, const QList<LiveSplice>& splices)
+{
+    // Made for a list that changed since: the watcher has the newer one
+    if (generation != m_liveGeneration) {
+        return;
+    }
+    // The watcher waits for a list until it gets one or is stopped
+    if (!isVisible()) {
+        stopLiveUpdates();
+        return;
+    }
+    UIALIST_TRACE_SPAN("LiveUpdate");
+    
+    // Back to front and within the list, as the watcher makes them
+    int end = m_allControls.size();
+    for (const LiveSplice& splice : splices) {
+        if (splice.row < 0 || splice.count < 0 || splice.row + splice.count > end) {
+            UIALIST_LOG(Warning, "Live update does not fit the list, dropped");
+            startLiveUpdates(); // The list as it is, for the watcher to index again
+            return;
+        }
+        end = splice.row;
+    }
+    
+    if (m_readingOrderCheckBox && m_readingOrderCheckBox->isChecked()) {
+        // A changed rectangle may move any row of the reading order: laid out again
+        QList<ControlInfo> updated;
+        updated.reserve(m_allControls.size());
+        int next = 0;
+        for (auto splice = splices.crbegin(); splice != splices.crend(); ++splice) {
+            for (; next < splice->row; ++next) {
+                updated.append(m_allControls.at(next));
+            }
+            updated.append(splice->controls);
+            next = splice->row + splice->count;
+        }
+        for (; next < m_allControls.size(); ++next) {
+            updated.append(m_allControls.at(next));
+        }
+        replaceControls(updated);
+    } else {
+        // In tree order only the rows of the changed subtrees change
+        for (const LiveSplice& splice : splices) {
+            spliceControls(splice);
+        }
+        updateButtonStates();
+    }
+    
+    accountSnapshot(true);
+    publishSnapshot();
+    UIALIST_LOG(Debug, "Live update of {} splices, {} controls now", splices.size(), m_allControls.size());
+    
+    // The watcher waits for the list its next splices apply to
+    startLiveUpdates();
+}
+
+void UIAList::spliceControls(const LiveSplice& splice)
+{
+    const int first = splice.row;
+    const int end = splice.row + splice.count;
+    const int added = splice.controls.size();
+    
+    // Rows show controls in tree order: the first row of a control at index or after
+    auto rowOf = [this](int index) {
+        int low = 0;
+        int high = m_listWidget->count();
+        while (low < high) {
+            int middle = (low + high) / 2;
+            if (m_listWidget->item(middle)->data(Qt::UserRole).toInt() < index) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    };
+    const int firstRow = rowOf(first);
+    const int endRow = rowOf(end);
+    
+    // The selected control, if among the replaced, to select it again in the new rows
+    int selectedRow = m_listWidget->currentRow();
+    bool selectionReplaced = selectedRow >= firstRow && selectedRow < endRow;
+    std::vector<int> selectedId;
+    QString selectedText;
+    if (selectionReplaced) {
+        const ControlInfo& selected = m_allControls[m_listWidget->item(selectedRow)->data(Qt::UserRole).toInt()];
+        selectedId = selected.locator.Id();
+        selectedText = selected.displayText;
+        m_listWidget->setCurrentRow(-1);
+    }
+    
+    m_allControls.remove(first, splice.count);
+    m_allControls.insert(first, added, ControlInfo());
+    std::vector<UIAListCore::ElementRect> bounds;
+    bounds.reserve(static_cast<size_t>(added));
+    for (int i = 0; i < added; ++i) {
+        m_allControls[first + i] = splice.controls.at(i);
+        bounds.push_back(splice.controls.at(i).bounds);
+    }
+    m_spatialIndex.Splice(static_cast<uint32_t>(first), static_cast<uint32_t>(splice.count), bounds);
+    if (m_selectedIndex >= end) {
+        m_selectedIndex += added - splice.count;
+    }
+    
+    for (int row = endRow; row-- > firstRow;) {
+        delete m_listWidget->takeItem(row);
+    }
+    for (int row = firstRow; row < m_listWidget->count(); ++row) {
+        QListWidgetItem* item = m_listWidget->item(row);
+        item->setData(Qt::UserRole, item->data(Qt::UserRole).toInt() + added - splice.count);
+    }
+    
+    UIAListCore::ListOptions options;
+    options.HideEmptyTitles = m_hideEmptyTitlesCheckBox && m_hideEmptyTitlesCheckBox->isChecked();
+    options.HideMenus = m_hideMenusCheckBox && m_hideMenusCheckBox->isChecked();
+    std::vector<std::u16string_view> texts;
+    std::vector<std::u16string_view> names;
+    int row = firstRow;
+    for (int index = first; index < first + added; ++index) {
+        const ControlInfo& controlInfo = m_allControls[index];
+        if (!UIAListCore::IsListed(controlInfo.controlType, utf16View(controlInfo.originalName), options)) {
+            continue;
+        }
+        m_listWidget->insertItem(row++, newListItem(index));
+        texts.push_back(utf16View(controlInfo.displayText));
+        names.push_back(utf16View(controlInfo.originalName));
+    }
+    m_filter.Splice(static_cast<size_t>(firstRow), static_cast<size_t>(endRow - firstRow), texts, names);
+    for (int newRow = firstRow; newRow < row; ++newRow) {
+        m_listWidget->item(newRow)->setHidden(!m_filter.IsMatch(static_cast<size_t>(newRow)));
+    }
+    
+    if (!selectionReplaced) {
+        return;
+    }
+    for (int newRow = firstRow; newRow < row; ++newRow) {
+        QListWidgetItem* item = m_listWidget->item(newRow);
+        const ControlInfo& controlInfo = m_allControls[item->data(Qt::UserRole).toInt()];
+        bool same = selectedId.empty() ? controlInfo.displayText == selectedText : controlInfo.locator.Id() == selectedId;
+        if (same && !item->isHidden()) {
+            m_listWidget->setCurrentRow(newRow);
+            return;
+        }
+    }
+    
+    // The selected control is gone: its neighbour, which is news
+    int nearestRow = -1;
+    for (int i = firstRow; i < m_listWidget->count() && nearestRow < 0; ++i) {
+        if (!m_listWidget->item(i)->isHidden()) {
+            nearestRow = i;
+        }
+    }
+    for (int i = firstRow; i-- > 0 && nearestRow < 0;) {
+        if (!m_listWidget->item(i)->isHidden()) {
+            nearestRow = i;
+        }
+    }
+    if (nearestRow >= 0) {
+        m_listWidget->setCurrentRow(nearestRow);
+        announceSelectedItem(m_listWidget->item(nearestRow)->text());
+    }
+}
+
+void UIAList::startLiveUpdates()
+{
+    // A quick list is not the whole window, which the watcher walks changes of.
+    // A watcher still waiting for a list would wait for good: stopped instead.
+    if (!isVisible() || !m_uiAutomation || !m_targetWindow || m_scopeElement || m_listLimited) {
+        stopLiveUpdates();
+        return;
+    }
+    
+    if (!m_liveWatcher) {
+        m_liveThread = new QThread(this);
+        m_liveWatcher = new LiveTreeWatcher(m_uiAutomation, m_targetWindow);
+        m_liveWatcher->moveToThread(m_liveThread);
+        
+        connect(m_liveThread, &QThread::started, m_liveWatcher, &LiveTreeWatcher::watch);
+        connect(m_liveWatcher, &LiveTreeWatcher::subtreesChanged, this, &UIAList::onSubtreesChanged);
+        connect(m_liveThread, &QThread::finished, m_liveWatcher, &QObject::deleteLater);
+        connect(m_liveThread, &QThread::finished, m_liveThread, &QObject::deleteLater);
+        m_liveThread->start();
+    }
+    
+    QList<UIAListCore::ElementLocator> locators;
+    locators.reserve(m_allControls.size());
+    for (const ControlInfo& controlInfo : m_allControls) {
+        locators.append(controlInfo.locator);
+    }
+    m_liveWatcher->setList(++m_liveGeneration, locators);
+}
+
+void UIAList::stopLiveUpdates()
+{
+    // Splices still on their way are for an older generation
+    ++m_liveGeneration;
+    if (!m_liveWatcher) {
+        return;
+    }
+    
+    // Not waited for: a walk of a hung application must not hang the UI.
+    // The thread unsubscribes and deletes itself and the watcher when done.
+    m_liveWatcher->stop();
+    m_liveThread->quit();
+    m_liveWatcher = nullptr;
+    m_liveThread = nullptr;
+}
+
 void UIAList::walkControls(IUIAutomationElement* element, IUIAutomationTreeWalker* walker)
 {
     if (!element || !walker) return;
@@ -411,104 +1210,333 @@ QString UIAList::getControlTypeString(CONTROLTYPEID controlType)
     }
 }
 
-void UIAList::populateListWidget()
+void UIAList::populateListWidget(bool selectBest)
 {
+    UIALIST_TRACE_SPAN("PopulateListWidget");
+    
     m_listWidget->clear();
     
-    bool hideEmptyTitles = m_hideEmptyTitlesCheckBox && m_hideEmptyTitlesCheckBox->isChecked();
-    bool hideMenus = m_hideMenusCheckBox && m_hideMenusCheckBox->isChecked();
+    UIAListCore::ListOptions options;
+    options.HideEmptyTitles = m_hideEmptyTitlesCheckBox && m_hideEmptyTitlesCheckBox->isChecked();
+    options.HideMenus = m_hideMenusCheckBox && m_hideMenusCheckBox->isChecked();
     
-    for (int i = 0; i < m_allControls.size(); ++i) {
-        const ControlInfo& controlInfo = m_allControls[i];
-        
-        // Always filter out Text and Window control types
-        if (controlInfo.controlType == UIA_TextControlTypeId || 
-            controlInfo.controlType == UIA_WindowControlTypeId) {
+    // The filter's rows are the list's; the text typed so far still applies
+    m_filter.Clear();
+    m_filter.SetQuery(utf16View(m_filterEdit->text()));
+    
+    // Offscreen is judged against the virtual screen, all monitors together
+    std::vector<UIAListCore::ElementRect> bounds;
+    bounds.reserve(static_cast<size_t>(m_allControls.size()));
+    for (const ControlInfo& controlInfo : m_allControls) {
+        bounds.push_back(controlInfo.bounds);
+    }
+    const int screenLeft = GetSystemMetrics(SM_XVIRTUALSCREEN);
+    const int screenTop = GetSystemMetrics(SM_YVIRTUALSCREEN);
+    m_spatialIndex.Build(bounds, { screenLeft, screenTop, screenLeft + GetSystemMetrics(SM_CXVIRTUALSCREEN),
+                                   screenTop + GetSystemMetrics(SM_CYVIRTUALSCREEN) });
+    
+    std::vector<uint32_t> order;
+    if (m_readingOrderCheckBox && m_readingOrderCheckBox->isChecked()) {
+        m_spatialIndex.ReadingOrder(order);
+    } else {
+        order.resize(bounds.size());
+        for (uint32_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+    }
+    
+    for (uint32_t index : order) {
+        const int i = static_cast<int>(index);
+        const ControlInfo& controlInfo = m_allControls[i];
+        if (!UIAListCore::IsListed(controlInfo.controlType, utf16View(controlInfo.originalName), options)) {
             continue;
         }
         
-        // Skip controls with empty or no titles if checkbox is checked
-        if (hideEmptyTitles) {
-            QString name = controlInfo.originalName.trimmed();
-            if (name.isEmpty() || name == "(no name)") {
-                continue; // Skip this control
-            }
+        QListWidgetItem* item = newListItem(i);
+        m_listWidget->addItem(item);
+        m_filter.Add(utf16View(controlInfo.displayText), utf16View(controlInfo.originalName));
+        if (!m_filter.IsMatch(m_filter.Size() - 1)) {
+            item->setHidden(true);
         }
-        
-        // Skip menus and menu items if checkbox is checked
-        if (hideMenus) {
-            if (controlInfo.controlType == UIA_MenuControlTypeId ||
-                controlInfo.controlType == UIA_MenuBarControlTypeId ||
-                controlInfo.controlType == UIA_MenuItemControlTypeId) {
-                continue; // Skip this control
-            }
+        if (m_listWidget->count() == 1) {
+            UIAListCore::TraceInstant("FirstRow");
         }
-        
-        QListWidgetItem* item = new QListWidgetItem(controlInfo.displayText);
-        item->setData(Qt::UserRole, i); // Store index to m_allControls
-        m_listWidget->addItem(item);
     }
     
-    // Auto-select the first item if none is selected
-    if (m_listWidget->count() > 0 && m_listWidget->currentRow() == -1) {
-        m_listWidget->setCurrentRow(0);
-        QListWidgetItem* firstItem = m_listWidget->item(0);
-        if (firstItem) {
-            announceSelectedItem(firstItem->text());
-        }
+    // Auto-select the best match (the first item without filter text) if none is selected
+    size_t best = m_filter.BestMatch();
+    if (selectBest && best != UIAListCore::FilterEngine::NoMatch && m_listWidget->currentRow() == -1) {
+        m_listWidget->setCurrentRow(static_cast<int>(best));
+        announceSelectedItem(m_listWidget->item(static_cast<int>(best))->text());
+    }
+    
+    if (m_snapshotId) {
+        accountSnapshot(false);
     }
     
     updateButtonStates();
 }
 
+QListWidgetItem* UIAList::newListItem(int index) const
+{
+    const ControlInfo& controlInfo = m_allControls[index];
+    QListWidgetItem* item = new QListWidgetItem(controlInfo.displayText);
+    item->setData(Qt::UserRole, index); // Store index to m_allControls
+    if (m_spatialIndex.IsOffscreen(static_cast<uint32_t>(index)) && !controlInfo.bounds.IsEmpty()) {
+        item->setData(Qt::AccessibleDescriptionRole, tr("off screen"));
+    }
+    return item;
+}
+
+void UIAList::accountSnapshot(bool controlsChanged)
+{
+    // QListWidgetItem, its private data and two role values; the text is
+    // shared with the ControlInfo
+    static const size_t listRowBytes = sizeof(QListWidgetItem) + 96;
+    
+    if (controlsChanged) {
+        m_snapshotUsage = controlsMemoryUsage();
+    }
+    m_snapshotUsage.Rows = static_cast<size_t>(m_listWidget->count());
+    m_snapshotUsage.RowBytes = m_snapshotUsage.Rows * listRowBytes;
+    
+    UIAListCore::MemoryBudget& budget = UIAListCore::MemoryBudget::Instance();
+    if (m_snapshotId) {
+        budget.Update(m_snapshotId, m_snapshotUsage);
+    } else {
+        m_snapshotId = budget.Add(m_snapshotUsage, [this]() { releaseSnapshot(); });
+        UIALIST_LOG(Info, "Snapshot of {} controls: {} bytes, {} COM references, {} rows", m_allControls.size(),
+                    m_snapshotUsage.Bytes(), m_snapshotUsage.ComReferences, m_snapshotUsage.Rows);
+    }
+    
+    // Finished after the window was closed
+    if (!isVisible()) {
+        budget.SetVisible(m_snapshotId, false);
+        budget.Enforce();
+    }
+}
+
+void UIAList::releaseSnapshot()
+{
+    // Also called by the memory budget when it evicts the hidden list
+    if (m_snapshotId) {
+        UIAListCore::MemoryBudget::Instance().Remove(m_snapshotId);
+        m_snapshotId = 0;
+    }
+    
+    m_listWidget->clear();
+    m_filter = UIAListCore::FilterEngine(); // Frees its buffers
+    m_selectedIndex = -1;
+    m_controlMap.clear();
+    m_allControls = QList<ControlInfo>(); // Frees the capacity too, and with it the COM references
+    releaseScope();
+    
+    // Query clients walk the window again if they still ask for it
+    QMutexLocker locker(&m_servedMutex);
+    if (m_servedWindow) {
+        m_querySnapshots->Remove(reinterpret_cast<uintptr_t>(m_servedWindow));
+    }
+    m_servedControls = QList<ControlInfo>();
+    m_servedWindow = nullptr;
+}
+
+void UIAList::publishSnapshot()
+{
+    UIALIST_TRACE_SPAN("QueryPublish");
+    
+    auto snapshot = std::make_shared<UIAListCore::QuerySnapshot>();
+    snapshot->Window = reinterpret_cast<uintptr_t>(m_targetWindow);
+    snapshot->Title = m_targetWindowTitle.toStdString();
+    snapshot->Rows.reserve(m_allControls.size());
+    for (int i = 0; i < m_allControls.size(); ++i) {
+        const ControlInfo& control = m_allControls.at(i);
+        UIAListCore::QueryRow row;
+        row.Index = static_cast<uint32_t>(i);
+        row.ControlType = control.controlType;
+        row.Name = control.originalName.toStdString();
+        row.Text = control.displayText.toStdString();
+        snapshot->Rows.push_back(std::move(row));
+    }
+    
+    {
+        // A shared copy; the list itself is not touched off the UI thread
+        QMutexLocker locker(&m_servedMutex);
+        m_servedControls = m_allControls;
+        m_servedWindow = m_targetWindow;
+    }
+    m_querySnapshots->Publish(std::move(snapshot));
+}
+
+UIAListCore::QueryStatus UIAList::invokeServedControl(uint64_t window, uint32_t index, UIAListCore::ActionKind action)
+{
+    // Runs on a query connection thread, must not touch widgets
+    ControlInfo controlInfo;
+    {
+        QMutexLocker locker(&m_servedMutex);
+        if (window != reinterpret_cast<uintptr_t>(m_servedWindow) || index >= static_cast<uint32_t>(m_servedControls.size())) {
+            return UIAListCore::QueryStatus::NoSuchControl;
+        }
+        controlInfo = m_servedControls.at(static_cast<int>(index));
+    }
+    UIALIST_LOG(Info, "Query client invokes {} on {}", UIAListCore::ToString(action), logText(controlInfo.displayText));
+    
+    int timeoutMs = UIAListCore::SettingsStore::Instance().Get()->ActionTimeoutMs;
+    std::future<UIAListCore::ActionResult> done = m_actionExecutor->Submit(
+        controlAction(m_uiAutomation, controlInfo, action), std::chrono::milliseconds(timeoutMs));
+    
+    switch (done.get()) {
+    case UIAListCore::ActionResult::Succeeded:
+        return UIAListCore::QueryStatus::Ok;
+    case UIAListCore::ActionResult::TimedOut:
+        return UIAListCore::QueryStatus::TimedOut;
+    default:
+        return UIAListCore::QueryStatus::ActionFailed;
+    }
+}
+
+void UIAList::trimIdle()
+{
+    UIALIST_TRACE_SPAN("TrimIdle");
+    
+    // Nothing finished to keep, or shown again meanwhile
+    if (isVisible() || !m_snapshotId) {
+        return;
+    }
+    
+    UIAListCore::ProcessMemory before = UIAListCore::ProcessMemory::Current();
+    
+    // The worker thread and its automation cache are rebuilt on the next show
+    if (m_workerThread && m_workerThread->isRunning()) {
+        if (m_worker) {
+            m_worker->cancelEnumeration();
+        }
+        m_workerThread->quit();
+        m_workerThread->wait(1000);
+    }
+    if (m_workerThread && !m_workerThread->isRunning()) {
+        m_workerThread = nullptr; // deleteLater on finished
+        m_worker = nullptr;
+    }
+    
+    dropCompactSnapshot();
+    UIAListCore::ElementLocator::Packer packer;
+    std::string locator;
+    for (const ControlInfo& controlInfo : m_allControls) {
+        locator.clear();
+        packer.Pack(controlInfo.locator, locator);
+        m_compactSnapshot.Append(controlInfo.displayText.toStdWString(), controlInfo.originalName.toStdWString(),
+                                 static_cast<int32_t>(controlInfo.controlType), locator);
+    }
+    m_compactSnapshot.SetShared(packer.Steps());
+    m_compactSnapshot.ShrinkToFit();
+    m_compactWindow = m_targetWindow;
+    size_t controls = static_cast<size_t>(m_allControls.size());
+    
+    // Rows, element references and lists go; the compact form is budgeted
+    // like any hidden snapshot and dropped first when it has to
+    releaseSnapshot();
+    UIAListCore::MemoryUsage usage;
+    usage.StringBytes = m_compactSnapshot.Bytes();
+    UIAListCore::MemoryBudget& budget = UIAListCore::MemoryBudget::Instance();
+    m_compactSnapshotId = budget.Add(usage, [this]() {
+        m_compactSnapshotId = 0;
+        dropCompactSnapshot();
+    });
+    budget.SetVisible(m_compactSnapshotId, false);
+    budget.Enforce();
+    
+    UIAListCore::ProcessMemory::TrimWorkingSet();
+    UIAListCore::ProcessMemory after = UIAListCore::ProcessMemory::Current();
+    UIALIST_LOG(Info, "Idle trim compacted {} controls to {} bytes; working set {} -> {} bytes, private {} -> {} bytes",
+                controls, m_compactSnapshot.Bytes(), before.WorkingSetBytes, after.WorkingSetBytes,
+                before.PrivateBytes, after.PrivateBytes);
+}
+
+bool UIAList::restoreCompactSnapshot(void* windowHandle)
+{
+    UIALIST_TRACE_SPAN("RestoreCompactSnapshot");
+    
+    if (m_compactSnapshot.Empty() || m_compactWindow != windowHandle) {
+        dropCompactSnapshot();
+        return false;
+    }
+    
+    UIAListCore::ElementLocator::Unpacker unpacker(m_compactSnapshot.Shared());
+    QList<ControlInfo> restored;
+    restored.reserve(static_cast<qsizetype>(m_compactSnapshot.Rows()));
+    bool valid = unpacker.IsValid() && m_compactSnapshot.ForEach([&](const UIAListCore::CompactSnapshot::Row& row) {
+        ControlInfo controlInfo(QString::fromStdWString(row.DisplayText), QString::fromStdWString(row.Name), nullptr,
+                                static_cast<CONTROLTYPEID>(row.ControlType));
+        unpacker.Unpack(row.Locator, controlInfo.locator);
+        restored.append(controlInfo);
+    });
+    dropCompactSnapshot();
+    if (!valid) {
+        UIALIST_LOG(Warning, "Compact snapshot is corrupt, enumerating from scratch");
+        return false;
+    }
+    
+    m_allControls.swap(restored);
+    m_listRestored = true;
+    m_windowTitleLabel->setText(QString("Controls for: %1").arg(m_targetWindowTitle));
+    populateListWidget();
+    accountSnapshot(true);
+    m_filterEdit->clear();
+    announceText(QString("Showing controls for %1").arg(m_targetWindowTitle));
+    
+    UIALIST_LOG(Info, "Restored {} controls from the compact snapshot", m_allControls.size());
+    UIAListCore::TraceInstant("ListRestored");
+    return true;
+}
+
+void UIAList::dropCompactSnapshot()
+{
+    if (m_compactSnapshotId) {
+        UIAListCore::MemoryBudget::Instance().Remove(m_compactSnapshotId);
+        m_compactSnapshotId = 0;
+    }
+    m_compactSnapshot.Clear();
+    m_compactWindow = nullptr;
+}
+
+UIAListCore::MemoryUsage UIAList::controlsMemoryUsage() const
+{
+    UIAListCore::MemoryUsage usage;
+    usage.ArrayBytes = static_cast<size_t>(m_allControls.capacity()) * sizeof(ControlInfo) +
+                       static_cast<size_t>(m_controlMap.size()) * (sizeof(QString) + sizeof(ControlInfo) + 4 * sizeof(void*)) +
+                       m_filter.MemoryBytes() + m_spatialIndex.MemoryBytes();
+    for (const ControlInfo& controlInfo : m_allControls) {
+        usage.StringBytes += static_cast<size_t>(controlInfo.displayText.capacity() + controlInfo.originalName.capacity()) * sizeof(QChar);
+        usage.StringBytes += controlInfo.locator.MemoryBytes();
+        if (controlInfo.element) {
+            ++usage.ComReferences;
+        }
+    }
+    return usage;
+}
+
 void UIAList::onFilterChanged(const QString& text)
 {
-    // Split filter text into individual words
-    QStringList filterWords = text.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    UIALIST_TRACE_SPAN("FilterChanged");
     
+    // Rows containing every word of the filter text, ignoring case
+    m_filter.SetQuery(utf16View(text));
     for (int i = 0; i < m_listWidget->count(); ++i) {
+        bool hidden = !m_filter.IsMatch(static_cast<size_t>(i));
         QListWidgetItem* item = m_listWidget->item(i);
-        bool visible = true;
-        
-        if (!filterWords.isEmpty()) {
-            QString itemText = item->text();
-            
-            // Check if all filter words are present in the item text (case insensitive)
-            for (const QString& word : filterWords) {
-                if (!itemText.contains(word, Qt::CaseInsensitive)) {
-                    visible = false;
-                    break;
-                }
-            }
+        if (item->isHidden() != hidden) {
+            item->setHidden(hidden);
         }
-        
-        item->setHidden(!visible);
     }
     
-    // If no item is currently selected, select the first visible item
-    if (m_listWidget->currentRow() == -1) {
-        for (int i = 0; i < m_listWidget->count(); ++i) {
-            QListWidgetItem* item = m_listWidget->item(i);
-            if (item && !item->isHidden()) {
-                m_listWidget->setCurrentRow(i);
-                announceSelectedItem(item->text());
-                break;
-            }
-        }
-    } else {
-        // Check if the currently selected item is still visible
-        QListWidgetItem* currentItem = m_listWidget->currentItem();
-        if (currentItem && currentItem->isHidden()) {
-            // Current item is hidden, select the first visible item
-            m_listWidget->setCurrentRow(-1); // Clear selection first
-            for (int i = 0; i < m_listWidget->count(); ++i) {
-                QListWidgetItem* item = m_listWidget->item(i);
-                if (item && !item->isHidden()) {
-                    m_listWidget->setCurrentRow(i);
-                    announceSelectedItem(item->text());
-                    break;
-                }
-            }
+    // Nothing selected, or the selection was filtered out: select the best match
+    QListWidgetItem* currentItem = m_listWidget->currentItem();
+    if (!currentItem || currentItem->isHidden()) {
+        m_listWidget->setCurrentRow(-1);
+        size_t best = m_filter.BestMatch();
+        if (best != UIAListCore::FilterEngine::NoMatch) {
+            m_listWidget->setCurrentRow(static_cast<int>(best));
+            announceSelectedItem(m_listWidget->item(static_cast<int>(best))->text());
         }
     }
     
@@ -517,18 +1545,18 @@ void UIAList::onFilterChanged(const QString& text)
 
 void UIAList::onItemSelectionChanged()
 {
-    QList<QListWidgetItem*> selectedItems = m_listWidget->selectedItems();
-    if (selectedItems.isEmpty()) {
-        m_selectedControl = ControlInfo();
+    // Runs on every arrow key press in the list: no copies, no formatting
+    QListWidgetItem* selectedItem = m_listWidget->currentItem();
+    if (!selectedItem || !selectedItem->isSelected()) {
+        m_selectedIndex = -1;
         return;
     }
     
-    QListWidgetItem* selectedItem = selectedItems.first();
     int index = selectedItem->data(Qt::UserRole).toInt();
     
     if (index >= 0 && index < m_allControls.size()) {
-        m_selectedControl = m_allControls[index];
-        qDebug() << "Selected control:" << m_selectedControl.displayText;
+        m_selectedIndex = index;
+        UIALIST_LOG(Debug, "Selected control {}: {}", index, logText(m_allControls[index].displayText));
     }
 }
 
@@ -546,6 +1574,13 @@ void UIAList::onHideMenusChanged(bool checked)
     populateListWidget();
 }
 
+void UIAList::onReadingOrderChanged(bool checked)
+{
+    Q_UNUSED(checked)
+    // Repopulate the list in the new order
+    populateListWidget();
+}
+
 void UIAList::cleanupUIAutomation()
 {
     if (m_controlViewWalker) {
@@ -557,8 +1592,6 @@ void UIAList::cleanupUIAutomation()
         m_uiAutomation->Release();
         m_uiAutomation = nullptr;
     }
-    
-    CoUninitialize();
 }
 
 bool UIAList::eventFilter(QObject *obj, QEvent *event)
@@ -575,7 +1608,6 @@ bool UIAList::eventFilter(QObject *obj, QEvent *event)
         } else if (keyEvent->key() == Qt::Key_Return || keyEvent->key() == Qt::Key_Enter) {
             ensureItemSelected();
             executeDefaultAction();
-            hide();
             return true; // Suppress default behavior
         }
     }
@@ -632,38 +1664,82 @@ void UIAList::selectVisibleListItem(int direction)
 
 void UIAList::announceSelectedItem(const QString& text)
 {
-    // Use QAccessible to announce the selected item to screen readers
-    if (m_listWidget && m_listWidget->currentItem()) {
-        QAccessibleEvent event(m_listWidget, QAccessible::Selection);
-        QAccessible::updateAccessibility(&event);
-        
-        // Also send a focus event to ensure screen readers announce the text
-        QAccessibleEvent focusEvent(m_listWidget, QAccessible::Focus);
-        QAccessible::updateAccessibility(&focusEvent);
+    Q_UNUSED(text)
+    // The row current when the announcement is due is the one spoken
+    if (m_announcements.Submit(UIAListCore::Announcement::Selection, UIAListCore::AnnouncementScheduler::Clock::now())) {
+        raiseAnnouncement(UIAListCore::Announcement::Selection);
+    } else {
+        scheduleAnnouncements();
     }
-    
-    // Also announce using Windows SAPI if available
-    // This would require additional Windows-specific screen reader announcement code
-    // For now, we rely on Qt's accessibility framework
 }
 
 void UIAList::announceText(const QString& text)
 {
-    // Set the window title label as accessible name and description for screen readers
-    if (m_windowTitleLabel) {
-        m_windowTitleLabel->setAccessibleName(text);
-        m_windowTitleLabel->setAccessibleDescription(text);
+    m_pendingStatus = text;
+    if (m_announcements.Submit(UIAListCore::Announcement::Status, UIAListCore::AnnouncementScheduler::Clock::now())) {
+        raiseAnnouncement(UIAListCore::Announcement::Status);
+    } else {
+        scheduleAnnouncements();
+    }
+}
+
+void UIAList::raiseAnnouncement(UIAListCore::Announcement kind)
+{
+    UIALIST_TRACE_SPAN("Announce");
+    if (kind == UIAListCore::Announcement::Selection) {
+        // Use QAccessible to announce the selected item to screen readers
+        if (m_listWidget && m_listWidget->currentItem()) {
+            QAccessibleEvent event(m_listWidget, QAccessible::Selection);
+            QAccessible::updateAccessibility(&event);
+            
+            // Also send a focus event to ensure screen readers announce the text
+            QAccessibleEvent focusEvent(m_listWidget, QAccessible::Focus);
+            QAccessible::updateAccessibility(&focusEvent);
+        }
+        return;
+    }
+    
+    // Set the shown label as accessible name and description for screen readers;
+    // while listing that is the overlay's
+    QLabel* label = (m_stackedWidget && m_stackedWidget->currentWidget() == m_loadingWidget) ? m_loadingLabel
+                                                                                             : m_windowTitleLabel;
+    if (label) {
+        label->setAccessibleName(m_pendingStatus);
+        label->setAccessibleDescription(m_pendingStatus);
         
         // Send a focus event to the label to make screen readers announce it
-        QAccessibleEvent labelEvent(m_windowTitleLabel, QAccessible::Focus);
+        QAccessibleEvent labelEvent(label, QAccessible::Focus);
         QAccessible::updateAccessibility(&labelEvent);
         
         // Also send a name changed event
-        QAccessibleEvent nameEvent(m_windowTitleLabel, QAccessible::NameChanged);
+        QAccessibleEvent nameEvent(label, QAccessible::NameChanged);
         QAccessible::updateAccessibility(&nameEvent);
     }
 }
 
+void UIAList::flushAnnouncements()
+{
+    // Status first, so the row read after it is the last thing heard
+    for (UIAListCore::Announcement kind : m_announcements.TakeDue(UIAListCore::AnnouncementScheduler::Clock::now())) {
+        raiseAnnouncement(kind);
+    }
+    scheduleAnnouncements();
+}
+
+void UIAList::scheduleAnnouncements()
+{
+    using Clock = UIAListCore::AnnouncementScheduler::Clock;
+    Clock::time_point due = m_announcements.NextDue();
+    if (due == Clock::time_point::max()) {
+        m_announceTimer->stop();
+        return;
+    }
+    
+    // Rounded up: a timer firing early would find nothing due
+    auto wait = std::chrono::ceil<std::chrono::milliseconds>(due - Clock::now());
+    m_announceTimer->start(static_cast<int>(std::max<int64_t>(0, wait.count())));
+}
+
 void UIAList::keyPressEvent(QKeyEvent *event)
 {
     if (event->key() == Qt::Key_Escape) {
@@ -681,6 +1757,31 @@ void UIAList::focusOutEvent(QFocusEvent *event)
     hide();
 }
 
+void UIAList::hideEvent(QHideEvent *event)
+{
+    QMainWindow::hideEvent(event);
+    
+    // Nothing left to read once the list is gone, nor to keep current
+    m_announcements.Cancel();
+    m_announceTimer->stop();
+    m_progressTimer->stop();
+    stopLiveUpdates();
+    
+    // The list is rebuilt on the next show; until then it only costs memory
+    UIAListCore::MemoryBudget& budget = UIAListCore::MemoryBudget::Instance();
+    if (m_snapshotId) {
+        budget.SetVisible(m_snapshotId, false);
+    }
+    if (size_t evicted = budget.Enforce()) {
+        UIALIST_LOG(Info, "Memory budget evicted {} hidden snapshots", evicted);
+    }
+    
+    int idleTrimSeconds = UIAListCore::SettingsStore::Instance().Get()->IdleTrimSeconds;
+    if (idleTrimSeconds > 0) {
+        m_idleTrimTimer->start(idleTrimSeconds * 1000);
+    }
+}
+
 bool UIAList::event(QEvent *event)
 {
     if (event->type() == QEvent::WindowDeactivate) {
@@ -695,286 +1796,97 @@ void UIAList::onClickButtonClicked()
 {
     ensureItemSelected();
     clickSelectedControl();
-    hide();
 }
 
 void UIAList::onFocusButtonClicked()
 {
     ensureItemSelected();
     focusSelectedControl();
-    hide();
 }
 
 void UIAList::onDoubleClickButtonClicked()
 {
     ensureItemSelected();
     doubleClickSelectedControl();
-    hide();
 }
 
 void UIAList::clickSelectedControl()
 {
-    QList<QListWidgetItem*> selectedItems = m_listWidget->selectedItems();
-    if (selectedItems.isEmpty()) {
-        qDebug() << "No control selected";
+    ControlInfo controlInfo;
+    if (!selectedControlInfo(controlInfo)) {
         return;
     }
     
-    QListWidgetItem* selectedItem = selectedItems.first();
-    int index = selectedItem->data(Qt::UserRole).toInt();
-    
-    if (index >= 0 && index < m_allControls.size()) {
-        const ControlInfo& controlInfo = m_allControls[index];
-        IUIAutomationElement* element = controlInfo.element;
-        
-        if (element) {
-            qDebug() << "Attempting to click control:" << controlInfo.displayText;
-            
-            // Method 1: Try to get bounding rectangle and simulate mouse click
-            RECT rect;
-            HRESULT hr = element->get_CurrentBoundingRectangle(&rect);
-            if (SUCCEEDED(hr)) {
-                int x = rect.left + (rect.right - rect.left) / 2;
-                int y = rect.top + (rect.bottom - rect.top) / 2;
-                
-                qDebug() << "Attempting mouse click at coordinates:" << x << "," << y;
-                
-                // Use Windows API to simulate mouse click
-                SetCursorPos(x, y);
-                Sleep(50); // Small delay for stability
-                mouse_event(MOUSEEVENTF_LEFTDOWN, 0, 0, 0, 0);
-                mouse_event(MOUSEEVENTF_LEFTUP, 0, 0, 0, 0);
-                
-                qDebug() << "Successfully clicked control via mouse simulation:" << controlInfo.displayText;
-                return;
-            }
-            
-            // Method 2: Try to invoke the element (for buttons, etc.)
-            IUIAutomationInvokePattern* invokePattern = nullptr;
-            hr = element->GetCurrentPatternAs(UIA_InvokePatternId, __uuidof(IUIAutomationInvokePattern), (void**)&invokePattern);
-            
-            if (SUCCEEDED(hr) && invokePattern) {
-                qDebug() << "Trying invoke pattern";
-                hr = invokePattern->Invoke();
-                invokePattern->Release();
-                if (SUCCEEDED(hr)) {
-                    qDebug() << "Successfully invoked control:" << controlInfo.displayText;
-                    return;
-                } else {
-                    qDebug() << "Invoke pattern failed with HRESULT:" << hr;
-                }
-            }
-            
-            // Method 3: Try legacy action (for older controls)
-            IUIAutomationLegacyIAccessiblePattern* legacyPattern = nullptr;
-            hr = element->GetCurrentPatternAs(UIA_LegacyIAccessiblePatternId, __uuidof(IUIAutomationLegacyIAccessiblePattern), (void**)&legacyPattern);
-            
-            if (SUCCEEDED(hr) && legacyPattern) {
-                qDebug() << "Trying legacy accessible pattern";
-                hr = legacyPattern->DoDefaultAction();
-                legacyPattern->Release();
-                if (SUCCEEDED(hr)) {
-                    qDebug() << "Successfully clicked control via legacy pattern:" << controlInfo.displayText;
-                    return;
-                } else {
-                    qDebug() << "Legacy pattern failed with HRESULT:" << hr;
-                }
-            }
-            
-            // Method 4: Try selection pattern for list items
-            IUIAutomationSelectionItemPattern* selectionPattern = nullptr;
-            hr = element->GetCurrentPatternAs(UIA_SelectionItemPatternId, __uuidof(IUIAutomationSelectionItemPattern), (void**)&selectionPattern);
-            
-            if (SUCCEEDED(hr) && selectionPattern) {
-                qDebug() << "Trying selection item pattern";
-                hr = selectionPattern->Select();
-                selectionPattern->Release();
-                if (SUCCEEDED(hr)) {
-                    qDebug() << "Successfully selected control:" << controlInfo.displayText;
-                    return;
-                } else {
-                    qDebug() << "Selection pattern failed with HRESULT:" << hr;
-                }
-            }
-            
-            qDebug() << "All click methods failed for control:" << controlInfo.displayText;
-        }
-    }
+    runAction(tr("click"), controlInfo, UIAListCore::ActionKind::Click);
 }
 
 void UIAList::focusSelectedControl()
 {
-    QList<QListWidgetItem*> selectedItems = m_listWidget->selectedItems();
-    if (selectedItems.isEmpty()) {
-        qDebug() << "No control selected";
+    ControlInfo controlInfo;
+    if (!selectedControlInfo(controlInfo)) {
         return;
     }
     
-    QListWidgetItem* selectedItem = selectedItems.first();
-    int index = selectedItem->data(Qt::UserRole).toInt();
-    
-    if (index >= 0 && index < m_allControls.size()) {
-        const ControlInfo& controlInfo = m_allControls[index];
-        IUIAutomationElement* element = controlInfo.element;
-        
-        if (element) {
-            qDebug() << "Attempting to focus control:" << controlInfo.displayText;
-            
-            // Method 1: Use UI Automation SetFocus
-            HRESULT hr = element->SetFocus();
-            if (SUCCEEDED(hr)) {
-                qDebug() << "Successfully focused control via SetFocus:" << controlInfo.displayText;
-                return;
-            } else {
-                qDebug() << "SetFocus failed with HRESULT:" << hr;
-            }
-            
-            // Method 2: Try to get bounding rectangle and click to focus
-            RECT rect;
-            hr = element->get_CurrentBoundingRectangle(&rect);
-            if (SUCCEEDED(hr)) {
-                int x = rect.left + (rect.right - rect.left) / 2;
-                int y = rect.top + (rect.bottom - rect.top) / 2;
-                
-                qDebug() << "Attempting focus via mouse click at coordinates:" << x << "," << y;
-                
-                // Click on the control to give it focus
-                SetCursorPos(x, y);
-                Sleep(50);
-                mouse_event(MOUSEEVENTF_LEFTDOWN, 0, 0, 0, 0);
-                mouse_event(MOUSEEVENTF_LEFTUP, 0, 0, 0, 0);
-                
-                qDebug() << "Successfully focused control via mouse click:" << controlInfo.displayText;
-                return;
-            }
-            
-            // Method 3: Try to use keyboard navigation to focus (Tab key simulation)
-            qDebug() << "Trying keyboard Tab navigation to focus";
-            
-            // Get current focused element to compare
-            IUIAutomationElement* currentFocus = nullptr;
-            m_uiAutomation->GetFocusedElement(&currentFocus);
-            
-            // Send Tab key to try to navigate to the control
-            // This is a simplified approach - in practice you'd need more sophisticated navigation
-            keybd_event(VK_TAB, 0, 0, 0);
-            keybd_event(VK_TAB, 0, KEYEVENTF_KEYUP, 0);
-            
-            Sleep(100); // Give time for focus to change
-            
-            IUIAutomationElement* newFocus = nullptr;
-            m_uiAutomation->GetFocusedElement(&newFocus);
-            
-            if (currentFocus) currentFocus->Release();
-            if (newFocus) {
-                qDebug() << "Tab navigation attempted";
-                newFocus->Release();
-            }
-            
-            qDebug() << "All focus methods failed for control:" << controlInfo.displayText;
-        }
-    }
+    runAction(tr("focus"), controlInfo, UIAListCore::ActionKind::Focus);
 }
 
 void UIAList::doubleClickSelectedControl()
 {
-    QList<QListWidgetItem*> selectedItems = m_listWidget->selectedItems();
-    if (selectedItems.isEmpty()) {
-        qDebug() << "No control selected";
+    ControlInfo controlInfo;
+    if (!selectedControlInfo(controlInfo)) {
         return;
     }
     
-    QListWidgetItem* selectedItem = selectedItems.first();
+    runAction(tr("double click"), controlInfo, UIAListCore::ActionKind::DoubleClick);
+}
+
+bool UIAList::selectedControlInfo(ControlInfo& controlInfo)
+{
+    QListWidgetItem* selectedItem = m_listWidget->currentItem();
+    if (!selectedItem || !selectedItem->isSelected()) {
+        UIALIST_LOG(Debug, "No control selected");
+        return false;
+    }
+    
     int index = selectedItem->data(Qt::UserRole).toInt();
     
-    if (index >= 0 && index < m_allControls.size()) {
-        const ControlInfo& controlInfo = m_allControls[index];
-        IUIAutomationElement* element = controlInfo.element;
-        
-        if (element) {
-            qDebug() << "Attempting to double-click control:" << controlInfo.displayText;
-            
-            // Method 1: Try to get bounding rectangle and simulate mouse double-click
-            RECT rect;
-            HRESULT hr = element->get_CurrentBoundingRectangle(&rect);
-            if (SUCCEEDED(hr)) {
-                int x = rect.left + (rect.right - rect.left) / 2;
-                int y = rect.top + (rect.bottom - rect.top) / 2;
-                
-                qDebug() << "Attempting mouse double-click at coordinates:" << x << "," << y;
-                
-                // Use Windows API to simulate mouse double-click
-                SetCursorPos(x, y);
-                Sleep(50);
-                mouse_event(MOUSEEVENTF_LEFTDOWN, 0, 0, 0, 0);
-                mouse_event(MOUSEEVENTF_LEFTUP, 0, 0, 0, 0);
-                Sleep(50); // Brief pause between clicks
-                mouse_event(MOUSEEVENTF_LEFTDOWN, 0, 0, 0, 0);
-                mouse_event(MOUSEEVENTF_LEFTUP, 0, 0, 0, 0);
-                
-                qDebug() << "Successfully double-clicked control via mouse simulation:" << controlInfo.displayText;
-                return;
-            }
-            
-            // Method 2: For double click, we can use the Toggle pattern for checkboxes/radio buttons
-            IUIAutomationTogglePattern* togglePattern = nullptr;
-            hr = element->GetCurrentPatternAs(UIA_TogglePatternId, __uuidof(IUIAutomationTogglePattern), (void**)&togglePattern);
-            
-            if (SUCCEEDED(hr) && togglePattern) {
-                qDebug() << "Trying toggle pattern";
-                hr = togglePattern->Toggle();
-                togglePattern->Release();
-                if (SUCCEEDED(hr)) {
-                    qDebug() << "Successfully toggled control:" << controlInfo.displayText;
-                    return;
-                } else {
-                    qDebug() << "Toggle pattern failed with HRESULT:" << hr;
-                }
-            }
-            
-            // Method 3: Try double click via legacy pattern
-            IUIAutomationLegacyIAccessiblePattern* legacyPattern = nullptr;
-            hr = element->GetCurrentPatternAs(UIA_LegacyIAccessiblePatternId, __uuidof(IUIAutomationLegacyIAccessiblePattern), (void**)&legacyPattern);
-            
-            if (SUCCEEDED(hr) && legacyPattern) {
-                qDebug() << "Trying legacy accessible double-click";
-                // Simulate double click by calling DoDefaultAction twice
-                hr = legacyPattern->DoDefaultAction();
-                if (SUCCEEDED(hr)) {
-                    Sleep(50);
-                    legacyPattern->DoDefaultAction();
-                }
-                legacyPattern->Release();
-                if (SUCCEEDED(hr)) {
-                    qDebug() << "Successfully double-clicked control via legacy pattern:" << controlInfo.displayText;
-                    return;
-                } else {
-                    qDebug() << "Legacy double-click failed with HRESULT:" << hr;
-                }
-            }
-            
-            // Method 4: Fallback - try regular invoke pattern twice
-            IUIAutomationInvokePattern* invokePattern = nullptr;
-            hr = element->GetCurrentPatternAs(UIA_InvokePatternId, __uuidof(IUIAutomationInvokePattern), (void**)&invokePattern);
-            
-            if (SUCCEEDED(hr) && invokePattern) {
-                qDebug() << "Trying double invoke pattern";
-                hr = invokePattern->Invoke();
-                if (SUCCEEDED(hr)) {
-                    Sleep(50);
-                    invokePattern->Invoke(); // Second invoke for double click
-                }
-                invokePattern->Release();
-                if (SUCCEEDED(hr)) {
-                    qDebug() << "Successfully double-invoked control:" << controlInfo.displayText;
-                    return;
-                } else {
-                    qDebug() << "Double invoke failed with HRESULT:" << hr;
-                }
-            }
-            
-            qDebug() << "All double-click methods failed for control:" << controlInfo.displayText;
-        }
+    if (index < 0 || index >= m_allControls.size()) {
+        return false;
+    }
+    
+    controlInfo = m_allControls[index];
+    // Restored controls have no element yet, ensureLiveControl resolves their locator
+    return controlInfo.element || !controlInfo.locator.IsEmpty();
+}
+
+void UIAList::runAction(const QString& actionName, const ControlInfo& controlInfo, UIAListCore::ActionKind kind)
+{
+    // Hide immediately; a busy target application must not freeze this window
+    hide();
+    
+    int timeoutMs = UIAListCore::SettingsStore::Instance().Get()->ActionTimeoutMs;
+    QString controlName = controlInfo.displayText;
+    
+    // ~ActionExecutor waits for a completion that is under way, so the
+    // callback may use this; the action itself may not
+    m_actionExecutor->Submit(controlAction(m_uiAutomation, controlInfo, kind), std::chrono::milliseconds(timeoutMs),
+        [this, actionName, controlName](UIAListCore::ActionResult result) {
+            // Back to the UI thread to announce the result
+            QMetaObject::invokeMethod(this, [this, actionName, controlName, result]() {
+                announceActionResult(actionName, controlName, result);
+            }, Qt::QueuedConnection);
+        });
+}
+
+void UIAList::announceActionResult(const QString& actionName, const QString& controlName, UIAListCore::ActionResult result)
+{
+    UIALIST_LOG(Info, "Action {} on {} finished: {}", logText(actionName), logText(controlName), UIAListCore::ToString(result));
+    
+    // Success speaks for itself in the target application
+    if (result == UIAListCore::ActionResult::TimedOut) {
+        m_trayIcon->showMessage(tr("UIAList"), tr("The application did not respond to %1 on %2").arg(actionName, controlName));
+    } else if (result == UIAListCore::ActionResult::Failed) {
+        m_trayIcon->showMessage(tr("UIAList"), tr("Could not %1 %2").arg(actionName, controlName));
     }
 }
 
@@ -1023,7 +1935,7 @@ void UIAList::updateButtonStates()
 
 void UIAList::executeDefaultAction()
 {
-    int defaultAction = m_settings->value("defaultAction", 0).toInt(); // 0 = Click by default
+    int defaultAction = UIAListCore::SettingsStore::Instance().Get()->DefaultAction; // 0 = Click by default
     
     switch (defaultAction) {
         case 0: // Click
@@ -1043,7 +1955,7 @@ void UIAList::executeDefaultAction()
 
 void UIAList::checkAndShowWelcome()
 {
-    bool welcomeShown = m_settings->value("welcomeShown", false).toBool();
+    bool welcomeShown = UIAListCore::SettingsStore::Instance().Get()->WelcomeShown;
     
     if (!welcomeShown) {
         // Show welcome dialog on first run
@@ -1060,120 +1972,180 @@ void UIAList::showWelcomeScreen()
 }
 
 // ControlEnumerationWorker implementation
-ControlEnumerationWorker::ControlEnumerationWorker(IUIAutomation* uiAutomation, IUIAutomationTreeWalker* walker, void* windowHandle)
-    : m_uiAutomation(uiAutomation), m_walker(walker), m_windowHandle(windowHandle), m_cancelled(false)
+ControlEnumerationWorker::ControlEnumerationWorker(IUIAutomation* uiAutomation, void* windowHandle,
+                                                   std::shared_ptr<UIAListCore::EnumerationProgress> progress)
+    : m_uiAutomation(uiAutomation), m_progress(std::move(progress)), m_found(0), m_lastRing(0), m_scoped(false),
+      m_scopeDepth(-1), m_comInitialized(false), m_windowHandle(windowHandle), m_cancelled(false)
 {
 }
 
+void ControlEnumerationWorker::setScope(int maxDepth)
+{
+    m_scoped = true;
+    m_scopeDepth = maxDepth;
+}
+
 void ControlEnumerationWorker::enumerateControls()
 {
-    // Initialize COM for this thread
+    UIALIST_TRACE_SPAN("EnumerateControls");
+    
+    // Initialize COM for this thread, until it finishes: the walker is kept for widenScope
     HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
-    if (FAILED(hr)) {
-        emit enumerationCancelled();
-        return;
-    }
-
+    m_comInitialized = SUCCEEDED(hr);
+    
+    // Before the list's window takes the focus, see UIAList::startEnumeration
     HWND targetWindow = (HWND)m_windowHandle;
-    if (!targetWindow) {
+    if (m_comInitialized && m_uiAutomation && targetWindow) {
+        m_provider = std::make_unique<UIAListCore::UiaTreeProvider>(m_uiAutomation, targetWindow);
+        m_provider->NoteFocus();
+    }
+    m_focusNoted.release();
+    
+    if (!m_provider) {
         emit enumerationCancelled();
-        CoUninitialize();
         return;
     }
 
     // Get window title
     wchar_t windowTitle[256];
     GetWindowTextW(targetWindow, windowTitle, 256);
-    QString windowTitleStr = QString::fromWCharArray(windowTitle);
-    if (windowTitleStr.isEmpty()) {
-        windowTitleStr = "Untitled Window";
+    m_windowTitle = QString::fromWCharArray(windowTitle);
+    if (m_windowTitle.isEmpty()) {
+        m_windowTitle = "Untitled Window";
     }
 
-    // Validate UI Automation objects
-    if (!m_uiAutomation || !m_walker) {
-        emit enumerationCancelled();
-        CoUninitialize();
-        return;
+    // The listed properties travel with each navigation call
+    m_walker = std::make_unique<UIAListCore::ControlWalker>(*m_provider, UIAListCore::WalkMode::BuildCache,
+                                                            listedProperties);
+    m_stats = UIAListCore::EnumerationStatsCollector();
+    m_walker->SetStats(&m_stats);
+    m_walker->SetProgress(m_progress.get());
+    if (m_scoped) {
+        m_walker->SetScoped(true, m_scopeDepth >= 0 ? static_cast<size_t>(m_scopeDepth) : SIZE_MAX);
     }
-
-    // Get UI Automation element for the target window
-    IUIAutomationElement* rootElement = nullptr;
-    hr = m_uiAutomation->ElementFromHandle(targetWindow, &rootElement);
-    if (FAILED(hr) || !rootElement) {
+    m_locators = std::make_unique<UIAListCore::UiaLocatorStack>(targetWindow);
+    m_progress->Start();
+
+    // Outward from the focus when it is in the window, else from the window
+    if (!m_walker->WalkOutward([this](UIAListCore::TreeElement& element, const UIAListCore::ElementProperties& properties, size_t depth) {
+            onElement(element, properties, depth);
+        }, [this](const UIAListCore::ControlWalker::Ring& ring) {
+            onRing(ring);
+        }, &m_cancelled)) {
         emit enumerationCancelled();
-        CoUninitialize();
         return;
     }
-
-    // Walk through all controls
-    walkControls(rootElement, m_walker);
-
-    rootElement->Release();
-
-    // Check if cancelled before emitting finished
-    QMutexLocker locker(&m_cancelMutex);
-    if (!m_cancelled) {
-        emit enumerationFinished(windowTitleStr);
+    
+    finishWalk();
+    
+    // Statistics are of whole windows
+    if (!m_cancelled && !m_scoped) {
+        recordStats(targetWindow);
     }
+}
 
-    CoUninitialize();
+void ControlEnumerationWorker::widenScope(int found)
+{
+    UIALIST_TRACE_SPAN("WidenScope");
+    
+    // Numbered on from the list shown
+    m_cancelled = false;
+    m_found = found;
+    if (!m_walker || m_walker->Complete() ||
+        !UIAListCore::ElementLocator::IsAlive(
+            static_cast<UIAListCore::UiaTreeElement&>(m_walker->Ancestor(m_lastRing)).Get())) {
+        emit scopeLost();
+        return;
+    }
+    
+    m_progress->Start();
+    m_walker->Widen([this](UIAListCore::TreeElement& element, const UIAListCore::ElementProperties& properties, size_t depth) {
+        onElement(element, properties, depth);
+    }, [this](const UIAListCore::ControlWalker::Ring& ring) {
+        onRing(ring);
+    }, &m_cancelled);
+    
+    finishWalk();
 }
 
 void ControlEnumerationWorker::cancelEnumeration()
 {
-    QMutexLocker locker(&m_cancelMutex);
     m_cancelled = true;
 }
 
-void ControlEnumerationWorker::walkControls(IUIAutomationElement* element, IUIAutomationTreeWalker* walker)
+void ControlEnumerationWorker::releaseWalker()
 {
-    if (!element || !walker) return;
-
-    // Check if cancelled
-    {
-        QMutexLocker locker(&m_cancelMutex);
-        if (m_cancelled) return;
+    // The elements the walker holds belong to this thread's apartment
+    m_locators.reset();
+    m_walker.reset();
+    m_provider.reset();
+    if (m_comInitialized) {
+        CoUninitialize();
+        m_comInitialized = false;
     }
+}
 
-    // Get control type
-    CONTROLTYPEID controlType;
-    HRESULT hr = element->get_CurrentControlType(&controlType);
-    if (FAILED(hr)) return;
-
-    // Get control name
-    BSTR name = nullptr;
-    element->get_CurrentName(&name);
-    QString controlName = name ? QString::fromWCharArray(name) : QString("(no name)");
-    if (name) SysFreeString(name);
-
-    // Get control type string
-    QString controlTypeStr = getControlTypeString(controlType);
-
-    // Create display text
-    QString displayText = QString("%1: %2").arg(controlTypeStr, controlName);
+void ControlEnumerationWorker::onElement(UIAListCore::TreeElement& element, const UIAListCore::ElementProperties& properties,
+                                         size_t depth)
+{
+    IUIAutomationElement* uiaElement = static_cast<UIAListCore::UiaTreeElement&>(element).Get();
+    const UIAListCore::ElementLocator& locator = m_locators->Visit(*m_walker, uiaElement, depth);
+    
+    QString controlName = properties.HasName ? QString::fromStdWString(properties.Name) : QString("(no name)");
+    QString displayText = QString("%1: %2").arg(getControlTypeString(properties.ControlType), controlName);
+    emit controlFound(displayText, controlName, uiaElement, static_cast<int>(properties.ControlType),
+                      properties.Capabilities, locator);
+    ++m_found;
+}
 
-    // Emit the control found signal
-    emit controlFound(displayText, controlName, element, static_cast<int>(controlType));
+void ControlEnumerationWorker::onRing(const UIAListCore::ControlWalker::Ring& ring)
+{
+    m_lastRing = ring.Index;
+    
+    // A walk from the window is a single ring, listed when it is finished
+    if (m_walker->AncestorCount() == 0) {
+        return;
+    }
+    emit ringCompleted(m_found - static_cast<int>(ring.Count), static_cast<int>(ring.Count), static_cast<int>(ring.InnerAt));
+}
 
-    // Walk child elements
-    IUIAutomationElement* child = nullptr;
-    hr = walker->GetFirstChildElement(element, &child);
-    while (SUCCEEDED(hr) && child) {
-        // Check if cancelled before processing child
-        {
-            QMutexLocker locker(&m_cancelMutex);
-            if (m_cancelled) {
-                child->Release();
-                return;
-            }
+void ControlEnumerationWorker::finishWalk()
+{
+    if (m_cancelled) {
+        return;
+    }
+    
+    // A quick list ends at the nearest pane, group, dialog or document
+    if (m_scoped && !m_walker->Complete()) {
+        const UIAListCore::ElementProperties& properties = m_walker->AncestorProperties(m_lastRing);
+        QString description = getControlTypeString(properties.ControlType);
+        if (!properties.Name.empty()) {
+            description += QString(" %1").arg(QString::fromStdWString(properties.Name));
         }
+        
+        IUIAutomationElement* scope = static_cast<UIAListCore::UiaTreeElement&>(m_walker->Ancestor(m_lastRing)).Get();
+        scope->AddRef();
+        emit scopeReached(scope, description);
+    }
+    
+    emit enumerationFinished(m_windowTitle);
+}
 
-        walkControls(child, walker);
-
-        IUIAutomationElement* nextChild = nullptr;
-        hr = walker->GetNextSiblingElement(child, &nextChild);
-        child->Release();
-        child = nextChild;
+void ControlEnumerationWorker::recordStats(HWND targetWindow)
+{
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    if (directory.isEmpty() || !QDir().mkpath(directory)) {
+        return;
+    }
+    
+    std::string image = UIAListCore::UiaTreeProvider::ProcessImageName(targetWindow);
+    UIAListCore::EnumerationRecord record = m_stats.Finish(image.empty() ? std::string("(unknown)") : image,
+                                                           UIAListCore::ToString(UIAListCore::WalkMode::BuildCache),
+                                                           m_provider->Calls());
+    
+    UIAListCore::EnumerationStatsLog log(QDir(directory).filePath("enumeration-stats.log").toStdWString());
+    if (!log.Append(record)) {
+        qDebug() << "Could not write enumeration statistics to" << directory;
     }
 }
 
@@ -1223,4 +2195,397 @@ QString ControlEnumerationWorker::getControlTypeString(int controlType)
     }
 }
 
+// Posts the target window's structure and name changes to the watcher's queue.
+// UI Automation calls it on its own threads; it only reads the cached runtime id.
+class LiveChangeHandler : public IUIAutomationStructureChangedEventHandler, public IUIAutomationPropertyChangedEventHandler
+{
+public:
+    explicit LiveChangeHandler(std::shared_ptr<UIAListCore::TreeUpdateQueue> queue)
+        : m_refCount(1), m_queue(std::move(queue))
+    {
+    }
+    
+    // IUnknown
+    ULONG STDMETHODCALLTYPE AddRef() override
+    {
+        return InterlockedIncrement(&m_refCount);
+    }
+    
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        ULONG refCount = InterlockedDecrement(&m_refCount);
+        if (refCount == 0) delete this;
+        return refCount;
+    }
+    
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override
+    {
+        if (!ppv) return E_POINTER;
+        
+        if (riid == __uuidof(IUnknown) || riid == __uuidof(IUIAutomationStructureChangedEventHandler)) {
+            *ppv = static_cast<IUIAutomationStructureChangedEventHandler*>(this);
+        } else if (riid == __uuidof(IUIAutomationPropertyChangedEventHandler)) {
+            *ppv = static_cast<IUIAutomationPropertyChangedEventHandler*>(this);
+        } else {
+            *ppv = nullptr;
+            return E_NOINTERFACE;
+        }
+        
+        AddRef();
+        return S_OK;
+    }
+    
+    // IUIAutomationStructureChangedEventHandler: the sender is the parent whose
+    // children changed, or for ChildAdded the new child; the watcher sorts it out
+    HRESULT STDMETHODCALLTYPE HandleStructureChangedEvent(IUIAutomationElement* sender, StructureChangeType, SAFEARRAY*) override
+    {
+        post(sender, UIAListCore::TreeChangeStructure);
+        return S_OK;
+    }
+    
+    // IUIAutomationPropertyChangedEventHandler, for the name only
+    HRESULT STDMETHODCALLTYPE HandlePropertyChangedEvent(IUIAutomationElement* sender, PROPERTYID, VARIANT) override
+    {
+        post(sender, UIAListCore::TreeChangeName);
+        return S_OK;
+    }
+    
+private:
+    ~LiveChangeHandler() = default;
+    
+    void post(IUIAutomationElement* sender, uint32_t changes)
+    {
+        if (!sender) return;
+        sender->AddRef();
+        m_queue->Post(UIAListCore::ElementLocator::CachedRuntimeId(sender), changes,
+                      std::make_shared<UIAListCore::UiaTreeElement>(sender));
+    }
+    
+    LONG m_refCount;
+    std::shared_ptr<UIAListCore::TreeUpdateQueue> m_queue;
+};
+
+// A row of the list, as the enumeration lists it (UIAList::onControlFound)
+static ControlInfo listedControl(IUIAutomationElement* element, const UIAListCore::ElementProperties& properties,
+                                 const UIAListCore::ElementLocator& locator)
+{
+    QString controlName = properties.HasName ? QString::fromStdWString(properties.Name) : QString("(no name)");
+    QString displayText = QString("%1: %2").arg(ControlEnumerationWorker::getControlTypeString(properties.ControlType),
+                                                controlName);
+    ControlInfo controlInfo(displayText, controlName, element, static_cast<CONTROLTYPEID>(properties.ControlType));
+    controlInfo.capabilities = properties.Capabilities;
+    controlInfo.locator = locator;
+    controlInfo.bounds = cachedBounds(element);
+    return controlInfo;
+}
+
+LiveTreeWatcher::LiveTreeWatcher(IUIAutomation* uiAutomation, void* windowHandle)
+    : m_uiAutomation(uiAutomation), m_root(nullptr), m_handler(nullptr), m_windowHandle(windowHandle), m_queue(std::make_shared<UIAListCore::TreeUpdateQueue>()), m_generation(0),
+      m_stopped(false), m_indexedGeneration(0)
+{
+}
+
+LiveTreeWatcher::~LiveTreeWatcher()
+{
+    unsubscribe();
+}
+
+void LiveTreeWatcher::setList(quint64 generation, const QList<UIAListCore::ElementLocator>& locators)
+{
+    QMutexLocker locker(&m_listMutex);
+    m_generation = generation;
+    m_locators = locators;
+    m_listChanged.wakeAll();
+}
+
+void LiveTreeWatcher::stop()
+{
+    {
+        QMutexLocker locker(&m_listMutex);
+        m_stopped = true;
+        m_listChanged.wakeAll();
+    }
+    m_queue->Close();
+}
+
+void LiveTreeWatcher::watch()
+{
+    // Event handlers are added and removed off the UI thread, in the MTA
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    if (FAILED(hr)) {
+        return;
+    }
+    
+    if (subscribe()) {
+        UIAListCore::TreeUpdateQueue::Batch batch;
+        quint64 spliced = 0; // Generation of the list the last splices were made for
+        while (waitForList(spliced) && m_queue->Wait(batch)) {
+            UIALIST_TRACE_SPAN("LiveWalk");
+            indexList();
+            QList<LiveSplice> splices = splice(batch);
+            if (stopped()) {
+                break;
+            }
+            if (splices.isEmpty()) {
+                continue; // Nothing the list shows
+            }
+            spliced = m_indexedGeneration;
+            emit subtreesChanged(spliced, splices);
+        }
+        
+        UIAListCore::TreeUpdateQueue::Stats stats = m_queue->GetStats();
+        UIALIST_LOG(Info, "Live updates: {} events in {} batches, {} storms", stats.Events, stats.Batches, stats.WholeTree);
+    }
+    unsubscribe();
+    
+    CoUninitialize();
+}
+
+bool LiveTreeWatcher::subscribe()
+{
+    // Changed subtrees are walked as the enumeration walks the window, with its cache request
+    m_provider = std::make_unique<UIAListCore::UiaTreeProvider>(m_uiAutomation, (HWND)m_windowHandle);
+    m_walker = std::make_unique<UIAListCore::ControlWalker>(*m_provider, UIAListCore::WalkMode::BuildCache,
+                                                            listedProperties);
+    UIAListCore::CacheRequest request;
+    request.Properties = listedProperties;
+    if (!m_provider->SetCacheRequest(request)) {
+        return false;
+    }
+    IUIAutomationCacheRequest* cacheRequest = m_provider->GetCacheRequest();
+    
+    std::unique_ptr<UIAListCore::TreeElement> root = m_provider->Root();
+    if (!root) {
+        return false;
+    }
+    m_root = static_cast<UIAListCore::UiaTreeElement&>(*root).Get();
+    m_root->AddRef();
+    
+    // Senders come with a row's properties, so posting costs no calls and
+    // a sender is walked from as it is
+    m_handler = new LiveChangeHandler(m_queue);
+    HRESULT hr = m_uiAutomation->AddStructureChangedEventHandler(m_root, TreeScope_Subtree, cacheRequest, m_handler);
+    if (FAILED(hr)) {
+        UIALIST_LOG(Warning, "Cannot watch structure changes: HRESULT {}", UIAListCore::LogArgument::Hex(static_cast<uint32_t>(hr)));
+        return false;
+    }
+    PROPERTYID nameProperty = UIA_NamePropertyId;
+    hr = m_uiAutomation->AddPropertyChangedEventHandlerNativeArray(m_root, TreeScope_Subtree, cacheRequest, m_handler,
+                                                                   &nameProperty, 1);
+    if (FAILED(hr)) {
+        UIALIST_LOG(Warning, "Cannot watch name changes: HRESULT {}", UIAListCore::LogArgument::Hex(static_cast<uint32_t>(hr)));
+    }
+    return true;
+}
+
+void LiveTreeWatcher::unsubscribe()
+{
+    // Blocks until handler calls in progress returned
+    if (m_handler && m_root) {
+        m_uiAutomation->RemoveStructureChangedEventHandler(m_root, m_handler);
+        m_uiAutomation->RemovePropertyChangedEventHandler(m_root, m_handler);
+    }
+    if (m_handler) {
+        m_handler->Release();
+        m_handler = nullptr;
+    }
+    if (m_root) {
+        m_root->Release();
+        m_root = nullptr;
+    }
+    m_walker.reset();
+    m_provider.reset();
+}
+
+bool LiveTreeWatcher::waitForList(quint64 generation)
+{
+    // Until the window applied the last splices and sent the list they made
+    QMutexLocker locker(&m_listMutex);
+    while (!m_stopped && m_generation == generation) {
+        m_listChanged.wait(&m_listMutex);
+    }
+    return !m_stopped;
+}
+
+void LiveTreeWatcher::indexList()
+{
+    QList<UIAListCore::ElementLocator> locators;
+    {
+        QMutexLocker locker(&m_listMutex);
+        if (m_indexedGeneration == m_generation) {
+            return;
+        }
+        m_indexedGeneration = m_generation;
+        locators = m_locators;
+    }
+    
+    m_indexedLocators = locators;
+    m_rows.clear();
+    m_depths.clear();
+    m_depths.reserve(locators.size());
+    for (int row = 0; row < locators.size(); ++row) {
+        const UIAListCore::ElementLocator& locator = locators.at(row);
+        m_depths.push_back(static_cast<uint32_t>(locator.Depth()));
+        if (!locator.Id().empty()) {
+            m_rows.emplace(locator.Id(), row);
+        }
+    }
+    
+    // The root window's locator has no runtime id
+    if (!m_depths.empty()) {
+        m_rows.emplace(UIAListCore::ElementLocator::CachedRuntimeId(m_root), 0);
+    }
+}
+
+int LiveTreeWatcher::findRow(IUIAutomationElement* element, bool climb, IUIAutomationElement** found)
+{
+    // Ancestors tried for an element the list does not show yet
+    static const int maxClimb = 16;
+    
+    *found = nullptr;
+    element->AddRef();
+    std::unique_ptr<UIAListCore::TreeElement> current = std::make_unique<UIAListCore::UiaTreeElement>(element);
+    for (int level = 0; current; ++level) {
+        IUIAutomationElement* candidate = static_cast<UIAListCore::UiaTreeElement&>(*current).Get();
+        auto row = m_rows.find(UIAListCore::ElementLocator::CachedRuntimeId(candidate));
+        if (row != m_rows.end()) {
+            candidate->AddRef();
+            *found = candidate;
+            return row->second;
+        }
+        current = climb && level < maxClimb ? m_provider->Parent(*current) : nullptr;
+    }
+    return -1;
+}
+
+QList<LiveSplice> LiveTreeWatcher::splice(const UIAListCore::TreeUpdateQueue::Batch& batch)
+{
+    QList<LiveSplice> splices;
+    if (m_depths.empty()) {
+        return splices;
+    }
+    
+    // Changed rows with the fresh elements the events brought
+    std::map<size_t, IUIAutomationElement*> structure;
+    std::map<size_t, IUIAutomationElement*> names;
+    if (batch.WholeTree) {
+        m_root->AddRef();
+        structure[0] = m_root;
+    }
+    for (const UIAListCore::TreeUpdateQueue::Change& change : batch.Changes) {
+        auto* changed = static_cast<UIAListCore::UiaTreeElement*>(change.Element.get());
+        if (!changed || !changed->Get() || stopped()) {
+            continue;
+        }
+        
+        bool restructured = (change.Changes & UIAListCore::TreeChangeStructure) != 0;
+        IUIAutomationElement* element = nullptr;
+        int row = findRow(changed->Get(), restructured, &element);
+        if (row < 0 && restructured) {
+            // Somewhere the list cannot place: everything
+            row = 0;
+            m_root->AddRef();
+            element = m_root;
+        }
+        if (row < 0) {
+            continue;
+        }
+        
+        std::map<size_t, IUIAutomationElement*>& rows = restructured ? structure : names;
+        if (!rows.emplace(static_cast<size_t>(row), element).second) {
+            element->Release();
+        }
+    }
+    
+    std::vector<size_t> structureRows;
+    for (const auto& [row, element] : structure) {
+        structureRows.push_back(row);
+    }
+    std::vector<size_t> outermost = UIAListCore::OutermostSubtrees(m_depths, structureRows);
+    
+    const QList<UIAListCore::ElementLocator>& locators = m_indexedLocators;
+    const UIAListCore::ElementLocator rootLocator = UIAListCore::ElementLocator::ForWindow((HWND)m_windowHandle);
+    
+    // The nearest row above at one level up
+    auto parentLocator = [&](size_t row) {
+        for (size_t above = row; above-- > 0;) {
+            if (m_depths[above] + 1 == m_depths[row]) {
+                return locators.at(static_cast<int>(above));
+            }
+        }
+        return rootLocator;
+    };
+    
+    size_t walked = 0;
+    for (size_t row : outermost) {
+        if (stopped()) {
+            break;
+        }
+        IUIAutomationElement* element = structure[row];
+        UIAListCore::ElementLocator locator = row == 0 ? rootLocator
+                                                       : UIAListCore::ElementLocator::Capture(element, parentLocator(row));
+        LiveSplice rows;
+        rows.row = static_cast<int>(row);
+        rows.count = static_cast<int>(UIAListCore::SubtreeEnd(m_depths, row) - row);
+        walk(element, locator, rows.controls);
+        walked += rows.controls.size();
+        splices.append(rows);
+    }
+    
+    // Renamed rows a re-walked subtree does not cover
+    for (const auto& [row, element] : names) {
+        auto after = std::upper_bound(outermost.begin(), outermost.end(), row);
+        if (after != outermost.begin() && row < UIAListCore::SubtreeEnd(m_depths, *(after - 1))) {
+            continue;
+        }
+        element->AddRef();
+        UIAListCore::UiaTreeElement renamedElement(element);
+        UIAListCore::ElementProperties properties;
+        if (!m_provider->GetProperties(renamedElement, listedProperties, properties)) {
+            continue;
+        }
+        LiveSplice renamed;
+        renamed.row = static_cast<int>(row);
+        renamed.count = 1;
+        renamed.controls.append(listedControl(element, properties,
+                                              row == 0 ? rootLocator : locators.at(static_cast<int>(row))));
+        splices.append(renamed);
+    }
+    
+    for (const auto& [row, element] : structure) {
+        element->Release();
+    }
+    for (const auto& [row, element] : names) {
+        element->Release();
+    }
+    
+    // Back to front, so applying one leaves the rows of the next in place
+    std::sort(splices.begin(), splices.end(), [](const LiveSplice& a, const LiveSplice& b) { return a.row > b.row; });
+    UIALIST_LOG(Debug, "Live batch of {} events: {} subtrees re-walked ({} controls), {} renamed", batch.Events,
+                outermost.size(), walked, splices.size() - outermost.size());
+    return splices;
+}
+
+void LiveTreeWatcher::walk(IUIAutomationElement* element, const UIAListCore::ElementLocator& locator,
+                           QList<ControlInfo>& controls)
+{
+    // Locators by depth, each captured from its parent's
+    std::vector<UIAListCore::ElementLocator> locators(1, locator);
+    m_provider->SetRoot(element);
+    m_walker->Walk([&](UIAListCore::TreeElement& visited, const UIAListCore::ElementProperties& properties, size_t depth) {
+        IUIAutomationElement* uiaElement = static_cast<UIAListCore::UiaTreeElement&>(visited).Get();
+        locators.resize(depth + 1);
+        if (depth > 0) {
+            locators[depth] = UIAListCore::ElementLocator::Capture(uiaElement, locators[depth - 1]);
+        }
+        controls.append(listedControl(uiaElement, properties, locators[depth]));
+    }, &m_stopped);
+    m_provider->SetRoot(nullptr);
+}
+
+bool LiveTreeWatcher::stopped()
+{
+    return m_stopped;
+}
+
 #include "uialist.moc"
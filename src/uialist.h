@@ -31,46 +31,112 @@
 #include <QString>
 #include <QKeyEvent>
 #include <QFocusEvent>
-#include <QSettings>
 #include <QThread>
 #include <QMutex>
+#include <QWaitCondition>
+#include <QSemaphore>
 #include <QMovie>
 #include <QStackedWidget>
 #include <QProgressBar>
 #include <QTimer>
 
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+
 #include <windows.h>
 #include <uiautomation.h>
 #include <comdef.h>
 
+#include "ActionExecutor.h"
+#include "ActionStrategy.h"
+#include "AnnouncementScheduler.h"
+#include "CallStats.h"
+#include "CompactSnapshot.h"
+#include "ControlWalker.h"
+#include "ElementLocator.h"
+#include "EnumerationProgress.h"
+#include "EnumerationStats.h"
+#include "FilterEngine.h"
+#include "MemoryBudget.h"
+#include "QueryServer.h"
+#include "SettingsStore.h"
+#include "SpatialIndex.h"
+#include "StagedStartup.h"
+#include "TreeUpdateQueue.h"
+#include "UiaTreeProvider.h"
+
 class UIAListIcon;
+class LiveChangeHandler;
 
-// Worker thread for enumerating controls
+// Passed from the enumeration worker to the UI thread
+Q_DECLARE_METATYPE(UIAListCore::ElementLocator)
+
+// Worker thread for enumerating controls, through UIAListCore::ControlWalker
 class ControlEnumerationWorker : public QObject
 {
     Q_OBJECT
 
 public:
-    ControlEnumerationWorker(IUIAutomation* uiAutomation, IUIAutomationTreeWalker* walker, void* windowHandle);
+    ControlEnumerationWorker(IUIAutomation* uiAutomation, void* windowHandle,
+                             std::shared_ptr<UIAListCore::EnumerationProgress> progress);
+    
+    // Before the start: stop at the nearest pane, group, dialog or document
+    // around the focus, leaving out what is more than maxDepth below a
+    // container (-1 all)
+    void setScope(int maxDepth);
+
+    // UI thread: blocks until the worker noted the focused control, at most
+    // timeoutMs; the list's window must not take the focus before
+    bool waitForFocus(int timeoutMs) { return m_focusNoted.tryAcquire(1, timeoutMs); }
 
 public slots:
     void enumerateControls();
+    // After scopeReached: walks on to the next scope, or the window, the
+    // controls numbered on from found
+    void widenScope(int found);
     void cancelEnumeration();
+    // On the worker thread as it finishes
+    void releaseWalker();
 
 signals:
-    void controlFound(const QString& displayText, const QString& originalName, void* element, int controlType);
+    void controlFound(const QString& displayText, const QString& originalName, void* element, int controlType,
+                      uint capabilities, const UIAListCore::ElementLocator& locator);
+    // The controls found since the last ring, see UIAListCore::ControlWalker::WalkOutward
+    void ringCompleted(int first, int count, int innerAt);
     void enumerationFinished(const QString& windowTitle);
     void enumerationCancelled();
+    // Before enumerationFinished, when a scoped walk stopped short of the
+    // window; scope is AddRef'd for the receiver
+    void scopeReached(void* scope, const QString& description);
+    // The scope to widen from is no longer in the window; nothing was walked
+    void scopeLost();
+
+public:
+    static QString getControlTypeString(int controlType);
 
 private:
-    void walkControls(IUIAutomationElement* element, IUIAutomationTreeWalker* walker);
-    QString getControlTypeString(int controlType);
+    void onElement(UIAListCore::TreeElement& element, const UIAListCore::ElementProperties& properties, size_t depth);
+    void onRing(const UIAListCore::ControlWalker::Ring& ring);
+    void finishWalk();
+    void recordStats(HWND targetWindow);
 
     IUIAutomation* m_uiAutomation;
-    IUIAutomationTreeWalker* m_walker;
+    std::unique_ptr<UIAListCore::UiaTreeProvider> m_provider;
+    std::unique_ptr<UIAListCore::ControlWalker> m_walker; // Kept for widenScope
+    std::unique_ptr<UIAListCore::UiaLocatorStack> m_locators;
+    UIAListCore::EnumerationStatsCollector m_stats;
+    std::shared_ptr<UIAListCore::EnumerationProgress> m_progress; // Read by the window's progress timer
+    int m_found; // Controls emitted so far
+    size_t m_lastRing; // Index of the last ring walked
+    bool m_scoped;
+    int m_scopeDepth; // Levels below a scope container walked, -1 all
+    bool m_comInitialized;
+    QString m_windowTitle;
+    QSemaphore m_focusNoted;
     void* m_windowHandle;
-    bool m_cancelled;
-    QMutex m_cancelMutex;
+    std::atomic<bool> m_cancelled;
 };
 
 struct ControlInfo {
@@ -78,10 +144,13 @@ struct ControlInfo {
     QString originalName; // Store the original control name for filtering
     IUIAutomationElement* element;
     CONTROLTYPEID controlType; // Store the control type for filtering
+    UIAListCore::ElementLocator locator; // Finds the control again when element went stale
+    UIAListCore::ElementRect bounds; // Screen rectangle when it was listed, empty when unknown
+    uint32_t capabilities; // Prefetched UIAListCore::Capability bits, CapabilitiesNone when unknown
     
-    ControlInfo() : element(nullptr), controlType(0) {}
+    ControlInfo() : element(nullptr), controlType(0), capabilities(UIAListCore::CapabilitiesNone) {}
     ControlInfo(const QString& text, const QString& name, IUIAutomationElement* elem, CONTROLTYPEID type = 0) 
-        : displayText(text), originalName(name), element(elem), controlType(type) 
+        : displayText(text), originalName(name), element(elem), controlType(type), capabilities(UIAListCore::CapabilitiesNone) 
     {
         if (element) element->AddRef();
     }
@@ -90,7 +159,7 @@ struct ControlInfo {
         if (element) element->Release();
     }
     
-    ControlInfo(const ControlInfo& other) : displayText(other.displayText), originalName(other.originalName), element(other.element), controlType(other.controlType) {
+    ControlInfo(const ControlInfo& other) : displayText(other.displayText), originalName(other.originalName), element(other.element), controlType(other.controlType), locator(other.locator), bounds(other.bounds), capabilities(other.capabilities) {
         if (element) element->AddRef();
     }
     
@@ -101,12 +170,79 @@ struct ControlInfo {
             originalName = other.originalName;
             element = other.element;
             controlType = other.controlType;
+            locator = other.locator;
+            bounds = other.bounds;
+            capabilities = other.capabilities;
             if (element) element->AddRef();
         }
         return *this;
     }
 };
 
+// Rows of the list replaced by a live update: count rows at row become controls
+struct LiveSplice {
+    int row = 0;
+    int count = 0;
+    QList<ControlInfo> controls;
+};
+Q_DECLARE_METATYPE(QList<LiveSplice>)
+
+// Keeps the shown list current while the target window changes: structure
+// and name change events of the window are coalesced in a TreeUpdateQueue
+// and the changed subtrees re-walked here, on a thread of its own, by a
+// ControlWalker reading what the enumeration reads. Runs in
+// watch() until stop(); the list it applies to comes with setList after
+// every change of it, splices for an older list are dropped by the window.
+class LiveTreeWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    LiveTreeWatcher(IUIAutomation* uiAutomation, void* windowHandle);
+    ~LiveTreeWatcher();
+
+    // Any thread
+    void setList(quint64 generation, const QList<UIAListCore::ElementLocator>& locators);
+    void stop();
+
+public slots:
+    void watch();
+
+signals:
+    void subtreesChanged(quint64 generation, const QList<LiveSplice>& splices);
+
+private:
+    bool subscribe();
+    void unsubscribe();
+    bool waitForList(quint64 generation);
+    void indexList();
+    int findRow(IUIAutomationElement* element, bool climb, IUIAutomationElement** found);
+    QList<LiveSplice> splice(const UIAListCore::TreeUpdateQueue::Batch& batch);
+    void walk(IUIAutomationElement* element, const UIAListCore::ElementLocator& locator, QList<ControlInfo>& controls);
+    bool stopped();
+
+    IUIAutomation* m_uiAutomation;
+    std::unique_ptr<UIAListCore::UiaTreeProvider> m_provider; // With the enumeration's cache request
+    std::unique_ptr<UIAListCore::ControlWalker> m_walker;
+    IUIAutomationElement* m_root;
+    LiveChangeHandler* m_handler; // Structure and name changes, posting to m_queue
+    void* m_windowHandle;
+    std::shared_ptr<UIAListCore::TreeUpdateQueue> m_queue;
+
+    // The list as the window last sent it
+    QMutex m_listMutex;
+    QWaitCondition m_listChanged;
+    quint64 m_generation;
+    QList<UIAListCore::ElementLocator> m_locators;
+    std::atomic<bool> m_stopped; // Written under m_listMutex, read by walks too
+    
+    // The list the next splices are made for, on this thread only
+    quint64 m_indexedGeneration;
+    QList<UIAListCore::ElementLocator> m_indexedLocators;
+    std::map<UIAListCore::RuntimeId, int> m_rows;
+    std::vector<uint32_t> m_depths;
+};
+
 class UIAList : public QMainWindow
 {
     Q_OBJECT
@@ -119,42 +255,79 @@ public:
 
 private slots:
     void showWindow(void* foregroundWindow);
+    void showQuickWindow(void* foregroundWindow);
     void onFilterChanged(const QString& text);
     void onItemSelectionChanged();
     void onHideEmptyTitlesChanged(bool checked);
     void onHideMenusChanged(bool checked);
+    void onReadingOrderChanged(bool checked);
     void onClickButtonClicked();
     void onFocusButtonClicked();
     void onDoubleClickButtonClicked();
-    void onControlFound(const QString& displayText, const QString& originalName, void* element, int controlType);
+    void onWidenButtonClicked();
+    void onControlFound(const QString& displayText, const QString& originalName, void* element, int controlType,
+                        uint capabilities, const UIAListCore::ElementLocator& locator);
+    void onRingCompleted(int first, int count, int innerAt);
     void onEnumerationFinished(const QString& windowTitle);
     void onEnumerationCancelled();
+    void onScopeReached(void* scope, const QString& description);
+    void onScopeLost();
     void onCancelButtonClicked();
+    void updateProgress();
+    void onSubtreesChanged(quint64 generation, const QList<LiveSplice>& splices);
 
 protected:
     bool eventFilter(QObject *obj, QEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     void focusOutEvent(QFocusEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
     bool event(QEvent *event) override;
 
 private:
     void setupUI();
     void setupLoadingOverlay();
+    void ensureWindowCreated();
+    void applySettings(const UIAListCore::Settings& settings);
     void initializeUIAutomation();
+    bool waitForAutomation();
     void checkAndShowWelcome();
-    void startEnumeration(void* windowHandle);
+    void openWindow(void* foregroundWindow, bool quick);
+    void startEnumeration(void* windowHandle, bool quick = false);
+    void widenEnumeration();
+    void releaseScope();
     void showLoadingOverlay();
     void hideLoadingOverlay();
+    void stopProgress();
     void walkControls(IUIAutomationElement* element, IUIAutomationTreeWalker* walker);
     QString getControlTypeString(CONTROLTYPEID controlType);
-    void populateListWidget();
+    void populateListWidget(bool selectBest = true);
+    QListWidgetItem* newListItem(int index) const;
+    void replaceControls(QList<ControlInfo> controls);
+    void spliceControls(const LiveSplice& splice);
+    QList<ControlInfo> incomingInTreeOrder() const;
+    void accountSnapshot(bool controlsChanged);
+    void releaseSnapshot();
+    void publishSnapshot();
+    UIAListCore::QueryStatus invokeServedControl(uint64_t window, uint32_t index, UIAListCore::ActionKind action);
+    UIAListCore::MemoryUsage controlsMemoryUsage() const;
+    void trimIdle();
+    bool restoreCompactSnapshot(void* windowHandle);
+    void dropCompactSnapshot();
     void cleanupUIAutomation();
+    void startLiveUpdates();
+    void stopLiveUpdates();
     void selectVisibleListItem(int direction);
     void announceSelectedItem(const QString& text);
     void announceText(const QString& text);
+    void raiseAnnouncement(UIAListCore::Announcement kind);
+    void flushAnnouncements();
+    void scheduleAnnouncements();
     void clickSelectedControl();
     void focusSelectedControl();
     void doubleClickSelectedControl();
+    bool selectedControlInfo(ControlInfo& controlInfo);
+    void runAction(const QString& actionName, const ControlInfo& controlInfo, UIAListCore::ActionKind kind);
+    void announceActionResult(const QString& actionName, const QString& controlName, UIAListCore::ActionResult result);
     void ensureItemSelected();
     void updateButtonStates();
     void executeDefaultAction();
@@ -173,29 +346,76 @@ private:
     QListWidget *m_listWidget;
     QCheckBox *m_hideEmptyTitlesCheckBox;
     QCheckBox *m_hideMenusCheckBox;
+    QCheckBox *m_readingOrderCheckBox;
     QPushButton *m_clickButton;
     QPushButton *m_focusButton;
     QPushButton *m_doubleClickButton;
+    QPushButton *m_widenButton; // Shown while the list is scoped
+#if UIALIST_CALL_STATS
+    QLabel *m_callStatsLabel;  // Debug builds: UI Automation calls of the last enumeration
+    std::vector<UIAListCore::CallCount> m_callsBefore;
+#endif
 
     // Loading overlay components
     QVBoxLayout *m_loadingLayout;
     QLabel *m_loadingLabel;
     QProgressBar *m_progressBar;
     QPushButton *m_cancelButton;
+    QTimer *m_progressTimer; // Runs while the overlay is shown
+    std::shared_ptr<UIAListCore::EnumerationProgress> m_progress; // Of the running enumeration
+    double m_progressAnnounced; // Elapsed seconds of the last progress announcement
     
     // UI Automation
     IUIAutomation *m_uiAutomation;
     IUIAutomationTreeWalker *m_controlViewWalker;
     
     // Threading components
+    std::unique_ptr<UIAListCore::StagedStartup> m_startup; // Owns the apartment m_uiAutomation lives in
+    bool m_startupLogged;
     QThread *m_workerThread;
     ControlEnumerationWorker *m_worker;
+    std::unique_ptr<UIAListCore::ActionExecutor> m_actionExecutor;
 
     // Data storage
     QMap<QString, ControlInfo> m_controlMap;
     QList<ControlInfo> m_allControls;
-    ControlInfo m_selectedControl;
+    int m_selectedIndex; // Into m_allControls, -1 without selection
+    UIAListCore::FilterEngine m_filter; // One row per m_listWidget item, in order
+    UIAListCore::SpatialIndex m_spatialIndex; // Bounds of m_allControls, rebuilt with the list, spliced with it
+    UIAListCore::MemoryBudget::SnapshotId m_snapshotId; // 0 while no finished list is held
+    UIAListCore::MemoryUsage m_snapshotUsage;
+    QList<ControlInfo> m_incomingControls; // Of the running enumeration, replace m_allControls when it finishes
+    std::vector<UIAListCore::ControlWalker::Ring> m_incomingRings; // Of m_incomingControls, when walked outward from the focus
+    bool m_listPartial; // m_allControls holds the rings around the focus, the enumeration is still running
+    IUIAutomationElement* m_scopeElement; // Container m_allControls is scoped to, null for the whole window
+    QString m_scopeDescription;
+    bool m_listLimited; // A quick list with a depth limit, widened or not
+    void* m_targetWindow;
+    bool m_listRestored; // m_allControls came from the compact snapshot, the enumeration refreshes it
+    
+    // Idle trim: the list of a window hidden for a while, packed
+    QTimer *m_idleTrimTimer;
+    UIAListCore::CompactSnapshot m_compactSnapshot;
+    void* m_compactWindow;
+    UIAListCore::MemoryBudget::SnapshotId m_compactSnapshotId;
     QString m_targetWindowTitle;
-    QSettings *m_settings;
+    UIAListCore::SettingsStore::ListenerId m_settingsListener;
+    
+    // Query API: other processes read and act on the list over a named pipe
+    std::unique_ptr<UIAListCore::QuerySnapshotCache> m_querySnapshots;
+    std::unique_ptr<UIAListCore::QueryServer> m_queryServer;
+    QMutex m_servedMutex;
+    QList<ControlInfo> m_servedControls; // m_allControls as published, for Invoke on the connection threads
+    void* m_servedWindow;
+    
+    // Screen reader announcements, coalesced so key repeat and typing do not flood it
+    UIAListCore::AnnouncementScheduler m_announcements;
+    QTimer *m_announceTimer;
+    QString m_pendingStatus; // Latest announceText, spoken when Status is due
+    
+    // Live updates of the shown list
+    QThread *m_liveThread;
+    LiveTreeWatcher *m_liveWatcher;
+    quint64 m_liveGeneration; // Bumped with every change of m_allControls the watcher must know
 };
 #endif // UIALIST_H
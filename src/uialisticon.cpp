@@ -19,14 +19,17 @@
 #include "uialisticon.h"
 #include "aboutdialog.h"
 #include "settingsdialog.h"
+#include "SettingsStore.h"
+#include "Trace.h"
 #include <QApplication>
+#include <QCursor>
 #include <QIcon>
 #include <QDebug>
 
 #include <windows.h>
 
-UIAListIcon::UIAListIcon(QObject *parent)
-    : QObject(parent), m_trayIcon(nullptr), m_contextMenu(nullptr), m_activateAction(nullptr), m_settingsAction(nullptr), m_aboutAction(nullptr), m_quitAction(nullptr), m_currentShortcut(QKeySequence("Ctrl+Alt+U"))
+UIAListIcon::UIAListIcon(const QKeySequence &shortcut, QObject *parent)
+    : QObject(parent), m_trayIcon(nullptr), m_contextMenu(nullptr), m_activateAction(nullptr), m_settingsAction(nullptr), m_aboutAction(nullptr), m_quitAction(nullptr), m_currentShortcut(shortcut)
 {
     if (!QSystemTrayIcon::isSystemTrayAvailable()) {
         qDebug() << "System tray is not available!";
@@ -43,14 +46,8 @@ UIAListIcon::UIAListIcon(QObject *parent)
     m_trayIcon->setToolTip(tr("UIAList"));
     qDebug() << "Tray icon created successfully";
     
-    createContextMenu();
-    m_trayIcon->setContextMenu(m_contextMenu);
-    qDebug() << "Context menu set";
-    
-    // Load shortcut from settings
-    QSettings settings("UIAList", "Settings");
-    QString shortcutString = settings.value("shortcutKey", "Ctrl+Alt+U").toString();
-    m_currentShortcut = QKeySequence::fromString(shortcutString);
+    // The context menu is built when it is first opened
+    connect(m_trayIcon, &QSystemTrayIcon::activated, this, &UIAListIcon::onTrayActivated);
     
     registerGlobalShortcut();
 }
@@ -61,6 +58,7 @@ UIAListIcon::~UIAListIcon()
     if (m_trayIcon) {
         m_trayIcon->hide();
     }
+    delete m_contextMenu;
 }
 
 void UIAListIcon::show()
@@ -79,6 +77,13 @@ bool UIAListIcon::isVisible() const
     return m_trayIcon && m_trayIcon->isVisible();
 }
 
+void UIAListIcon::showMessage(const QString &title, const QString &message)
+{
+    if (m_trayIcon) {
+        m_trayIcon->showMessage(title, message, QSystemTrayIcon::Warning);
+    }
+}
+
 void UIAListIcon::createContextMenu()
 {
     m_contextMenu = new QMenu();
@@ -104,6 +109,18 @@ void UIAListIcon::createContextMenu()
     m_contextMenu->addAction(m_quitAction);
 }
 
+void UIAListIcon::onTrayActivated(QSystemTrayIcon::ActivationReason reason)
+{
+    if (reason != QSystemTrayIcon::Context || m_contextMenu) {
+        return;
+    }
+    
+    // From now on the tray icon opens the menu itself
+    createContextMenu();
+    m_trayIcon->setContextMenu(m_contextMenu);
+    m_contextMenu->popup(QCursor::pos());
+}
+
 void UIAListIcon::activate()
 {
     qDebug() << "Activate action triggered";
@@ -114,6 +131,13 @@ void UIAListIcon::activate()
     emit activateRequested((void*)foregroundWindow);
 }
 
+void UIAListIcon::quickActivate()
+{
+    // Only the pane or dialog around the focus of the foreground window
+    HWND foregroundWindow = GetForegroundWindow();
+    emit quickActivateRequested((void*)foregroundWindow);
+}
+
 void UIAListIcon::showSettings()
 {
     // Temporarily unregister hotkey to prevent activation during settings change
@@ -155,32 +179,25 @@ void UIAListIcon::registerGlobalShortcut()
     registerGlobalShortcut(m_currentShortcut);
 }
 
-void UIAListIcon::registerGlobalShortcut(const QKeySequence &keySequence)
+// Windows modifiers and virtual key of the first key of keySequence; false when it is empty
+static bool nativeHotkey(const QKeySequence &keySequence, UINT &winModifiers, UINT &winVk)
 {
-    // Unregister old hotkey first
-    unregisterGlobalShortcut();
-    
-    // Install native event filter to handle hotkey messages
-    qApp->installNativeEventFilter(this);
-    
-    // Convert QKeySequence to Windows virtual key and modifiers
     if (keySequence.isEmpty()) {
-        qDebug() << "Empty key sequence, not registering hotkey";
-        return;
+        return false;
     }
     
     int key = keySequence[0];
     int modifiers = key & 0xFFFF0000;
     int vk = key & 0x0000FFFF;
     
-    UINT winModifiers = 0;
+    winModifiers = 0;
     if (modifiers & Qt::ControlModifier) winModifiers |= MOD_CONTROL;
     if (modifiers & Qt::AltModifier) winModifiers |= MOD_ALT;
     if (modifiers & Qt::ShiftModifier) winModifiers |= MOD_SHIFT;
     if (modifiers & Qt::MetaModifier) winModifiers |= MOD_WIN;
     
     // Convert Qt key to Windows virtual key
-    UINT winVk = vk;
+    winVk = vk;
     if (vk >= Qt::Key_A && vk <= Qt::Key_Z) {
         winVk = vk - Qt::Key_A + 'A';
     } else if (vk >= Qt::Key_0 && vk <= Qt::Key_9) {
@@ -189,26 +206,57 @@ void UIAListIcon::registerGlobalShortcut(const QKeySequence &keySequence)
         winVk = vk - Qt::Key_F1 + VK_F1;
     }
     // Add more key mappings as needed
+    return true;
+}
+
+void UIAListIcon::registerGlobalShortcut(const QKeySequence &keySequence)
+{
+    // Unregister old hotkey first
+    unregisterGlobalShortcut();
     
-    if (RegisterHotKey(nullptr, HOTKEY_ID, winModifiers, winVk)) {
+    // Install native event filter to handle hotkey messages
+    qApp->installNativeEventFilter(this);
+    
+    // Convert QKeySequence to Windows virtual key and modifiers
+    UINT winModifiers = 0;
+    UINT winVk = 0;
+    if (!nativeHotkey(keySequence, winModifiers, winVk)) {
+        qDebug() << "Empty key sequence, not registering hotkey";
+    } else if (RegisterHotKey(nullptr, HOTKEY_ID, winModifiers, winVk)) {
         qDebug() << "Global shortcut" << keySequence.toString() << "registered successfully";
         m_currentShortcut = keySequence;
     } else {
         qDebug() << "Failed to register global shortcut" << keySequence.toString();
     }
+    
+    // Lists the focused pane or dialog only
+    QKeySequence quickShortcut = QKeySequence::fromString(
+        QString::fromStdWString(UIAListCore::SettingsStore::Instance().Get()->QuickShortcutKey));
+    if (!nativeHotkey(quickShortcut, winModifiers, winVk)) {
+        qDebug() << "No quick list shortcut";
+    } else if (!RegisterHotKey(nullptr, QUICK_HOTKEY_ID, winModifiers, winVk)) {
+        qDebug() << "Failed to register the quick list shortcut" << quickShortcut.toString();
+    }
 }
 
 void UIAListIcon::unregisterGlobalShortcut()
 {
     UnregisterHotKey(nullptr, HOTKEY_ID);
+    UnregisterHotKey(nullptr, QUICK_HOTKEY_ID);
     qApp->removeNativeEventFilter(this);
     qDebug() << "Global shortcut unregistered";
 }
 
 void UIAListIcon::updateShortcut(const QKeySequence &newShortcut)
 {
+    if (newShortcut == m_currentShortcut) {
+        return;
+    }
+    
     registerGlobalShortcut(newShortcut);
-    m_activateAction->setShortcut(newShortcut);
+    if (m_activateAction) {
+        m_activateAction->setShortcut(newShortcut);
+    }
 }
 
 bool UIAListIcon::nativeEventFilter(const QByteArray &eventType, void *message, qintptr *result)
@@ -218,10 +266,17 @@ bool UIAListIcon::nativeEventFilter(const QByteArray &eventType, void *message,
     if (eventType == "windows_generic_MSG") {
         MSG *msg = static_cast<MSG*>(message);
         if (msg->message == WM_HOTKEY && msg->wParam == HOTKEY_ID) {
+            UIALIST_TRACE_SPAN("Hotkey");
             qDebug() << "Global hotkey Ctrl+Alt+U activated";
             activate();
             return true;
         }
+        if (msg->message == WM_HOTKEY && msg->wParam == QUICK_HOTKEY_ID) {
+            UIALIST_TRACE_SPAN("QuickHotkey");
+            qDebug() << "Quick list hotkey activated";
+            quickActivate();
+            return true;
+        }
     }
     
     return false;
@@ -24,7 +24,6 @@
 #include <QMenu>
 #include <QAction>
 #include <QKeySequence>
-#include <QSettings>
 
 #include <QAbstractNativeEventFilter>
 
@@ -33,18 +32,22 @@ class UIAListIcon : public QObject, public QAbstractNativeEventFilter
     Q_OBJECT
 
 public:
-    UIAListIcon(QObject *parent = nullptr);
+    UIAListIcon(const QKeySequence &shortcut, QObject *parent = nullptr);
     ~UIAListIcon();
     
     void show();
     bool isVisible() const;
+    void showMessage(const QString &title, const QString &message);
     void updateShortcut(const QKeySequence &newShortcut);
 
 signals:
     void activateRequested(void* foregroundWindow);
+    void quickActivateRequested(void* foregroundWindow);
 
 private slots:
     void activate();
+    void quickActivate();
+    void onTrayActivated(QSystemTrayIcon::ActivationReason reason);
     void showSettings();
     void showAbout();
     void quit();
@@ -65,6 +68,7 @@ private:
     QAction *m_aboutAction;
     QAction *m_quitAction;
     static const int HOTKEY_ID = 1;
+    static const int QUICK_HOTKEY_ID = 2; // Settings::QuickShortcutKey
     QKeySequence m_currentShortcut;
 };
 
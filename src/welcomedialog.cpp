@@ -18,9 +18,9 @@
 
 #include "welcomedialog.h"
 #include "settingsdialog.h"
+#include "SettingsStore.h"
 #include <QApplication>
 #include <QIcon>
-#include <QSettings>
 
 WelcomeDialog::WelcomeDialog(QWidget *parent)
     : QDialog(parent), m_mainLayout(nullptr), m_iconLayout(nullptr), 
@@ -33,9 +33,7 @@ WelcomeDialog::WelcomeDialog(QWidget *parent)
     setModal(true);
     
     // Mark that welcome screen has been shown
-    QSettings settings("UIAList", "Settings");
-    settings.setValue("welcomeShown", true);
-    settings.sync();
+    UIAListCore::SettingsStore::Instance().Update([](UIAListCore::Settings& settings) { settings.WelcomeShown = true; });
 }
 
 void WelcomeDialog::setupUI()
@@ -0,0 +1,161 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// ActionExecutor: results, the watchdog's timeout, cancelling the queue
+// on destruction, and an action hung past its deadline being left behind
+// by the destructor. Exits 1 when a check fails, naming it on stderr.
+
+#include "ActionExecutor.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+using namespace UIAListCore;
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_failures;
+        }
+    }
+
+    // Polls until condition holds or timeout passes
+    template <typename Condition>
+    bool WaitFor(Condition condition, std::chrono::milliseconds timeout)
+    {
+        const auto end = Clock::now() + timeout;
+        while (!condition())
+        {
+            if (Clock::now() >= end) return false;
+            std::this_thread::sleep_for(1ms);
+        }
+        return true;
+    }
+
+    void TestResults()
+    {
+        ActionExecutor executor;
+        std::atomic<int> completions{ 0 };
+        auto counted = [&completions](ActionResult) { ++completions; };
+
+        auto succeeded = executor.Submit([]() { return true; }, 1000ms, counted);
+        auto failed = executor.Submit([]() { return false; }, 1000ms, counted);
+        auto threw = executor.Submit([]() -> bool { throw 1; }, 1000ms, counted);
+
+        Check(succeeded.get() == ActionResult::Succeeded, "an action returning true succeeds");
+        Check(failed.get() == ActionResult::Failed, "an action returning false fails");
+        Check(threw.get() == ActionResult::Failed, "an action throwing fails");
+        Check(WaitFor([&completions]() { return completions == 3; }, 1000ms), "every action completes once");
+    }
+
+    void TestTimeout()
+    {
+        ActionExecutor executor;
+        std::atomic<int> completions{ 0 };
+
+        const auto start = Clock::now();
+        auto slow = executor.Submit([]() { std::this_thread::sleep_for(300ms); return true; }, 50ms,
+                                    [&completions](ActionResult) { ++completions; });
+        Check(slow.get() == ActionResult::TimedOut, "a slow action times out");
+        Check(Clock::now() - start < 250ms, "the timeout is reported at the deadline, not when the action returns");
+
+        // Queued behind the slow one past its own deadline: never started
+        std::atomic<bool> ran{ false };
+        auto queued = executor.Submit([&ran]() { ran = true; return true; }, 10ms);
+        Check(queued.get() == ActionResult::TimedOut, "a queued action times out behind a slow one");
+
+        std::this_thread::sleep_for(350ms);
+        Check(!ran, "an action timed out in the queue never runs");
+        Check(completions == 1, "the late return of a timed out action completes nothing");
+    }
+
+    void TestDestroyCancelsQueue()
+    {
+        std::future<ActionResult> running;
+        std::future<ActionResult> queued;
+        {
+            ActionExecutor executor;
+            std::atomic<bool> started{ false };
+            running = executor.Submit([&started]() { started = true; std::this_thread::sleep_for(50ms); return true; },
+                                      1000ms);
+            queued = executor.Submit([]() { return true; }, 1000ms);
+            Check(WaitFor([&started]() { return started.load(); }, 1000ms), "the first action starts");
+        }
+        Check(running.get() == ActionResult::Succeeded, "the destructor waits for the running action");
+        Check(queued.get() == ActionResult::Cancelled, "the destructor cancels queued actions");
+    }
+
+    void TestDestroyLeavesHungActionBehind()
+    {
+        // Everything the action and the hooks use is owned by them, the way
+        // a frontend's actions must be once the executor may leave them behind
+        struct Shared
+        {
+            std::atomic<bool> Started{ false };
+            std::atomic<bool> Release{ false };
+            std::atomic<bool> Returned{ false };
+            std::atomic<bool> ThreadStopped{ false };
+            std::atomic<int> Completions{ 0 };
+        };
+        auto shared = std::make_shared<Shared>();
+
+        auto executor = std::make_unique<ActionExecutor>(ActionExecutor::ThreadHook(),
+                                                         [shared]() { shared->ThreadStopped = true; });
+        std::future<ActionResult> hung = executor->Submit([shared]() {
+                shared->Started = true;
+                WaitFor([&shared]() { return shared->Release.load(); }, 10000ms);
+                shared->Returned = true;
+                return true;
+            }, 100ms, [shared](ActionResult) { ++shared->Completions; });
+        Check(WaitFor([&shared]() { return shared->Started.load(); }, 1000ms), "the hung action starts");
+
+        const auto start = Clock::now();
+        executor.reset();
+        const auto destroyTime = Clock::now() - start;
+
+        Check(destroyTime < 1000ms, "the destructor returns at the deadline of a hung action");
+        Check(hung.get() == ActionResult::TimedOut, "the hung action is reported as timed out");
+        Check(shared->Completions == 1, "the hung action completes once, before the destructor returns");
+        Check(!shared->Returned && !shared->ThreadStopped, "the hung action is still running after the destructor");
+
+        // The detached thread finishes on its own once the call returns
+        shared->Release = true;
+        Check(WaitFor([&shared]() { return shared->ThreadStopped.load(); }, 2000ms),
+              "the left behind thread runs onThreadStop when the action returns");
+        Check(shared->Completions == 1, "the late return of the left behind action completes nothing");
+    }
+}
+
+int main()
+{
+    TestResults();
+    TestTimeout();
+    TestDestroyCancelsQueue();
+    TestDestroyLeavesHungActionBehind();
+
+    if (g_failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("ActionExecutor: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,199 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// FilterEngine: case folding, word matching while typing on and back, the
+// row selected for a query, splicing rows in, and which controls get a row
+// at all.
+// Exits 1 when a check fails, naming it on stderr.
+
+#include "FilterEngine.h"
+
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+using namespace UIAListCore;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_failures;
+        }
+    }
+
+    std::vector<uint32_t> Rows(std::initializer_list<uint32_t> rows)
+    {
+        return std::vector<uint32_t>(rows);
+    }
+
+    void TestFoldCase()
+    {
+        Check(FoldCase(u'A') == u'a' && FoldCase(u'z') == u'z' && FoldCase(u'@') == u'@', "ASCII");
+        Check(FoldCase(u'É') == u'é', "Latin-1 E acute");
+        Check(FoldCase(u'×') == u'×', "multiplication sign stays");
+        Check(FoldCase(u'ß') == u'ß', "sharp s has no single-unit folding");
+        Check(FoldCase(u'Ÿ') == u'ÿ', "Y diaeresis folds into Latin-1");
+        Check(FoldCase(u'ǅ') == u'ǆ', "title case digraph");
+        Check(FoldCase(u'Ƈ') == u'ƈ', "Latin Extended-B");
+        Check(FoldCase(u'Σ') == u'σ' && FoldCase(u'ς') == u'σ', "Greek sigma, final sigma");
+        Check(FoldCase(u'Ж') == u'ж' && FoldCase(u'Ё') == u'ё', "Cyrillic");
+        Check(FoldCase(u'Ա') == u'ա', "Armenian");
+        Check(FoldCase(u'ẞ') == u'ß', "capital sharp s");
+        Check(FoldCase(u'Ⓐ') == u'ⓐ', "circled letters");
+        Check(FoldCase(u'Ａ') == u'ａ', "fullwidth");
+        Check(FoldCase(u'中') == u'中', "CJK stays");
+        Check(FoldCase(char16_t(0xD801)) == char16_t(0xD801), "surrogates stay");
+
+        // Folding is idempotent over the whole plane
+        bool idempotent = true;
+        for (uint32_t c = 0; c <= 0xFFFF; ++c)
+        {
+            const char16_t folded = FoldCase(static_cast<char16_t>(c));
+            idempotent = idempotent && FoldCase(folded) == folded;
+        }
+        Check(idempotent, "folding a folded unit changes nothing");
+    }
+
+    void TestMatching()
+    {
+        FilterEngine engine;
+        engine.Add(u"Button: OK", u"OK");
+        engine.Add(u"Button: Cancel", u"Cancel");
+        engine.Add(u"Edit: File name", u"File name");
+        engine.Add(u"MenuItem: ÜBER UIAList", u"ÜBER UIAList");
+        engine.Add(u"ListItem: СПИСОК", u"СПИСОК");
+
+        Check(!engine.HasQuery() && engine.Matches().size() == 5, "no query lists every row");
+
+        Check(engine.SetQuery(u"button") == 2 && engine.Matches() == Rows({ 0, 1 }), "case-insensitive word");
+        Check(engine.SetQuery(u"button c") == 1 && engine.Matches() == Rows({ 1 }), "typed on narrows");
+        Check(engine.IsMatch(1) && !engine.IsMatch(0), "IsMatch follows the narrowed matches");
+        Check(engine.SetQuery(u"button") == 2 && engine.IsMatch(0), "backspace widens again");
+        Check(engine.SetQuery(u"name file") == 1 && engine.Matches() == Rows({ 2 }), "words in any order");
+        Check(engine.SetQuery(u"file zip") == 0, "every word must match");
+        Check(engine.SetQuery(u"  \t ") == 5 && !engine.HasQuery(), "blank query lists every row");
+
+        Check(engine.SetQuery(u"über") == 1 && engine.Matches() == Rows({ 3 }), "Latin-1 capitals match");
+        Check(engine.SetQuery(u"список") == 1 && engine.Matches() == Rows({ 4 }),
+              "Cyrillic capitals match");
+
+        // A row added while a query is set is checked against it
+        engine.SetQuery(u"cancel");
+        engine.Add(u"Hyperlink: CANCEL order", u"CANCEL order");
+        Check(engine.Matches() == Rows({ 1, 5 }) && engine.IsMatch(5), "added rows are filtered");
+
+        engine.Clear();
+        Check(engine.Size() == 0 && engine.Matches().empty(), "Clear drops the rows");
+    }
+
+    void TestBestMatch()
+    {
+        FilterEngine engine;
+        engine.Add(u"Button: Reopen", u"Reopen");              // "open" anywhere
+        engine.Add(u"MenuItem: Recent open", u"Recent open");  // at a word start
+        engine.Add(u"Button: Open folder", u"Open folder");    // at the name start
+
+        engine.SetQuery(u"open");
+        Check(engine.Matches().size() == 3, "every row contains the word");
+        Check(engine.BestMatch() == 2, "name start wins over word start and anywhere");
+
+        engine.SetQuery(u"recent");
+        Check(engine.BestMatch() == 1, "the only match");
+
+        engine.SetQuery(u"re");
+        Check(engine.BestMatch() == 0, "equal scores: the first in list order");
+
+        engine.SetQuery(u"open");
+        engine.Add(u"Button: Open", u"Open");  // The whole name
+        engine.Add(u"Button: Open", u"Open");  // Same again, later in the list
+        Check(engine.BestMatch() == 3, "the equal name wins, first in list order");
+
+        engine.SetQuery(u"OPEN");
+        Check(engine.BestMatch() == 3, "ranking ignores case");
+
+        engine.SetQuery(u"save");
+        Check(engine.BestMatch() == FilterEngine::NoMatch, "no match");
+
+        engine.SetQuery(u"");
+        Check(engine.BestMatch() == 0, "without a query the first row");
+    }
+
+    void TestSplice()
+    {
+        FilterEngine engine;
+        engine.Add(u"Button: OK", u"OK");
+        engine.Add(u"Group: Options", u"Options");
+        engine.Add(u"CheckBox: Wrap", u"Wrap");
+        engine.Add(u"Button: Cancel", u"Cancel");
+        engine.SetQuery(u"button");
+
+        // The group's subtree re-walked with one box more, checked against the query
+        engine.Splice(1, 2, { u"Group: Options", u"CheckBox: Wrap", u"Button: Reset" }, { u"Options", u"Wrap", u"Reset" });
+        Check(engine.Size() == 5, "splice replaces the rows");
+        Check(engine.Matches() == Rows({ 0, 3, 4 }) && engine.IsMatch(3) && !engine.IsMatch(2),
+              "spliced rows are filtered, later rows move along");
+        Check(engine.BestMatch() == 0, "the first match after a splice");
+
+        engine.Splice(1, 3, {}, {});
+        Check(engine.Size() == 2 && engine.Matches() == Rows({ 0, 1 }), "a removed subtree");
+
+        // Renamed often enough that the dropped texts are reclaimed
+        for (int i = 0; i <= 20; ++i)
+        {
+            engine.Splice(1, 1, { i % 2 ? u"Button: Abort" : u"Button: Cancel" }, { i % 2 ? u"Abort" : u"Cancel" });
+        }
+        Check(engine.SetQuery(u"cancel") == 1 && engine.Matches() == Rows({ 1 }), "texts survive reclaiming");
+        Check(engine.SetQuery(u"ok") == 1 && engine.BestMatch() == 0, "untouched rows survive reclaiming");
+        Check(engine.SetQuery(u"abort") == 0, "replaced texts are gone");
+    }
+
+    void TestIsListed()
+    {
+        const int32_t button = 50000;
+        const int32_t text = 50020;
+        const int32_t window = 50032;
+        const int32_t menuItem = 50011;
+
+        ListOptions options;
+        Check(IsListed(button, u"OK", options), "buttons are listed");
+        Check(!IsListed(text, u"Label", options) && !IsListed(window, u"Main", options), "text and windows never");
+        Check(IsListed(button, u"  ", options) && IsListed(menuItem, u"File", options), "nothing hidden by default");
+
+        options.HideEmptyTitles = true;
+        options.HideMenus = true;
+        Check(!IsListed(button, u"   ", options) && !IsListed(button, u"(no name)", options), "empty titles hidden");
+        Check(!IsListed(menuItem, u"File", options), "menus hidden");
+        Check(IsListed(button, u"OK", options), "named buttons stay");
+    }
+}
+
+int main()
+{
+    TestFoldCase();
+    TestMatching();
+    TestBestMatch();
+    TestSplice();
+    TestIsListed();
+
+    if (g_failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("FilterEngine: all checks passed\n");
+    return 0;
+}
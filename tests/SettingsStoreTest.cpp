@@ -0,0 +1,217 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// SettingsStore over FileSettingsBackend: the snapshot loaded on Open,
+// changes coalescing into one write, a change by another process picked
+// up, and a backend that cannot store not hanging Flush and Close.
+// Exits 1 when a check fails, naming it on stderr.
+
+#include "SettingsStore.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+using namespace UIAListCore;
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_failures;
+        }
+    }
+
+    // Polls until condition holds or timeout passes
+    template <typename Condition>
+    bool WaitFor(Condition condition, std::chrono::milliseconds timeout)
+    {
+        const auto end = Clock::now() + timeout;
+        while (!condition())
+        {
+            if (Clock::now() >= end) return false;
+            std::this_thread::sleep_for(5ms);
+        }
+        return true;
+    }
+
+    // A settings file of its own per test, removed afterwards
+    struct TemporaryFile
+    {
+        std::filesystem::path Path;
+
+        explicit TemporaryFile(const char* name)
+            : Path(std::filesystem::temp_directory_path() /
+                   (std::string("UIAListSettingsTest-") + name + "-" +
+                    std::to_string(Clock::now().time_since_epoch().count())))
+        {
+        }
+
+        ~TemporaryFile()
+        {
+            std::error_code error;
+            std::filesystem::remove(Path, error);
+            Path += ".tmp";
+            std::filesystem::remove(Path, error);
+        }
+    };
+
+    // Counts what reaches it; stores fail while Failing is set
+    class CountingBackend : public SettingsBackend
+    {
+    public:
+        struct Counts
+        {
+            std::atomic<int> Stores{ 0 };
+            std::atomic<bool> Failing{ false };
+        };
+
+        explicit CountingBackend(std::shared_ptr<Counts> counts) : m_counts(std::move(counts)) {}
+
+        SettingValues Load() override { return {}; }
+
+        bool Store(const SettingValues&) override
+        {
+            ++m_counts->Stores;
+            return !m_counts->Failing;
+        }
+
+        bool WaitForChange(std::chrono::milliseconds timeout) override
+        {
+            std::this_thread::sleep_for(std::min(timeout, std::chrono::milliseconds(5)));
+            return false;
+        }
+
+        void Wake() override {}
+
+    private:
+        std::shared_ptr<Counts> m_counts;
+    };
+
+    void TestLoad()
+    {
+        TemporaryFile file("load");
+        {
+            std::ofstream out(file.Path, std::ios::binary);
+            out << "u defaultAction 2\n"
+                << "s shortcutKey Ctrl+Alt+L\n"
+                << "s welcomeShown true\n"  // As QSettings writes booleans
+                << "u actionTimeoutMs 750\n"
+                << "x unknown line\n";
+        }
+
+        SettingsStore store;
+        store.Open(std::make_unique<FileSettingsBackend>(file.Path));
+        const std::shared_ptr<const Settings> settings = store.Get();
+        Check(settings->DefaultAction == 2, "a number is loaded");
+        Check(settings->ShortcutKey == L"Ctrl+Alt+L", "a string is loaded");
+        Check(settings->WelcomeShown, "a QSettings boolean is loaded");
+        Check(settings->ActionTimeoutMs == 750, "another number is loaded");
+        Check(settings->IdleTrimSeconds == Settings().IdleTrimSeconds, "what the file lacks is the default");
+        Check(store.Loads() == 1 && store.Stores() == 0, "Open loads once and stores nothing");
+    }
+
+    void TestCoalescing()
+    {
+        TemporaryFile file("coalescing");
+        SettingsStore store;
+        store.Open(std::make_unique<FileSettingsBackend>(file.Path), 100ms);
+
+        for (int i = 1; i <= 100; ++i)
+        {
+            store.Update([i](Settings& settings) { settings.ActionTimeoutMs = i; });
+        }
+        Check(store.Get()->ActionTimeoutMs == 100, "an update applies to the snapshot at once");
+
+        Check(store.Flush(), "Flush stores the pending changes");
+        Check(store.Stores() == 1, "100 updates coalesce into one write");
+
+        const Settings stored = SettingsStore::FromValues(FileSettingsBackend(file.Path).Load());
+        Check(stored.ActionTimeoutMs == 100, "the last update is what is stored");
+
+        store.Update([](Settings& settings) { settings.ActionTimeoutMs = 100; });
+        Check(store.Flush() && store.Stores() == 1, "an update changing nothing writes nothing");
+    }
+
+    void TestExternalChange()
+    {
+        TemporaryFile file("external");
+        SettingsStore store;
+        store.Open(std::make_unique<FileSettingsBackend>(file.Path), 50ms);
+
+        std::atomic<int> notified{ 0 };
+        store.Subscribe([&notified](const Settings& settings) {
+            if (settings.ShortcutKey == L"Ctrl+Shift+F12") ++notified;
+        });
+
+        // Another process, the other frontend or the installer
+        FileSettingsBackend other(file.Path);
+        Check(other.Store({ { "shortcutKey", std::wstring(L"Ctrl+Shift+F12") } }), "the other process stores");
+
+        Check(WaitFor([&notified]() { return notified > 0; }, 3000ms), "listeners hear of the change");
+        Check(store.Get()->ShortcutKey == L"Ctrl+Shift+F12", "the snapshot has the change");
+        Check(store.Loads() >= 2, "the change was loaded");
+        store.Close();
+    }
+
+    void TestFailingBackend()
+    {
+        auto counts = std::make_shared<CountingBackend::Counts>();
+        counts->Failing = true;
+        auto store = std::make_unique<SettingsStore>();
+        store->Open(std::make_unique<CountingBackend>(counts), 200ms);
+
+        store->Update([](Settings& settings) { settings.DefaultAction = 1; });
+        auto start = Clock::now();
+        Check(!store->Flush(), "Flush reports a store that failed");
+        Check(Clock::now() - start < 1000ms, "Flush returns after the failed store");
+        Check(counts->Stores == 1, "Flush waits for one store only");
+
+        // Retried within the write delay; a working backend stores it then
+        counts->Failing = false;
+        Check(WaitFor([&counts]() { return counts->Stores >= 2; }, 1000ms), "a failed store is retried");
+        Check(store->Flush() && store->Stores() == 1, "the retry stores the change");
+
+        // Still failing at exit: Close tries once more and gives up
+        counts->Failing = true;
+        store->Update([](Settings& settings) { settings.DefaultAction = 2; });
+        start = Clock::now();
+        Check(!store->Flush(), "Flush fails again");
+        store.reset();
+        Check(Clock::now() - start < 1000ms, "Close does not wait for a failing backend");
+    }
+}
+
+int main()
+{
+    TestLoad();
+    TestCoalescing();
+    TestExternalChange();
+    TestFailingBackend();
+
+    if (g_failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("SettingsStore: all checks passed\n");
+    return 0;
+}
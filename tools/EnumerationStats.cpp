@@ -0,0 +1,113 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// Summary of the per-application enumeration statistics log: which
+// applications are slow to enumerate and which subtrees the time goes to.
+//
+// Usage: EnumerationStats [--log PATH] [--app IMAGE] [--records] [--share S] [--min-runs N]
+//   --log       defaults to %LOCALAPPDATA%\UIAList\enumeration-stats.log
+//   --app       only this process image, e.g. WINWORD.EXE
+//   --records   also list the individual enumerations
+//   --share     dominant subtree threshold (default 0.8 of every run)
+
+#include "EnumerationStats.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+using namespace UIAListCore;
+
+namespace
+{
+    std::filesystem::path DefaultLogPath()
+    {
+        const char* localAppData = std::getenv("LOCALAPPDATA");
+        if (!localAppData) return std::filesystem::path();
+        return std::filesystem::path(localAppData) / "UIAList" / "enumeration-stats.log";
+    }
+
+    void PrintRecords(const std::vector<EnumerationRecord>& records, const std::string& app)
+    {
+        std::printf("%-20s %-24s %-10s %8s %5s %9s %10s %8s\n",
+                    "time", "application", "mode", "nodes", "depth", "calls", "wall ms", "us/node");
+        for (const EnumerationRecord& record : records)
+        {
+            if (!app.empty() && record.ProcessImage != app) continue;
+
+            char time[32];
+            std::time_t timestamp = static_cast<std::time_t>(record.Timestamp);
+            std::strftime(time, sizeof(time), "%Y-%m-%d %H:%M:%S", std::localtime(&timestamp));
+            std::printf("%-20s %-24s %-10s %8zu %5zu %9llu %10.1f %8.1f\n",
+                        time, record.ProcessImage.c_str(), record.Mode.c_str(), record.Nodes, record.MaxDepth,
+                        static_cast<unsigned long long>(record.Calls), record.WallMilliseconds,
+                        record.MicrosecondsPerNode());
+        }
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path path = DefaultLogPath();
+    std::string app;
+    bool records = false;
+    double share = 0.8;
+    size_t minRuns = 3;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--records") == 0) records = true;
+        else if (i + 1 < argc && std::strcmp(argv[i], "--log") == 0) path = argv[++i];
+        else if (i + 1 < argc && std::strcmp(argv[i], "--app") == 0) app = argv[++i];
+        else if (i + 1 < argc && std::strcmp(argv[i], "--share") == 0) share = std::atof(argv[++i]);
+        else if (i + 1 < argc && std::strcmp(argv[i], "--min-runs") == 0) minRuns = static_cast<size_t>(std::atoi(argv[++i]));
+    }
+
+    if (path.empty())
+    {
+        std::fprintf(stderr, "No log given and LOCALAPPDATA is not set, use --log PATH\n");
+        return 2;
+    }
+
+    std::vector<EnumerationRecord> loaded = EnumerationStatsLog(path).Load();
+    if (loaded.empty())
+    {
+        std::fprintf(stderr, "No enumeration statistics in %s\n", path.string().c_str());
+        return 1;
+    }
+
+    if (records) PrintRecords(loaded, app);
+
+    for (const ApplicationSummary& summary : Summarize(loaded))
+    {
+        if (!app.empty() && summary.ProcessImage != app) continue;
+
+        std::printf("%s: %zu runs, median %.1f ms, max %.1f ms, %.0f nodes, depth %.0f, %.2f calls/node, %.1f us/node\n",
+                    summary.ProcessImage.c_str(), summary.Runs, summary.MedianMilliseconds, summary.MaxMilliseconds,
+                    summary.MeanNodes, summary.MaxDepth, summary.MeanCallsPerNode, summary.MeanMicrosecondsPerNode);
+
+        for (const SubtreeShare& subtree : summary.Subtrees)
+        {
+            std::printf("    %5.1f%% (min %5.1f%%, %zu/%zu runs, %8.1f ms)  %s\n",
+                        subtree.MeanShare * 100, subtree.MinShare * 100, subtree.Runs, summary.Runs,
+                        subtree.MeanMilliseconds, subtree.Key.c_str());
+        }
+
+        for (const std::string& key : summary.DominantSubtrees(share, minRuns))
+        {
+            std::printf("    dominant: %s\n", key.c_str());
+        }
+    }
+
+    return 0;
+}
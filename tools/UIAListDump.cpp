@@ -0,0 +1,257 @@
+/*
+ * UIAList - Accessibility Tool for Screen Reader Users
+ * Copyright (C) 2025 Stefan Lohmaier
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// Headless UIAList: streams the controls of one window to stdout as JSON
+// Lines, one control per line as the walk finds it (see ControlStream.h),
+// for scripted audits without the GUI.
+//
+// Usage: UIAListDump (--hwnd H | --title REGEX | --process IMAGE) [options]
+//   --hwnd          window handle, decimal or 0x hex
+//   --title         first visible top-level window whose title matches (ECMAScript, case-insensitive)
+//   --process       first visible top-level window of this executable, e.g. WINWORD.EXE
+//   --properties    what each line carries: type,name,automationid,capabilities (default: the first three)
+//   --type          only these control types, e.g. Button,Edit
+//   --name          only controls whose name contains this, case-insensitive
+//   --named         only controls with a non-blank name
+//   --max-depth     do not descend below this depth (the window is 0)
+//   --timeout-ms    stop the walk after this long, exit code 3
+//   --flush-ms      write buffered lines at least this often (default 100, 0 every line)
+//
+// Exit codes: 0 complete, 1 usage, 2 window not found or not accessible,
+// 3 timed out (the lines found so far are written), 4 output closed
+
+// No pch.h here: a console program next to the app
+#include <windows.h>
+#include <shellapi.h>
+#include <UIAutomation.h>
+
+#include "ControlStream.h"
+#include "UiaTreeProvider.h"
+#include "Utf8.h"
+
+#include <fcntl.h>
+#include <io.h>
+
+#include <cstdio>
+#include <cwchar>
+#include <iterator>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace UIAListCore;
+
+namespace
+{
+    enum ExitCode
+    {
+        ExitComplete = 0,
+        ExitUsage = 1,
+        ExitNoWindow = 2,
+        ExitTimedOut = 3,
+        ExitWriteFailed = 4
+    };
+
+    struct WindowQuery
+    {
+        const std::wregex* Title{ nullptr };
+        std::string ProcessImage;
+        HWND Found{ nullptr };
+    };
+
+    BOOL CALLBACK FindWindowCallback(HWND window, LPARAM parameter)
+    {
+        WindowQuery& query = *reinterpret_cast<WindowQuery*>(parameter);
+        if (!IsWindowVisible(window) || GetWindow(window, GW_OWNER)) return TRUE;
+
+        if (query.Title)
+        {
+            wchar_t title[512];
+            const int length = GetWindowTextW(window, title, static_cast<int>(std::size(title)));
+            if (length <= 0 || !std::regex_search(title, title + length, *query.Title)) return TRUE;
+        }
+        if (!query.ProcessImage.empty() &&
+            _stricmp(UiaTreeProvider::ProcessImageName(window).c_str(), query.ProcessImage.c_str()) != 0)
+        {
+            return TRUE;
+        }
+
+        query.Found = window;
+        return FALSE;
+    }
+
+    // "Button,Edit" -> { "Button", "Edit" }
+    std::vector<std::wstring> Split(const std::wstring& text)
+    {
+        std::vector<std::wstring> parts;
+        size_t start = 0;
+        while (start <= text.size())
+        {
+            size_t end = text.find(L',', start);
+            if (end == std::wstring::npos) end = text.size();
+            if (end > start) parts.push_back(text.substr(start, end - start));
+            start = end + 1;
+        }
+        return parts;
+    }
+
+    bool ParseProperties(const std::wstring& text, uint32_t& properties)
+    {
+        properties = PropertyNone;
+        for (const std::wstring& part : Split(text))
+        {
+            if (_wcsicmp(part.c_str(), L"type") == 0) properties |= PropertyControlType;
+            else if (_wcsicmp(part.c_str(), L"name") == 0) properties |= PropertyName;
+            else if (_wcsicmp(part.c_str(), L"automationid") == 0) properties |= PropertyAutomationId;
+            else if (_wcsicmp(part.c_str(), L"capabilities") == 0) properties |= PropertyCapabilities;
+            else return false;
+        }
+        return true;
+    }
+
+    bool ParseControlTypes(const std::wstring& text, std::vector<int32_t>& controlTypes)
+    {
+        for (const std::wstring& part : Split(text))
+        {
+            const int32_t controlType = ControlTypeFromName(ToUtf8(part));
+            if (controlType == 0) return false;
+            controlTypes.push_back(controlType);
+        }
+        return true;
+    }
+
+    int Usage(const char* problem)
+    {
+        std::fprintf(stderr, "%s\n", problem);
+        std::fprintf(stderr, "Usage: UIAListDump (--hwnd H | --title REGEX | --process IMAGE) [--properties LIST]\n"
+                             "                   [--type LIST] [--name TEXT] [--named] [--max-depth D]\n"
+                             "                   [--timeout-ms T] [--flush-ms F]\n");
+        return ExitUsage;
+    }
+}
+
+int main()
+{
+    // argv in the console code page would mangle titles and names
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (!argv) return ExitUsage;
+
+    HWND window = nullptr;
+    std::wstring title;
+    std::string processImage;
+    ControlStreamOptions options;
+    long flushMs = static_cast<long>(JsonLinesWriter::DefaultFlushInterval.count());
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const wchar_t* option = argv[i];
+        if (wcscmp(option, L"--named") == 0)
+        {
+            options.NamedOnly = true;
+            continue;
+        }
+        if (i + 1 >= argc) return Usage("Missing value");
+
+        const std::wstring value = argv[++i];
+        if (wcscmp(option, L"--hwnd") == 0)
+        {
+            window = reinterpret_cast<HWND>(static_cast<uintptr_t>(wcstoull(value.c_str(), nullptr, 0)));
+        }
+        else if (wcscmp(option, L"--title") == 0) title = value;
+        else if (wcscmp(option, L"--process") == 0) processImage = ToUtf8(value);
+        else if (wcscmp(option, L"--properties") == 0)
+        {
+            if (!ParseProperties(value, options.Properties)) return Usage("Unknown property");
+        }
+        else if (wcscmp(option, L"--type") == 0)
+        {
+            if (!ParseControlTypes(value, options.ControlTypes)) return Usage("Unknown control type");
+        }
+        else if (wcscmp(option, L"--name") == 0) options.NameContains = value;
+        else if (wcscmp(option, L"--max-depth") == 0) options.MaxDepth = wcstoul(value.c_str(), nullptr, 10);
+        else if (wcscmp(option, L"--timeout-ms") == 0)
+        {
+            options.TimeBudget = std::chrono::milliseconds(wcstol(value.c_str(), nullptr, 10));
+        }
+        else if (wcscmp(option, L"--flush-ms") == 0) flushMs = wcstol(value.c_str(), nullptr, 10);
+        else return Usage("Unknown option");
+    }
+    LocalFree(argv);
+
+    if (!window)
+    {
+        if (title.empty() && processImage.empty()) return Usage("No window given");
+
+        std::wregex titlePattern;
+        WindowQuery query;
+        if (!title.empty())
+        {
+            try
+            {
+                titlePattern.assign(title, std::regex_constants::ECMAScript | std::regex_constants::icase);
+            }
+            catch (const std::regex_error&)
+            {
+                return Usage("Invalid title pattern");
+            }
+            query.Title = &titlePattern;
+        }
+        query.ProcessImage = processImage;
+        EnumWindows(FindWindowCallback, reinterpret_cast<LPARAM>(&query));
+        window = query.Found;
+    }
+    if (!window || !IsWindow(window))
+    {
+        std::fprintf(stderr, "Window not found\n");
+        return ExitNoWindow;
+    }
+
+    // The walk is the only thing on this thread, no message pump needed
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    if (FAILED(hr))
+    {
+        std::fprintf(stderr, "CoInitializeEx failed: 0x%08lx\n", static_cast<unsigned long>(hr));
+        return ExitNoWindow;
+    }
+
+    IUIAutomation* automation = nullptr;
+    hr = CoCreateInstance(__uuidof(CUIAutomation), nullptr, CLSCTX_INPROC_SERVER,
+                          __uuidof(IUIAutomation), reinterpret_cast<void**>(&automation));
+    if (FAILED(hr))
+    {
+        std::fprintf(stderr, "Cannot create UI Automation: 0x%08lx\n", static_cast<unsigned long>(hr));
+        CoUninitialize();
+        return ExitNoWindow;
+    }
+
+    // UTF-8 lines as written, without "\r\n" translation
+    _setmode(_fileno(stdout), _O_BINARY);
+
+    StreamResult result;
+    {
+        UiaTreeProvider provider(automation, window);
+        JsonLinesWriter writer(stdout, std::chrono::milliseconds(flushMs));
+        result = StreamControls(provider, options, writer);
+    }
+    automation->Release();
+    CoUninitialize();
+
+    std::fprintf(stderr, "%zu of %zu controls written in %.1f ms, %s\n",
+                 result.Written, result.Visited, result.Milliseconds, ToString(result.Status));
+
+    switch (result.Status)
+    {
+    case StreamStatus::Complete: return ExitComplete;
+    case StreamStatus::TimedOut: return ExitTimedOut;
+    case StreamStatus::WriteFailed: return ExitWriteFailed;
+    default: return ExitNoWindow;
+    }
+}